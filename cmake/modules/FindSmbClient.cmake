@@ -25,6 +25,24 @@ find_library(SMBCLIENT_LIBRARY NAMES smbclient
 
 set(SMBCLIENT_VERSION ${PC_SMBCLIENT_VERSION})
 
+if(SMBCLIENT_INCLUDE_DIR AND SMBCLIENT_LIBRARY)
+  # smbc_readdirplus (samba 4.5+) returns the attributes of all entries with the directory listing
+  include(CheckCSourceCompiles)
+  set(CMAKE_REQUIRED_INCLUDES ${SMBCLIENT_INCLUDE_DIR})
+  set(CMAKE_REQUIRED_LIBRARIES ${SMBCLIENT_LIBRARY})
+  check_c_source_compiles("#include <sys/types.h>
+                           #include <libsmbclient.h>
+
+                           int main()
+                           {
+                             const struct libsmb_file_info *info = smbc_readdirplus(0);
+                             return info != 0 && info->attrs != 0;
+                           }
+                          " HAVE_SMBC_READDIRPLUS)
+  unset(CMAKE_REQUIRED_INCLUDES)
+  unset(CMAKE_REQUIRED_LIBRARIES)
+endif()
+
 include(FindPackageHandleStandardArgs)
 find_package_handle_standard_args(SmbClient
                                   REQUIRED_VARS SMBCLIENT_LIBRARY SMBCLIENT_INCLUDE_DIR
@@ -34,6 +52,9 @@ if(SMBCLIENT_FOUND)
   set(SMBCLIENT_LIBRARIES ${SMBCLIENT_LIBRARY})
   set(SMBCLIENT_INCLUDE_DIRS ${SMBCLIENT_INCLUDE_DIR})
   set(SMBCLIENT_DEFINITIONS -DHAVE_LIBSMBCLIENT=1)
+  if(HAVE_SMBC_READDIRPLUS)
+    list(APPEND SMBCLIENT_DEFINITIONS -DHAVE_SMBC_READDIRPLUS=1)
+  endif()
 
   if(NOT TARGET SmbClient::SmbClient)
     add_library(SmbClient::SmbClient UNKNOWN IMPORTED)
@@ -41,6 +62,10 @@ if(SMBCLIENT_FOUND)
                                    IMPORTED_LOCATION "${SMBCLIENT_LIBRARY}"
                                    INTERFACE_INCLUDE_DIRECTORIES "${SMBCLIENT_INCLUDE_DIR}"
                                    INTERFACE_COMPILE_DEFINITIONS HAVE_LIBSMBCLIENT=1)
+    if(HAVE_SMBC_READDIRPLUS)
+      set_property(TARGET SmbClient::SmbClient APPEND PROPERTY
+                                   INTERFACE_COMPILE_DEFINITIONS HAVE_SMBC_READDIRPLUS=1)
+    endif()
   endif()
 endif()
 
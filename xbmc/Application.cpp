@@ -28,6 +28,7 @@
 #include "utils/JobManager.h"
 #include "utils/Variant.h"
 #include "utils/Splash.h"
+#include "utils/TaskGraph.h"
 #include "LangInfo.h"
 #include "utils/Screenshot.h"
 #include "Util.h"
@@ -595,6 +596,7 @@ bool CApplication::Create()
 
   // Initialize default Settings - don't move
   CLog::Log(LOGNOTICE, "load settings...");
+  int64_t start = CTaskTrace::Now();
   if (!m_ServiceManager->GetSettings().Initialize())
     return false;
 
@@ -605,6 +607,7 @@ bool CApplication::Create()
     return false;
   }
   m_ServiceManager->GetSettings().SetLoaded();
+  m_ServiceManager->GetStartupTrace().Add("create", "settings", start);
 
   CLog::Log(LOGINFO, "creating subdirectories");
   CLog::Log(LOGINFO, "userdata folder: %s", CURL::GetRedacted(CProfilesManager::GetInstance().GetProfileUserDataFolder()).c_str());
@@ -622,20 +625,16 @@ bool CApplication::Create()
 #endif // TARGET_WINDOWS
 
   // initialize the addon database (must be before the addon manager is init'd)
+  start = CTaskTrace::Now();
   CDatabaseManager::GetInstance().Initialize(true);
+  m_ServiceManager->GetStartupTrace().Add("create", "addondatabase", start);
 
+  // starts the AudioEngine too
   if (!m_ServiceManager->Init2())
   {
     return false;
   }
 
-  // start the AudioEngine
-  if(!m_ServiceManager->StartAudioEngine())
-  {
-    CLog::Log(LOGFATAL, "CApplication::Create: Failed to start the AudioEngine");
-    return false;
-  }
-
   // restore AE's previous volume state
   SetHardwareVolume(m_volumeLevel);
   m_ServiceManager->GetActiveAE().SetMute(m_muted);
@@ -1101,22 +1100,21 @@ bool CApplication::Initialize()
   g_curlInterface.Unload();
 
   // initialize (and update as needed) our databases
-  CEvent event(true);
-  CJobManager::GetInstance().Submit([&event]() {
+  CTaskGraph graph("initialize", &m_ServiceManager->GetStartupTrace());
+  graph.Add("databases", []() {
     CDatabaseManager::GetInstance().Initialize();
-    event.Set();
+    return true;
   });
   std::string localizedStr = g_localizeStrings.Get(24150);
   int iDots = 1;
-  while (!event.WaitMSec(1000))
-  {
+  graph.Run([&localizedStr, &iDots]() {
     if (CDatabaseManager::GetInstance().m_bIsUpgrading)
       CSplash::GetInstance().Show(std::string(iDots, ' ') + localizedStr + std::string(iDots, '.'));
     if (iDots == 3)
       iDots = 1;
     else
       ++iDots;
-  }
+  });
   CSplash::GetInstance().Show();
 
   StartServices();
@@ -1128,12 +1126,14 @@ bool CApplication::Initialize()
   {
     m_ServiceManager->GetSettings().GetSetting(CSettings::SETTING_POWERMANAGEMENT_DISPLAYSOFF)->SetRequirementsMet(m_dpms->IsSupported());
 
+    int64_t start = CTaskTrace::Now();
     g_windowManager.CreateWindows();
+    m_ServiceManager->GetStartupTrace().Add("initialize", "windows", start);
 
     m_confirmSkinChange = false;
 
     std::vector<std::string> incompatibleAddons;
-    event.Reset();
+    CEvent event(true);
     std::atomic<bool> isMigratingAddons(false);
     CJobManager::GetInstance().Submit([&event, &incompatibleAddons, &isMigratingAddons]() {
         incompatibleAddons = CAddonSystemSettings::GetInstance().MigrateAddons([&isMigratingAddons]() {
@@ -1156,6 +1156,7 @@ bool CApplication::Initialize()
     m_incompatibleAddons = incompatibleAddons;
     m_confirmSkinChange = true;
 
+    start = CTaskTrace::Now();
     std::string defaultSkin = std::static_pointer_cast<const CSettingString>(m_ServiceManager->GetSettings().GetSetting(CSettings::SETTING_LOOKANDFEEL_SKIN))->GetDefault();
     if (!LoadSkin(m_ServiceManager->GetSettings().GetString(CSettings::SETTING_LOOKANDFEEL_SKIN)))
     {
@@ -1166,6 +1167,7 @@ bool CApplication::Initialize()
         return false;
       }
     }
+    m_ServiceManager->GetStartupTrace().Add("initialize", "skin", start);
 
     // initialize splash window after splash screen disappears
     // because we need a real window in the background which gets
@@ -57,7 +57,11 @@ void CBackgroundInfoLoader::Run()
 
         try
         {
-          if (LoadItemCached(pItem.get()) && m_pObserver)
+          // keep the GUI from releasing the info tag while we work on it
+          pItem->LockMusicInfoTag();
+          bool loaded = LoadItemCached(pItem.get());
+          pItem->UnlockMusicInfoTag();
+          if (loaded && m_pObserver)
             m_pObserver->OnItemLoaded(pItem.get());
         }
         catch (...)
@@ -77,7 +81,10 @@ void CBackgroundInfoLoader::Run()
 
         try
         {
-          if (LoadItemLookup(pItem.get()) && m_pObserver)
+          pItem->LockMusicInfoTag();
+          bool loaded = LoadItemLookup(pItem.get());
+          pItem->UnlockMusicInfoTag();
+          if (loaded && m_pObserver)
             m_pObserver->OnItemLoaded(pItem.get());
         }
         catch (...)
@@ -53,6 +53,7 @@
 #include "video/VideoInfoTag.h"
 #include "threads/SingleLock.h"
 #include "music/tags/MusicInfoTag.h"
+#include "music/tags/MusicInfoTagSource.h"
 #include "pictures/PictureInfoTag.h"
 #include "music/Artist.h"
 #include "music/Album.h"
@@ -246,6 +247,9 @@ CFileItem::CFileItem(const CGenre& genre)
 
 CFileItem::CFileItem(const CFileItem& item)
 : m_musicInfoTag(NULL),
+  m_musicInfoTagRow(0),
+  m_musicInfoTagChanged(false),
+  m_musicInfoTagLocks(0),
   m_videoInfoTag(NULL),
   m_pictureInfoTag(NULL),
   m_gameInfoTag(NULL)
@@ -368,6 +372,11 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
   m_dateTime = item.m_dateTime;
   m_dwSize = item.m_dwSize;
 
+  // copies share the source of the tag unless it was updated, so copying a
+  // huge listing doesn't create all of its tags
+  m_musicInfoTagSource = item.m_musicInfoTagChanged ? nullptr : item.m_musicInfoTagSource;
+  m_musicInfoTagRow = item.m_musicInfoTagRow;
+  m_musicInfoTagChanged = false;
   if (item.m_musicInfoTag)
   {
     if (m_musicInfoTag)
@@ -451,6 +460,9 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
 void CFileItem::Initialize()
 {
   m_musicInfoTag = NULL;
+  m_musicInfoTagRow = 0;
+  m_musicInfoTagChanged = false;
+  m_musicInfoTagLocks = 0;
   m_videoInfoTag = NULL;
   m_pictureInfoTag = NULL;
   m_gameInfoTag = NULL;
@@ -491,6 +503,7 @@ void CFileItem::Reset()
   m_mimetype.clear();
   delete m_musicInfoTag;
   m_musicInfoTag=NULL;
+  m_musicInfoTagSource.reset();
   delete m_videoInfoTag;
   m_videoInfoTag=NULL;
   m_epgInfoTag.reset();
@@ -540,10 +553,10 @@ void CFileItem::Archive(CArchive& ar)
     ar << m_specialSort;
     ar << m_doContentLookup;
 
-    if (m_musicInfoTag)
+    if (HasMusicInfoTag())
     {
       ar << 1;
-      ar << *m_musicInfoTag;
+      ar << *GetMusicInfoTag();
     }
     else
       ar << 0;
@@ -639,8 +652,8 @@ void CFileItem::Serialize(CVariant& value) const
   value["mimetype"] = m_mimetype;
   value["extrainfo"] = m_extrainfo;
 
-  if (m_musicInfoTag)
-    (*m_musicInfoTag).Serialize(value["musicInfoTag"]);
+  if (HasMusicInfoTag())
+    GetMusicInfoTag()->Serialize(value["musicInfoTag"]);
 
   if (m_videoInfoTag)
     (*m_videoInfoTag).Serialize(value["videoInfoTag"]);
@@ -1496,7 +1509,7 @@ bool CFileItem::IsSamePath(const CFileItem *item) const
   }
   if (IsMusicDb() && HasMusicInfoTag())
   {
-    CFileItem dbItem(m_musicInfoTag->GetURL(), false);
+    CFileItem dbItem(GetMusicInfoTag()->GetURL(), false);
     if (HasProperty("item_start"))
       dbItem.SetProperty("item_start", GetProperty("item_start"));
     return dbItem.IsSamePath(item);
@@ -1510,7 +1523,7 @@ bool CFileItem::IsSamePath(const CFileItem *item) const
   }
   if (item->IsMusicDb() && item->HasMusicInfoTag())
   {
-    CFileItem dbItem(item->m_musicInfoTag->GetURL(), false);
+    CFileItem dbItem(item->GetMusicInfoTag()->GetURL(), false);
     if (item->HasProperty("item_start"))
       dbItem.SetProperty("item_start", item->GetProperty("item_start"));
     return IsSamePath(&dbItem);
@@ -2195,6 +2208,8 @@ void CFileItemList::Sort(SortDescription sortDescription)
     sortItems[index] = std::shared_ptr<SortItem>(new SortItem);
     m_items[index]->ToSortable(*sortItems[index], fields);
     (*sortItems[index])[FieldId] = index;
+    // don't keep all the tags of a huge listing around just for sorting
+    m_items[index]->ReleaseMusicInfoTag();
   }
 
   // do the sorting
@@ -3261,7 +3276,7 @@ bool CFileItem::LoadMusicTag()
   if (!IsAudio())
     return false;
   // already loaded?
-  if (HasMusicInfoTag() && m_musicInfoTag->Loaded())
+  if (HasMusicInfoTag() && GetMusicInfoTag()->Loaded())
     return true;
   // check db
   CMusicDatabase musicDatabase;
@@ -3425,10 +3440,89 @@ CPictureInfoTag* CFileItem::GetPictureInfoTag()
 
 MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
 {
+  if (m_musicInfoTagSource)
+  {
+    // the tag may be changed through the pointer, so keep it instead of
+    // creating it from the source again
+    CSingleLock lock(m_musicInfoTagSource->GetLock());
+    LoadMusicInfoTag();
+    m_musicInfoTagChanged = true;
+  }
+  else if (!m_musicInfoTag)
+    LoadMusicInfoTag();
+
+  return m_musicInfoTag;
+}
+
+const MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag() const
+{
+  if (!m_musicInfoTag && m_musicInfoTagSource)
+    LoadMusicInfoTag();
+
+  return m_musicInfoTag;
+}
+
+void CFileItem::LoadMusicInfoTag() const
+{
+  if (m_musicInfoTagSource)
+  {
+    CSingleLock lock(m_musicInfoTagSource->GetLock());
+    if (!m_musicInfoTag)
+      m_musicInfoTag = m_musicInfoTagSource->CreateTag(m_musicInfoTagRow);
+  }
+
   if (!m_musicInfoTag)
     m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
+}
 
-  return m_musicInfoTag;
+void CFileItem::SetMusicInfoTagSource(std::shared_ptr<const MUSIC_INFO::CMusicInfoTagSource> source, unsigned int row)
+{
+  delete m_musicInfoTag;
+  m_musicInfoTag = NULL;
+  m_musicInfoTagSource = std::move(source);
+  m_musicInfoTagRow = row;
+  m_musicInfoTagChanged = false;
+}
+
+bool CFileItem::ReleaseMusicInfoTag()
+{
+  if (!m_musicInfoTagSource || !m_musicInfoTag)
+    return false;
+
+  CSingleLock lock(m_musicInfoTagSource->GetLock());
+  if (m_musicInfoTagLocks > 0 || m_musicInfoTagChanged)
+    return false;
+
+  delete m_musicInfoTag;
+  m_musicInfoTag = NULL;
+  return true;
+}
+
+void CFileItem::LockMusicInfoTag()
+{
+  std::shared_ptr<const MUSIC_INFO::CMusicInfoTagSource> source(m_musicInfoTagSource);
+  if (!source)
+    return;
+
+  CSingleLock lock(source->GetLock());
+  m_musicInfoTagLocks++;
+}
+
+void CFileItem::UnlockMusicInfoTag()
+{
+  std::shared_ptr<const MUSIC_INFO::CMusicInfoTagSource> source(m_musicInfoTagSource);
+  if (!source)
+    return;
+
+  CSingleLock lock(source->GetLock());
+  if (m_musicInfoTagLocks > 0)
+    m_musicInfoTagLocks--;
+}
+
+void CFileItem::FreeMemory(bool immediately /* = false */)
+{
+  CGUIListItem::FreeMemory(immediately);
+  ReleaseMusicInfoTag();
 }
 
 CGameInfoTag* CFileItem::GetGameInfoTag()
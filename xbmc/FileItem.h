@@ -44,6 +44,7 @@
 namespace MUSIC_INFO
 {
   class CMusicInfoTag;
+  class CMusicInfoTagSource;
 }
 class CVideoInfoTag;
 class CPictureInfoTag;
@@ -260,15 +261,38 @@ public:
 
   inline bool HasMusicInfoTag() const
   {
-    return m_musicInfoTag != NULL;
+    return m_musicInfoTag != NULL || m_musicInfoTagSource != nullptr;
   }
 
   MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag();
 
-  inline const MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag() const
-  {
-    return m_musicInfoTag;
-  }
+  const MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag() const;
+
+  /*! \brief Lets the music info tag of the item be created from a source when it's accessed.
+   The tag is released again by FreeMemory() when the item isn't visible anymore, unless
+   it was accessed through the non-const GetMusicInfoTag(), which may change it.
+   \param source source of the tags of a listing, which is kept by the item
+   \param row row of the item in the source
+   \sa MUSIC_INFO::CMusicInfoTagSource
+   */
+  void SetMusicInfoTagSource(std::shared_ptr<const MUSIC_INFO::CMusicInfoTagSource> source, unsigned int row);
+  const std::shared_ptr<const MUSIC_INFO::CMusicInfoTagSource>& GetMusicInfoTagSource() const { return m_musicInfoTagSource; }
+
+  /*! \brief Releases a music info tag created from the source of the item.
+   \return true if the tag was released, false if the item has no source, the tag was accessed
+   for changes through GetMusicInfoTag() or it's locked by a background loader
+   \sa SetMusicInfoTagSource, LockMusicInfoTag
+   */
+  bool ReleaseMusicInfoTag();
+
+  /*! \brief Keeps the music info tag of the item from being released while it's worked on.
+   Only the item is locked, not the source of the whole listing. Every call has to be
+   matched by a call to UnlockMusicInfoTag().
+   */
+  void LockMusicInfoTag();
+  void UnlockMusicInfoTag();
+
+  virtual void FreeMemory(bool immediately = false);
 
   bool HasVideoInfoTag() const;
 
@@ -566,6 +590,8 @@ private:
    */
   CBookmark GetResumePoint() const;
 
+  void LoadMusicInfoTag() const;
+
   std::string m_strPath;            ///< complete path to item
 
   SortSpecial m_specialSort;
@@ -575,7 +601,11 @@ private:
   std::string m_mimetype;
   std::string m_extrainfo;
   bool m_doContentLookup;
-  MUSIC_INFO::CMusicInfoTag* m_musicInfoTag;
+  mutable MUSIC_INFO::CMusicInfoTag* m_musicInfoTag; // created from m_musicInfoTagSource when first accessed
+  std::shared_ptr<const MUSIC_INFO::CMusicInfoTagSource> m_musicInfoTagSource;
+  unsigned int m_musicInfoTagRow;
+  bool m_musicInfoTagChanged;
+  unsigned int m_musicInfoTagLocks; // guarded by the lock of m_musicInfoTagSource
   CVideoInfoTag* m_videoInfoTag;
   PVR::CPVREpgInfoTagPtr m_epgInfoTag;
   PVR::CPVRChannelPtr m_pvrChannelInfoTag;
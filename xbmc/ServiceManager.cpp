@@ -35,6 +35,8 @@
 #include "pvr/PVRManager.h"
 #include "settings/Settings.h"
 
+#define STARTUP_TRACE_FILE "special://temp/startup-trace.json"
+
 using namespace KODI;
 
 CServiceManager::CServiceManager() :
@@ -69,24 +71,51 @@ bool CServiceManager::Init1()
 
 bool CServiceManager::Init2()
 {
+  // sets up the environment the others run in
+  int64_t start = CTaskTrace::Now();
   m_Platform->Init();
+  m_startupTrace.Add("init2", "platform", start);
 
   m_addonMgr.reset(new ADDON::CAddonMgr());
-  if (!m_addonMgr->Init())
-  {
-    CLog::Log(LOGFATAL, "CServiceManager::Init: Unable to start CAddonMgr");
-    return false;
-  }
-
   m_PVRManager.reset(new PVR::CPVRManager());
   m_dataCacheCore.reset(new CDataCacheCore());
-
   m_binaryAddonCache.reset( new ADDON::CBinaryAddonCache());
-  m_binaryAddonCache->Init();
-
-  m_favouritesService.reset(new CFavouritesService(CProfilesManager::GetInstance().GetProfileUserDataFolder()));
   m_contextMenuManager.reset(new CContextMenuManager(*m_addonMgr.get()));
 
+  CTaskGraph graph("init2", &m_startupTrace);
+  graph.Add("addons", [this]() {
+    if (!m_addonMgr->Init())
+    {
+      CLog::Log(LOGFATAL, "CServiceManager::Init: Unable to start CAddonMgr");
+      return false;
+    }
+    return true;
+  });
+  graph.Add("binaryaddoncache", [this]() {
+    m_binaryAddonCache->Init();
+    return true;
+  }, { "addons" });
+  graph.Add("favourites", [this]() {
+    m_favouritesService.reset(new CFavouritesService(CProfilesManager::GetInstance().GetProfileUserDataFolder()));
+    return true;
+  });
+  // opening the audio devices doesn't need the add-ons, the engine isn't
+  // created yet when running the tests
+  if (m_ActiveAE)
+  {
+    graph.Add("audioengine", [this]() {
+      if (!StartAudioEngine())
+      {
+        CLog::Log(LOGFATAL, "CServiceManager::Init: Unable to start the AudioEngine");
+        return false;
+      }
+      return true;
+    });
+  }
+
+  if (!graph.Run())
+    return false;
+
   init_level = 2;
   return true;
 }
@@ -122,10 +151,28 @@ bool CServiceManager::StartAudioEngine()
 
 bool CServiceManager::Init3()
 {
-  m_peripherals->Initialise();
-  m_PVRManager->Init();
-  m_contextMenuManager->Init();
-  m_gameServices->Init(*m_peripherals);
+  CTaskGraph graph("init3", &m_startupTrace);
+  // scanning the busses can take seconds, e.g. to open a CEC adapter
+  graph.Add("peripherals", [this]() {
+    m_peripherals->Initialise();
+    return true;
+  });
+  graph.Add("games", [this]() {
+    m_gameServices->Init(*m_peripherals);
+    return true;
+  }, { "peripherals" });
+  // gets dialogs of the window manager
+  graph.Add("pvr", [this]() {
+    m_PVRManager->Init();
+    return true;
+  }, {}, true);
+  graph.Add("contextmenu", [this]() {
+    m_contextMenuManager->Init();
+    return true;
+  });
+  graph.Run();
+
+  m_startupTrace.Write(STARTUP_TRACE_FILE);
 
   init_level = 3;
   return true;
@@ -223,6 +270,11 @@ CFavouritesService& CServiceManager::GetFavouritesService()
   return *m_favouritesService;
 }
 
+CTaskTrace& CServiceManager::GetStartupTrace()
+{
+  return m_startupTrace;
+}
+
 // deleters for unique_ptr
 void CServiceManager::delete_dataCacheCore::operator()(CDataCacheCore *p) const
 {
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include "platform/Platform.h"
+#include "utils/TaskGraph.h"
 
 namespace ADDON {
 class CAddonMgr;
@@ -104,6 +105,10 @@ public:
   CSettings& GetSettings();
   CFavouritesService& GetFavouritesService();
 
+  /**\brief Get the trace of the startup steps, written to special://temp/ by Init3()
+   */
+  CTaskTrace& GetStartupTrace();
+
 protected:
   struct delete_dataCacheCore
   {
@@ -141,4 +146,5 @@ protected:
   std::unique_ptr<KODI::GAME::CGameServices> m_gameServices;
   std::unique_ptr<PERIPHERALS::CPeripherals> m_peripherals;
   std::unique_ptr<CFavouritesService, delete_favouritesService> m_favouritesService;
+  CTaskTrace m_startupTrace;
 };
@@ -18,9 +18,13 @@
  *
  */
 
+#include "system.h"
 #include "TextureCache.h"
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
+#ifdef HAS_WEB_SERVER
+#include "network/httprequesthandler/HTTPResponseCache.h"
+#endif
 #include "profiles/ProfilesManager.h"
 #include "threads/SingleLock.h"
 #include "utils/Crc32.h"
@@ -191,6 +195,11 @@ void CTextureCache::ClearCachedImage(const std::string &url, bool deleteSource /
   path = URIUtils::ReplaceExtension(path, ".dds");
   if (CFile::Exists(path))
     CFile::Delete(path);
+
+#ifdef HAS_WEB_SERVER
+  // drop any transformed versions of the image served by the webserver
+  CHTTPResponseCache::GetInstance().Invalidate(url);
+#endif
 }
 
 bool CTextureCache::ClearCachedImage(int id)
@@ -272,7 +281,13 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
     if (job->m_oldHash == job->m_details.hash)
       SetCachedTextureValid(job->m_url, job->m_details.updateable);
     else
+    {
       AddCachedTexture(job->m_url, job->m_details);
+#ifdef HAS_WEB_SERVER
+      // the image has changed so any transformed versions are outdated
+      CHTTPResponseCache::GetInstance().Invalidate(job->m_url);
+#endif
+    }
   }
 
   { // remove from our processing list
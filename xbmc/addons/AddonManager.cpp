@@ -61,6 +61,8 @@
 #include "utils/XMLUtils.h"
 #include "ServiceBroker.h"
 
+#define ADDON_MANIFEST_INDEX "special://temp/addonmanifests.bin"
+
 using namespace XFILE;
 
 namespace ADDON
@@ -333,26 +335,6 @@ bool CAddonMgr::Init()
   //! @todo could separate addons into different contexts would allow partial unloading of addon framework
   m_cp_context = m_cpluff->create_context(&status);
   assert(m_cp_context);
-  status = m_cpluff->register_pcollection(m_cp_context, CSpecialProtocol::TranslatePath("special://home/addons").c_str());
-  if (status != CP_OK)
-  {
-    CLog::Log(LOGERROR, "ADDONS: Fatal Error, cp_register_pcollection() returned status: %i", status);
-    return false;
-  }
-
-  status = m_cpluff->register_pcollection(m_cp_context, CSpecialProtocol::TranslatePath("special://xbmc/addons").c_str());
-  if (status != CP_OK)
-  {
-    CLog::Log(LOGERROR, "ADDONS: Fatal Error, cp_register_pcollection() returned status: %i", status);
-    return false;
-  }
-
-  status = m_cpluff->register_pcollection(m_cp_context, CSpecialProtocol::TranslatePath("special://xbmcbin/addons").c_str());
-  if (status != CP_OK)
-  {
-    CLog::Log(LOGERROR, "ADDONS: Fatal Error, cp_register_pcollection() returned status: %i", status);
-    return false;
-  }
 
   status = m_cpluff->register_logger(m_cp_context, cp_logger,
       this, clog_to_cp(g_advancedSettings.m_logLevel));
@@ -371,6 +353,9 @@ bool CAddonMgr::Init()
  if (!m_database.Open())
    CLog::Log(LOGFATAL, "ADDONS: Failed to open database");
 
+  // descriptors of add-ons which didn't change since the last run aren't parsed
+  // until they're used, see GetPluginInfo()
+  m_manifests.Load(ADDON_MANIFEST_INDEX);
   FindAddons();
 
   //Ensure required add-ons are installed and enabled
@@ -399,6 +384,7 @@ void CAddonMgr::DeInit()
 {
   m_cpluff->destroy_context(m_cp_context);
   m_cpluff.reset();
+  m_descriptors.clear();
   m_database.Close();
 }
 
@@ -570,30 +556,26 @@ bool CAddonMgr::GetAddonsInternal(const TYPE &type, VECADDONS &addons, bool enab
   if (!m_cp_context)
     return false;
 
+  if (type != ADDON_UNKNOWN && m_manifests.GetByType(type).empty())
+    return false;
+
   std::vector<CAddonBuilder> builders;
   m_database.GetInstalled(builders);
 
   for (auto& builder : builders)
   {
-    cp_status_t status;
-    cp_plugin_info_t* cp_addon = m_cpluff->get_plugin_info(m_cp_context, builder.GetId().c_str(), &status);
-    if (status == CP_OK && cp_addon)
-    {
-      if (enabledOnly && IsAddonDisabled(cp_addon->identifier))
-      {
-        m_cpluff->release_info(m_cp_context, cp_addon);
-        continue;
-      }
+    //FIXME: hack for skipping special dependency addons (xbmc.python etc.).
+    //Will break if any extension point is added to them
+    const CAddonManifestIndex::SManifest* manifest = m_manifests.Get(builder.GetId());
+    if (!manifest || !manifest->HasType(type))
+      continue;
 
-      //FIXME: hack for skipping special dependency addons (xbmc.python etc.).
-      //Will break if any extension point is added to them
-      cp_extension_t *props = GetFirstExtPoint(cp_addon, type);
-      if (props == nullptr)
-      {
-        m_cpluff->release_info(m_cp_context, cp_addon);
-        continue;
-      }
+    if (enabledOnly && IsAddonDisabled(builder.GetId()))
+      continue;
 
+    cp_plugin_info_t* cp_addon = GetPluginInfo(builder.GetId());
+    if (cp_addon)
+    {
       AddonPtr addon;
       if (Factory(cp_addon, type, builder))
         addon = builder.Build();
@@ -616,9 +598,12 @@ bool CAddonMgr::GetAddon(const std::string &str, AddonPtr &addon, const TYPE &ty
 {
   CSingleLock lock(m_critSection);
 
-  cp_status_t status;
-  cp_plugin_info_t *cpaddon = m_cpluff->get_plugin_info(m_cp_context, str.c_str(), &status);
-  if (status == CP_OK && cpaddon)
+  const CAddonManifestIndex::SManifest* manifest = m_manifests.Get(str);
+  if (!manifest || (type != ADDON_UNKNOWN && !manifest->HasType(type)))
+    return false;
+
+  cp_plugin_info_t *cpaddon = GetPluginInfo(str);
+  if (cpaddon)
   {
     addon = Factory(cpaddon, type);
     m_cpluff->release_info(m_cp_context, cpaddon);
@@ -635,12 +620,41 @@ bool CAddonMgr::GetAddon(const std::string &str, AddonPtr &addon, const TYPE &ty
     }
     return NULL != addon.get();
   }
-  if (cpaddon)
-    m_cpluff->release_info(m_cp_context, cpaddon);
-
   return false;
 }
 
+cp_plugin_info_t* CAddonMgr::GetPluginInfo(const std::string& id)
+{
+  const CAddonManifestIndex::SManifest* manifest = m_manifests.Get(id);
+  if (!manifest)
+    return nullptr;
+
+  cp_status_t status;
+  if (m_descriptors.find(id) == m_descriptors.end())
+  {
+    cp_plugin_info_t* info = m_cpluff->load_plugin_descriptor(m_cp_context, manifest->path.c_str(), &status);
+    if (!info)
+      return nullptr;
+
+    bool installed = manifest->id == info->identifier && m_cpluff->install_plugin(m_cp_context, info) == CP_OK;
+    m_cpluff->release_info(m_cp_context, info);
+    if (!installed)
+    {
+      CLog::Log(LOGERROR, "ADDONS: failed to load descriptor of %s from %s", id.c_str(), manifest->path.c_str());
+      return nullptr;
+    }
+    m_descriptors[id] = manifest->path;
+  }
+
+  return m_cpluff->get_plugin_info(m_cp_context, id.c_str(), &status);
+}
+
+void CAddonMgr::UnloadDescriptor(const std::string& id)
+{
+  if (m_descriptors.erase(id) > 0)
+    m_cpluff->uninstall_plugin(m_cp_context, id.c_str());
+}
+
 bool CAddonMgr::FindAddons()
 {
   bool result = false;
@@ -648,17 +662,67 @@ bool CAddonMgr::FindAddons()
   if (m_cpluff && m_cp_context)
   {
     result = true;
-    m_cpluff->scan_plugins(m_cp_context, CP_SP_UPGRADE);
+
+    std::vector<std::string> directories = {
+      CSpecialProtocol::TranslatePath("special://home/addons"),
+      CSpecialProtocol::TranslatePath("special://xbmc/addons"),
+      CSpecialProtocol::TranslatePath("special://xbmcbin/addons")
+    };
+
+    // only new and changed descriptors are parsed
+    std::map<std::string, cp_plugin_info_t*> parsed;
+    bool changed = m_manifests.Scan(directories,
+      [this, &parsed](const std::string& path, CAddonManifestIndex::SManifest& manifest)
+      {
+        cp_status_t status;
+        cp_plugin_info_t* info = m_cpluff->load_plugin_descriptor(m_cp_context, path.c_str(), &status);
+        if (!info)
+          return false;
+
+        manifest.id = info->identifier;
+        manifest.version = info->version ? info->version : "";
+        for (unsigned int i = 0; i < info->num_extensions; ++i)
+        {
+          const char* extPoint = info->extensions[i].ext_point_id;
+          if (strcmp(extPoint, "kodi.addon.metadata") != 0 && strcmp(extPoint, "xbmc.addon.metadata") != 0)
+            manifest.extPoints.push_back(extPoint);
+        }
+        parsed[path] = info;
+        return true;
+      });
+
+    // drop loaded descriptors which changed or whose add-on is gone
+    for (auto it = m_descriptors.begin(); it != m_descriptors.end();)
+    {
+      const CAddonManifestIndex::SManifest* manifest = m_manifests.Get(it->first);
+      if (!manifest || manifest->path != it->second || parsed.find(it->second) != parsed.end())
+      {
+        m_cpluff->uninstall_plugin(m_cp_context, it->first.c_str());
+        it = m_descriptors.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    // keep what had to be parsed anyway
+    for (const auto& descriptor : parsed)
+    {
+      const CAddonManifestIndex::SManifest* manifest = m_manifests.Get(descriptor.second->identifier);
+      if (manifest && manifest->path == descriptor.first &&
+          m_cpluff->install_plugin(m_cp_context, descriptor.second) == CP_OK)
+        m_descriptors[manifest->id] = manifest->path;
+      m_cpluff->release_info(m_cp_context, descriptor.second);
+    }
+
+    if (changed)
+      m_manifests.Store(ADDON_MANIFEST_INDEX);
+
+    CLog::Log(LOGDEBUG, "ADDONS: found %zu add-ons, parsed %zu descriptors", m_manifests.GetIds().size(), parsed.size());
 
     //Sync with db
     {
-      std::set<std::string> installed;
-      cp_status_t status;
-      int n;
-      cp_plugin_info_t** cp_addons = m_cpluff->get_plugins_info(m_cp_context, &status, &n);
-      for (int i = 0; i < n; ++i)
-        installed.insert(cp_addons[i]->identifier);
-      m_cpluff->release_info(m_cp_context, cp_addons);
+      std::vector<std::string> ids = m_manifests.GetIds();
+      std::set<std::string> installed(ids.begin(), ids.end());
       m_database.SyncInstalled(installed, m_systemAddons, m_optionalAddons);
     }
 
@@ -682,8 +746,9 @@ bool CAddonMgr::UnloadAddon(const AddonPtr& addon)
   CSingleLock lock(m_critSection);
   if (m_cpluff && m_cp_context)
   {
-    if (m_cpluff->uninstall_plugin(m_cp_context, addon->ID().c_str()) == CP_OK)
+    if (m_manifests.Remove(addon->ID()))
     {
+      UnloadDescriptor(addon->ID());
       m_events.Publish(AddonEvents::InstalledChanged());
       return true;
     }
@@ -697,7 +762,8 @@ bool CAddonMgr::ReloadAddon(AddonPtr& addon)
   if (!addon ||!m_cpluff || !m_cp_context)
     return false;
 
-  m_cpluff->uninstall_plugin(m_cp_context, addon->ID().c_str());
+  m_manifests.Remove(addon->ID());
+  UnloadDescriptor(addon->ID());
   return FindAddons()
       && GetAddon(addon->ID(), addon, ADDON_UNKNOWN, false)
       && EnableAddon(addon->ID());
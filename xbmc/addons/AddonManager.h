@@ -21,6 +21,7 @@
 #include "Addon.h"
 #include "AddonDatabase.h"
 #include "AddonEvents.h"
+#include "AddonManifestIndex.h"
 #include "Repository.h"
 #include "threads/CriticalSection.h"
 #include "utils/EventStream.h"
@@ -269,6 +270,12 @@ namespace ADDON
     static bool PlatformSupportsAddon(const cp_plugin_info_t *info);
 
     bool GetAddonsInternal(const TYPE &type, VECADDONS &addons, bool enabledOnly);
+
+    /*! \brief Get the descriptor of an add-on in the index, loads it into libcpluff if it isn't yet.
+     \return the descriptor, release it with release_info(), or nullptr if the add-on isn't found
+     */
+    cp_plugin_info_t* GetPluginInfo(const std::string& id);
+    void UnloadDescriptor(const std::string& id);
     bool EnableSingle(const std::string& id);
 
     std::set<std::string> m_disabled;
@@ -279,6 +286,8 @@ namespace ADDON
     CEventSource<AddonEvent> m_events;
     std::set<std::string> m_systemAddons;
     std::set<std::string> m_optionalAddons;
+    CAddonManifestIndex m_manifests;
+    std::map<std::string, std::string> m_descriptors; //!< add-ons loaded into libcpluff, and the directory loaded from
     bool m_serviceSystemStarted;
   };
 
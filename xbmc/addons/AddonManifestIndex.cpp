@@ -0,0 +1,309 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AddonManifestIndex.h"
+
+#include <algorithm>
+
+#include "AddonVersion.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/BinarySerializer.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#define MANIFESTINDEX_MAGIC     "KAMI"
+#define MANIFESTINDEX_VERSION   1
+// upper limits to reject broken files early
+#define MANIFESTINDEX_MAX_SIZE  (16 * 1024 * 1024)
+#define MANIFESTINDEX_MAX_ITEMS 100000
+
+namespace ADDON
+{
+
+bool CAddonManifestIndex::SManifest::HasType(TYPE type) const
+{
+  if (type == ADDON_UNKNOWN)
+    return !types.empty();
+  return std::find(types.begin(), types.end(), type) != types.end();
+}
+
+bool CAddonManifestIndex::Load(const std::string &file)
+{
+  XFILE::CFile input;
+  if (!input.Open(file))
+    return false;
+
+  int64_t length = input.GetLength();
+  if (length <= 0 || length > MANIFESTINDEX_MAX_SIZE)
+    return false;
+
+  std::string data(static_cast<size_t>(length), '\0');
+  if (input.Read(&data[0], data.size()) != static_cast<ssize_t>(data.size()))
+    return false;
+
+  CBinaryReader reader(data.c_str(), data.size());
+
+  uint32_t version, count;
+  if (!reader.ReadMagic(MANIFESTINDEX_MAGIC) || !reader.Read(version) || version != MANIFESTINDEX_VERSION ||
+      !reader.Read(count) || count > MANIFESTINDEX_MAX_ITEMS)
+    return false;
+
+  std::vector<SDirectory> directories(count);
+  for (auto &directory : directories)
+  {
+    if (!reader.ReadString(directory.path) || !reader.Read(directory.modified) ||
+        !reader.ReadStrings(directory.addons, MANIFESTINDEX_MAX_ITEMS))
+      return false;
+  }
+
+  if (!reader.Read(count) || count > MANIFESTINDEX_MAX_ITEMS)
+    return false;
+
+  std::map<std::string, SManifest> manifests;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    SManifest manifest;
+    if (!reader.ReadString(manifest.path) || !reader.Read(manifest.size) || !reader.Read(manifest.modified) ||
+        !reader.ReadString(manifest.id) || !reader.ReadString(manifest.version) ||
+        !reader.ReadStrings(manifest.extPoints, MANIFESTINDEX_MAX_ITEMS))
+      return false;
+    manifests[manifest.path] = std::move(manifest);
+  }
+
+  if (!reader.AtEnd())
+  {
+    CLog::Log(LOGWARNING, "CAddonManifestIndex::%s - invalid index %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  m_directories = std::move(directories);
+  m_manifests = std::move(manifests);
+  m_byId.clear();
+  m_byType.clear();
+  return true;
+}
+
+bool CAddonManifestIndex::Store(const std::string &file) const
+{
+  std::string data;
+  CBinaryWriter writer(data);
+  writer.WriteMagic(MANIFESTINDEX_MAGIC);
+  writer.Write(static_cast<uint32_t>(MANIFESTINDEX_VERSION));
+
+  writer.Write(static_cast<uint32_t>(m_directories.size()));
+  for (const auto &directory : m_directories)
+  {
+    writer.WriteString(directory.path);
+    writer.Write(directory.modified);
+    writer.WriteStrings(directory.addons);
+  }
+
+  writer.Write(static_cast<uint32_t>(m_manifests.size()));
+  for (const auto &it : m_manifests)
+  {
+    const SManifest &manifest = it.second;
+    writer.WriteString(manifest.path);
+    writer.Write(manifest.size);
+    writer.Write(manifest.modified);
+    writer.WriteString(manifest.id);
+    writer.WriteString(manifest.version);
+    writer.WriteStrings(manifest.extPoints);
+  }
+
+  XFILE::CFile output;
+  if (!output.OpenForWrite(file, true) ||
+      output.Write(data.c_str(), data.size()) != static_cast<ssize_t>(data.size()))
+  {
+    CLog::Log(LOGWARNING, "CAddonManifestIndex::%s - failed to write %s", __FUNCTION__, file.c_str());
+    output.Close();
+    XFILE::CFile::Delete(file);
+    return false;
+  }
+  return true;
+}
+
+bool CAddonManifestIndex::Scan(const std::vector<std::string> &directories, const Parser &parser)
+{
+  bool changed = false;
+  std::vector<SDirectory> scanned;
+  std::map<std::string, SManifest> manifests;
+
+  for (const auto &path : directories)
+  {
+    SDirectory directory;
+    directory.path = path;
+
+    int64_t size;
+    if (!GetFileInfo(path, size, directory.modified))
+    {
+      directory.modified = 0;
+      scanned.push_back(std::move(directory));
+      continue;
+    }
+
+    auto known = std::find_if(m_directories.begin(), m_directories.end(),
+                              [&path](const SDirectory &other) { return other.path == path; });
+    if (known != m_directories.end() && known->modified == directory.modified)
+      directory.addons = known->addons;
+    else
+    {
+      // add-ons were added or removed, or the directory is new to the index
+      changed = true;
+      CFileItemList items;
+      XFILE::CDirectory::GetDirectory(path, items, "", XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_BYPASS_CACHE);
+      for (int i = 0; i < items.Size(); i++)
+      {
+        if (!items[i]->m_bIsFolder)
+          continue;
+
+        std::string addonPath = items[i]->GetPath();
+        URIUtils::RemoveSlashAtEnd(addonPath);
+        if (!StringUtils::StartsWith(URIUtils::GetFileName(addonPath), "."))
+          directory.addons.push_back(addonPath);
+      }
+      std::sort(directory.addons.begin(), directory.addons.end());
+    }
+
+    for (const auto &addonPath : directory.addons)
+    {
+      SManifest manifest;
+      manifest.path = addonPath;
+      if (!GetFileInfo(URIUtils::AddFileToFolder(addonPath, "addon.xml"), manifest.size, manifest.modified))
+        continue;
+
+      auto it = m_manifests.find(addonPath);
+      if (it != m_manifests.end() && it->second.size == manifest.size && it->second.modified == manifest.modified)
+      {
+        manifests.insert(*it);
+        continue;
+      }
+
+      changed = true;
+      if (!parser(addonPath, manifest))
+      {
+        // remember invalid descriptors too, they aren't parsed again until they change
+        manifest.id.clear();
+        manifest.extPoints.clear();
+      }
+      manifests[addonPath] = std::move(manifest);
+    }
+
+    scanned.push_back(std::move(directory));
+  }
+
+  if (manifests.size() != m_manifests.size())
+    changed = true;
+
+  m_directories = std::move(scanned);
+  m_manifests = std::move(manifests);
+  Resolve();
+  return changed;
+}
+
+const CAddonManifestIndex::SManifest* CAddonManifestIndex::Get(const std::string &id) const
+{
+  auto it = m_byId.find(id);
+  return it != m_byId.end() ? it->second : nullptr;
+}
+
+const std::vector<const CAddonManifestIndex::SManifest*>& CAddonManifestIndex::GetByType(TYPE type) const
+{
+  static const std::vector<const SManifest*> empty;
+  auto it = m_byType.find(type);
+  return it != m_byType.end() ? it->second : empty;
+}
+
+std::vector<std::string> CAddonManifestIndex::GetIds() const
+{
+  std::vector<std::string> ids;
+  ids.reserve(m_byId.size());
+  for (const auto &it : m_byId)
+    ids.push_back(it.first);
+  return ids;
+}
+
+bool CAddonManifestIndex::Remove(const std::string &id)
+{
+  auto it = m_byId.find(id);
+  if (it == m_byId.end())
+    return false;
+
+  const SManifest *manifest = it->second;
+  m_byId.erase(it);
+  for (auto type : manifest->types)
+  {
+    auto &manifests = m_byType[type];
+    manifests.erase(std::remove(manifests.begin(), manifests.end(), manifest), manifests.end());
+  }
+  return true;
+}
+
+bool CAddonManifestIndex::GetFileInfo(const std::string &path, int64_t &size, int64_t &modified)
+{
+  struct __stat64 buffer;
+  if (XFILE::CFile::Stat(path, &buffer) != 0)
+    return false;
+
+  size = buffer.st_size;
+  modified = buffer.st_mtime;
+  return true;
+}
+
+void CAddonManifestIndex::Resolve()
+{
+  m_byId.clear();
+  m_byType.clear();
+
+  for (const auto &directory : m_directories)
+  {
+    for (const auto &addonPath : directory.addons)
+    {
+      auto it = m_manifests.find(addonPath);
+      if (it == m_manifests.end() || it->second.id.empty())
+        continue;
+
+      SManifest &manifest = it->second;
+      manifest.types.clear();
+      for (const auto &extPoint : manifest.extPoints)
+        manifest.types.push_back(CAddonInfo::TranslateType(extPoint));
+
+      auto known = m_byId.find(manifest.id);
+      if (known == m_byId.end())
+        m_byId.insert(std::make_pair(manifest.id, &manifest));
+      else if (AddonVersion(manifest.version) > AddonVersion(known->second->version))
+        known->second = &manifest;
+    }
+  }
+
+  for (const auto &it : m_byId)
+  {
+    for (auto type : it.second->types)
+    {
+      auto &manifests = m_byType[type];
+      if (std::find(manifests.begin(), manifests.end(), it.second) == manifests.end())
+        manifests.push_back(it.second);
+    }
+  }
+}
+
+}
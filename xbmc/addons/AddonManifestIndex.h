@@ -0,0 +1,120 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <functional>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AddonInfo.h"
+
+namespace ADDON
+{
+
+/*!
+ \brief Index of the add-on descriptors in the add-on directories.
+
+ Keeps the id, version and extension points of every add-on, so add-ons can
+ be looked up by id and type without parsing their addon.xml. The index is
+ stored in a compact binary file between runs. A directory is only listed
+ again when its modification time changed and a descriptor is only parsed
+ again when the size or modification time of its addon.xml changed.
+ */
+class CAddonManifestIndex
+{
+public:
+  struct SManifest
+  {
+    std::string id;                     //!< empty if the descriptor is invalid
+    std::string version;
+    std::string path;                   //!< the add-on directory
+    int64_t size;                       //!< size of addon.xml
+    int64_t modified;                   //!< modification time of addon.xml
+    std::vector<std::string> extPoints; //!< extension points, without the metadata
+    std::vector<TYPE> types;            //!< types of the extension points
+
+    /*!
+     \brief Whether an extension point provides the type, any extension point
+     for ADDON_UNKNOWN.
+     */
+    bool HasType(TYPE type) const;
+  };
+
+  /*!
+   \brief Parses the descriptor of a new or changed add-on.
+   \param path the add-on directory
+   \param manifest [out] the id, version and extension points
+   \return false if the directory has no valid descriptor
+   */
+  typedef std::function<bool(const std::string &path, SManifest &manifest)> Parser;
+
+  CAddonManifestIndex() = default;
+  CAddonManifestIndex(const CAddonManifestIndex&) = delete;
+  CAddonManifestIndex& operator=(const CAddonManifestIndex&) = delete;
+
+  /*!
+   \brief Load an index stored by Store(). Nothing can be looked up before the
+   next Scan(), which validates it against the directories.
+   */
+  bool Load(const std::string &file);
+  bool Store(const std::string &file) const;
+
+  /*!
+   \brief Find the add-ons in the directories. If an add-on is found more
+   than once, the highest version is used, and the first one found of the same
+   version.
+   \param directories the add-on directories in order of priority
+   \param parser called for add-ons which aren't in the index or changed
+   \return true if the index changed and should be stored
+   */
+  bool Scan(const std::vector<std::string> &directories, const Parser &parser);
+
+  const SManifest* Get(const std::string &id) const;
+  const std::vector<const SManifest*>& GetByType(TYPE type) const;
+  std::vector<std::string> GetIds() const;
+
+  /*!
+   \brief Hide an add-on until the next Scan().
+   \return false if the add-on isn't in the index
+   */
+  bool Remove(const std::string &id);
+
+private:
+  struct SDirectory
+  {
+    std::string path;
+    int64_t modified;
+    std::vector<std::string> addons; //!< the add-on directories it contains
+  };
+
+  static bool GetFileInfo(const std::string &path, int64_t &size, int64_t &modified);
+  void Resolve();
+
+  std::vector<SDirectory> m_directories;
+  std::map<std::string, SManifest> m_manifests; //!< by add-on directory
+  std::unordered_map<std::string, const SManifest*> m_byId;
+  std::map<TYPE, std::vector<const SManifest*>> m_byType;
+};
+
+}
@@ -21,6 +21,8 @@
 #include "Skin.h"
 #include "AddonManager.h"
 #include "ServiceBroker.h"
+#include "FileItem.h"
+#include "GUIInfoManager.h"
 #include "Util.h"
 #include "dialogs/GUIDialogKaiToast.h"
 // fallback for new skin resolution code
@@ -31,8 +33,10 @@
 #include "guilib/WindowIDs.h"
 #include "messaging/ApplicationMessenger.h"
 #include "messaging/helpers/DialogHelper.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/lib/Setting.h"
+#include "utils/Crc32.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -192,6 +196,7 @@ CSkinInfo::CSkinInfo(
       m_defaultRes(resolution),
       m_resolutions(resolutions),
       m_effectsSlowDown(effectsSlowDown),
+      m_skinIncludeFiles(0),
       m_debugging(debugging)
 {
   LoadStartupWindows(nullptr);
@@ -278,6 +283,24 @@ void CSkinInfo::LoadIncludes()
   CLog::Log(LOGINFO, "Loading skin includes from %s", includesPath.c_str());
   m_includes.Clear();
   m_includes.Load(includesPath);
+  m_skinIncludeFiles = m_includes.GetFiles().size();
+
+  // cached windows are valid as long as the skin, its resolution and none
+  // of its XML files change
+  std::string key = StringUtils::Format("%s|%s|%s", ID().c_str(), Version().asString().c_str(), m_currentAspect.c_str());
+  std::vector<std::string> paths;
+  GetSkinPaths(paths);
+  for (const auto &path : paths)
+  {
+    CFileItemList items;
+    CDirectory::GetDirectory(path, items, ".xml", DIR_FLAG_NO_FILE_DIRS);
+    for (int i = 0; i < items.Size(); i++)
+      key += StringUtils::Format("|%s:%" PRId64 ":%s", items[i]->GetPath().c_str(), items[i]->m_dwSize, items[i]->m_dateTime.GetAsDBDateTime().c_str());
+  }
+  for (const auto &file : m_includes.GetFiles())
+    key += "|" + file;
+
+  m_windowCache.SetSkinKey(StringUtils::Format("%08x%08zx", static_cast<uint32_t>(Crc32::Compute(key)), key.size()));
 }
 
 void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions /* = NULL */)
@@ -288,6 +311,50 @@ void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool
   m_includes.Resolve(node, xmlIncludeConditions);
 }
 
+std::unique_ptr<TiXmlElement> CSkinInfo::GetCachedWindow(const std::string &path, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions)
+{
+  if (!g_advancedSettings.m_guiSkinCache)
+    return nullptr;
+
+  CGUIWindowCache::SEntry entry;
+  if (!m_windowCache.Load(path, entry))
+    return nullptr;
+
+  // a skin setting or something else the includes depend on has changed
+  std::map<INFO::InfoPtr, bool> conditions;
+  for (const auto &condition : entry.conditions)
+  {
+    INFO::InfoPtr info = g_infoManager.Register(condition.first);
+    if (!info || info->Get() != condition.second)
+      return nullptr;
+    conditions.insert(std::make_pair(info, condition.second));
+  }
+
+  // other windows may rely on includes loaded by this one
+  for (const auto &file : entry.includeFiles)
+    m_includes.Load(file);
+
+  if (xmlIncludeConditions)
+    xmlIncludeConditions->swap(conditions);
+
+  return std::move(entry.window);
+}
+
+void CSkinInfo::CacheWindow(const std::string &path, const TiXmlElement *node, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  if (!g_advancedSettings.m_guiSkinCache || !node)
+    return;
+
+  std::vector<std::pair<std::string, bool>> conditions;
+  for (const auto &condition : xmlIncludeConditions)
+    conditions.push_back(std::make_pair(condition.first->GetExpression(), condition.second));
+
+  const std::vector<std::string> &files = m_includes.GetFiles();
+  std::vector<std::string> includeFiles(files.begin() + std::min(m_skinIncludeFiles, files.size()), files.end());
+
+  m_windowCache.Store(path, *node, conditions, includeFiles);
+}
+
 int CSkinInfo::GetStartWindow() const
 {
   int windowID = CServiceBroker::GetSettings().GetInt(CSettings::SETTING_LOOKANDFEEL_STARTUPWINDOW);
@@ -28,6 +28,7 @@
 #include "addons/Addon.h"
 #include "guilib/GraphicContext.h" // needed for the RESOLUTION members
 #include "guilib/GUIIncludes.h"    // needed for the GUIInclude member
+#include "guilib/GUIWindowCache.h" // needed for the GUIWindowCache member
 
 #define CREDIT_LINE_LENGTH 50
 
@@ -164,6 +165,20 @@ public:
 
   void ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions = NULL);
 
+  /*! \brief Get a window with includes resolved from the window cache
+   \param path the window XML
+   \param xmlIncludeConditions [out] the conditions used to resolve includes
+   \return the resolved window, nullptr if it isn't cached or include conditions have changed their values since
+   */
+  std::unique_ptr<TiXmlElement> GetCachedWindow(const std::string &path, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions);
+
+  /*! \brief Store a window with includes resolved in the window cache
+   \param path the window XML
+   \param node the window after ResolveIncludes()
+   \param xmlIncludeConditions the conditions used to resolve includes
+   */
+  void CacheWindow(const std::string &path, const TiXmlElement *node, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
   const std::vector<CStartupWindow> &GetStartupWindows() const { return m_startupWindows; };
@@ -235,6 +250,8 @@ protected:
 
   float m_effectsSlowDown;
   CGUIIncludes m_includes;
+  CGUIWindowCache m_windowCache;
+  size_t m_skinIncludeFiles;    ///< number of include files loaded with includes.xml
   std::string m_currentAspect;
 
   std::vector<CStartupWindow> m_startupWindows;
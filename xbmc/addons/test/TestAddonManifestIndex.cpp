@@ -0,0 +1,179 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "addons/AddonManifestIndex.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ADDON;
+
+class TestAddonManifestIndex : public testing::Test
+{
+protected:
+  TestAddonManifestIndex() : m_parsed(0)
+  {
+    m_root = CSpecialProtocol::TranslatePath("special://temp/manifestindex/");
+    XFILE::CDirectory::RemoveRecursive(m_root);
+    XFILE::CDirectory::Create(m_root);
+    m_directories.push_back(URIUtils::AddFileToFolder(m_root, "home"));
+    m_directories.push_back(URIUtils::AddFileToFolder(m_root, "system"));
+    for (const auto &directory : m_directories)
+      XFILE::CDirectory::Create(directory);
+
+    m_parser = [this](const std::string &path, CAddonManifestIndex::SManifest &manifest)
+    {
+      m_parsed++;
+      // the test descriptors are "id version extpoint..."
+      XFILE::CFile file;
+      std::string content;
+      char buffer[256];
+      ssize_t read;
+      if (!file.Open(URIUtils::AddFileToFolder(path, "addon.xml")))
+        return false;
+      while ((read = file.Read(buffer, sizeof(buffer))) > 0)
+        content.append(buffer, read);
+
+      std::vector<std::string> fields = StringUtils::Split(content, " ");
+      if (fields.size() < 2)
+        return false;
+      manifest.id = fields[0];
+      manifest.version = fields[1];
+      manifest.extPoints.assign(fields.begin() + 2, fields.end());
+      return true;
+    };
+  }
+
+  ~TestAddonManifestIndex()
+  {
+    XFILE::CDirectory::RemoveRecursive(m_root);
+  }
+
+  void CreateAddon(int directory, const std::string &name, const std::string &descriptor)
+  {
+    std::string path = URIUtils::AddFileToFolder(m_directories[directory], name);
+    XFILE::CDirectory::Create(path);
+    XFILE::CFile file;
+    ASSERT_TRUE(file.OpenForWrite(URIUtils::AddFileToFolder(path, "addon.xml"), true));
+    file.Write(descriptor.c_str(), descriptor.size());
+  }
+
+  std::string m_root;
+  std::vector<std::string> m_directories;
+  CAddonManifestIndex::Parser m_parser;
+  int m_parsed;
+};
+
+TEST_F(TestAddonManifestIndex, Scan)
+{
+  CreateAddon(0, "plugin.video.foo", "plugin.video.foo 1.0.0 xbmc.python.pluginsource");
+  CreateAddon(1, "plugin.video.foo", "plugin.video.foo 0.9.0 xbmc.python.pluginsource");
+  CreateAddon(1, "script.module.bar", "script.module.bar 2.0.0 xbmc.python.module");
+  CreateAddon(1, "xbmc.python", "xbmc.python 2.25.0");
+  CreateAddon(1, "broken", "broken");
+
+  CAddonManifestIndex index;
+  EXPECT_TRUE(index.Scan(m_directories, m_parser));
+  EXPECT_EQ(5, m_parsed);
+  EXPECT_EQ(3U, index.GetIds().size());
+
+  const CAddonManifestIndex::SManifest *manifest = index.Get("plugin.video.foo");
+  ASSERT_TRUE(manifest != nullptr);
+  EXPECT_EQ("1.0.0", manifest->version);
+  EXPECT_EQ(URIUtils::AddFileToFolder(m_directories[0], "plugin.video.foo"), manifest->path);
+  EXPECT_TRUE(manifest->HasType(ADDON_PLUGIN));
+  EXPECT_TRUE(manifest->HasType(ADDON_UNKNOWN));
+  EXPECT_FALSE(manifest->HasType(ADDON_SCRIPT_MODULE));
+
+  manifest = index.Get("xbmc.python");
+  ASSERT_TRUE(manifest != nullptr);
+  EXPECT_FALSE(manifest->HasType(ADDON_UNKNOWN));
+
+  EXPECT_TRUE(index.Get("broken") == nullptr);
+  ASSERT_EQ(1U, index.GetByType(ADDON_SCRIPT_MODULE).size());
+  EXPECT_EQ("script.module.bar", index.GetByType(ADDON_SCRIPT_MODULE)[0]->id);
+  EXPECT_TRUE(index.GetByType(ADDON_SKIN).empty());
+}
+
+TEST_F(TestAddonManifestIndex, StoreAndLoad)
+{
+  CreateAddon(0, "plugin.video.foo", "plugin.video.foo 1.0.0 xbmc.python.pluginsource");
+  CreateAddon(1, "broken", "broken");
+
+  std::string file = URIUtils::AddFileToFolder(m_root, "index.bin");
+  {
+    CAddonManifestIndex index;
+    index.Scan(m_directories, m_parser);
+    EXPECT_TRUE(index.Store(file));
+  }
+
+  // nothing changed, so nothing is parsed, not even the broken descriptor
+  m_parsed = 0;
+  CAddonManifestIndex index;
+  ASSERT_TRUE(index.Load(file));
+  EXPECT_FALSE(index.Scan(m_directories, m_parser));
+  EXPECT_EQ(0, m_parsed);
+
+  const CAddonManifestIndex::SManifest *manifest = index.Get("plugin.video.foo");
+  ASSERT_TRUE(manifest != nullptr);
+  EXPECT_EQ("1.0.0", manifest->version);
+  EXPECT_TRUE(manifest->HasType(ADDON_PLUGIN));
+
+  // a changed descriptor is parsed again
+  CreateAddon(0, "plugin.video.foo", "plugin.video.foo 1.0.10 xbmc.python.pluginsource");
+  EXPECT_TRUE(index.Scan(m_directories, m_parser));
+  EXPECT_EQ(1, m_parsed);
+  ASSERT_TRUE(index.Get("plugin.video.foo") != nullptr);
+  EXPECT_EQ("1.0.10", index.Get("plugin.video.foo")->version);
+}
+
+TEST_F(TestAddonManifestIndex, Remove)
+{
+  CreateAddon(0, "plugin.video.foo", "plugin.video.foo 1.0.0 xbmc.python.pluginsource");
+
+  CAddonManifestIndex index;
+  index.Scan(m_directories, m_parser);
+  EXPECT_TRUE(index.Remove("plugin.video.foo"));
+  EXPECT_FALSE(index.Remove("plugin.video.foo"));
+  EXPECT_TRUE(index.Get("plugin.video.foo") == nullptr);
+  EXPECT_TRUE(index.GetByType(ADDON_PLUGIN).empty());
+
+  // back after the next scan without being parsed again
+  m_parsed = 0;
+  index.Scan(m_directories, m_parser);
+  EXPECT_EQ(0, m_parsed);
+  EXPECT_TRUE(index.Get("plugin.video.foo") != nullptr);
+}
+
+TEST_F(TestAddonManifestIndex, LoadInvalid)
+{
+  std::string file = URIUtils::AddFileToFolder(m_root, "index.bin");
+  XFILE::CFile output;
+  ASSERT_TRUE(output.OpenForWrite(file, true));
+  output.Write("KAMI\x01", 5);
+  output.Close();
+
+  CAddonManifestIndex index;
+  EXPECT_FALSE(index.Load(file));
+}
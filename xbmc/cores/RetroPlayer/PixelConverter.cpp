@@ -19,9 +19,11 @@
  */
 
 #include "PixelConverter.h"
+#include "PixelConverterUtils.h"
 #include "cores/VideoPlayer/DVDClock.h"
 #include "cores/VideoPlayer/DVDCodecs/DVDCodecUtils.h"
 #include "cores/VideoPlayer/TimingConstants.h"
+#include "cores/VideoPlayer/VideoRenderers/DirectBufferPool.h"
 #include "utils/log.h"
 
 extern "C"
@@ -29,12 +31,27 @@ extern "C"
   #include "libswscale/swscale.h"
 }
 
+// Same layout as the buffers the FFmpeg decoder decodes into
+#define DIRECT_BUFFER_ALIGN 64
+
+namespace
+{
+  unsigned int AlignUp(unsigned int value)
+  {
+    return (value + DIRECT_BUFFER_ALIGN - 1) & ~(DIRECT_BUFFER_ALIGN - 1);
+  }
+}
+
 CPixelConverter::CPixelConverter() :
+  m_pixfmt(AV_PIX_FMT_NONE),
   m_renderFormat(RENDER_FMT_NONE),
   m_width(0),
   m_height(0),
   m_swsContext(nullptr),
-  m_buf(nullptr)
+  m_buf(nullptr),
+  m_bConvertToYUV420P(false),
+  m_directBufferPool(nullptr),
+  m_directBuffer(nullptr)
 {
 }
 
@@ -50,16 +67,21 @@ bool CPixelConverter::Open(AVPixelFormat pixfmt, AVPixelFormat targetfmt, unsign
     return false;
   }
 
+  m_pixfmt = pixfmt;
   m_width = width;
   m_height = height;
 
-  m_swsContext = sws_getContext(width, height, pixfmt,
-                                width, height, targetfmt,
-                                SWS_FAST_BILINEAR, NULL, NULL, NULL);
-  if (!m_swsContext)
+  m_bConvertToYUV420P = (targetfmt == AV_PIX_FMT_YUV420P && CPixelConverterUtils::CanConvert(pixfmt));
+  if (!m_bConvertToYUV420P)
   {
-    CLog::Log(LOGERROR, "%s: Failed to create swscale context", __FUNCTION__);
-    return false;
+    m_swsContext = sws_getContext(width, height, pixfmt,
+                                  width, height, targetfmt,
+                                  SWS_FAST_BILINEAR, NULL, NULL, NULL);
+    if (!m_swsContext)
+    {
+      CLog::Log(LOGERROR, "%s: Failed to create swscale context", __FUNCTION__);
+      return false;
+    }
   }
 
   m_buf = CDVDCodecUtils::AllocatePicture(width, height);
@@ -74,6 +96,9 @@ bool CPixelConverter::Open(AVPixelFormat pixfmt, AVPixelFormat targetfmt, unsign
 
 void CPixelConverter::Dispose()
 {
+  ReleaseDirectBuffer();
+  SAFE_RELEASE(m_directBufferPool);
+
   if (m_swsContext)
   {
     sws_freeContext(m_swsContext);
@@ -89,9 +114,12 @@ void CPixelConverter::Dispose()
 
 bool CPixelConverter::Decode(const uint8_t* pData, unsigned int size)
 {
-  if (pData == nullptr || size == 0 || m_swsContext == nullptr)
+  if (pData == nullptr || size == 0 || (m_swsContext == nullptr && !m_bConvertToYUV420P) || m_buf == nullptr)
     return false;
 
+  // The renderer holds its own reference to the previous frame
+  ReleaseDirectBuffer();
+
   uint8_t* dataMutable = const_cast<uint8_t*>(pData);
 
   const int stride = size / m_height;
@@ -101,7 +129,12 @@ bool CPixelConverter::Decode(const uint8_t* pData, unsigned int size)
   uint8_t* dst[] =       { m_buf->data[0],      m_buf->data[1],      m_buf->data[2],      0 };
   int      dstStride[] = { m_buf->iLineSize[0], m_buf->iLineSize[1], m_buf->iLineSize[2], 0 };
 
-  sws_scale(m_swsContext, src, srcStride, 0, m_height, dst, dstStride);
+  GetDirectBuffer(dst, dstStride);
+
+  if (m_bConvertToYUV420P)
+    CPixelConverterUtils::ConvertToYUV420P(m_pixfmt, pData, stride, m_width, m_height, dst, dstStride, m_convertBuffer);
+  else
+    sws_scale(m_swsContext, src, srcStride, 0, m_height, dst, dstStride);
 
   return true;
 }
@@ -117,6 +150,16 @@ void CPixelConverter::GetPicture(VideoPicture& dvdVideoPicture)
     dvdVideoPicture.iLineSize[i] = m_buf->iLineSize[i];
   }
 
+  if (m_directBuffer)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      dvdVideoPicture.data[i]      = m_directData[i];
+      dvdVideoPicture.iLineSize[i] = m_directStride[i];
+    }
+  }
+  dvdVideoPicture.directBuffer   = m_directBuffer;
+
   dvdVideoPicture.iFlags         = 0; // *not* DVP_FLAG_ALLOCATED
   dvdVideoPicture.color_matrix   = 4; // CONF_FLAGS_YUVCOEF_BT601
   dvdVideoPicture.color_range    = 0; // *not* CONF_FLAGS_YUV_FULLRANGE
@@ -126,3 +169,59 @@ void CPixelConverter::GetPicture(VideoPicture& dvdVideoPicture)
   dvdVideoPicture.iDisplayHeight = m_height;
   dvdVideoPicture.format         = m_renderFormat;
 }
+
+void CPixelConverter::SetDirectBufferPool(IDirectBufferPool* pool)
+{
+  if (pool == m_directBufferPool)
+    return;
+
+  ReleaseDirectBuffer();
+  SAFE_RELEASE(m_directBufferPool);
+
+  if (pool)
+  {
+    CLog::Log(LOGDEBUG, "%s: converting frames into buffers of the renderer", __FUNCTION__);
+    m_directBufferPool = pool->Acquire();
+  }
+}
+
+bool CPixelConverter::GetDirectBuffer(uint8_t* dst[3], int dstStride[3])
+{
+  // Only YUV420P is taken by the renderer as it is
+  if (!m_directBufferPool || m_renderFormat != RENDER_FMT_YUV420P)
+    return false;
+
+  const unsigned int planeWidth[] = { m_width, (m_width + 1) / 2, (m_width + 1) / 2 };
+  const unsigned int planeHeight[] = { m_height, (m_height + 1) / 2, (m_height + 1) / 2 };
+
+  size_t offset[3];
+  size_t size = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    m_directStride[i] = AlignUp(planeWidth[i]);
+    offset[i] = size;
+    size += AlignUp(m_directStride[i] * planeHeight[i] + DIRECT_BUFFER_ALIGN);
+  }
+
+  m_directBuffer = m_directBufferPool->Get(size);
+  if (!m_directBuffer)
+    return false;
+
+  for (int i = 0; i < 3; i++)
+  {
+    m_directData[i] = m_directBuffer->data + offset[i];
+    dst[i] = m_directData[i];
+    dstStride[i] = m_directStride[i];
+  }
+
+  return true;
+}
+
+void CPixelConverter::ReleaseDirectBuffer()
+{
+  if (m_directBuffer)
+  {
+    m_directBuffer->Release();
+    m_directBuffer = nullptr;
+  }
+}
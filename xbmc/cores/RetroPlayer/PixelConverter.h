@@ -23,7 +23,10 @@
 #include "cores/VideoPlayer/VideoRenderers/RenderFormats.h"
 
 #include <stdint.h>
+#include <vector>
 
+class CDirectBuffer;
+class IDirectBufferPool;
 struct VideoPicture;
 struct SwsContext;
 
@@ -39,10 +42,35 @@ public:
   virtual bool Decode(const uint8_t* pData, unsigned int size) override;
   virtual void GetPicture(VideoPicture& dvdVideoPicture) override;
 
+  /*!
+   * \brief Convert frames into memory of the renderer
+   *
+   * The renderer takes the frame without copying it, and the converter
+   * writes the next frame into another buffer while it is shown. Frames are
+   * converted into the converter's own memory if no buffer is available.
+   *
+   * \param pool The pool of the renderer, or nullptr to stop using it
+   */
+  void SetDirectBufferPool(IDirectBufferPool* pool);
+
 protected:
+  bool GetDirectBuffer(uint8_t* dst[3], int dstStride[3]);
+  void ReleaseDirectBuffer();
+
+  AVPixelFormat m_pixfmt;
   ERenderFormat m_renderFormat;
   unsigned int m_width;
   unsigned int m_height;
   SwsContext* m_swsContext;
   VideoPicture* m_buf;
+
+  // Fast path, see CPixelConverterUtils
+  bool m_bConvertToYUV420P;
+  std::vector<int16_t> m_convertBuffer;
+
+  // Direct rendering
+  IDirectBufferPool* m_directBufferPool;
+  CDirectBuffer* m_directBuffer;
+  uint8_t* m_directData[3];
+  int m_directStride[3];
 };
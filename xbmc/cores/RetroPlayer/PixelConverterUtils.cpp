@@ -0,0 +1,268 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PixelConverterUtils.h"
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Fixed point coefficients of BT.601 with limited range, scaled by 256:
+//
+//   Y = (( 66 R + 129 G +  25 B + 128) >> 8) + 16
+//   U = ((-38 R -  74 G + 112 B + 128) >> 8) + 128
+//   V = ((112 R -  94 G -  18 B + 128) >> 8) + 128
+//
+// The SIMD and the scalar code compute exactly the same values.
+
+namespace
+{
+  // Rows are unpacked to 16 bit R, G and B values of 0-255, one extra value
+  // repeats the last pixel for frames with an odd width
+  struct UnpackedRow
+  {
+    int16_t* r;
+    int16_t* g;
+    int16_t* b;
+  };
+
+  inline int16_t Expand5(unsigned int value) { return static_cast<int16_t>((value << 3) | (value >> 2)); }
+  inline int16_t Expand6(unsigned int value) { return static_cast<int16_t>((value << 2) | (value >> 4)); }
+
+  void Unpack0RGB32(const uint8_t* src, unsigned int width, const UnpackedRow& row)
+  {
+    const uint32_t* pixels = reinterpret_cast<const uint32_t*>(src);
+    unsigned int x = 0;
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    for (; x + 8 <= width; x += 8)
+    {
+      const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+      const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x + 4));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row.r + x), _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask),
+                                                                              _mm_and_si128(_mm_srli_epi32(hi, 16), mask)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row.g + x), _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask),
+                                                                              _mm_and_si128(_mm_srli_epi32(hi, 8), mask)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row.b + x), _mm_packs_epi32(_mm_and_si128(lo, mask),
+                                                                              _mm_and_si128(hi, mask)));
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+      row.r[x] = static_cast<int16_t>((pixels[x] >> 16) & 0xFF);
+      row.g[x] = static_cast<int16_t>((pixels[x] >> 8) & 0xFF);
+      row.b[x] = static_cast<int16_t>(pixels[x] & 0xFF);
+    }
+  }
+
+  template<unsigned int RED_SHIFT, unsigned int GREEN_BITS>
+  void UnpackRGB16(const uint8_t* src, unsigned int width, const UnpackedRow& row)
+  {
+    const uint16_t* pixels = reinterpret_cast<const uint16_t*>(src);
+    const unsigned int greenMask = (1 << GREEN_BITS) - 1;
+    unsigned int x = 0;
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i maskGreen = _mm_set1_epi16(static_cast<int16_t>(greenMask));
+    for (; x + 8 <= width; x += 8)
+    {
+      const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+      const __m128i r = _mm_and_si128(_mm_srli_epi16(p, RED_SHIFT), mask5);
+      const __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), maskGreen);
+      const __m128i b = _mm_and_si128(p, mask5);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row.r + x), _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row.g + x), GREEN_BITS == 6 ? _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4))
+                                                                              : _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row.b + x), _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2)));
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+      row.r[x] = Expand5((pixels[x] >> RED_SHIFT) & 0x1F);
+      row.g[x] = GREEN_BITS == 6 ? Expand6((pixels[x] >> 5) & greenMask) : Expand5((pixels[x] >> 5) & greenMask);
+      row.b[x] = Expand5(pixels[x] & 0x1F);
+    }
+  }
+
+  void Unpack(AVPixelFormat pixfmt, const uint8_t* src, unsigned int width, const UnpackedRow& row)
+  {
+    switch (pixfmt)
+    {
+    case AV_PIX_FMT_0RGB32:
+      Unpack0RGB32(src, width, row);
+      break;
+    case AV_PIX_FMT_RGB565:
+      UnpackRGB16<11, 6>(src, width, row);
+      break;
+    case AV_PIX_FMT_RGB555:
+      UnpackRGB16<10, 5>(src, width, row);
+      break;
+    default:
+      break;
+    }
+
+    row.r[width] = row.r[width - 1];
+    row.g[width] = row.g[width - 1];
+    row.b[width] = row.b[width - 1];
+  }
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  // Coefficients for _mm_madd_epi16() of interleaved pairs
+  inline __m128i Coefficients(int16_t first, int16_t second)
+  {
+    return _mm_set_epi16(second, first, second, first, second, first, second, first);
+  }
+#endif
+
+  void ConvertLuma(const UnpackedRow& row, unsigned int width, uint8_t* dst)
+  {
+    unsigned int x = 0;
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    // Pairs of 16 bit coefficients for _mm_madd_epi16(), the constant 1
+    // paired with blue adds the rounding and the offset
+    const __m128i coeffRG = Coefficients(66, 129);
+    const __m128i coeffB1 = Coefficients(25, 128 + (16 << 8));
+    const __m128i one = _mm_set1_epi16(1);
+    for (; x + 8 <= width; x += 8)
+    {
+      const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.r + x));
+      const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.g + x));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.b + x));
+      const __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(r, g), coeffRG),
+                                                      _mm_madd_epi16(_mm_unpacklo_epi16(b, one), coeffB1)), 8);
+      const __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(r, g), coeffRG),
+                                                      _mm_madd_epi16(_mm_unpackhi_epi16(b, one), coeffB1)), 8);
+      const __m128i y = _mm_packs_epi32(lo, hi);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(y, y));
+    }
+#endif
+
+    for (; x < width; x++)
+      dst[x] = static_cast<uint8_t>((66 * row.r[x] + 129 * row.g[x] + 25 * row.b[x] + 128 + (16 << 8)) >> 8);
+  }
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  // Average 8 chroma samples of 2x2 pixels each
+  inline __m128i Average(const int16_t* top, const int16_t* bottom)
+  {
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top)), one),
+                                     _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom)), one));
+    const __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 8)), one),
+                                     _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 8)), one));
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, two), 2), _mm_srai_epi32(_mm_add_epi32(hi, two), 2));
+  }
+
+  inline void StoreChroma(__m128i r, __m128i g, __m128i b, __m128i coeffRG, __m128i coeffB1, uint8_t* dst)
+  {
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i offset = _mm_set1_epi32(128);
+    const __m128i lo = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(r, g), coeffRG),
+                                                                  _mm_madd_epi16(_mm_unpacklo_epi16(b, one), coeffB1)), 8), offset);
+    const __m128i hi = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(r, g), coeffRG),
+                                                                  _mm_madd_epi16(_mm_unpackhi_epi16(b, one), coeffB1)), 8), offset);
+    const __m128i c = _mm_packs_epi32(lo, hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(c, c));
+  }
+#endif
+
+  void ConvertChroma(const UnpackedRow& top, const UnpackedRow& bottom, unsigned int chromaWidth, uint8_t* dstU, uint8_t* dstV)
+  {
+    unsigned int x = 0;
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    const __m128i coeffURG = Coefficients(-38, -74);
+    const __m128i coeffUB1 = Coefficients(112, 128);
+    const __m128i coeffVRG = Coefficients(112, -94);
+    const __m128i coeffVB1 = Coefficients(-18, 128);
+    for (; x + 8 <= chromaWidth; x += 8)
+    {
+      const __m128i r = Average(top.r + 2 * x, bottom.r + 2 * x);
+      const __m128i g = Average(top.g + 2 * x, bottom.g + 2 * x);
+      const __m128i b = Average(top.b + 2 * x, bottom.b + 2 * x);
+      StoreChroma(r, g, b, coeffURG, coeffUB1, dstU + x);
+      StoreChroma(r, g, b, coeffVRG, coeffVB1, dstV + x);
+    }
+#endif
+
+    for (; x < chromaWidth; x++)
+    {
+      const int r = (top.r[2 * x] + top.r[2 * x + 1] + bottom.r[2 * x] + bottom.r[2 * x + 1] + 2) >> 2;
+      const int g = (top.g[2 * x] + top.g[2 * x + 1] + bottom.g[2 * x] + bottom.g[2 * x + 1] + 2) >> 2;
+      const int b = (top.b[2 * x] + top.b[2 * x + 1] + bottom.b[2 * x] + bottom.b[2 * x + 1] + 2) >> 2;
+      dstU[x] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      dstV[x] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+  }
+}
+
+bool CPixelConverterUtils::CanConvert(AVPixelFormat pixfmt)
+{
+  return pixfmt == AV_PIX_FMT_0RGB32 ||
+         pixfmt == AV_PIX_FMT_RGB565 ||
+         pixfmt == AV_PIX_FMT_RGB555;
+}
+
+void CPixelConverterUtils::ConvertToYUV420P(AVPixelFormat pixfmt, const uint8_t* src, unsigned int srcStride,
+                                            unsigned int width, unsigned int height,
+                                            uint8_t* const dst[3], const int dstStride[3],
+                                            std::vector<int16_t>& buffer)
+{
+  if (!CanConvert(pixfmt) || width == 0 || height == 0)
+    return;
+
+  // Room for the extra pixel and for reading 16 values past every chroma
+  // sample that is converted with SIMD
+  const size_t rowSize = width + 16;
+  buffer.resize(6 * rowSize);
+
+  UnpackedRow rows[2];
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    rows[i].r = buffer.data() + (3 * i) * rowSize;
+    rows[i].g = buffer.data() + (3 * i + 1) * rowSize;
+    rows[i].b = buffer.data() + (3 * i + 2) * rowSize;
+  }
+
+  const unsigned int chromaWidth = (width + 1) / 2;
+
+  for (unsigned int y = 0; y < height; y += 2)
+  {
+    Unpack(pixfmt, src + y * srcStride, width, rows[0]);
+    ConvertLuma(rows[0], width, dst[0] + y * dstStride[0]);
+
+    // The last row of a frame with an odd height is its own pair
+    const UnpackedRow* bottom = &rows[0];
+    if (y + 1 < height)
+    {
+      Unpack(pixfmt, src + (y + 1) * srcStride, width, rows[1]);
+      ConvertLuma(rows[1], width, dst[0] + (y + 1) * dstStride[0]);
+      bottom = &rows[1];
+    }
+
+    ConvertChroma(rows[0], *bottom, chromaWidth, dst[1] + y / 2 * dstStride[1], dst[2] + y / 2 * dstStride[2]);
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "libavutil/pixfmt.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*!
+ * \brief Conversion of the RGB formats used by game clients to YUV420P
+ *
+ * Faster than swscale for these formats, as it does nothing but the
+ * conversion and uses SSE2 where available. The colors are converted
+ * according to BT.601 with limited range and the chroma of 2x2 pixels is
+ * averaged.
+ */
+class CPixelConverterUtils
+{
+public:
+  /*!
+   * \brief Check if a format can be converted, which is the case for
+   *        AV_PIX_FMT_0RGB32, AV_PIX_FMT_RGB565 and AV_PIX_FMT_RGB555
+   */
+  static bool CanConvert(AVPixelFormat pixfmt);
+
+  /*!
+   * \brief Convert a frame to YUV420P
+   *
+   * \param pixfmt The source format, see CanConvert()
+   * \param src The source pixels
+   * \param srcStride The size of a source row in bytes
+   * \param width The width of the frame
+   * \param height The height of the frame
+   * \param dst The Y, U and V planes, U and V are half the width and height
+   *        rounded up
+   * \param dstStride The size of a row of each plane in bytes
+   * \param buffer Scratch memory, kept by the caller to avoid allocations
+   *        per frame
+   */
+  static void ConvertToYUV420P(AVPixelFormat pixfmt, const uint8_t* src, unsigned int srcStride,
+                               unsigned int width, unsigned int height,
+                               uint8_t* const dst[3], const int dstStride[3],
+                               std::vector<int16_t>& buffer);
+};
@@ -44,6 +44,7 @@ CRetroPlayerVideo::CRetroPlayerVideo(CRenderManager& renderManager, CProcessInfo
   m_framerate(0.0),
   m_orientation(0),
   m_bConfigured(false),
+  m_bDirectBufferChecked(false),
   m_droppedFrames(0)
 {
   m_renderManager.PreInit();
@@ -62,6 +63,7 @@ bool CRetroPlayerVideo::OpenPixelStream(AVPixelFormat pixfmt, unsigned int width
   m_framerate = framerate;
   m_orientation = orientationDeg;
   m_bConfigured = false;
+  m_bDirectBufferChecked = false;
   m_droppedFrames = 0;
 
 #ifdef TARGET_RASPBERRY_PI
@@ -145,7 +147,14 @@ bool CRetroPlayerVideo::Configure(VideoPicture& picture)
     unsigned int flags = CONF_FLAGS_YUVCOEF_BT601 | // color_matrix = 4
                          CONF_FLAGS_FULLSCREEN;     // Allow fullscreen
 
-    const int buffers = 1; //! @todo
+    // Double buffering, a frame is converted while the previous one is shown
+    const int buffers = 2;
+
+    // Configuring may replace the renderer, stop using the buffers of the old
+    // one and ask the new one for its pool once it exists
+    m_bDirectBufferChecked = false;
+    if (m_pixelConverter)
+      m_pixelConverter->SetDirectBufferPool(nullptr);
 
     m_bConfigured = m_renderManager.Configure(picture, static_cast<float>(m_framerate), flags, m_orientation, buffers);
 
@@ -180,6 +189,14 @@ bool CRetroPlayerVideo::GetPicture(const uint8_t* data, unsigned int size, Video
     // Drop frame if another is queued
     const bool bDropped = (queued > 0);
 
+    // The renderer is created when the render manager is configured, so its
+    // buffers can be used starting with the next frame
+    if (!m_bDirectBufferChecked && m_bConfigured && m_renderManager.IsConfigured())
+    {
+      m_pixelConverter->SetDirectBufferPool(m_renderManager.GetRenderInfo().directBufferPool);
+      m_bDirectBufferChecked = true;
+    }
+
     if (!bDropped)
     {
       if (m_pixelConverter->Decode(data, size))
@@ -68,6 +68,7 @@ namespace RETRO
     double       m_framerate;
     unsigned int m_orientation; // Degrees counter-clockwise
     bool         m_bConfigured; // Need first picture to configure the render manager
+    bool         m_bDirectBufferChecked; // Renderer was asked for its direct buffer pool
     unsigned int m_droppedFrames;
     std::unique_ptr<CPixelConverter> m_pixelConverter;
     std::unique_ptr<CDVDVideoCodec>  m_pVideoCodec;
@@ -0,0 +1,158 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/RetroPlayer/PixelConverterUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+  struct RGB
+  {
+    int r;
+    int g;
+    int b;
+  };
+
+  int Expand(unsigned int value, unsigned int bits)
+  {
+    return static_cast<int>((value << (8 - bits)) | (value >> (2 * bits - 8)));
+  }
+
+  RGB GetPixel(AVPixelFormat pixfmt, const uint8_t* row, unsigned int x)
+  {
+    if (pixfmt == AV_PIX_FMT_0RGB32)
+    {
+      const uint32_t pixel = reinterpret_cast<const uint32_t*>(row)[x];
+      return RGB{ static_cast<int>((pixel >> 16) & 0xFF), static_cast<int>((pixel >> 8) & 0xFF), static_cast<int>(pixel & 0xFF) };
+    }
+
+    const uint16_t pixel = reinterpret_cast<const uint16_t*>(row)[x];
+    if (pixfmt == AV_PIX_FMT_RGB565)
+      return RGB{ Expand(pixel >> 11, 5), Expand((pixel >> 5) & 0x3F, 6), Expand(pixel & 0x1F, 5) };
+
+    return RGB{ Expand((pixel >> 10) & 0x1F, 5), Expand((pixel >> 5) & 0x1F, 5), Expand(pixel & 0x1F, 5) };
+  }
+
+  // Straightforward conversion that the optimized one has to match exactly
+  void Convert(AVPixelFormat pixfmt, const std::vector<uint8_t>& src, unsigned int srcStride,
+               unsigned int width, unsigned int height, std::vector<uint8_t> (&dst)[3])
+  {
+    const unsigned int chromaWidth = (width + 1) / 2;
+    const unsigned int chromaHeight = (height + 1) / 2;
+
+    dst[0].resize(width * height);
+    dst[1].resize(chromaWidth * chromaHeight);
+    dst[2].resize(chromaWidth * chromaHeight);
+
+    for (unsigned int y = 0; y < height; y++)
+    {
+      for (unsigned int x = 0; x < width; x++)
+      {
+        const RGB p = GetPixel(pixfmt, src.data() + y * srcStride, x);
+        dst[0][y * width + x] = static_cast<uint8_t>(((66 * p.r + 129 * p.g + 25 * p.b + 128) >> 8) + 16);
+      }
+    }
+
+    for (unsigned int y = 0; y < chromaHeight; y++)
+    {
+      for (unsigned int x = 0; x < chromaWidth; x++)
+      {
+        RGB sum = { 0, 0, 0 };
+        for (unsigned int i = 0; i < 4; i++)
+        {
+          const unsigned int px = std::min(2 * x + i % 2, width - 1);
+          const unsigned int py = std::min(2 * y + i / 2, height - 1);
+          const RGB p = GetPixel(pixfmt, src.data() + py * srcStride, px);
+          sum.r += p.r;
+          sum.g += p.g;
+          sum.b += p.b;
+        }
+        const int r = (sum.r + 2) >> 2;
+        const int g = (sum.g + 2) >> 2;
+        const int b = (sum.b + 2) >> 2;
+        dst[1][y * chromaWidth + x] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        dst[2][y * chromaWidth + x] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      }
+    }
+  }
+}
+
+class TestPixelConverterUtils : public testing::TestWithParam<AVPixelFormat>
+{
+};
+
+TEST_P(TestPixelConverterUtils, ConvertToYUV420P)
+{
+  const AVPixelFormat pixfmt = GetParam();
+  const unsigned int bpp = pixfmt == AV_PIX_FMT_0RGB32 ? 4 : 2;
+
+  ASSERT_TRUE(CPixelConverterUtils::CanConvert(pixfmt));
+
+  std::mt19937 rng(0);
+  std::vector<int16_t> buffer;
+
+  // Even, odd and smaller than a SIMD register
+  const unsigned int sizes[][2] = { { 320, 240 }, { 37, 21 }, { 5, 3 }, { 1, 1 } };
+  for (const auto& size : sizes)
+  {
+    const unsigned int width = size[0];
+    const unsigned int height = size[1];
+    const unsigned int srcStride = width * bpp + 12;
+
+    std::vector<uint8_t> src(srcStride * height);
+    for (auto& byte : src)
+      byte = static_cast<uint8_t>(rng());
+
+    std::vector<uint8_t> expected[3];
+    Convert(pixfmt, src, srcStride, width, height, expected);
+
+    const int dstStride[3] = { static_cast<int>(width) + 7, static_cast<int>((width + 1) / 2) + 3, static_cast<int>((width + 1) / 2) + 5 };
+    const unsigned int planeHeight[3] = { height, (height + 1) / 2, (height + 1) / 2 };
+    const unsigned int planeWidth[3] = { width, (width + 1) / 2, (width + 1) / 2 };
+
+    std::vector<uint8_t> planes[3];
+    uint8_t* dst[3];
+    for (unsigned int i = 0; i < 3; i++)
+    {
+      planes[i].resize(dstStride[i] * planeHeight[i]);
+      dst[i] = planes[i].data();
+    }
+
+    CPixelConverterUtils::ConvertToYUV420P(pixfmt, src.data(), srcStride, width, height, dst, dstStride, buffer);
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+      for (unsigned int y = 0; y < planeHeight[i]; y++)
+      {
+        for (unsigned int x = 0; x < planeWidth[i]; x++)
+          ASSERT_EQ(expected[i][y * planeWidth[i] + x], planes[i][y * dstStride[i] + x])
+            << "plane " << i << " at " << x << "x" << y << " of " << width << "x" << height;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(Formats, TestPixelConverterUtils,
+                        testing::Values(AV_PIX_FMT_0RGB32, AV_PIX_FMT_RGB565, AV_PIX_FMT_RGB555));
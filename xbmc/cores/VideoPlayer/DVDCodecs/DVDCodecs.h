@@ -39,4 +39,5 @@ public:
   std::vector<CDVDCodecOption> m_keys;
   std::vector<ERenderFormat> m_formats;
   const void *m_opaque_pointer;
+  IDirectBufferPool *m_directBufferPool = nullptr;
 };
@@ -54,11 +54,18 @@
 CCriticalSection videoCodecSection;
 
 CDVDVideoCodec* CDVDFactoryCodec::CreateVideoCodec(CDVDStreamInfo &hint, CProcessInfo &processInfo, const CRenderInfo &info)
+{
+  return CreateVideoCodec(hint, processInfo, info, std::vector<CDVDCodecOption>());
+}
+
+CDVDVideoCodec* CDVDFactoryCodec::CreateVideoCodec(CDVDStreamInfo &hint, CProcessInfo &processInfo, const CRenderInfo &info,
+                                                   const std::vector<CDVDCodecOption> &keys)
 {
   CSingleLock lock(videoCodecSection);
 
   std::unique_ptr<CDVDVideoCodec> pCodec;
   CDVDCodecOptions options;
+  options.m_keys = keys;
 
   if (info.formats.empty())
     options.m_formats.push_back(RENDER_FMT_YUV420P);
@@ -66,6 +73,7 @@ CDVDVideoCodec* CDVDFactoryCodec::CreateVideoCodec(CDVDStreamInfo &hint, CProces
     options.m_formats = info.formats;
 
   options.m_opaque_pointer = info.opaque_pointer;
+  options.m_directBufferPool = info.directBufferPool;
 
   // platform specifig video decoders
   if (!(hint.codecOptions & CODEC_FORCE_SOFTWARE))
@@ -20,6 +20,8 @@
  *
  */
 
+#include <vector>
+
 #include "cores/VideoPlayer/VideoRenderers/RenderFormats.h"
 #include "cores/VideoPlayer/VideoRenderers/BaseRenderer.h"
 #include "cores/VideoPlayer/Process/ProcessInfo.h"
@@ -44,6 +46,12 @@ public:
                                           CProcessInfo &processInfo,
                                           const CRenderInfo &info);
 
+  // the options are handed to the decoder as they are, e.g. "threads" and "thread_type" to ffmpeg
+  static CDVDVideoCodec* CreateVideoCodec(CDVDStreamInfo &hint,
+                                          CProcessInfo &processInfo,
+                                          const CRenderInfo &info,
+                                          const std::vector<CDVDCodecOption> &options);
+
   static CDVDVideoCodec* CreateVideoCodec(CDVDStreamInfo &hint,
                                           CProcessInfo &processInfo);
 
@@ -35,6 +35,7 @@ extern "C" {
 #include <map>
 
 class CSetting;
+class CDirectBuffer;
 
 // when modifying these structures, make sure you update all codecs accordingly
 #define FRAME_TYPE_UNDEF 0
@@ -54,6 +55,7 @@ struct VideoPicture
   int iLineSize[4];   // [4] = alpha channel, currently not used
 
   void *hwPic;
+  CDirectBuffer *directBuffer; // software decoded into memory of the renderer, valid as long as data[]
 
   unsigned int iFlags;
 
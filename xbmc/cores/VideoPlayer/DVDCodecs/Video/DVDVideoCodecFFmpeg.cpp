@@ -34,7 +34,10 @@
 #include "utils/log.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderManager.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderFormats.h"
+#include "cores/VideoPlayer/VideoRenderers/DirectBufferPool.h"
+#include "threads/SystemClock.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include <memory>
 
 extern "C" {
@@ -43,6 +46,7 @@ extern "C" {
 #include "libavfilter/buffersink.h"
 #include "libavfilter/buffersrc.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/imgutils.h"
 }
 
 #ifndef TARGET_POSIX
@@ -53,6 +57,16 @@ extern "C" {
 #define RINT lrint
 #endif
 
+// alignment of the lines and planes of frames decoded into renderer memory
+#define DIRECT_BUFFER_ALIGN 64
+
+// pixels per second a single decoder thread is expected to handle
+#define THREADING_PIXELS_PER_THREAD (1920 * 1080 * 30 / 4)
+// pictures after a seek before going back to frame threading
+#define THREADING_LOWLATENCY_FRAMES 50
+// seeks closer together than this (ms) switch to slice threading
+#define THREADING_SEEK_INTERVAL 2000
+
 enum DecoderState
 {
   STATE_NONE,
@@ -125,6 +139,15 @@ void CDVDVideoCodecFFmpeg::CDropControl::Process(int64_t pts, bool drop)
   m_lastPTS = pts;
 }
 
+void CDVDVideoCodecFFmpeg::CDecodeStats::Reset()
+{
+  m_start = 0;
+  m_firstFrame = 0;
+  m_lastFrame = 0;
+  m_busy = 0;
+  m_frames = 0;
+}
+
 enum AVPixelFormat CDVDVideoCodecFFmpeg::GetFormat(struct AVCodecContext * avctx, const AVPixelFormat * fmt)
 {
   ICallbackHWAccel *cb = static_cast<ICallbackHWAccel*>(avctx->opaque);
@@ -152,7 +175,7 @@ enum AVPixelFormat CDVDVideoCodecFFmpeg::GetFormat(struct AVCodecContext * avctx
   if (ctx->HasHardware())
   {
     ctx->SetHardware(nullptr);
-    avctx->get_buffer2 = avcodec_default_get_buffer2;
+    avctx->get_buffer2 = ctx->CanDecodeDirect(avctx->codec) ? GetBuffer : avcodec_default_get_buffer2;
     avctx->slice_flags = 0;
     avctx->hwaccel_context = 0;
   }
@@ -184,6 +207,71 @@ enum AVPixelFormat CDVDVideoCodecFFmpeg::GetFormat(struct AVCodecContext * avctx
   return avcodec_default_get_format(avctx, fmt);
 }
 
+int CDVDVideoCodecFFmpeg::GetBuffer(struct AVCodecContext *avctx, AVFrame *frame, int flags)
+{
+  ICallbackHWAccel *cb = static_cast<ICallbackHWAccel*>(avctx->opaque);
+  CDVDVideoCodecFFmpeg* ctx  = dynamic_cast<CDVDVideoCodecFFmpeg*>(cb);
+
+  // only the formats the renderer uploads from its buffers as they are
+  AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+  if (!ctx || !ctx->m_directBufferPool ||
+      (format != AV_PIX_FMT_YUV420P && format != AV_PIX_FMT_YUVJ420P &&
+       format != AV_PIX_FMT_YUV420P10 && format != AV_PIX_FMT_YUV420P16))
+    return avcodec_default_get_buffer2(avctx, frame, flags);
+
+  int width = frame->width;
+  int height = frame->height;
+  int alignment[AV_NUM_DATA_POINTERS];
+  avcodec_align_dimensions2(avctx, &width, &height, alignment);
+
+  int linesize[4];
+  if (av_image_fill_linesizes(linesize, format, FFALIGN(width, DIRECT_BUFFER_ALIGN)) < 0)
+    return avcodec_default_get_buffer2(avctx, frame, flags);
+
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+  size_t offset[3];
+  size_t size = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    int planeHeight = i ? AV_CEIL_RSHIFT(height, desc->log2_chroma_h) : height;
+    linesize[i] = FFALIGN(linesize[i], DIRECT_BUFFER_ALIGN);
+    offset[i] = size;
+    // some decoders read a few bytes beyond the end of a plane
+    size += FFALIGN(linesize[i] * planeHeight + DIRECT_BUFFER_ALIGN, DIRECT_BUFFER_ALIGN);
+  }
+
+  CDirectBuffer *buffer = ctx->m_directBufferPool->Get(size);
+  if (!buffer)
+    return avcodec_default_get_buffer2(avctx, frame, flags);
+
+  frame->buf[0] = av_buffer_create(buffer->data, size, ReleaseBuffer, buffer, 0);
+  if (!frame->buf[0])
+  {
+    buffer->Release();
+    return AVERROR(ENOMEM);
+  }
+
+  for (int i = 0; i < 3; i++)
+  {
+    frame->data[i] = buffer->data + offset[i];
+    frame->linesize[i] = linesize[i];
+  }
+  frame->extended_data = frame->data;
+
+  return 0;
+}
+
+void CDVDVideoCodecFFmpeg::ReleaseBuffer(void *opaque, uint8_t *data)
+{
+  static_cast<CDirectBuffer*>(opaque)->Release();
+}
+
+bool CDVDVideoCodecFFmpeg::CanDecodeDirect(const AVCodec *codec) const
+{
+  // without DR1 the codec ignores the planes and line sizes of GetBuffer()
+  return m_directBufferPool && codec && (codec->capabilities & AV_CODEC_CAP_DR1);
+}
+
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg(CProcessInfo &processInfo) : CDVDVideoCodec(processInfo)
 {
   m_pCodecContext = nullptr;
@@ -204,6 +292,7 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg(CProcessInfo &processInfo) : CDVDVide
   m_iOrientation = 0;
   m_decoderState = STATE_NONE;
   m_pHardware = nullptr;
+  m_directBufferPool = nullptr;
   m_iLastKeyframe = 0;
   m_dts = DVD_NOPTS_VALUE;
   m_started = false;
@@ -215,11 +304,18 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg(CProcessInfo &processInfo) : CDVDVide
   m_interlaced = false;
   m_eof = false;
   m_DAR = 1.0;
+  m_lowLatency = false;
+  m_lowLatencyFrames = 0;
+  m_threadSwitch = THREADSWITCH_NONE;
+  m_keyFrames = false;
+  m_lastReset = 0;
+  m_decodeStats.Reset();
 }
 
 CDVDVideoCodecFFmpeg::~CDVDVideoCodecFFmpeg()
 {
   Dispose();
+  SAFE_RELEASE(m_directBufferPool);
 }
 
 bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options)
@@ -231,6 +327,13 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
 
   m_iOrientation = hints.orientation;
 
+  if (options.m_directBufferPool != m_directBufferPool)
+  {
+    SAFE_RELEASE(m_directBufferPool);
+    if (options.m_directBufferPool)
+      m_directBufferPool = options.m_directBufferPool->Acquire();
+  }
+
   m_formats.clear();
   for(std::vector<ERenderFormat>::iterator it = options.m_formats.begin(); it != options.m_formats.end(); ++it)
   {
@@ -264,21 +367,23 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->get_format = GetFormat;
   m_pCodecContext->codec_tag = hints.codec_tag;
 
+  // decode straight into the memory of the renderer if the codec allows it
+  if (CanDecodeDirect(pCodec))
+    m_pCodecContext->get_buffer2 = GetBuffer;
+
   // setup threading model
   if (!(hints.codecOptions & CODEC_FORCE_SOFTWARE))
   {
     if (m_decoderState == STATE_NONE)
     {
       m_decoderState = STATE_HW_SINGLE;
+      // zapping through live channels should show a picture as soon as possible
+      m_lowLatency = hints.realtime;
     }
     else
     {
-      int num_threads = g_cpuInfo.getCPUCount() * 3 / 2;
-      num_threads = std::max(1, std::min(num_threads, 16));
-      m_pCodecContext->thread_count = num_threads;
-      m_pCodecContext->thread_safe_callbacks = 1;
+      SetThreading(pCodec);
       m_decoderState = STATE_SW_MULTI;
-      CLog::Log(LOGDEBUG, "CDVDVideoCodecFFmpeg - open frame threaded with %d threads", num_threads);
     }
   }
   else
@@ -366,6 +471,8 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
 
 void CDVDVideoCodecFFmpeg::Dispose()
 {
+  LogDecodeStats();
+
   av_frame_free(&m_pFrame);
   av_frame_free(&m_pDecodedFrame);
   av_frame_free(&m_pFilterFrame);
@@ -375,6 +482,77 @@ void CDVDVideoCodecFFmpeg::Dispose()
   FilterClose();
 }
 
+void CDVDVideoCodecFFmpeg::SetThreading(AVCodec *codec)
+{
+  int threads = GetThreadCount(m_hints, m_options, g_cpuInfo.getCPUCount());
+
+  // slice threading doesn't delay the pictures, but depending on the stream
+  // it may not scale as well as frame threading
+  bool slice = m_lowLatency && g_advancedSettings.m_videoAdaptiveThreading &&
+               (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS);
+
+  m_pCodecContext->thread_count = threads;
+  m_pCodecContext->thread_type = slice ? FF_THREAD_SLICE : FF_THREAD_FRAME | FF_THREAD_SLICE;
+  m_pCodecContext->thread_safe_callbacks = 1;
+  CLog::Log(LOGDEBUG, "CDVDVideoCodecFFmpeg - open %s threaded with %d threads", slice ? "slice" : "frame", threads);
+}
+
+int CDVDVideoCodecFFmpeg::GetThreadCount(const CDVDStreamInfo &hints, const CDVDCodecOptions &options, int cpuCount)
+{
+  for (const auto &option : options.m_keys)
+  {
+    if (option.m_name == "threads" && atoi(option.m_value.c_str()) > 0)
+      return atoi(option.m_value.c_str());
+  }
+
+  int maxThreads = cpuCount * 3 / 2;
+  maxThreads = std::max(1, std::min(maxThreads, 16));
+
+  if (hints.width <= 0 || hints.height <= 0)
+    return maxThreads;
+
+  // every additional thread adds a picture of delay with frame threading, so
+  // only use as many as the resolution and frame rate of the stream need
+  double fps = 25.0;
+  if (hints.fpsrate > 0 && hints.fpsscale > 0)
+    fps = std::max(static_cast<double>(hints.fpsrate) / hints.fpsscale, 24.0);
+
+  double pixelRate = static_cast<double>(hints.width) * hints.height * fps;
+  int threads = static_cast<int>(pixelRate / THREADING_PIXELS_PER_THREAD) + 1;
+
+  return std::max(std::min(2, maxThreads), std::min(threads, maxThreads));
+}
+
+CDVDVideoCodec::VCReturn CDVDVideoCodecFFmpeg::SwitchThreading()
+{
+  CLog::Log(LOGDEBUG, "CDVDVideoCodecFFmpeg::SwitchThreading - back to frame threading");
+  m_lowLatency = false;
+  m_threadSwitch = THREADSWITCH_NONE;
+  Reopen();
+  return VC_BUFFER;
+}
+
+void CDVDVideoCodecFFmpeg::LogDecodeStats()
+{
+  if (!m_pCodecContext || m_decodeStats.m_frames < 2)
+  {
+    m_decodeStats.Reset();
+    return;
+  }
+
+  double freq = static_cast<double>(CurrentHostFrequency());
+  double fps = (m_decodeStats.m_frames - 1) * freq / std::max<int64_t>(m_decodeStats.m_lastFrame - m_decodeStats.m_firstFrame, 1);
+
+  CLog::Log(LOGDEBUG, "CDVDVideoCodecFFmpeg - %s threaded with %d threads: %u pictures at %.1f fps, first picture after %.1f ms, %.2f ms per picture in decoder calls",
+            m_pCodecContext->active_thread_type == FF_THREAD_FRAME ? "frame" : "slice",
+            m_pCodecContext->thread_count,
+            m_decodeStats.m_frames, fps,
+            (m_decodeStats.m_firstFrame - m_decodeStats.m_start) * 1000.0 / freq,
+            m_decodeStats.m_busy * 1000.0 / freq / m_decodeStats.m_frames);
+
+  m_decodeStats.Reset();
+}
+
 void CDVDVideoCodecFFmpeg::SetFilters()
 {
   // ask codec to do deinterlacing if possible
@@ -472,6 +650,18 @@ bool CDVDVideoCodecFFmpeg::AddData(const DemuxPacket &packet)
     Reset();
   }
 
+  if (packet.bKeyFrame)
+    m_keyFrames = true;
+
+  // frame threading can only take over at a keyframe
+  if (m_threadSwitch == THREADSWITCH_PENDING && packet.bKeyFrame)
+    m_threadSwitch = THREADSWITCH_DRAIN;
+  if (m_threadSwitch == THREADSWITCH_DRAIN)
+    return false;
+
+  if (!m_decodeStats.m_start)
+    m_decodeStats.m_start = CurrentHostCounter();
+
   m_dts = packet.dts;
   m_pCodecContext->reordered_opaque = pts_dtoi(packet.pts);
 
@@ -482,7 +672,9 @@ bool CDVDVideoCodecFFmpeg::AddData(const DemuxPacket &packet)
   avpkt.dts = (packet.dts == DVD_NOPTS_VALUE) ? AV_NOPTS_VALUE : static_cast<int64_t>(packet.dts / DVD_TIME_BASE * AV_TIME_BASE);
   avpkt.pts = (packet.pts == DVD_NOPTS_VALUE) ? AV_NOPTS_VALUE : static_cast<int64_t>(packet.pts / DVD_TIME_BASE * AV_TIME_BASE);
 
+  int64_t start = CurrentHostCounter();
   int ret = avcodec_send_packet(m_pCodecContext, &avpkt);
+  m_decodeStats.m_busy += CurrentHostCounter() - start;
 
   // try again
   if (ret == AVERROR(EAGAIN))
@@ -553,7 +745,7 @@ CDVDVideoCodec::VCReturn CDVDVideoCodecFFmpeg::GetPicture(VideoPicture* pVideoPi
   }
 
   // process ffmpeg
-  if (m_codecControlFlags & DVD_CODEC_CTRL_DRAIN)
+  if ((m_codecControlFlags & DVD_CODEC_CTRL_DRAIN) || m_threadSwitch == THREADSWITCH_DRAIN)
   {
     AVPacket avpkt;
     av_init_packet(&avpkt);
@@ -564,7 +756,9 @@ CDVDVideoCodec::VCReturn CDVDVideoCodecFFmpeg::GetPicture(VideoPicture* pVideoPi
     avcodec_send_packet(m_pCodecContext, &avpkt);
   }
 
+  int64_t start = CurrentHostCounter();
   int ret = avcodec_receive_frame(m_pCodecContext, m_pDecodedFrame);
+  m_decodeStats.m_busy += CurrentHostCounter() - start;
 
   if (m_decoderState == STATE_HW_FAILED && !m_pHardware)
     return VC_REOPEN;
@@ -574,6 +768,10 @@ CDVDVideoCodec::VCReturn CDVDVideoCodecFFmpeg::GetPicture(VideoPicture* pVideoPi
 
   if (ret == AVERROR_EOF)
   {
+    // all pictures of the slice threaded decoder are out
+    if (m_threadSwitch == THREADSWITCH_DRAIN)
+      return SwitchThreading();
+
     // next drain hw accel or filter
     if (m_pHardware)
     {
@@ -672,6 +870,23 @@ CDVDVideoCodec::VCReturn CDVDVideoCodecFFmpeg::GetPicture(VideoPicture* pVideoPi
     }
   }
 
+  int64_t now = CurrentHostCounter();
+  if (!m_decodeStats.m_firstFrame)
+    m_decodeStats.m_firstFrame = now;
+  m_decodeStats.m_lastFrame = now;
+  m_decodeStats.m_frames++;
+
+  if (m_lowLatency && m_threadSwitch == THREADSWITCH_NONE &&
+      m_pCodecContext->active_thread_type == FF_THREAD_SLICE)
+  {
+    // live streams stay on slice threading unless the decoder falls behind
+    bool late = (m_codecControlFlags & (DVD_CODEC_CTRL_HURRY | DVD_CODEC_CTRL_DROP | DVD_CODEC_CTRL_DROP_ANY)) != 0;
+    // without keyframes from the demuxer (e.g. inputstream add-ons) there's
+    // no safe point to switch at, stay on slice threading
+    if (++m_lowLatencyFrames >= THREADING_LOWLATENCY_FRAMES && (!m_hints.realtime || late) && m_keyFrames)
+      m_threadSwitch = THREADSWITCH_PENDING;
+  }
+
   // push the frame to hw decoder for further processing
   if (m_pHardware)
   {
@@ -772,11 +987,24 @@ bool CDVDVideoCodecFFmpeg::SetPictureParams(VideoPicture* pVideoPicture)
       m_postProc.GetPicture(pVideoPicture);
   }
 
+  // let the renderer take the frame if it was decoded into its memory and
+  // neither the filters nor post processing have moved it elsewhere
+  if (m_directBufferPool && m_pFrame->buf[0] && !m_pFrame->buf[1])
+  {
+    CDirectBuffer *buffer = static_cast<CDirectBuffer*>(av_buffer_get_opaque(m_pFrame->buf[0]));
+    if (pVideoPicture->data[0] >= m_pFrame->buf[0]->data &&
+        pVideoPicture->data[0] < m_pFrame->buf[0]->data + m_pFrame->buf[0]->size &&
+        m_directBufferPool->Owns(buffer))
+      pVideoPicture->directBuffer = buffer;
+  }
+
   return true;
 }
 
 void CDVDVideoCodecFFmpeg::Reset()
 {
+  LogDecodeStats();
+
   m_started = false;
   m_interlaced = false;
   m_decoderPts = DVD_NOPTS_VALUE;
@@ -792,6 +1020,27 @@ void CDVDVideoCodecFFmpeg::Reset()
   m_filters = "";
   FilterClose();
   m_dropCtrl.Reset(false);
+
+  // while seeking repeatedly frame threading would hold back the first pictures
+  // after each seek until all threads are busy, use slice threading until
+  // playback is steady again. A single seek isn't worth reopening the decoder
+  // twice.
+  if (g_advancedSettings.m_videoAdaptiveThreading && m_decoderState == STATE_SW_MULTI && !m_pHardware)
+  {
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    bool seeking = m_lastReset && now - m_lastReset < THREADING_SEEK_INTERVAL;
+    m_lastReset = now;
+
+    m_lowLatencyFrames = 0;
+    m_threadSwitch = THREADSWITCH_NONE;
+    if (!m_lowLatency && seeking && m_keyFrames &&
+        m_pCodecContext->active_thread_type == FF_THREAD_FRAME &&
+        (m_pCodecContext->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS))
+    {
+      m_lowLatency = true;
+      Reopen();
+    }
+  }
 }
 
 void CDVDVideoCodecFFmpeg::Reopen()
@@ -808,6 +1057,7 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(VideoPicture* pVideoPicture)
   if (!m_pFrame)
     return false;
 
+  pVideoPicture->directBuffer = nullptr;
   pVideoPicture->iWidth = m_pFrame->width;
   pVideoPicture->iHeight = m_pFrame->height;
 
@@ -56,9 +56,18 @@ public:
   virtual IHardwareDecoder* GetHWAccel() override;
   virtual bool GetPictureCommon(VideoPicture* pVideoPicture) override;
 
+  /*!
+   * The number of decoder threads for a stream, scaled by its resolution and frame rate.
+   * A positive "threads" option overrides it.
+   */
+  static int GetThreadCount(const CDVDStreamInfo &hints, const CDVDCodecOptions &options, int cpuCount);
+
 protected:
   void Dispose();
   static enum AVPixelFormat GetFormat(struct AVCodecContext * avctx, const AVPixelFormat * fmt);
+  static int GetBuffer(struct AVCodecContext *avctx, AVFrame *frame, int flags);
+  static void ReleaseBuffer(void *opaque, uint8_t *data);
+  bool CanDecodeDirect(const AVCodec *codec) const;
 
   int  FilterOpen(const std::string& filters, bool scale);
   void FilterClose();
@@ -66,6 +75,9 @@ protected:
   void SetFilters();
   void UpdateName();
   bool SetPictureParams(VideoPicture* pVideoPicture);
+  void SetThreading(AVCodec *codec);
+  CDVDVideoCodec::VCReturn SwitchThreading();
+  void LogDecodeStats();
 
   IHardwareDecoder* CreateVideoDecoderHW(AVPixelFormat pixfmt, CProcessInfo &processInfo);
   bool HasHardware() { return m_pHardware != nullptr; };
@@ -99,6 +111,7 @@ protected:
   std::string m_name;
   int m_decoderState;
   IHardwareDecoder *m_pHardware;
+  IDirectBufferPool *m_directBufferPool;
   int m_iLastKeyframe;
   double m_dts;
   bool   m_started;
@@ -113,6 +126,30 @@ protected:
   CDVDStreamInfo m_hints;
   CDVDCodecOptions m_options;
 
+  // slice threading after seeks and on live streams, frame threading otherwise
+  bool m_lowLatency;
+  int m_lowLatencyFrames;
+  enum
+  {
+    THREADSWITCH_NONE,
+    THREADSWITCH_PENDING, // waiting for a keyframe
+    THREADSWITCH_DRAIN    // getting the remaining pictures out of the decoder
+  } m_threadSwitch;
+  bool m_keyFrames;          // the demuxer flags keyframes
+  unsigned int m_lastReset;  // system clock of the last seek
+
+  // decoder performance since the last open or reset
+  struct CDecodeStats
+  {
+    void Reset();
+
+    int64_t m_start;      // first packet, in host counter ticks
+    int64_t m_firstFrame; // first picture
+    int64_t m_lastFrame;  // last picture
+    int64_t m_busy;       // time spent in the decoder calls
+    unsigned int m_frames;
+  } m_decodeStats;
+
   struct CDropControl
   {
     CDropControl();
@@ -0,0 +1,509 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxCache.h"
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "URL.h"
+#include "utils/BinarySerializer.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#define DEMUXCACHE_DIRECTORY   "special://temp/demuxcache/"
+#define DEMUXCACHE_MAGIC       "KDMC"
+#define DEMUXCACHE_VERSION     1
+// upper limits to keep entries of broken files from growing without bounds
+#define DEMUXCACHE_MAX_SIZE    (8 * 1024 * 1024)
+#define DEMUXCACHE_MAX_STREAMS 256
+#define DEMUXCACHE_MAX_ENTRIES 250000
+#define DEMUXCACHE_MAX_FILES   250
+
+namespace
+{
+
+// number of entries in the cache directory, counted when the first entry is added
+CCriticalSection g_cacheFilesSection;
+std::string g_cacheDirectory = DEMUXCACHE_DIRECTORY;
+int g_cacheFiles = -1;
+
+}
+
+CDVDDemuxCache::CDVDDemuxCache(const CURL &url, int64_t fileSize)
+  : m_path(url.Get()),
+    m_fileSize(fileSize),
+    m_modified(0),
+    m_valid(false),
+    m_stored(false),
+    m_changed(false),
+    m_hasStreamInfo(false),
+    m_duration(AV_NOPTS_VALUE),
+    m_startTime(AV_NOPTS_VALUE),
+    m_bitRate(0)
+{
+  if (m_fileSize <= 0)
+    return;
+
+  // without a modification time a changed file couldn't be told apart
+  struct __stat64 buffer;
+  if (XFILE::CFile::Stat(url, &buffer) != 0 || buffer.st_mtime == 0)
+    return;
+
+  {
+    CSingleLock lock(g_cacheFilesSection);
+    m_directory = g_cacheDirectory;
+  }
+
+  m_modified = buffer.st_mtime;
+  m_cacheFile = URIUtils::AddFileToFolder(m_directory, StringUtils::Format("%08x.cache", static_cast<uint32_t>(Crc32::Compute(m_path))));
+  m_valid = true;
+}
+
+void CDVDDemuxCache::SetDirectory(const std::string &directory)
+{
+  CSingleLock lock(g_cacheFilesSection);
+  g_cacheDirectory = directory.empty() ? DEMUXCACHE_DIRECTORY : directory;
+  g_cacheFiles = -1;
+}
+
+bool CDVDDemuxCache::Load()
+{
+  if (!m_valid || !XFILE::CFile::Exists(m_cacheFile))
+    return false;
+
+  // even an entry which can't be used is overwritten, not added
+  m_stored = true;
+
+  XFILE::CFile file;
+  if (!file.Open(m_cacheFile))
+    return false;
+
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > DEMUXCACHE_MAX_SIZE)
+    return false;
+
+  std::string data(static_cast<size_t>(length), '\0');
+  if (file.Read(&data[0], data.size()) != static_cast<ssize_t>(data.size()))
+    return false;
+  file.Close();
+
+  if (!Deserialize(data))
+  {
+    // another file with the same hash or an outdated one, start over
+    m_hasStreamInfo = false;
+    m_streams.clear();
+    m_index.clear();
+    return false;
+  }
+
+  return true;
+}
+
+void CDVDDemuxCache::Save()
+{
+  if (!m_valid || !m_changed)
+    return;
+
+  std::string data;
+  if (!Serialize(data))
+    return;
+
+  if (!XFILE::CDirectory::Exists(m_directory))
+    XFILE::CDirectory::Create(m_directory);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(m_cacheFile, true) ||
+      file.Write(data.c_str(), data.size()) != static_cast<ssize_t>(data.size()))
+  {
+    CLog::Log(LOGWARNING, "CDVDDemuxCache::%s - failed to write %s", __FUNCTION__, m_cacheFile.c_str());
+    file.Close();
+    XFILE::CFile::Delete(m_cacheFile);
+    return;
+  }
+  file.Close();
+
+  m_changed = false;
+  CLog::Log(LOGDEBUG, "CDVDDemuxCache::%s - stored %zu bytes for %s", __FUNCTION__, data.size(), CURL::GetRedacted(m_path).c_str());
+
+  if (m_stored)
+    return;
+  m_stored = true;
+
+  // only a new entry can exceed the limit
+  CSingleLock lock(g_cacheFilesSection);
+  if (m_directory != g_cacheDirectory)
+    return;
+  if (g_cacheFiles < 0)
+    g_cacheFiles = Prune(m_directory);
+  else if (++g_cacheFiles > DEMUXCACHE_MAX_FILES)
+    g_cacheFiles = Prune(m_directory);
+}
+
+bool CDVDDemuxCache::ApplyStreamInfo(AVFormatContext *context) const
+{
+  if (!m_hasStreamInfo || !context || !context->iformat)
+    return false;
+
+  // streams found later on can't be described by the cache
+  if ((context->ctx_flags & AVFMTCTX_NOHEADER) ||
+      m_format != context->iformat->name ||
+      m_streams.size() != context->nb_streams)
+    return false;
+
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const AVCodecParameters *codecpar = context->streams[i]->codecpar;
+    if (codecpar->codec_id != AV_CODEC_ID_NONE && codecpar->codec_id != AV_CODEC_ID_PROBE &&
+        codecpar->codec_id != m_streams[i].parameters.codecId)
+      return false;
+  }
+
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    AVStream *st = context->streams[i];
+    AVCodecParameters *codecpar = st->codecpar;
+    const StreamParameters &p = m_streams[i].parameters;
+
+    codecpar->codec_type = static_cast<AVMediaType>(p.codecType);
+    codecpar->codec_id = static_cast<AVCodecID>(p.codecId);
+    codecpar->codec_tag = p.codecTag;
+    codecpar->format = p.format;
+    codecpar->bit_rate = p.bitRate;
+    codecpar->bits_per_coded_sample = p.bitsPerCodedSample;
+    codecpar->bits_per_raw_sample = p.bitsPerRawSample;
+    codecpar->profile = p.profile;
+    codecpar->level = p.level;
+    codecpar->width = p.width;
+    codecpar->height = p.height;
+    codecpar->sample_aspect_ratio = av_make_q(p.sampleAspectNum, p.sampleAspectDen);
+    codecpar->field_order = static_cast<AVFieldOrder>(p.fieldOrder);
+    codecpar->color_range = static_cast<AVColorRange>(p.colorRange);
+    codecpar->color_primaries = static_cast<AVColorPrimaries>(p.colorPrimaries);
+    codecpar->color_trc = static_cast<AVColorTransferCharacteristic>(p.colorTrc);
+    codecpar->color_space = static_cast<AVColorSpace>(p.colorSpace);
+    codecpar->chroma_location = static_cast<AVChromaLocation>(p.chromaLocation);
+    codecpar->channel_layout = p.channelLayout;
+    codecpar->channels = p.channels;
+    codecpar->sample_rate = p.sampleRate;
+    codecpar->block_align = p.blockAlign;
+    codecpar->frame_size = p.frameSize;
+    codecpar->initial_padding = p.initialPadding;
+    codecpar->seek_preroll = p.seekPreroll;
+
+    const std::string &extraData = m_streams[i].extraData;
+    if (!extraData.empty() &&
+        (codecpar->extradata_size != static_cast<int>(extraData.size()) ||
+         memcmp(codecpar->extradata, extraData.data(), extraData.size()) != 0))
+    {
+      uint8_t *buffer = static_cast<uint8_t*>(av_mallocz(extraData.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+      if (buffer)
+      {
+        memcpy(buffer, extraData.data(), extraData.size());
+        av_freep(&codecpar->extradata);
+        codecpar->extradata = buffer;
+        codecpar->extradata_size = static_cast<int>(extraData.size());
+      }
+    }
+
+    st->avg_frame_rate = av_make_q(p.avgFrameRateNum, p.avgFrameRateDen);
+    st->r_frame_rate = av_make_q(p.realFrameRateNum, p.realFrameRateDen);
+    st->codec_info_nb_frames = p.codecInfoFrames;
+    if (st->start_time == AV_NOPTS_VALUE)
+      st->start_time = p.startTime;
+    if (st->duration == AV_NOPTS_VALUE)
+      st->duration = p.duration;
+  }
+
+  if (context->duration == AV_NOPTS_VALUE)
+    context->duration = m_duration;
+  if (context->start_time == AV_NOPTS_VALUE)
+    context->start_time = m_startTime;
+  if (context->bit_rate <= 0)
+    context->bit_rate = m_bitRate;
+
+  return true;
+}
+
+void CDVDDemuxCache::SetStreamInfo(const AVFormatContext *context)
+{
+  if (!m_valid || !context || !context->iformat || context->nb_streams > DEMUXCACHE_MAX_STREAMS)
+    return;
+
+  m_format = context->iformat->name;
+  m_duration = context->duration;
+  m_startTime = context->start_time;
+  m_bitRate = context->bit_rate;
+
+  m_streams.clear();
+  m_streams.reserve(context->nb_streams);
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const AVStream *st = context->streams[i];
+    const AVCodecParameters *codecpar = st->codecpar;
+
+    StreamInfo info;
+    StreamParameters &p = info.parameters;
+    memset(&p, 0, sizeof(p));
+    p.codecType = codecpar->codec_type;
+    p.codecId = codecpar->codec_id;
+    p.codecTag = codecpar->codec_tag;
+    p.format = codecpar->format;
+    p.bitRate = codecpar->bit_rate;
+    p.bitsPerCodedSample = codecpar->bits_per_coded_sample;
+    p.bitsPerRawSample = codecpar->bits_per_raw_sample;
+    p.profile = codecpar->profile;
+    p.level = codecpar->level;
+    p.width = codecpar->width;
+    p.height = codecpar->height;
+    p.sampleAspectNum = codecpar->sample_aspect_ratio.num;
+    p.sampleAspectDen = codecpar->sample_aspect_ratio.den;
+    p.fieldOrder = codecpar->field_order;
+    p.colorRange = codecpar->color_range;
+    p.colorPrimaries = codecpar->color_primaries;
+    p.colorTrc = codecpar->color_trc;
+    p.colorSpace = codecpar->color_space;
+    p.chromaLocation = codecpar->chroma_location;
+    p.channelLayout = codecpar->channel_layout;
+    p.channels = codecpar->channels;
+    p.sampleRate = codecpar->sample_rate;
+    p.blockAlign = codecpar->block_align;
+    p.frameSize = codecpar->frame_size;
+    p.initialPadding = codecpar->initial_padding;
+    p.seekPreroll = codecpar->seek_preroll;
+    p.avgFrameRateNum = st->avg_frame_rate.num;
+    p.avgFrameRateDen = st->avg_frame_rate.den;
+    p.realFrameRateNum = st->r_frame_rate.num;
+    p.realFrameRateDen = st->r_frame_rate.den;
+    p.codecInfoFrames = st->codec_info_nb_frames;
+    p.startTime = st->start_time;
+    p.duration = st->duration;
+
+    if (codecpar->extradata && codecpar->extradata_size > 0)
+      info.extraData.assign(reinterpret_cast<const char*>(codecpar->extradata), codecpar->extradata_size);
+
+    m_streams.push_back(info);
+  }
+
+  m_hasStreamInfo = true;
+  m_changed = true;
+}
+
+int CDVDDemuxCache::ApplyIndex(AVFormatContext *context) const
+{
+  if (!context)
+    return 0;
+
+  int added = 0;
+  for (const auto &index : m_index)
+  {
+    if (index.stream < 0 || index.stream >= static_cast<int>(context->nb_streams))
+      continue;
+
+    AVStream *st = context->streams[index.stream];
+    if (st->codecpar->codec_id != index.codecId ||
+        st->nb_index_entries >= static_cast<int>(index.entries.size()))
+      continue;
+
+    // av_add_index_entry() keeps the index sorted and skips known timestamps
+    for (const auto &entry : index.entries)
+    {
+      if (av_add_index_entry(st, entry.pos, entry.timestamp, entry.size, entry.distance, AVINDEX_KEYFRAME) < 0)
+        break;
+      added++;
+    }
+  }
+
+  return added;
+}
+
+void CDVDDemuxCache::UpdateIndex(const AVFormatContext *context)
+{
+  if (!m_valid || !context || context->nb_streams > DEMUXCACHE_MAX_STREAMS)
+    return;
+
+  // the index of the video streams is all that's needed to seek, audio only files use theirs
+  bool hasVideo = false;
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    if (context->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+      hasVideo = true;
+  }
+
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const AVStream *st = context->streams[i];
+    AVMediaType type = st->codecpar->codec_type;
+    if (type != (hasVideo ? AVMEDIA_TYPE_VIDEO : AVMEDIA_TYPE_AUDIO) || st->nb_index_entries <= 0)
+      continue;
+
+    std::vector<IndexEntry> entries;
+    entries.reserve(st->nb_index_entries);
+    for (int j = 0; j < st->nb_index_entries && entries.size() < DEMUXCACHE_MAX_ENTRIES; j++)
+    {
+      const AVIndexEntry &ie = st->index_entries[j];
+      if (!(ie.flags & AVINDEX_KEYFRAME))
+        continue;
+
+      IndexEntry entry;
+      entry.pos = ie.pos;
+      entry.timestamp = ie.timestamp;
+      entry.size = ie.size;
+      entry.distance = ie.min_distance;
+      entries.push_back(entry);
+    }
+
+    auto it = m_index.begin();
+    while (it != m_index.end() && it->stream != static_cast<int>(i))
+      ++it;
+
+    if (it == m_index.end())
+    {
+      StreamIndex index;
+      index.stream = i;
+      index.codecId = st->codecpar->codec_id;
+      m_index.push_back(index);
+      it = m_index.end() - 1;
+    }
+    else if (it->codecId == st->codecpar->codec_id && it->entries.size() >= entries.size())
+      continue;
+
+    it->codecId = st->codecpar->codec_id;
+    it->entries.swap(entries);
+    m_changed = true;
+  }
+}
+
+bool CDVDDemuxCache::Serialize(std::string &data) const
+{
+  data.clear();
+  CBinaryWriter writer(data);
+  writer.WriteMagic(DEMUXCACHE_MAGIC);
+  writer.Write(static_cast<uint32_t>(DEMUXCACHE_VERSION));
+  writer.WriteString(m_path);
+  writer.Write(m_fileSize);
+  writer.Write(m_modified);
+
+  writer.Write(static_cast<uint8_t>(m_hasStreamInfo ? 1 : 0));
+  if (m_hasStreamInfo)
+  {
+    writer.WriteString(m_format);
+    writer.Write(m_duration);
+    writer.Write(m_startTime);
+    writer.Write(m_bitRate);
+    writer.Write(static_cast<uint32_t>(m_streams.size()));
+    for (const auto &stream : m_streams)
+    {
+      writer.Write(stream.parameters);
+      writer.WriteString(stream.extraData);
+    }
+  }
+
+  writer.Write(static_cast<uint32_t>(m_index.size()));
+  for (const auto &index : m_index)
+  {
+    writer.Write(index.stream);
+    writer.Write(index.codecId);
+    writer.Write(static_cast<uint32_t>(index.entries.size()));
+    if (!index.entries.empty())
+      writer.WriteArray(index.entries.data(), index.entries.size() * sizeof(IndexEntry));
+  }
+
+  return data.size() <= DEMUXCACHE_MAX_SIZE;
+}
+
+bool CDVDDemuxCache::Deserialize(const std::string &data)
+{
+  CBinaryReader reader(data.c_str(), data.size());
+
+  uint32_t version;
+  std::string path;
+  int64_t fileSize, modified;
+  if (!reader.ReadMagic(DEMUXCACHE_MAGIC) ||
+      !reader.Read(version) || version != DEMUXCACHE_VERSION ||
+      !reader.ReadString(path) || path != m_path ||
+      !reader.Read(fileSize) || fileSize != m_fileSize ||
+      !reader.Read(modified) || modified != m_modified)
+    return false;
+
+  uint8_t hasStreamInfo;
+  if (!reader.Read(hasStreamInfo))
+    return false;
+
+  m_hasStreamInfo = hasStreamInfo != 0;
+  if (m_hasStreamInfo)
+  {
+    uint32_t count;
+    if (!reader.ReadString(m_format) ||
+        !reader.Read(m_duration) || !reader.Read(m_startTime) || !reader.Read(m_bitRate) ||
+        !reader.Read(count) || count > DEMUXCACHE_MAX_STREAMS)
+      return false;
+
+    m_streams.resize(count);
+    for (auto &stream : m_streams)
+    {
+      if (!reader.Read(stream.parameters) || !reader.ReadString(stream.extraData))
+        return false;
+    }
+  }
+
+  uint32_t count;
+  if (!reader.Read(count) || count > DEMUXCACHE_MAX_STREAMS)
+    return false;
+
+  m_index.resize(count);
+  for (auto &index : m_index)
+  {
+    uint32_t entries;
+    if (!reader.Read(index.stream) || !reader.Read(index.codecId) ||
+        !reader.Read(entries) || entries > DEMUXCACHE_MAX_ENTRIES)
+      return false;
+
+    index.entries.resize(entries);
+    if (entries > 0 && !reader.ReadArray(index.entries.data(), entries * sizeof(IndexEntry)))
+      return false;
+  }
+
+  return reader.AtEnd();
+}
+
+int CDVDDemuxCache::Prune(const std::string &directory)
+{
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(directory, items, ".cache", XFILE::DIR_FLAG_NO_FILE_DIRS))
+    return 0;
+
+  int count = items.Size();
+  if (count <= DEMUXCACHE_MAX_FILES)
+    return count;
+
+  // drop the entries of the files which haven't been played for the longest time
+  items.Sort(SortByDate, SortOrderAscending);
+  for (int i = 0; i < items.Size() - DEMUXCACHE_MAX_FILES; i++)
+  {
+    if (XFILE::CFile::Delete(items[i]->GetPath()))
+      count--;
+  }
+  return count;
+}
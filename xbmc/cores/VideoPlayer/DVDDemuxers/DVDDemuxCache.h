@@ -0,0 +1,180 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+class CURL;
+
+/*!
+ * Remembers what avformat_find_stream_info() found out about a file and the
+ * keyframe index ffmpeg built while it was played, so reopening the same file
+ * doesn't have to probe it again and seeks can go straight to a byte offset
+ * instead of scanning the file (which is slow on network sources without cues).
+ *
+ * Entries are kept in special://temp/demuxcache/ and are keyed by path, size
+ * and modification time of the file, so a changed file invalidates its entry.
+ */
+class CDVDDemuxCache
+{
+public:
+  CDVDDemuxCache(const CURL &url, int64_t fileSize);
+
+  /*!
+   * Keep the entries of caches created from now on in another directory.
+   * \param directory the directory, empty for the default one
+   */
+  static void SetDirectory(const std::string &directory);
+
+  /*!
+   * Read the cache entry of the file.
+   * \return false if the file can't be cached or there is no matching entry
+   */
+  bool Load();
+
+  /*!
+   * Write the cache entry if it has changed since it was loaded.
+   */
+  void Save();
+
+  bool IsValid() const { return m_valid; }
+  bool HasStreamInfo() const { return m_hasStreamInfo; }
+
+  /*!
+   * Fill in the codec parameters of the streams found in the header of the
+   * file, replacing the need for avformat_find_stream_info().
+   * \return false if the cached parameters don't match the opened file
+   */
+  bool ApplyStreamInfo(AVFormatContext *context) const;
+
+  /*!
+   * Remember the codec parameters of a completely probed file.
+   */
+  void SetStreamInfo(const AVFormatContext *context);
+
+  /*!
+   * Add the cached keyframes to the index of the streams if ffmpeg knows less
+   * of them itself.
+   * \return the number of added index entries
+   */
+  int ApplyIndex(AVFormatContext *context) const;
+
+  /*!
+   * Remember the keyframe index of the streams if it has grown beyond the
+   * cached one.
+   */
+  void UpdateIndex(const AVFormatContext *context);
+
+private:
+  // the codec parameters of a stream, stored as they are
+  struct StreamParameters
+  {
+    int64_t bitRate;
+    uint64_t channelLayout;
+    int64_t startTime;
+    int64_t duration;
+    int32_t codecType;
+    int32_t codecId;
+    uint32_t codecTag;
+    int32_t format;
+    int32_t bitsPerCodedSample;
+    int32_t bitsPerRawSample;
+    int32_t profile;
+    int32_t level;
+    int32_t width;
+    int32_t height;
+    int32_t sampleAspectNum;
+    int32_t sampleAspectDen;
+    int32_t fieldOrder;
+    int32_t colorRange;
+    int32_t colorPrimaries;
+    int32_t colorTrc;
+    int32_t colorSpace;
+    int32_t chromaLocation;
+    int32_t channels;
+    int32_t sampleRate;
+    int32_t blockAlign;
+    int32_t frameSize;
+    int32_t initialPadding;
+    int32_t seekPreroll;
+    int32_t avgFrameRateNum;
+    int32_t avgFrameRateDen;
+    int32_t realFrameRateNum;
+    int32_t realFrameRateDen;
+    int32_t codecInfoFrames;
+    int32_t reserved;
+  };
+
+  struct StreamInfo
+  {
+    StreamParameters parameters;
+    std::string extraData;
+  };
+
+  struct IndexEntry
+  {
+    int64_t pos;
+    int64_t timestamp;
+    int32_t size;
+    int32_t distance;
+  };
+
+  struct StreamIndex
+  {
+    int32_t stream;
+    int32_t codecId;
+    std::vector<IndexEntry> entries;
+  };
+
+  friend class TestDVDDemuxCacheHelper;
+
+  bool Serialize(std::string &data) const;
+  bool Deserialize(const std::string &data);
+
+  /*!
+   * Delete the oldest entries beyond the limit.
+   * \return the number of entries left
+   */
+  static int Prune(const std::string &directory);
+
+  std::string m_path;
+  std::string m_directory;
+  int64_t m_fileSize;
+  int64_t m_modified;
+  std::string m_cacheFile;
+  bool m_valid;
+  bool m_stored;  // there is an entry of the file on disk
+  bool m_changed;
+
+  bool m_hasStreamInfo;
+  std::string m_format;
+  int64_t m_duration;
+  int64_t m_startTime;
+  int64_t m_bitRate;
+  std::vector<StreamInfo> m_streams;
+  std::vector<StreamIndex> m_index;
+};
@@ -213,6 +213,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput, bool streaminfo, bool filein
   m_currentPts = DVD_NOPTS_VALUE;
   m_speed = DVD_PLAYSPEED_NORMAL;
   m_program = UINT_MAX;
+  m_cachedStreamInfo = false;
+  m_storeDemuxCache = !fileinfo;
+  m_openTime = XbmcThreads::SystemClockMillis();
 
   const AVIOInterruptCB int_cb = { interrupt_cb, this };
 
@@ -456,32 +459,54 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput, bool streaminfo, bool filein
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
   m_bSup = strcmp(m_pFormatContext->iformat->name, "sup") == 0;
 
-  if (m_streaminfo)
+  // files which have been played before don't have to be probed again
+  m_demuxCache.reset();
+  if (g_advancedSettings.m_videoDemuxCache && m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE))
   {
-    /* to speed up dvd switches, only analyse very short */
-    if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
-      av_opt_set_int(m_pFormatContext, "analyzeduration", 500000, 0);
+    m_demuxCache.reset(new CDVDDemuxCache(m_pInput->GetURL(), m_pInput->GetLength()));
+    if (m_demuxCache->IsValid())
+      m_demuxCache->Load();
+    else
+      m_demuxCache.reset();
+  }
 
-    CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
-    int iErr = avformat_find_stream_info(m_pFormatContext, NULL);
-    if (iErr < 0)
+  if (m_streaminfo)
+  {
+    if (m_demuxCache && m_demuxCache->ApplyStreamInfo(m_pFormatContext))
     {
-      CLog::Log(LOGWARNING,"could not find codec parameters for %s", CURL::GetRedacted(strFile).c_str());
-      if (m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD) ||
-          m_pInput->IsStreamType(DVDSTREAM_TYPE_BLURAY) ||
-          (m_pFormatContext->nb_streams == 1 &&
-           m_pFormatContext->streams[0]->codecpar->codec_id == AV_CODEC_ID_AC3) ||
-          m_checkvideo)
-      {
-        // special case, our codecs can still handle it.
-      }
-      else
+      CLog::Log(LOGDEBUG, "%s - using cached stream info", __FUNCTION__);
+      m_cachedStreamInfo = true;
+    }
+    else
+    {
+      /* to speed up dvd switches, only analyse very short */
+      if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
+        av_opt_set_int(m_pFormatContext, "analyzeduration", 500000, 0);
+
+      CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
+      int iErr = avformat_find_stream_info(m_pFormatContext, NULL);
+      if (iErr < 0)
       {
-        Dispose();
-        return false;
+        CLog::Log(LOGWARNING,"could not find codec parameters for %s", CURL::GetRedacted(strFile).c_str());
+        if (m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD) ||
+            m_pInput->IsStreamType(DVDSTREAM_TYPE_BLURAY) ||
+            (m_pFormatContext->nb_streams == 1 &&
+             m_pFormatContext->streams[0]->codecpar->codec_id == AV_CODEC_ID_AC3) ||
+            m_checkvideo)
+        {
+          // special case, our codecs can still handle it.
+        }
+        else
+        {
+          Dispose();
+          return false;
+        }
       }
+      CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+      if (m_demuxCache && iErr >= 0)
+        m_demuxCache->SetStreamInfo(m_pFormatContext);
     }
-    CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
 
     if (m_checkvideo)
     {
@@ -496,6 +521,14 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput, bool streaminfo, bool filein
     skipCreateStreams = true;
   }
 
+  // the cached index allows to seek without scanning the file
+  if (m_demuxCache)
+  {
+    int entries = m_demuxCache->ApplyIndex(m_pFormatContext);
+    if (entries > 0)
+      CLog::Log(LOGDEBUG, "%s - added %d cached index entries", __FUNCTION__, entries);
+  }
+
   // reset any timeout
   m_timeout.SetInfinite();
 
@@ -565,6 +598,13 @@ void CDVDDemuxFFmpeg::Dispose()
       CLog::Log(LOGWARNING, "CDVDDemuxFFmpeg::Dispose - demuxer changed our byte context behind our back, possible memleak");
       m_ioContext = m_pFormatContext->pb;
     }
+
+    // thumbnail and stream details extraction only reuse entries of played files
+    if (m_demuxCache && m_storeDemuxCache)
+    {
+      m_demuxCache->UpdateIndex(m_pFormatContext);
+      m_demuxCache->Save();
+    }
     avformat_close_input(&m_pFormatContext);
   }
 
@@ -577,6 +617,8 @@ void CDVDDemuxFFmpeg::Dispose()
   m_ioContext = NULL;
   m_pFormatContext = NULL;
   m_speed = DVD_PLAYSPEED_NORMAL;
+  m_demuxCache.reset();
+  m_openTime = 0;
 
   DisposeStreams();
 
@@ -586,8 +628,10 @@ void CDVDDemuxFFmpeg::Dispose()
 void CDVDDemuxFFmpeg::Reset()
 {
   CDVDInputStream* pInputStream = m_pInput;
+  bool storeDemuxCache = m_storeDemuxCache;
   Dispose();
   Open(pInputStream, m_streaminfo);
+  m_storeDemuxCache = storeDemuxCache;
 }
 
 void CDVDDemuxFFmpeg::Flush()
@@ -966,6 +1010,7 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
         pPacket->pts = ConvertTimestamp(m_pkt.pkt.pts, stream->time_base.den, stream->time_base.num);
         pPacket->dts = ConvertTimestamp(m_pkt.pkt.dts, stream->time_base.den, stream->time_base.num);
         pPacket->duration =  DVD_SEC_TO_TIME((double)m_pkt.pkt.duration * stream->time_base.num / stream->time_base.den);
+        pPacket->bKeyFrame = (m_pkt.pkt.flags & AV_PKT_FLAG_KEY) != 0;
 
         CDVDInputStream::IDisplayTime *inputStream = m_pInput->GetIDisplayTime();
         if (inputStream)
@@ -1066,6 +1111,14 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
 
     pPacket->iStreamId = stream->uniqueId;
     pPacket->demuxerId = m_demuxerId;
+
+    if (m_openTime)
+    {
+      CLog::Log(LOGDEBUG, "CDVDDemuxFFmpeg::Read - first packet of %s after %u ms%s",
+                CURL::GetRedacted(m_pInput->GetFileName()).c_str(), XbmcThreads::SystemClockMillis() - m_openTime,
+                m_cachedStreamInfo ? " (cached stream info)" : "");
+      m_openTime = 0;
+    }
   }
   return pPacket;
 }
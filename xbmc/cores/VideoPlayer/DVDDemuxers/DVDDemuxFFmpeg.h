@@ -21,6 +21,7 @@
  */
 
 #include "DVDDemux.h"
+#include "DVDDemuxCache.h"
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
 #include <map>
@@ -114,6 +115,11 @@ public:
 
   bool Aborted();
 
+  /*!
+   * \return true if the streams were described by the demux cache instead of being probed
+   */
+  bool HasCachedStreamInfo() const { return m_cachedStreamInfo; }
+
   AVFormatContext* m_pFormatContext;
   CDVDInputStream* m_pInput;
 
@@ -169,5 +175,10 @@ protected:
   bool m_checkvideo;
   int m_displayTime = 0;
   double m_dtsAtDisplayTime;
+
+  std::unique_ptr<CDVDDemuxCache> m_demuxCache;
+  bool m_cachedStreamInfo = false;
+  bool m_storeDemuxCache = false;
+  unsigned int m_openTime = 0;  // set until the first packet is read
 };
 
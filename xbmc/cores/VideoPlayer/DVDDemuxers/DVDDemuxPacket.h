@@ -52,4 +52,7 @@ typedef struct DemuxPacket
   int dispTime;
 
   std::shared_ptr<DemuxCryptoInfo> cryptoInfo;
+
+  // add-ons fill in the members above, new ones go here to keep their offsets
+  bool bKeyFrame = false; // decoding can start at this packet, if known by the demuxer
 } DemuxPacket;
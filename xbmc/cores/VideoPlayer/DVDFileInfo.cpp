@@ -220,8 +220,16 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
 
         memset(&picture, 0, sizeof(picture));
 
+        // the seek lands on the keyframe before the position if the demuxer
+        // has an index, otherwise the pictures up to the next keyframe can't
+        // be decoded anyway. ffmpeg marks the keyframes, skip straight to one.
+        bool skipToKeyFrame = dynamic_cast<CDVDDemuxFFmpeg*>(pDemuxer) != nullptr;
+
         // num streams * 160 frames, should get a valid frame, if not abort.
         int abort_index = pDemuxer->GetNrOfStreams() * 160;
+        // packets before the keyframe don't count, but keyframes far apart or
+        // not flagged at all mustn't make it read the whole file
+        int skip_index = pDemuxer->GetNrOfStreams() * 1000;
         do
         {
           DemuxPacket* pPacket = pDemuxer->Read();
@@ -230,6 +238,17 @@ bool CDVDFileInfo::ExtractThumb(const std::string &strPath,
           if (!pPacket)
             break;
 
+          if (skipToKeyFrame && pPacket->iStreamId == nVideoStream && pPacket->bKeyFrame)
+            skipToKeyFrame = false;
+
+          if (skipToKeyFrame && skip_index-- > 0)
+          {
+            CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+            abort_index++;
+            continue;
+          }
+          skipToKeyFrame = false;
+
           if (pPacket->iStreamId != nVideoStream)
           {
             CDVDDemuxUtils::FreeDemuxPacket(pPacket);
@@ -23,6 +23,7 @@
 #include "ServiceBroker.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
@@ -30,6 +31,17 @@
 #include "threads/SingleLock.h"
 #include "guilib/GraphicContext.h"
 
+#include <algorithm>
+#include <string.h>
+
+// frames following the last requested one which are rendered ahead of time
+#define LIBASS_PRERENDER_FRAMES 8
+// stop rendering ahead if the cached bitmaps get bigger, 4k typesetting is large
+#define LIBASS_CACHE_MAX_BYTES  (64 * 1024 * 1024)
+// window around the last requested time which is kept in the cache
+#define LIBASS_CACHE_BEHIND_MS  1000
+#define LIBASS_CACHE_AHEAD_MS   10000
+
 static void libass_log(int level, const char *fmt, va_list args, void *data)
 {
   if(level >= 5)
@@ -38,9 +50,26 @@ static void libass_log(int level, const char *fmt, va_list args, void *data)
   CLog::Log(LOGDEBUG, "CDVDSubtitlesLibass: [ass] %s", log.c_str());
 }
 
+bool CDVDSubtitlesLibass::SRenderParams::operator==(const SRenderParams &rhs) const
+{
+  return frameWidth == rhs.frameWidth &&
+         frameHeight == rhs.frameHeight &&
+         videoWidth == rhs.videoWidth &&
+         videoHeight == rhs.videoHeight &&
+         useMargin == rhs.useMargin &&
+         position == rhs.position &&
+         pixelRatio == rhs.pixelRatio;
+}
+
 CDVDSubtitlesLibass::CDVDSubtitlesLibass()
+  : CThread("LibassPrerender")
 {
 
+  m_nextId = 1;
+  m_cacheSize = 0;
+  m_requestPts = DVD_NOPTS_VALUE;
+  m_frameDuration = 0.0;
+
   m_track = NULL;
   m_library = NULL;
   m_renderer = NULL;
@@ -94,6 +123,10 @@ CDVDSubtitlesLibass::CDVDSubtitlesLibass()
 
 CDVDSubtitlesLibass::~CDVDSubtitlesLibass()
 {
+  m_bStop = true;
+  m_prerenderEvent.Set();
+  StopThread();
+
   if(m_dll.IsLoaded())
   {
     if(m_track)
@@ -118,6 +151,7 @@ bool CDVDSubtitlesLibass::DecodeHeader(char* data, int size)
   }
 
   m_dll.ass_process_codec_private(m_track, data, size);
+  ClearCache();
   return true;
 }
 
@@ -131,6 +165,9 @@ bool CDVDSubtitlesLibass::DecodeDemuxPkt(char* data, int size, double start, dou
   }
 
   m_dll.ass_process_chunk(m_track, data, size, DVD_TIME_TO_MSEC(start), DVD_TIME_TO_MSEC(duration));
+
+  // the new event can only change what is shown from its start on
+  Invalidate(DVD_TIME_TO_MSEC(start));
   return true;
 }
 
@@ -149,27 +186,269 @@ bool CDVDSubtitlesLibass::CreateTrack(char* buf, size_t size)
   if(m_track == NULL)
     return false;
 
+  ClearCache();
   return true;
 }
 
 ASS_Image* CDVDSubtitlesLibass::RenderImage(int frameWidth, int frameHeight, int videoWidth, int videoHeight, double pts, int useMargin, double position, int *changes)
 {
-  CSingleLock lock(m_section);
-  if(!m_renderer || !m_track)
+  SRenderParams params;
+  params.frameWidth = frameWidth;
+  params.frameHeight = frameHeight;
+  params.videoWidth = videoWidth;
+  params.videoHeight = videoHeight;
+  params.useMargin = useMargin;
+  params.position = position;
+  params.pixelRatio = g_graphicsContext.GetResInfo().fPixelRatio;
+
+  long long ms = DVD_TIME_TO_MSEC(pts);
+  std::shared_ptr<SFrame> frame;
   {
-    CLog::Log(LOGERROR, "CDVDSubtitlesLibass: %s - Missing ASS structs(m_track or m_renderer)", __FUNCTION__);
+    CSingleLock lock(m_cacheSection);
+    if (params != m_params)
+    {
+      m_params = params;
+      m_cache.clear();
+      m_cacheSize = 0;
+    }
+
+    // the distance of the frames tells where the next ones will be
+    if (m_requestPts != DVD_NOPTS_VALUE && pts > m_requestPts && pts - m_requestPts < DVD_MSEC_TO_TIME(200))
+      m_frameDuration = pts - m_requestPts;
+    m_requestPts = pts;
+
+    Prune(ms);
+    frame = Find(ms);
+  }
+
+  if (!frame)
+  {
+    CSingleLock lock(m_section);
+    if(!m_renderer || !m_track)
+    {
+      CLog::Log(LOGERROR, "CDVDSubtitlesLibass: %s - Missing ASS structs(m_track or m_renderer)", __FUNCTION__);
+      return NULL;
+    }
+
+    {
+      // the worker may just have rendered it
+      CSingleLock cacheLock(m_cacheSection);
+      frame = Find(ms);
+    }
+
+    if (!frame)
+      frame = Render(params, ms);
+  }
+
+  if (g_advancedSettings.m_videoAssPrerender)
+  {
+    if (!IsRunning())
+      Create();
+    m_prerenderEvent.Set();
+  }
+
+  CSingleLock lock(m_cacheSection);
+  if (changes)
+    *changes = (m_current && m_current->id == frame->id) ? 0 : 2;
+  m_current = frame;
+
+  if (frame->images.empty())
     return NULL;
+  return frame->images.data();
+}
+
+void CDVDSubtitlesLibass::Process()
+{
+  while (!m_bStop)
+  {
+    SRenderParams params;
+    long long next = -1;
+    {
+      CSingleLock lock(m_cacheSection);
+      if (m_frameDuration > 0.0 && m_cacheSize < LIBASS_CACHE_MAX_BYTES)
+      {
+        for (int i = 1; i <= LIBASS_PRERENDER_FRAMES; i++)
+        {
+          long long ms = DVD_TIME_TO_MSEC(m_requestPts + i * m_frameDuration);
+          if (!Find(ms))
+          {
+            next = ms;
+            break;
+          }
+        }
+      }
+      params = m_params;
+    }
+
+    if (next < 0)
+    {
+      m_prerenderEvent.Wait();
+      continue;
+    }
+
+    {
+      CSingleLock lock(m_section);
+      if (m_renderer && m_track)
+      {
+        Render(params, next);
+        continue;
+      }
+    }
+    m_prerenderEvent.Wait();
   }
+}
 
-  double storage_aspect = (double)frameWidth / frameHeight;
-  m_dll.ass_set_frame_size(m_renderer, frameWidth, frameHeight);
-  int topmargin = (frameHeight - videoHeight) / 2;
-  int leftmargin = (frameWidth - videoWidth) / 2;
+std::shared_ptr<CDVDSubtitlesLibass::SFrame> CDVDSubtitlesLibass::Render(const SRenderParams &params, long long ms)
+{
+  double storage_aspect = (double)params.frameWidth / params.frameHeight;
+  m_dll.ass_set_frame_size(m_renderer, params.frameWidth, params.frameHeight);
+  int topmargin = (params.frameHeight - params.videoHeight) / 2;
+  int leftmargin = (params.frameWidth - params.videoWidth) / 2;
   m_dll.ass_set_margins(m_renderer, topmargin, topmargin, leftmargin, leftmargin);
-  m_dll.ass_set_use_margins(m_renderer, useMargin);
-  m_dll.ass_set_line_position(m_renderer, position);
-  m_dll.ass_set_aspect_ratio(m_renderer, storage_aspect / g_graphicsContext.GetResInfo().fPixelRatio, storage_aspect);
-  return m_dll.ass_render_frame(m_renderer, m_track, DVD_TIME_TO_MSEC(pts), changes);
+  m_dll.ass_set_use_margins(m_renderer, params.useMargin);
+  m_dll.ass_set_line_position(m_renderer, params.position);
+  m_dll.ass_set_aspect_ratio(m_renderer, storage_aspect / params.pixelRatio, storage_aspect);
+
+  int changes = 0;
+  ASS_Image *images = m_dll.ass_render_frame(m_renderer, m_track, ms, &changes);
+
+  // libass tells if the images are the same as the ones of its last call
+  std::shared_ptr<SFrame> frame;
+  if (changes == 0 && m_lastFrame && params == m_lastParams)
+    frame = m_lastFrame;
+  else
+    frame = CopyImages(images);
+
+  m_lastFrame = frame;
+  m_lastParams = params;
+
+  Insert(params, ms, frame);
+  return frame;
+}
+
+std::shared_ptr<CDVDSubtitlesLibass::SFrame> CDVDSubtitlesLibass::CopyImages(ASS_Image *images)
+{
+  std::shared_ptr<SFrame> frame = std::make_shared<SFrame>();
+  frame->id = m_nextId++;
+
+  size_t count = 0;
+  size_t bytes = 0;
+  for (ASS_Image *img = images; img; img = img->next)
+  {
+    // fully transparent or width or height is 0 -> not displayed
+    if ((img->color & 0xff) == 0xff || img->w == 0 || img->h == 0)
+      continue;
+    count++;
+    bytes += img->w * img->h;
+  }
+
+  frame->images.resize(count);
+  frame->bitmaps.resize(bytes);
+
+  ASS_Image *copy = frame->images.data();
+  uint8_t *bitmap = frame->bitmaps.data();
+  for (ASS_Image *img = images; img; img = img->next)
+  {
+    if ((img->color & 0xff) == 0xff || img->w == 0 || img->h == 0)
+      continue;
+
+    *copy = *img;
+    copy->stride = img->w;
+    copy->bitmap = bitmap;
+    for (int y = 0; y < img->h; y++)
+      memcpy(bitmap + y * img->w, img->bitmap + y * img->stride, img->w);
+    bitmap += img->w * img->h;
+
+    copy->next = (copy + 1 < frame->images.data() + count) ? copy + 1 : NULL;
+    copy++;
+  }
+
+  return frame;
+}
+
+std::shared_ptr<CDVDSubtitlesLibass::SFrame> CDVDSubtitlesLibass::Find(long long ms) const
+{
+  for (const auto &entry : m_cache)
+  {
+    if (entry.start > ms)
+      break;
+    if (entry.end >= ms)
+      return entry.frame;
+  }
+  return nullptr;
+}
+
+void CDVDSubtitlesLibass::Insert(const SRenderParams &params, long long ms, const std::shared_ptr<SFrame> &frame)
+{
+  CSingleLock lock(m_cacheSection);
+  if (params != m_params)
+    return;
+
+  // images of frames next to each other only differ if libass says so, any
+  // time in between shows them as well
+  long long gap = DVD_TIME_TO_MSEC(m_frameDuration * 1.5);
+
+  auto it = std::upper_bound(m_cache.begin(), m_cache.end(), ms,
+                             [](long long ms, const SCacheEntry &entry) { return ms < entry.start; });
+  if (it != m_cache.begin())
+  {
+    auto prev = it - 1;
+    if (prev->end >= ms)
+      return;
+    if (prev->frame == frame && ms - prev->end <= gap)
+    {
+      prev->end = ms;
+      return;
+    }
+  }
+  if (it != m_cache.end() && it->frame == frame && it->start - ms <= gap)
+  {
+    it->start = ms;
+    return;
+  }
+
+  SCacheEntry entry;
+  entry.start = ms;
+  entry.end = ms;
+  entry.frame = frame;
+  m_cache.insert(it, entry);
+  m_cacheSize += frame->bitmaps.size();
+}
+
+void CDVDSubtitlesLibass::Invalidate(long long from)
+{
+  CSingleLock lock(m_cacheSection);
+  while (!m_cache.empty() && m_cache.back().start >= from)
+  {
+    m_cacheSize -= m_cache.back().frame->bitmaps.size();
+    m_cache.pop_back();
+  }
+  if (!m_cache.empty() && m_cache.back().end >= from)
+    m_cache.back().end = from - 1;
+
+  m_prerenderEvent.Set();
+}
+
+void CDVDSubtitlesLibass::Prune(long long ms)
+{
+  while (!m_cache.empty() && m_cache.front().end < ms - LIBASS_CACHE_BEHIND_MS)
+  {
+    m_cacheSize -= m_cache.front().frame->bitmaps.size();
+    m_cache.pop_front();
+  }
+  while (!m_cache.empty() && m_cache.back().start > ms + LIBASS_CACHE_AHEAD_MS)
+  {
+    m_cacheSize -= m_cache.back().frame->bitmaps.size();
+    m_cache.pop_back();
+  }
+}
+
+void CDVDSubtitlesLibass::ClearCache()
+{
+  CSingleLock lock(m_cacheSection);
+  m_cache.clear();
+  m_cacheSize = 0;
+  m_lastFrame.reset();
 }
 
 ASS_Event* CDVDSubtitlesLibass::GetEvents()
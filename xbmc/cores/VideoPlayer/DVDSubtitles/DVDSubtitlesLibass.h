@@ -20,18 +20,31 @@
  *
  */
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "DllLibass.h"
 #include "DVDResource.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
 
 /** Wrapper for Libass **/
 
-class CDVDSubtitlesLibass : public IDVDResourceCounted<CDVDSubtitlesLibass>
+class CDVDSubtitlesLibass : public IDVDResourceCounted<CDVDSubtitlesLibass>, private CThread
 {
 public:
   CDVDSubtitlesLibass();
   virtual ~CDVDSubtitlesLibass();
 
+  /*!
+   * Render the subtitles shown at pts. The images stay valid until the next
+   * call, changes is 0 if they are the same as the ones of the last call.
+   *
+   * Frames following the requested one are rendered ahead of time on a worker
+   * thread, so most calls only look up the cache.
+   */
   ASS_Image* RenderImage(int frameWidth, int frameHeight, int videoWidth, int videoHeight, double pts, int useMargin = 0, double position = 0.0, int* changes = NULL);
   ASS_Event* GetEvents();
 
@@ -41,12 +54,69 @@ public:
   bool DecodeDemuxPkt(char* data, int size, double start, double duration);
   bool CreateTrack(char* buf, size_t size);
 
+protected:
+  void Process() override;
+
 private:
+  // everything libass renders the images for besides the time
+  struct SRenderParams
+  {
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int videoWidth = 0;
+    int videoHeight = 0;
+    int useMargin = 0;
+    double position = 0.0;
+    double pixelRatio = 1.0;
+
+    bool operator==(const SRenderParams &rhs) const;
+    bool operator!=(const SRenderParams &rhs) const { return !(*this == rhs); }
+  };
+
+  // a copy of the images of one ass_render_frame call, libass reuses its own
+  // on the next call
+  struct SFrame
+  {
+    unsigned int id = 0;
+    std::vector<ASS_Image> images;
+    std::vector<uint8_t> bitmaps;
+  };
+
+  // the frames from start to end (ms) showed the same images
+  struct SCacheEntry
+  {
+    long long start;
+    long long end;
+    std::shared_ptr<SFrame> frame;
+  };
+
+  std::shared_ptr<SFrame> Render(const SRenderParams &params, long long ms);
+  std::shared_ptr<SFrame> CopyImages(ASS_Image *images);
+  std::shared_ptr<SFrame> Find(long long ms) const;
+  void Insert(const SRenderParams &params, long long ms, const std::shared_ptr<SFrame> &frame);
+  void Invalidate(long long from);
+  void Prune(long long ms);
+  void ClearCache();
+
   DllLibass m_dll;
   long m_references;
   ASS_Library* m_library;
   ASS_Track* m_track;
   ASS_Renderer* m_renderer;
   CCriticalSection m_section;
-};
 
+  // state of the renderer, protected by m_section
+  SRenderParams m_lastParams;
+  std::shared_ptr<SFrame> m_lastFrame;
+  unsigned int m_nextId;
+
+  // cache and prerender requests, m_section is never taken while holding m_cacheSection
+  CCriticalSection m_cacheSection;
+  std::deque<SCacheEntry> m_cache;
+  size_t m_cacheSize;
+  SRenderParams m_params;
+  double m_requestPts;
+  double m_frameDuration;
+  std::shared_ptr<SFrame> m_current;
+  CEvent m_prerenderEvent;
+};
@@ -230,7 +230,9 @@ void CBaseRenderer::CalcNormalRenderRect(float offsetX, float offsetY, float wid
 
   // allow a certain error to maximize size of render area
   float fCorrection = width / height / outputFrameRatio - 1.0f;
-  float fAllowed    = CServiceBroker::GetSettings().GetInt(CSettings::SETTING_VIDEOPLAYER_ERRORINASPECT) * 0.01f;
+  // called for every frame, so read the setting through a handle
+  static const SettingHandle errorInAspect = CServiceBroker::GetSettings().GetHandle(CSettings::SETTING_VIDEOPLAYER_ERRORINASPECT);
+  float fAllowed    = CServiceBroker::GetSettings().GetInt(errorInAspect) * 0.01f;
   if(fCorrection >   fAllowed) fCorrection =   fAllowed;
   if(fCorrection < - fAllowed) fCorrection = - fAllowed;
 
@@ -84,6 +84,8 @@ public:
   virtual void ReleaseImage(int source, bool preserve = false) = 0;
   virtual void AddVideoPictureHW(VideoPicture &picture, int index) {};
   virtual bool IsPictureHW(VideoPicture &picture) { return false; };
+  // take a software decoded picture which has been decoded into a buffer of GetRenderInfo().directBufferPool
+  virtual bool AddDirectPicture(VideoPicture &picture, int index) { return false; };
   virtual void FlipPage(int source) = 0;
   virtual void PreInit() = 0;
   virtual void UnInit() = 0;
@@ -0,0 +1,95 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cores/VideoPlayer/DVDResource.h"
+
+class IDirectBufferPool;
+
+/*!
+ * Memory of the renderer a software decoder can decode a frame into, so the
+ * frame doesn't have to be copied into the buffers of the renderer.
+ *
+ * The decoder and every render buffer showing the frame hold a reference,
+ * the buffer goes back to its pool once all of them are released.
+ */
+class CDirectBuffer
+{
+public:
+  CDirectBuffer(IDirectBufferPool *pool, uint8_t *data, size_t size, unsigned int id)
+    : data(data), size(size), id(id), fence(nullptr), m_pool(pool), m_refs(0) {}
+
+  CDirectBuffer* Acquire()
+  {
+    ++m_refs;
+    return this;
+  }
+
+  void Release();
+
+  uint8_t *data;
+  size_t size;
+  unsigned int id;  //!< name of the object of the renderer holding the memory
+  void *fence;      //!< private to the renderer, signals the end of the last upload
+
+private:
+  IDirectBufferPool *m_pool;
+  std::atomic<int> m_refs;
+};
+
+/*!
+ * Buffers shared by a renderer with the software decoder. Decoders may call
+ * Get() from any thread, everything else is up to the renderer.
+ */
+class IDirectBufferPool : public IDVDResourceCounted<IDirectBufferPool>
+{
+public:
+  virtual ~IDirectBufferPool() = default;
+
+  /*!
+   * Get a free buffer of the given size with one reference held by the caller.
+   * \return nullptr if no buffer is available, the decoder has to use its own memory then
+   */
+  virtual CDirectBuffer* Get(size_t size) = 0;
+
+  /*!
+   * Check if a buffer belongs to the pool and can still be used by the renderer.
+   */
+  virtual bool Owns(const CDirectBuffer *buffer) = 0;
+
+protected:
+  friend class CDirectBuffer;
+
+  /*!
+   * Called once the last reference of a buffer is released, from any thread.
+   */
+  virtual void Return(CDirectBuffer *buffer) = 0;
+};
+
+inline void CDirectBuffer::Release()
+{
+  if (--m_refs == 0)
+    m_pool->Return(this);
+}
@@ -0,0 +1,311 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "system_gl.h"
+
+#include <algorithm>
+
+#include "DirectBufferPoolGL.h"
+#include "Application.h"
+#include "messaging/ApplicationMessenger.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "windowing/WindowingFactory.h"
+
+using namespace KODI::MESSAGING;
+
+// enough for the references of the decoder and the queue of the renderer
+#define DIRECTBUFFER_MAX_BUFFERS 20
+// don't let 4k frames eat up the memory of the graphics card
+#define DIRECTBUFFER_MAX_MEMORY  (384 * 1024 * 1024)
+
+namespace
+{
+
+// buffers which have been returned after their pool has been disposed
+CCriticalSection orphanSection;
+std::vector<CDirectBuffer*> orphans;
+
+}
+
+CDirectBufferPoolGL::CDirectBufferPoolGL()
+  : m_size(0),
+    m_maxBuffers(0),
+    m_requested(0),
+    m_failed(false),
+    m_disposed(false)
+{
+}
+
+CDirectBufferPoolGL::~CDirectBufferPoolGL()
+{
+  // buffers of a pool which hasn't been disposed can't be used by anyone anymore
+  if (!m_buffers.empty())
+  {
+    CSingleLock lock(orphanSection);
+    orphans.insert(orphans.end(), m_buffers.begin(), m_buffers.end());
+  }
+
+  // the last reference is usually dropped by the decoder, which has no GL context
+  if (g_application.IsCurrentThread())
+    DestroyOrphans();
+  else
+  {
+    static ThreadMessageCallback callback = { DestroyOrphansCallback, nullptr };
+    CApplicationMessenger::GetInstance().PostMsg(TMSG_CALLBACK, -1, -1, static_cast<void*>(&callback));
+  }
+}
+
+bool CDirectBufferPoolGL::IsSupported()
+{
+  return g_Windowing.IsExtSupported("GL_ARB_buffer_storage") &&
+         g_Windowing.IsExtSupported("GL_ARB_sync");
+}
+
+CDirectBuffer* CDirectBufferPoolGL::Get(size_t size)
+{
+  CSingleLock lock(m_section);
+  if (m_disposed || m_failed || size == 0)
+    return nullptr;
+
+  if (size != m_size)
+  {
+    // buffers of the previous size are dropped by Process()
+    m_size = size;
+    m_maxBuffers = std::max<size_t>(2, std::min<size_t>(DIRECTBUFFER_MAX_BUFFERS, DIRECTBUFFER_MAX_MEMORY / size));
+    m_requested = 0;
+  }
+
+  for (auto it = m_free.begin(); it != m_free.end(); ++it)
+  {
+    if ((*it)->size != m_size)
+      continue;
+
+    CDirectBuffer *buffer = *it;
+    m_free.erase(it);
+
+    // every buffer in use keeps the pool alive
+    Acquire();
+    return buffer->Acquire();
+  }
+
+  size_t count = std::count_if(m_buffers.begin(), m_buffers.end(),
+                               [this](const CDirectBuffer *buffer) { return buffer->size == m_size; });
+  if (count + m_requested < m_maxBuffers)
+    m_requested++;
+
+  return nullptr;
+}
+
+bool CDirectBufferPoolGL::Owns(const CDirectBuffer *buffer)
+{
+  CSingleLock lock(m_section);
+  return !m_disposed && buffer && std::find(m_buffers.begin(), m_buffers.end(), buffer) != m_buffers.end();
+}
+
+void CDirectBufferPoolGL::Return(CDirectBuffer *buffer)
+{
+  {
+    CSingleLock lock(m_section);
+    if (!m_disposed)
+      m_returned.push_back(buffer);
+    else
+    {
+      m_buffers.erase(std::remove(m_buffers.begin(), m_buffers.end(), buffer), m_buffers.end());
+
+      CSingleLock orphanLock(orphanSection);
+      orphans.push_back(buffer);
+    }
+  }
+
+  // may delete the pool
+  Release();
+}
+
+void CDirectBufferPoolGL::Process()
+{
+  DestroyOrphans();
+
+  std::vector<CDirectBuffer*> dropped;
+  unsigned int requested;
+  size_t size;
+  {
+    CSingleLock lock(m_section);
+    if (m_disposed)
+      return;
+
+    for (auto it = m_returned.begin(); it != m_returned.end(); )
+    {
+      CDirectBuffer *buffer = *it;
+      if (buffer->fence)
+      {
+        GLsync fence = static_cast<GLsync>(buffer->fence);
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+          ++it;
+          continue;
+        }
+        glDeleteSync(fence);
+        buffer->fence = nullptr;
+      }
+
+      if (buffer->size == m_size)
+        m_free.push_back(buffer);
+      else
+        dropped.push_back(buffer);
+      it = m_returned.erase(it);
+    }
+
+    for (auto it = m_free.begin(); it != m_free.end(); )
+    {
+      if ((*it)->size != m_size)
+      {
+        dropped.push_back(*it);
+        it = m_free.erase(it);
+      }
+      else
+        ++it;
+    }
+
+    for (auto buffer : dropped)
+      m_buffers.erase(std::remove(m_buffers.begin(), m_buffers.end(), buffer), m_buffers.end());
+
+    requested = m_requested;
+    size = m_size;
+    m_requested = 0;
+  }
+
+  for (auto buffer : dropped)
+    Destroy(buffer);
+
+  std::vector<CDirectBuffer*> created;
+  for (unsigned int i = 0; i < requested; i++)
+  {
+    CDirectBuffer *buffer = Create(this, size);
+    if (!buffer)
+      break;
+    created.push_back(buffer);
+  }
+
+  CSingleLock lock(m_section);
+  if (requested > 0 && created.empty())
+  {
+    CLog::Log(LOGWARNING, "CDirectBufferPoolGL::%s - failed to create buffers, frames are copied again", __FUNCTION__);
+    m_failed = true;
+  }
+  else if (!created.empty())
+  {
+    CLog::Log(LOGDEBUG, "CDirectBufferPoolGL::%s - created %zu buffers of %zu bytes", __FUNCTION__, created.size(), size);
+  }
+
+  for (auto buffer : created)
+  {
+    m_buffers.push_back(buffer);
+    m_free.push_back(buffer);
+  }
+}
+
+void CDirectBufferPoolGL::SetFence(CDirectBuffer *buffer)
+{
+  if (buffer->fence)
+    glDeleteSync(static_cast<GLsync>(buffer->fence));
+  buffer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void CDirectBufferPoolGL::Dispose()
+{
+  std::vector<CDirectBuffer*> unused;
+  {
+    CSingleLock lock(m_section);
+    if (m_disposed)
+      return;
+    m_disposed = true;
+
+    unused.assign(m_free.begin(), m_free.end());
+    unused.insert(unused.end(), m_returned.begin(), m_returned.end());
+    m_free.clear();
+    m_returned.clear();
+
+    for (auto buffer : unused)
+      m_buffers.erase(std::remove(m_buffers.begin(), m_buffers.end(), buffer), m_buffers.end());
+
+    if (!m_buffers.empty())
+      CLog::Log(LOGDEBUG, "CDirectBufferPoolGL::%s - %zu buffers are still used by the decoder", __FUNCTION__, m_buffers.size());
+  }
+
+  for (auto buffer : unused)
+    Destroy(buffer);
+
+  DestroyOrphans();
+}
+
+CDirectBuffer* CDirectBufferPoolGL::Create(IDirectBufferPool *pool, size_t size)
+{
+  // the decoder reads the reference frames back, so ask for cached memory
+  // instead of write combined memory which is very slow to read from
+  const GLbitfield access = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  GLuint pbo = 0;
+  glGenBuffers(1, &pbo);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+  glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, access | GL_CLIENT_STORAGE_BIT);
+  void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  if (!data)
+  {
+    glDeleteBuffers(1, &pbo);
+    return nullptr;
+  }
+
+  return new CDirectBuffer(pool, static_cast<uint8_t*>(data), size, pbo);
+}
+
+void CDirectBufferPoolGL::Destroy(CDirectBuffer *buffer)
+{
+  if (buffer->fence)
+    glDeleteSync(static_cast<GLsync>(buffer->fence));
+
+  GLuint pbo = buffer->id;
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glDeleteBuffers(1, &pbo);
+
+  delete buffer;
+}
+
+void CDirectBufferPoolGL::DestroyOrphans()
+{
+  std::vector<CDirectBuffer*> buffers;
+  {
+    CSingleLock lock(orphanSection);
+    buffers.swap(orphans);
+  }
+
+  for (auto buffer : buffers)
+    Destroy(buffer);
+}
+
+void CDirectBufferPoolGL::DestroyOrphansCallback(void *userptr)
+{
+  DestroyOrphans();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <vector>
+
+#include "DirectBufferPool.h"
+#include "threads/CriticalSection.h"
+
+/*!
+ * Pixel buffer objects which stay mapped for their whole lifetime
+ * (GL_ARB_buffer_storage), so the decoder can write frames into them from its
+ * own threads and the renderer uploads them to the textures without another
+ * copy.
+ *
+ * The pool starts empty. Every request of the decoder which can't be served
+ * asks for one more buffer, which the render thread creates in Process(). A
+ * buffer is handed out again once the GPU has finished the last upload from it.
+ */
+class CDirectBufferPoolGL : public IDirectBufferPool
+{
+public:
+  CDirectBufferPoolGL();
+  ~CDirectBufferPoolGL() override;
+
+  static bool IsSupported();
+
+  CDirectBuffer* Get(size_t size) override;
+  bool Owns(const CDirectBuffer *buffer) override;
+
+  /*!
+   * Create requested buffers and recycle the returned ones, render thread only.
+   */
+  void Process();
+
+  /*!
+   * Remember that the texture upload from a buffer has been queued, render thread only.
+   */
+  void SetFence(CDirectBuffer *buffer);
+
+  /*!
+   * Free the GL resources of the pool, render thread only. Buffers still in use
+   * are freed on the render thread once the pool is destroyed.
+   */
+  void Dispose();
+
+protected:
+  void Return(CDirectBuffer *buffer) override;
+
+private:
+  static CDirectBuffer* Create(IDirectBufferPool *pool, size_t size);
+  static void Destroy(CDirectBuffer *buffer);
+  static void DestroyOrphans();
+  static void DestroyOrphansCallback(void *userptr);
+
+  CCriticalSection m_section;
+  std::vector<CDirectBuffer*> m_buffers;  //!< all buffers of the pool
+  std::deque<CDirectBuffer*> m_free;      //!< ready for the decoder
+  std::vector<CDirectBuffer*> m_returned; //!< waiting for the GPU to finish the last upload
+  size_t m_size;
+  size_t m_maxBuffers;
+  unsigned int m_requested;
+  bool m_failed;
+  bool m_disposed;
+};
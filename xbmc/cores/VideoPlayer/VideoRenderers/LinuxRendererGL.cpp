@@ -26,6 +26,7 @@
 #include <locale.h>
 
 #include "LinuxRendererGL.h"
+#include "DirectBufferPoolGL.h"
 #include "Application.h"
 #include "ServiceBroker.h"
 #include "settings/AdvancedSettings.h"
@@ -110,6 +111,9 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
   memset(&pbo   , 0, sizeof(pbo));
   flipindex = 0;
   hwDec = NULL;
+  directBuffer = NULL;
+  memset(&directOffset, 0, sizeof(directOffset));
+  memset(&directStride, 0, sizeof(directStride));
 }
 
 CLinuxRendererGL::YUVBUFFER::~YUVBUFFER()
@@ -152,6 +156,7 @@ CLinuxRendererGL::CLinuxRendererGL()
   m_clearColour = 0.0f;
   m_pboSupported = false;
   m_pboUsed = false;
+  m_directBufferPool = NULL;
   m_nonLinStretch = false;
   m_nonLinStretchGui = false;
   m_pixelRatio = 0.0f;
@@ -199,6 +204,12 @@ CLinuxRendererGL::~CLinuxRendererGL()
     delete m_pVideoFilterShader;
     m_pVideoFilterShader = NULL;
   }
+
+  if (m_directBufferPool)
+  {
+    m_directBufferPool->Dispose();
+    SAFE_RELEASE(m_directBufferPool);
+  }
 }
 
 bool CLinuxRendererGL::ValidateRenderer()
@@ -360,7 +371,11 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
   if( readonly )
     im.flags |= IMAGE_FLAG_READING;
   else
+  {
     im.flags |= IMAGE_FLAG_WRITING;
+    // the image is about to be overwritten
+    ReleaseDirectBuffer(m_buffers[source]);
+  }
 
   // copy the image - should be operator of YV12Image
   for (int p=0;p<MAX_PLANES;p++)
@@ -392,6 +407,52 @@ void CLinuxRendererGL::ReleaseImage(int source, bool preserve)
   m_bImageReady = true;
 }
 
+bool CLinuxRendererGL::AddDirectPicture(VideoPicture &picture, int index)
+{
+  YUVBUFFER &buf = m_buffers[index];
+  YV12Image &im = buf.image;
+
+  ReleaseDirectBuffer(buf);
+
+  CDirectBuffer *buffer = picture.directBuffer;
+  if (!buffer || !m_directBufferPool || !m_directBufferPool->Owns(buffer))
+    return false;
+
+  if (picture.format != m_format ||
+      picture.iWidth != im.width || picture.iHeight != im.height)
+    return false;
+
+  for (int p = 0; p < 3; p++)
+  {
+    if (picture.data[p] < buffer->data || picture.data[p] >= buffer->data + buffer->size)
+      return false;
+  }
+
+  // planes are uploaded from the buffer object, so keep offsets instead of pointers
+  for (int p = 0; p < 3; p++)
+  {
+    buf.directOffset[p] = picture.data[p] - buffer->data;
+    buf.directStride[p] = picture.iLineSize[p];
+  }
+  buf.directBuffer = buffer->Acquire();
+
+  return true;
+}
+
+void CLinuxRendererGL::ReleaseBuffer(int idx)
+{
+  ReleaseDirectBuffer(m_buffers[idx]);
+}
+
+void CLinuxRendererGL::ReleaseDirectBuffer(YUVBUFFER& buff)
+{
+  if (buff.directBuffer)
+  {
+    buff.directBuffer->Release();
+    buff.directBuffer = NULL;
+  }
+}
+
 void CLinuxRendererGL::GetPlaneTextureSize(YUVPLANE& plane)
 {
   /* texture is assumed to be bound */
@@ -705,6 +766,9 @@ void CLinuxRendererGL::FlipPage(int source)
 
   m_buffers[m_iYV12RenderBuffer].flipindex = ++m_flipindex;
 
+  if (m_directBufferPool)
+    m_directBufferPool->Process();
+
   return;
 }
 
@@ -736,6 +800,12 @@ void CLinuxRendererGL::PreInit()
 
   // setup the background colour
   m_clearColour = g_Windowing.UseLimitedColor() ? (16.0f / 0xff) : 0.0f;
+
+  if (!m_directBufferPool && g_advancedSettings.m_videoDirectDecode && CDirectBufferPoolGL::IsSupported())
+  {
+    CLog::Log(LOGDEBUG, "CLinuxRendererGL::PreInit - decoding into persistently mapped pixel buffers");
+    m_directBufferPool = new CDirectBufferPoolGL();
+  }
 }
 
 void CLinuxRendererGL::UpdateVideoFilter()
@@ -1838,54 +1908,78 @@ bool CLinuxRendererGL::UploadYV12Texture(int source)
 
   glPixelStorei(GL_UNPACK_ALIGNMENT,1);
 
+  // a frame decoded into a direct buffer is uploaded straight from its buffer object
+  BYTE *plane[MAX_PLANES];
+  int stride[MAX_PLANES];
+  GLuint *pbo = NULL;
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    if (buf.directBuffer)
+    {
+      plane[p] = (BYTE*)NULL + buf.directOffset[p];
+      stride[p] = buf.directStride[p];
+    }
+    else
+    {
+      plane[p] = im->plane[p];
+      stride[p] = im->stride[p];
+    }
+  }
+  if (buf.directBuffer)
+    pbo = &buf.directBuffer->id;
+
   if (deinterlacing)
   {
     // Load Even Y Field
     LoadPlane( fields[FIELD_TOP][0] , GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] );
+             , stride[0]*2, im->bpp, plane[0], pbo );
 
     //load Odd Y Field
     LoadPlane( fields[FIELD_BOT][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] + im->stride[0]) ;
+             , stride[0]*2, im->bpp, plane[0] + stride[0], pbo ) ;
 
     // Load Even U & V Fields
     LoadPlane( fields[FIELD_TOP][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] );
+             , stride[1]*2, im->bpp, plane[1], pbo );
 
     LoadPlane( fields[FIELD_TOP][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] );
+             , stride[2]*2, im->bpp, plane[2], pbo );
 
     // Load Odd U & V Fields
     LoadPlane( fields[FIELD_BOT][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] + im->stride[1] );
+             , stride[1]*2, im->bpp, plane[1] + stride[1], pbo );
 
     LoadPlane( fields[FIELD_BOT][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] + im->stride[2] );
+             , stride[2]*2, im->bpp, plane[2] + stride[2], pbo );
   }
   else
   {
     //Load Y plane
     LoadPlane( fields[FIELD_FULL][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height
-             , im->stride[0], im->bpp, im->plane[0] );
+             , stride[0], im->bpp, plane[0], pbo );
 
     //load U plane
     LoadPlane( fields[FIELD_FULL][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[1], im->bpp, im->plane[1] );
+             , stride[1], im->bpp, plane[1], pbo );
 
     //load V plane
     LoadPlane( fields[FIELD_FULL][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[2], im->bpp, im->plane[2] );
+             , stride[2], im->bpp, plane[2], pbo );
   }
 
+  // the buffer must not be handed to the decoder before the upload has finished
+  if (buf.directBuffer)
+    m_directBufferPool->SetFence(buf.directBuffer);
+
   VerifyGLState();
 
   CalculateTextureSourceRects(source, 3);
@@ -1900,6 +1994,8 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
   YUVFIELDS &fields = m_buffers[index].fields;
   GLuint    *pbo    = m_buffers[index].pbo;
 
+  ReleaseDirectBuffer(m_buffers[index]);
+
   if( fields[FIELD_FULL][0].id == 0 ) return;
 
   /* finish up all textures, and delete them */
@@ -2567,6 +2663,7 @@ CRenderInfo CLinuxRendererGL::GetRenderInfo()
   info.formats = m_formats;
   info.max_buffer_size = NUM_BUFFERS;
   info.optimal_buffer_size = 4;
+  info.directBufferPool = m_directBufferPool;
   return info;
 }
 
@@ -38,6 +38,9 @@
 #include "threads/Event.h"
 #include "VideoShaders/ShaderFormats.h"
 
+class CDirectBuffer;
+class CDirectBufferPoolGL;
+
 class CRenderCapture;
 
 class CBaseTexture;
@@ -122,6 +125,8 @@ public:
   virtual bool IsConfigured() { return m_bConfigured; }
   virtual int GetImage(YV12Image *image, int source = AUTOSOURCE, bool readonly = false);
   virtual void ReleaseImage(int source, bool preserve = false);
+  virtual bool AddDirectPicture(VideoPicture &picture, int index);
+  virtual void ReleaseBuffer(int idx);
   virtual void FlipPage(int source);
   virtual void PreInit();
   virtual void UnInit();
@@ -239,6 +244,11 @@ protected:
     GLuint    pbo[MAX_PLANES];
 
     void *hwDec;
+
+    // frame decoded into memory of the direct buffer pool, replaces the image
+    CDirectBuffer *directBuffer;
+    size_t directOffset[MAX_PLANES];
+    int directStride[MAX_PLANES];
   };
 
   typedef YUVBUFFER          YUVBUFFERS[NUM_BUFFERS];
@@ -275,6 +285,9 @@ protected:
   bool m_pboSupported;
   bool m_pboUsed;
 
+  void ReleaseDirectBuffer(YUVBUFFER& buff);
+  CDirectBufferPoolGL *m_directBufferPool;
+
   bool  m_nonLinStretch;
   bool  m_nonLinStretchGui;
   float m_pixelRatio;
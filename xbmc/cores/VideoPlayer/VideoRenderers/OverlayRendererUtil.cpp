@@ -28,6 +28,10 @@
 #include "guilib/GraphicContext.h"
 #include "settings/Settings.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace OVERLAY {
 
 static uint32_t build_rgba(int a, int r, int g, int b, bool mergealpha)
@@ -190,109 +194,92 @@ bool convert_quad(ASS_Image* images, SQuads& quads)
   if (!images)
     return false;
 
-  // first calculate how many glyph we have and the total x length
+  // first collect the glyphs and the area they cover
 
+  std::vector<ASS_Image*> glyphs;
+  int area = 0;
+  int max_w = 0;
   for(img = images; img; img = img->next)
   {
     // fully transparent or width or height is 0 -> not displayed
     if((img->color & 0xff) == 0xff || img->w == 0 || img->h == 0)
       continue;
 
-    quads.size_x += img->w + 1;
-    quads.count++;
+    glyphs.push_back(img);
+    area += (img->w + 1) * (img->h + 1);
+    max_w = std::max(max_w, img->w + 1);
   }
 
+  quads.count = glyphs.size();
   if (quads.count == 0)
     return false;
 
+  // pack the glyphs into rows of a roughly square texture, tallest first so
+  // the glyphs of a row are of similar height and little of the texture
+  // which is uploaded is empty
+
+  quads.size_x = std::max(max_w, (int)std::sqrt((double)area));
   if (quads.size_x > (int)g_Windowing.GetMaxTextureSize())
     quads.size_x = g_Windowing.GetMaxTextureSize();
 
+  std::vector<int> order(glyphs.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&glyphs](int a, int b) { return glyphs[a]->h > glyphs[b]->h; });
+
+  quads.quad = (SQuad*)calloc(quads.count, sizeof(SQuad));
+
   int curr_x = 0;
   int curr_y = 0;
+  int row_h  = 0;
 
-  // calculate the y size of the texture
-
-  for(img = images; img; img = img->next)
+  for (int i : order)
   {
-    if((img->color & 0xff) == 0xff || img->w == 0 || img->h == 0)
-      continue;
+    img = glyphs[i];
 
     // check if we need to split to new line
-    if (curr_x + img->w >= quads.size_x)
+    if (curr_x > 0 && curr_x + img->w >= quads.size_x)
     {
-      quads.size_y += curr_y + 1;
-      curr_x = 0;
-      curr_y = 0;
+      curr_y += row_h + 1;
+      curr_x  = 0;
+      row_h   = 0;
     }
 
-    curr_x += img->w + 1;
+    // the quads keep the order of the images, later ones are drawn on top
+    SQuad* v = quads.quad + i;
+    v->u = curr_x;
+    v->v = curr_y;
+    v->w = std::min(img->w, quads.size_x - curr_x);
+    v->h = img->h;
 
-    if (img->h > curr_y)
-      curr_y = img->h;
+    curr_x += img->w + 1;
+    row_h   = std::max(row_h, img->h);
   }
 
-  quads.size_y += curr_y + 1;
-
-  // allocate space for the glyph positions and texturedata
-
-  quads.quad = (SQuad*)  calloc(quads.count, sizeof(SQuad));
+  quads.size_y = curr_y + row_h + 1;
   quads.data = (uint8_t*)calloc(quads.size_x * quads.size_y, 1);
 
-  SQuad*   v    = quads.quad;
-  uint8_t* data = quads.data;
-
-  int y = 0;
-
-  curr_x = 0;
-  curr_y = 0;
-
-  for(img = images; img; img = img->next)
+  for (int i = 0; i < quads.count; i++)
   {
-    if((img->color & 0xff) == 0xff || img->w == 0 || img->h == 0)
-      continue;
+    img = glyphs[i];
+    SQuad* v = quads.quad + i;
 
     unsigned int color = img->color;
     unsigned int alpha = (color & 0xff);
 
-    if (curr_x + img->w >= quads.size_x)
-    {
-      curr_y += y + 1;
-      curr_x  = 0;
-      y       = 0;
-      data    = quads.data + curr_y * quads.size_x;
-    }
-
-    unsigned int r = ((color >> 24) & 0xff);
-    unsigned int g = ((color >> 16) & 0xff);
-    unsigned int b = ((color >> 8 ) & 0xff);
-
     v->a = 255 - alpha;
-    v->r = r;
-    v->g = g;
-    v->b = b;
-
-    v->u = curr_x;
-    v->v = curr_y;
+    v->r = ((color >> 24) & 0xff);
+    v->g = ((color >> 16) & 0xff);
+    v->b = ((color >> 8 ) & 0xff);
 
     v->x = img->dst_x;
     v->y = img->dst_y;
 
-    v->w = img->w;
-    v->h = img->h;
-
-    v++;
-
-    for(int i=0; i<img->h; i++)
-      memcpy(data        + quads.size_x * i
-           , img->bitmap + img->stride  * i
-           , img->w);
-
-    if (img->h > y)
-      y = img->h;
-
-    curr_x += img->w + 1;
-    data   += img->w + 1;
+    uint8_t* data = quads.data + v->v * quads.size_x + v->u;
+    for(int y = 0; y < img->h; y++)
+      memcpy(data        + quads.size_x * y
+           , img->bitmap + img->stride  * y
+           , v->w);
   }
   return true;
 }
@@ -24,6 +24,8 @@
 #include <vector>
 #include "cores/IPlayer.h"
 
+class IDirectBufferPool;
+
 enum ERenderFormat {
   RENDER_FMT_NONE = 0,
   RENDER_FMT_YUV420P,
@@ -55,6 +57,7 @@ struct CRenderInfo
     optimal_buffer_size = 0;
     max_buffer_size = 0;
     opaque_pointer = nullptr;
+    directBufferPool = nullptr;
     m_deintMethods.clear();
     formats.clear();
   }
@@ -65,5 +68,7 @@ struct CRenderInfo
   std::vector<EINTERLACEMETHOD> m_deintMethods;
   // Can be used for initialising video codec with information from renderer (e.g. a shared image pool)
   void *opaque_pointer;
+  // Memory of the renderer software decoders can decode into directly
+  IDirectBufferPool *directBufferPool;
 };
 
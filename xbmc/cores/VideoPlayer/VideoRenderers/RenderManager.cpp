@@ -27,6 +27,7 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "windowing/WindowingFactory.h"
 
 #include "Application.h"
@@ -1150,7 +1151,29 @@ int CRenderManager::AddVideoPicture(VideoPicture& pic)
        || pic.format == RENDER_FMT_YUV420P10
        || pic.format == RENDER_FMT_YUV420P16)
   {
-    CDVDCodecUtils::CopyPicture(&image, &pic);
+    int64_t start = CurrentHostCounter();
+    if (m_pRenderer->AddDirectPicture(pic, index))
+    {
+      m_uploadStats.directTime += CurrentHostCounter() - start;
+      m_uploadStats.directFrames++;
+    }
+    else
+    {
+      CDVDCodecUtils::CopyPicture(&image, &pic);
+      m_uploadStats.copyTime += CurrentHostCounter() - start;
+      m_uploadStats.copyFrames++;
+    }
+
+    if (m_uploadStats.copyFrames + m_uploadStats.directFrames >= 1000)
+    {
+      double freq = CurrentHostFrequency() / 1000.0;
+      CLog::Log(LOGDEBUG, "CRenderManager::AddVideoPicture - copied %u frames in %.3f ms avg, %u decoded into renderer memory in %.3f ms avg",
+                m_uploadStats.copyFrames,
+                m_uploadStats.copyFrames ? m_uploadStats.copyTime / freq / m_uploadStats.copyFrames : 0.0,
+                m_uploadStats.directFrames,
+                m_uploadStats.directFrames ? m_uploadStats.directTime / freq / m_uploadStats.directFrames : 0.0);
+      m_uploadStats = SUploadStats();
+    }
   }
   else if(pic.format == RENDER_FMT_NV12)
   {
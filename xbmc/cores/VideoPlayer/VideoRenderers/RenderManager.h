@@ -235,6 +235,15 @@ protected:
   unsigned int m_orientation;
   int m_NumberBuffers;
 
+  // time spent handing software decoded pictures to the renderer
+  struct SUploadStats
+  {
+    int64_t copyTime = 0;
+    int64_t directTime = 0;
+    unsigned int copyFrames = 0;
+    unsigned int directFrames = 0;
+  } m_uploadStats;
+
   int m_lateframes;
   double m_presentpts;
   EPRESENTSTEP m_presentstep;
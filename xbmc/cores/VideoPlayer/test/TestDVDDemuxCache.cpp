@@ -0,0 +1,300 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxCache.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+#include <vector>
+
+#define CACHE_PATH "special://temp/TestDVDDemuxCache/"
+
+class TestDVDDemuxCacheHelper
+{
+public:
+  static bool Serialize(const CDVDDemuxCache &cache, std::string &data)
+  {
+    return cache.Serialize(data);
+  }
+
+  static bool Deserialize(CDVDDemuxCache &cache, const std::string &data)
+  {
+    return cache.Deserialize(data);
+  }
+};
+
+class TestDVDDemuxCache : public testing::Test
+{
+protected:
+  TestDVDDemuxCache()
+    : url(XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt"))
+  {
+    format = AVInputFormat();
+    format.name = "test";
+
+    XFILE::CFile file;
+    if (file.Open(url))
+      size = file.GetLength();
+  }
+
+  ~TestDVDDemuxCache()
+  {
+    for (auto context : contexts)
+      avformat_free_context(context);
+  }
+
+  void SetUp() override
+  {
+    CDVDDemuxCache::SetDirectory(CACHE_PATH);
+  }
+
+  void TearDown() override
+  {
+    CDVDDemuxCache::SetDirectory("");
+    if (XFILE::CDirectory::Exists(CACHE_PATH))
+      XFILE::CDirectory::RemoveRecursive(CACHE_PATH);
+  }
+
+  // a file with an h264 video and an aac audio stream, as avformat_find_stream_info() leaves it
+  AVFormatContext* CreateProbedContext()
+  {
+    AVFormatContext *context = CreateContext(2);
+    context->duration = 60 * AV_TIME_BASE;
+    context->bit_rate = 4000000;
+
+    AVStream *video = context->streams[0];
+    video->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    video->codecpar->codec_id = AV_CODEC_ID_H264;
+    video->codecpar->width = 1920;
+    video->codecpar->height = 1080;
+    video->codecpar->profile = 100;
+    video->avg_frame_rate = av_make_q(24000, 1001);
+    video->codecpar->extradata = static_cast<uint8_t*>(av_mallocz(3 + AV_INPUT_BUFFER_PADDING_SIZE));
+    memcpy(video->codecpar->extradata, "avc", 3);
+    video->codecpar->extradata_size = 3;
+    for (int i = 0; i < 10; i++)
+      av_add_index_entry(video, i * 100000, i * 48000, 1000, 0, AVINDEX_KEYFRAME);
+
+    AVStream *audio = context->streams[1];
+    audio->codecpar->codec_type = AVMEDIA_TYPE_AUDIO;
+    audio->codecpar->codec_id = AV_CODEC_ID_AAC;
+    audio->codecpar->channels = 2;
+    audio->codecpar->sample_rate = 48000;
+
+    return context;
+  }
+
+  // the same file as it's found in the header, before probing
+  AVFormatContext* CreateContext(unsigned int streams)
+  {
+    AVFormatContext *context = avformat_alloc_context();
+    context->iformat = &format;
+    for (unsigned int i = 0; i < streams; i++)
+      avformat_new_stream(context, nullptr);
+    contexts.push_back(context);
+    return context;
+  }
+
+  CURL url;
+  int64_t size = 0;
+  AVInputFormat format;
+  std::vector<AVFormatContext*> contexts;
+};
+
+TEST_F(TestDVDDemuxCache, RoundTrip)
+{
+  CDVDDemuxCache cache(url, size);
+  ASSERT_TRUE(cache.IsValid());
+
+  AVFormatContext *probed = CreateProbedContext();
+  cache.SetStreamInfo(probed);
+  cache.UpdateIndex(probed);
+
+  std::string data;
+  ASSERT_TRUE(TestDVDDemuxCacheHelper::Serialize(cache, data));
+
+  CDVDDemuxCache loaded(url, size);
+  ASSERT_TRUE(TestDVDDemuxCacheHelper::Deserialize(loaded, data));
+  EXPECT_TRUE(loaded.HasStreamInfo());
+
+  AVFormatContext *context = CreateContext(2);
+  ASSERT_TRUE(loaded.ApplyStreamInfo(context));
+  EXPECT_EQ(60 * AV_TIME_BASE, context->duration);
+  EXPECT_EQ(4000000, context->bit_rate);
+
+  const AVStream *video = context->streams[0];
+  EXPECT_EQ(AVMEDIA_TYPE_VIDEO, video->codecpar->codec_type);
+  EXPECT_EQ(AV_CODEC_ID_H264, video->codecpar->codec_id);
+  EXPECT_EQ(1920, video->codecpar->width);
+  EXPECT_EQ(1080, video->codecpar->height);
+  EXPECT_EQ(100, video->codecpar->profile);
+  EXPECT_EQ(24000, video->avg_frame_rate.num);
+  EXPECT_EQ(1001, video->avg_frame_rate.den);
+  ASSERT_EQ(3, video->codecpar->extradata_size);
+  EXPECT_EQ(0, memcmp(video->codecpar->extradata, "avc", 3));
+
+  const AVStream *audio = context->streams[1];
+  EXPECT_EQ(AVMEDIA_TYPE_AUDIO, audio->codecpar->codec_type);
+  EXPECT_EQ(AV_CODEC_ID_AAC, audio->codecpar->codec_id);
+  EXPECT_EQ(2, audio->codecpar->channels);
+  EXPECT_EQ(48000, audio->codecpar->sample_rate);
+
+  EXPECT_EQ(10, loaded.ApplyIndex(context));
+  EXPECT_EQ(10, context->streams[0]->nb_index_entries);
+  EXPECT_EQ(0, context->streams[1]->nb_index_entries);
+  // known entries aren't added twice
+  EXPECT_EQ(0, loaded.ApplyIndex(context));
+}
+
+TEST_F(TestDVDDemuxCache, SaveAndLoad)
+{
+  CDVDDemuxCache cache(url, size);
+  AVFormatContext *probed = CreateProbedContext();
+  cache.SetStreamInfo(probed);
+  cache.UpdateIndex(probed);
+  cache.Save();
+
+  CFileItemList files;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(CACHE_PATH, files));
+  EXPECT_EQ(1, files.Size());
+
+  CDVDDemuxCache loaded(url, size);
+  ASSERT_TRUE(loaded.Load());
+  EXPECT_TRUE(loaded.HasStreamInfo());
+
+  AVFormatContext *context = CreateContext(2);
+  ASSERT_TRUE(loaded.ApplyStreamInfo(context));
+  EXPECT_EQ(10, loaded.ApplyIndex(context));
+
+  // the file has changed in the meantime
+  CDVDDemuxCache resized(url, size + 1);
+  EXPECT_FALSE(resized.Load());
+}
+
+TEST_F(TestDVDDemuxCache, IndexOnly)
+{
+  CDVDDemuxCache cache(url, size);
+  cache.UpdateIndex(CreateProbedContext());
+
+  std::string data;
+  ASSERT_TRUE(TestDVDDemuxCacheHelper::Serialize(cache, data));
+
+  CDVDDemuxCache loaded(url, size);
+  ASSERT_TRUE(TestDVDDemuxCacheHelper::Deserialize(loaded, data));
+  EXPECT_FALSE(loaded.HasStreamInfo());
+  EXPECT_FALSE(loaded.ApplyStreamInfo(CreateContext(2)));
+}
+
+TEST_F(TestDVDDemuxCache, InvalidData)
+{
+  CDVDDemuxCache cache(url, size);
+  AVFormatContext *probed = CreateProbedContext();
+  cache.SetStreamInfo(probed);
+  cache.UpdateIndex(probed);
+
+  std::string data;
+  ASSERT_TRUE(TestDVDDemuxCacheHelper::Serialize(cache, data));
+
+  CDVDDemuxCache empty(url, size);
+  EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(empty, ""));
+
+  for (size_t length = 1; length < data.size(); length += 7)
+  {
+    CDVDDemuxCache truncated(url, size);
+    EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(truncated, data.substr(0, length))) << length;
+  }
+
+  CDVDDemuxCache trailing(url, size);
+  EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(trailing, data + "x"));
+
+  std::string magic(data);
+  magic[0] = 'X';
+  CDVDDemuxCache badMagic(url, size);
+  EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(badMagic, magic));
+
+  std::string version(data);
+  version[4]++;
+  CDVDDemuxCache badVersion(url, size);
+  EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(badVersion, version));
+}
+
+TEST_F(TestDVDDemuxCache, OtherFile)
+{
+  CDVDDemuxCache cache(url, size);
+  cache.SetStreamInfo(CreateProbedContext());
+
+  std::string data;
+  ASSERT_TRUE(TestDVDDemuxCacheHelper::Serialize(cache, data));
+
+  // the file has changed in the meantime
+  CDVDDemuxCache resized(url, size + 1);
+  EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(resized, data));
+
+  // another file with the same hash
+  CURL other(XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt.zip"));
+  CDVDDemuxCache otherCache(other, size);
+  ASSERT_TRUE(otherCache.IsValid());
+  EXPECT_FALSE(TestDVDDemuxCacheHelper::Deserialize(otherCache, data));
+}
+
+TEST_F(TestDVDDemuxCache, MismatchingStreams)
+{
+  CDVDDemuxCache cache(url, size);
+  cache.SetStreamInfo(CreateProbedContext());
+
+  AVInputFormat otherFormat = AVInputFormat();
+  otherFormat.name = "other";
+  AVFormatContext *context = CreateContext(2);
+  context->iformat = &otherFormat;
+  EXPECT_FALSE(cache.ApplyStreamInfo(context));
+  context->iformat = &format;
+
+  EXPECT_FALSE(cache.ApplyStreamInfo(CreateContext(1)));
+  EXPECT_FALSE(cache.ApplyStreamInfo(CreateContext(3)));
+
+  // the header says it's a different codec
+  context = CreateContext(2);
+  context->streams[0]->codecpar->codec_id = AV_CODEC_ID_HEVC;
+  EXPECT_FALSE(cache.ApplyStreamInfo(context));
+
+  // streams found later on can't be described
+  context = CreateContext(2);
+  context->ctx_flags |= AVFMTCTX_NOHEADER;
+  EXPECT_FALSE(cache.ApplyStreamInfo(context));
+
+  context = CreateContext(2);
+  EXPECT_TRUE(cache.ApplyStreamInfo(context));
+}
+
+TEST_F(TestDVDDemuxCache, NoFile)
+{
+  CDVDDemuxCache missing(CURL(XBMC_REF_FILE_PATH("/xbmc/filesystem/test/missing.txt")), size);
+  EXPECT_FALSE(missing.IsValid());
+  EXPECT_FALSE(missing.Load());
+
+  CDVDDemuxCache unknownSize(url, 0);
+  EXPECT_FALSE(unknownSize.IsValid());
+}
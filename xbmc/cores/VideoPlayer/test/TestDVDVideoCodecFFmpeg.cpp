@@ -0,0 +1,88 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDCodecs/DVDCodecs.h"
+#include "cores/VideoPlayer/DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
+#include "cores/VideoPlayer/DVDStreamInfo.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+CDVDStreamInfo CreateHints(int width, int height, int fpsrate, int fpsscale)
+{
+  CDVDStreamInfo hints;
+  hints.width = width;
+  hints.height = height;
+  hints.fpsrate = fpsrate;
+  hints.fpsscale = fpsscale;
+  return hints;
+}
+
+}
+
+TEST(TestDVDVideoCodecFFmpeg, ThreadCountScalesWithStream)
+{
+  CDVDCodecOptions options;
+
+  // one and a half threads per cpu without anything known about the stream
+  EXPECT_EQ(12, CDVDVideoCodecFFmpeg::GetThreadCount(CDVDStreamInfo(), options, 8));
+
+  EXPECT_EQ(2, CDVDVideoCodecFFmpeg::GetThreadCount(CreateHints(720, 576, 25, 1), options, 8));
+  EXPECT_EQ(5, CDVDVideoCodecFFmpeg::GetThreadCount(CreateHints(1920, 1080, 30, 1), options, 8));
+  // low frame rates count as 24 fps
+  EXPECT_EQ(4, CDVDVideoCodecFFmpeg::GetThreadCount(CreateHints(1920, 1080, 10, 1), options, 8));
+  // an unknown frame rate counts as 25 fps
+  EXPECT_EQ(4, CDVDVideoCodecFFmpeg::GetThreadCount(CreateHints(1920, 1080, 0, 0), options, 8));
+}
+
+TEST(TestDVDVideoCodecFFmpeg, ThreadCountIsClamped)
+{
+  CDVDCodecOptions options;
+  const CDVDStreamInfo uhd(CreateHints(3840, 2160, 60, 1));
+
+  EXPECT_EQ(12, CDVDVideoCodecFFmpeg::GetThreadCount(uhd, options, 8));
+  EXPECT_EQ(16, CDVDVideoCodecFFmpeg::GetThreadCount(uhd, options, 32));
+  EXPECT_EQ(1, CDVDVideoCodecFFmpeg::GetThreadCount(uhd, options, 1));
+  EXPECT_EQ(1, CDVDVideoCodecFFmpeg::GetThreadCount(CDVDStreamInfo(), options, 0));
+
+  // at least two threads when the cpus allow it
+  EXPECT_EQ(2, CDVDVideoCodecFFmpeg::GetThreadCount(CreateHints(320, 240, 25, 1), options, 2));
+  EXPECT_EQ(1, CDVDVideoCodecFFmpeg::GetThreadCount(CreateHints(320, 240, 25, 1), options, 1));
+}
+
+TEST(TestDVDVideoCodecFFmpeg, ThreadCountOverride)
+{
+  const CDVDStreamInfo hd(CreateHints(1920, 1080, 30, 1));
+
+  CDVDCodecOptions options;
+  options.m_keys.push_back(CDVDCodecOption("thread_type", "slice"));
+  options.m_keys.push_back(CDVDCodecOption("threads", "3"));
+  EXPECT_EQ(3, CDVDVideoCodecFFmpeg::GetThreadCount(hd, options, 8));
+
+  // beyond the limits of the automatic choice
+  options.m_keys.back().m_value = "24";
+  EXPECT_EQ(24, CDVDVideoCodecFFmpeg::GetThreadCount(hd, options, 8));
+
+  // zero leaves the choice to the decoder
+  options.m_keys.back().m_value = "0";
+  EXPECT_EQ(5, CDVDVideoCodecFFmpeg::GetThreadCount(hd, options, 8));
+}
@@ -0,0 +1,187 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoPlayerBenchmark.h"
+#include "cores/VideoPlayer/VideoRenderers/DirectBufferPool.h"
+#include "filesystem/Directory.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+#define TEMP_PATH "special://temp/TestDirectBufferPool/"
+
+namespace
+{
+
+// a pool in main memory which hands out a limited number of buffers, like
+// the pool of the GL renderer without the GL objects
+class CMemoryBufferPool : public IDirectBufferPool
+{
+public:
+  explicit CMemoryBufferPool(unsigned int maxBuffers) : m_maxBuffers(maxBuffers) {}
+
+  ~CMemoryBufferPool() override
+  {
+    for (auto buffer : m_buffers)
+    {
+      delete[] buffer->data;
+      delete buffer;
+    }
+  }
+
+  CDirectBuffer* Get(size_t size) override
+  {
+    CSingleLock lock(m_section);
+    m_requests++;
+
+    CDirectBuffer *buffer = nullptr;
+    auto it = std::find_if(m_free.begin(), m_free.end(),
+                           [size](const CDirectBuffer *buffer) { return buffer->size == size; });
+    if (it != m_free.end())
+    {
+      buffer = *it;
+      m_free.erase(it);
+    }
+    else if (m_buffers.size() < m_maxBuffers)
+    {
+      buffer = new CDirectBuffer(this, new uint8_t[size], size, static_cast<unsigned int>(m_buffers.size()));
+      m_buffers.push_back(buffer);
+    }
+    else
+      return nullptr;
+
+    m_used++;
+    Acquire();
+    return buffer->Acquire();
+  }
+
+  bool Owns(const CDirectBuffer *buffer) override
+  {
+    CSingleLock lock(m_section);
+    return std::find(m_buffers.begin(), m_buffers.end(), buffer) != m_buffers.end();
+  }
+
+  unsigned int Requests() const { CSingleLock lock(m_section); return m_requests; }
+  unsigned int Used() const { CSingleLock lock(m_section); return m_used; }
+
+protected:
+  void Return(CDirectBuffer *buffer) override
+  {
+    {
+      CSingleLock lock(m_section);
+      m_free.push_back(buffer);
+      m_used--;
+    }
+    Release();
+  }
+
+private:
+  mutable CCriticalSection m_section;
+  std::vector<CDirectBuffer*> m_buffers;
+  std::vector<CDirectBuffer*> m_free;
+  unsigned int m_maxBuffers;
+  unsigned int m_requests = 0;
+  unsigned int m_used = 0;
+};
+
+}
+
+class TestDirectBufferPool : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ASSERT_TRUE(XFILE::CDirectory::Create(TEMP_PATH));
+    path = CSpecialProtocol::TranslatePath(TEMP_PATH "direct.asf");
+  }
+
+  void TearDown() override
+  {
+    if (XFILE::CDirectory::Exists(TEMP_PATH))
+      XFILE::CDirectory::RemoveRecursive(TEMP_PATH);
+  }
+
+  std::string path;
+};
+
+TEST_F(TestDirectBufferPool, ReturnsBufferAfterLastReference)
+{
+  CMemoryBufferPool *pool = new CMemoryBufferPool(1);
+  CDirectBuffer *buffer = pool->Get(64);
+  ASSERT_NE(nullptr, buffer);
+  EXPECT_TRUE(pool->Owns(buffer));
+  EXPECT_EQ(nullptr, pool->Get(64));
+
+  // the renderer takes a reference of its own
+  buffer->Acquire();
+  buffer->Release();
+  EXPECT_EQ(1U, pool->Used());
+
+  buffer->Release();
+  EXPECT_EQ(0U, pool->Used());
+  EXPECT_EQ(buffer, pool->Get(64));
+
+  buffer->Release();
+  pool->Release();
+}
+
+TEST_F(TestDirectBufferPool, DecodesIntoPoolBuffers)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 1, 320, 240));
+
+  CMemoryBufferPool *pool = new CMemoryBufferPool(20);
+  CVideoPlayerBenchmark::SOptions options;
+  options.audio = false;
+  options.directBufferPool = pool;
+  CVideoPlayerBenchmark::SResult result;
+  ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options, result));
+
+  EXPECT_EQ(25U, result.videoFrames + result.droppedFrames);
+  EXPECT_GT(result.directFrames, 0U);
+  EXPECT_EQ(result.videoFrames, result.directFrames);
+  EXPECT_EQ(0U, result.renderBuffers);
+  // the decoder has released every frame
+  EXPECT_EQ(0U, pool->Used());
+  pool->Release();
+}
+
+TEST_F(TestDirectBufferPool, FallsBackWithoutBuffers)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 1, 320, 240));
+
+  CMemoryBufferPool *pool = new CMemoryBufferPool(0);
+  CVideoPlayerBenchmark::SOptions options;
+  options.audio = false;
+  options.directBufferPool = pool;
+  CVideoPlayerBenchmark::SResult result;
+  ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options, result));
+
+  // every frame has been decoded into memory of the decoder and copied
+  EXPECT_GT(pool->Requests(), 0U);
+  EXPECT_EQ(25U, result.videoFrames + result.droppedFrames);
+  EXPECT_EQ(0U, result.directFrames);
+  EXPECT_EQ(1U, result.renderBuffers);
+  pool->Release();
+}
@@ -0,0 +1,168 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoPlayerBenchmark.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxCache.h"
+#include "filesystem/Directory.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#define TEMP_PATH "special://temp/TestVideoPlayerBenchmark/"
+
+class TestVideoPlayerBenchmark : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ASSERT_TRUE(XFILE::CDirectory::Create(TEMP_PATH));
+    path = CSpecialProtocol::TranslatePath(TEMP_PATH "benchmark.asf");
+    // the entries the demuxer stores for the test file
+    CDVDDemuxCache::SetDirectory(TEMP_PATH "demuxcache/");
+  }
+
+  void TearDown() override
+  {
+    CDVDDemuxCache::SetDirectory("");
+    if (XFILE::CDirectory::Exists(TEMP_PATH))
+      XFILE::CDirectory::RemoveRecursive(TEMP_PATH);
+  }
+
+  std::string path;
+};
+
+TEST_F(TestVideoPlayerBenchmark, DecodeTestFile)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 2, 320, 240));
+
+  CVideoPlayerBenchmark::SOptions options;
+  CVideoPlayerBenchmark::SResult result;
+  ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options, result));
+
+  EXPECT_EQ(50U, result.videoPackets);
+  EXPECT_EQ(50U, result.videoFrames + result.droppedFrames);
+  EXPECT_GT(result.audioPackets, 0U);
+  EXPECT_GT(result.audioSamples, 0U);
+  EXPECT_GT(result.packetBytes, 0U);
+  EXPECT_LE(result.renderBuffers, 1U);
+  EXPECT_GE(result.maxVideoQueue, 1U);
+  EXPECT_GT(result.total, 0.0);
+}
+
+TEST_F(TestVideoPlayerBenchmark, VideoOnly)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 1, 320, 240));
+
+  CVideoPlayerBenchmark::SOptions options;
+  options.audio = false;
+  options.render = false;
+  CVideoPlayerBenchmark::SResult result;
+  ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options, result));
+
+  EXPECT_EQ(25U, result.videoFrames + result.droppedFrames);
+  EXPECT_EQ(0U, result.audioPackets);
+  EXPECT_EQ(0U, result.audioSamples);
+  EXPECT_EQ(0.0, result.render);
+}
+
+TEST_F(TestVideoPlayerBenchmark, DecodeOnlyWithThreading)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 1, 640, 480));
+
+  std::vector<CVideoPlayerBenchmark::SOptions> options(2);
+  options[0].audio = false;
+  options[0].render = false;
+  options[1] = options[0];
+  options[1].threads = 2;
+  options[1].threadType = "slice";
+
+  std::vector<CVideoPlayerBenchmark::SResult> results(options.size());
+  for (size_t i = 0; i < options.size(); i++)
+  {
+    ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options[i], results[i]));
+    EXPECT_EQ(25U, results[i].videoFrames + results[i].droppedFrames);
+    EXPECT_GT(results[i].firstPicture, 0.0);
+    EXPECT_EQ(0.0, results[i].render);
+  }
+
+  // a header and one line per configuration
+  std::string report = CVideoPlayerBenchmark::ReportThreading(options, results);
+  std::vector<std::string> lines = StringUtils::Split(StringUtils::TrimRight(report), "\n");
+  ASSERT_EQ(3U, lines.size());
+  EXPECT_TRUE(StringUtils::StartsWith(lines[1], "default"));
+  EXPECT_TRUE(StringUtils::StartsWith(lines[2], "2"));
+  EXPECT_NE(std::string::npos, lines[2].find("slice"));
+}
+
+TEST_F(TestVideoPlayerBenchmark, DISABLED_Threading)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 20, 1280, 720));
+
+  CVideoPlayerBenchmark::SOptions decodeOnly;
+  decodeOnly.audio = false;
+  decodeOnly.render = false;
+
+  std::vector<CVideoPlayerBenchmark::SOptions> options;
+  options.push_back(decodeOnly);
+  for (int threads : { 2, 4, 8 })
+  {
+    for (const char *threadType : { "slice", "frame" })
+    {
+      CVideoPlayerBenchmark::SOptions configuration = decodeOnly;
+      configuration.threads = threads;
+      configuration.threadType = threadType;
+      options.push_back(configuration);
+    }
+  }
+
+  std::vector<CVideoPlayerBenchmark::SResult> results(options.size());
+  for (size_t i = 0; i < options.size(); i++)
+    ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options[i], results[i]));
+
+  CLog::Log(LOGDEBUG, "TestVideoPlayerBenchmark - decoding threads:\n%s",
+            CVideoPlayerBenchmark::ReportThreading(options, results).c_str());
+}
+
+TEST_F(TestVideoPlayerBenchmark, ReopenUsesDemuxCache)
+{
+  ASSERT_TRUE(CVideoPlayerBenchmark::CreateTestFile(path, 1, 320, 240));
+
+  CVideoPlayerBenchmark::SOptions options;
+  CVideoPlayerBenchmark::SResult first;
+  ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options, first));
+  EXPECT_GT(first.firstPacket, 0.0);
+
+  CVideoPlayerBenchmark::SResult second;
+  ASSERT_TRUE(CVideoPlayerBenchmark::Run(path, options, second));
+  EXPECT_TRUE(second.cachedStreamInfo);
+  EXPECT_GT(second.firstPacket, 0.0);
+  EXPECT_EQ(first.videoFrames + first.droppedFrames, second.videoFrames + second.droppedFrames);
+}
+
+TEST_F(TestVideoPlayerBenchmark, MissingFile)
+{
+  CVideoPlayerBenchmark::SOptions options;
+  CVideoPlayerBenchmark::SResult result;
+  EXPECT_FALSE(CVideoPlayerBenchmark::Run(path, options, result));
+}
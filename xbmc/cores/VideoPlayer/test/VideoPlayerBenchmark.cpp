@@ -0,0 +1,666 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoPlayerBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <inttypes.h>
+#include <memory>
+#include <string.h>
+#include <vector>
+
+#include "cores/VideoPlayer/DVDStreamInfo.h"
+#include "cores/VideoPlayer/DVDCodecs/DVDCodecs.h"
+#include "cores/VideoPlayer/DVDCodecs/DVDCodecUtils.h"
+#include "cores/VideoPlayer/DVDCodecs/DVDFactoryCodec.h"
+#include "cores/VideoPlayer/DVDCodecs/Audio/DVDAudioCodec.h"
+#include "cores/VideoPlayer/DVDCodecs/Video/DVDVideoCodec.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemux.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDFactoryDemuxer.h"
+#include "cores/VideoPlayer/DVDInputStreams/DVDFactoryInputStream.h"
+#include "cores/VideoPlayer/DVDInputStreams/DVDInputStream.h"
+#include "cores/VideoPlayer/Process/ProcessInfo.h"
+#include "cores/VideoPlayer/VideoRenderers/BaseRenderer.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/mathematics.h"
+}
+
+// decode calls in a row which neither took a packet nor returned anything
+#define BENCHMARK_MAX_STALLS 1000
+
+#define TESTFILE_FPS         25
+#define TESTFILE_SAMPLERATE  48000
+#define TESTFILE_TONE        440.0
+
+namespace
+{
+
+class CStageTimer
+{
+public:
+  explicit CStageTimer(double &seconds) : m_seconds(seconds), m_start(CurrentHostCounter()) {}
+  ~CStageTimer() { m_seconds += static_cast<double>(CurrentHostCounter() - m_start) / CurrentHostFrequency(); }
+
+private:
+  double &m_seconds;
+  int64_t m_start;
+};
+
+// the part of a renderer which touches the pictures: copy them into buffers
+// of its own, like the renderers do for software decoded pictures
+class CNullRenderer
+{
+public:
+  CNullRenderer() { memset(&m_image, 0, sizeof(m_image)); }
+
+  void Render(VideoPicture &picture, CVideoPlayerBenchmark::SResult &result)
+  {
+    // the renderer uploads these from the buffer they have been decoded into
+    if (picture.directBuffer)
+    {
+      result.directFrames++;
+      return;
+    }
+
+    unsigned int bpp;
+    if (picture.format == RENDER_FMT_YUV420P)
+      bpp = 1;
+    else if (picture.format == RENDER_FMT_YUV420P10 || picture.format == RENDER_FMT_YUV420P16)
+      bpp = 2;
+    else
+      return;
+
+    if (picture.iWidth != m_image.width || picture.iHeight != m_image.height || bpp != m_image.bpp)
+    {
+      m_image.width = picture.iWidth;
+      m_image.height = picture.iHeight;
+      m_image.bpp = bpp;
+      m_image.cshift_x = 1;
+      m_image.cshift_y = 1;
+      m_image.stride[0] = m_image.width * bpp;
+      m_image.stride[1] = m_image.stride[2] = ((m_image.width + 1) >> 1) * bpp;
+      m_image.planesize[0] = m_image.stride[0] * m_image.height;
+      m_image.planesize[1] = m_image.planesize[2] = m_image.stride[1] * ((m_image.height + 1) >> 1);
+
+      m_buffer.assign(m_image.planesize[0] + m_image.planesize[1] + m_image.planesize[2], 0);
+      m_image.plane[0] = m_buffer.data();
+      m_image.plane[1] = m_image.plane[0] + m_image.planesize[0];
+      m_image.plane[2] = m_image.plane[1] + m_image.planesize[1];
+
+      result.renderBuffers++;
+      result.renderBufferBytes += m_buffer.size();
+    }
+
+    CStageTimer timer(result.render);
+    CDVDCodecUtils::CopyPicture(&m_image, &picture);
+  }
+
+private:
+  YV12Image m_image;
+  std::vector<uint8_t> m_buffer;
+};
+
+// the benchmark runs without CApplication, registering twice is harmless
+void RegisterFFmpeg()
+{
+  avcodec_register_all();
+  av_register_all();
+}
+
+void FreePackets(std::deque<DemuxPacket*> &queue)
+{
+  for (auto packet : queue)
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  queue.clear();
+}
+
+/*!
+ * Feed the queued packets to the decoder and take out every picture, the way
+ * VideoPlayerVideo does. With drain set, all pictures are squeezed out until
+ * the decoder signals the end of the stream.
+ */
+bool DecodeVideo(CDVDVideoCodec &codec, std::deque<DemuxPacket*> &queue, CNullRenderer *renderer,
+                 CVideoPlayerBenchmark::SResult &result, int64_t firstVideoPacket, bool drain)
+{
+  if (drain)
+    codec.SetCodecControl(DVD_CODEC_CTRL_DRAIN);
+
+  int stalls = 0;
+  while (true)
+  {
+    bool added = false;
+    if (!queue.empty())
+    {
+      CStageTimer timer(result.videoDecode);
+      added = codec.AddData(*queue.front());
+    }
+    if (added)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(queue.front());
+      queue.pop_front();
+    }
+
+    VideoPicture picture;
+    memset(&picture, 0, sizeof(picture));
+
+    CDVDVideoCodec::VCReturn ret;
+    {
+      CStageTimer timer(result.videoDecode);
+      ret = codec.GetPicture(&picture);
+    }
+
+    if (ret == CDVDVideoCodec::VC_PICTURE)
+    {
+      stalls = 0;
+      if (result.videoFrames + result.droppedFrames == 0)
+        result.firstPicture = static_cast<double>(CurrentHostCounter() - firstVideoPacket) / CurrentHostFrequency();
+
+      if (picture.iFlags & DVP_FLAG_DROPPED)
+        result.droppedFrames++;
+      else
+      {
+        result.videoFrames++;
+        if (renderer)
+          renderer->Render(picture, result);
+      }
+    }
+    else if (ret == CDVDVideoCodec::VC_BUFFER)
+    {
+      if (queue.empty() && !drain)
+        return true;
+    }
+    else if (ret == CDVDVideoCodec::VC_REOPEN)
+      codec.Reopen();
+    else if (ret == CDVDVideoCodec::VC_EOF)
+      return true;
+    else if (ret == CDVDVideoCodec::VC_ERROR)
+    {
+      CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - video decoder returned error", __FUNCTION__);
+      return false;
+    }
+
+    if (added)
+      stalls = 0;
+    else if (ret != CDVDVideoCodec::VC_PICTURE && ++stalls > BENCHMARK_MAX_STALLS)
+    {
+      // a drained decoder without an eof signal is done as well
+      if (drain && queue.empty())
+        return true;
+
+      CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - video decoder stalled", __FUNCTION__);
+      return false;
+    }
+  }
+}
+
+bool DecodeAudio(CDVDAudioCodec &codec, std::deque<DemuxPacket*> &queue,
+                 CVideoPlayerBenchmark::SResult &result)
+{
+  int stalls = 0;
+  while (!queue.empty())
+  {
+    CStageTimer timer(result.audioDecode);
+
+    bool added = codec.AddData(*queue.front());
+    if (added)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(queue.front());
+      queue.pop_front();
+    }
+
+    // the sink would get these, dropping them keeps the run free of any clock
+    bool decoded = false;
+    DVDAudioFrame frame;
+    codec.GetData(frame);
+    while (frame.nb_frames)
+    {
+      decoded = true;
+      result.audioSamples += frame.nb_frames;
+      codec.GetData(frame);
+    }
+
+    if (added || decoded)
+      stalls = 0;
+    else if (++stalls > BENCHMARK_MAX_STALLS)
+    {
+      CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - audio decoder stalled", __FUNCTION__);
+      return false;
+    }
+  }
+  return true;
+}
+
+class CTestFileWriter
+{
+public:
+  ~CTestFileWriter()
+  {
+    av_frame_free(&m_videoFrame);
+    av_frame_free(&m_audioFrame);
+    avcodec_free_context(&m_video);
+    avcodec_free_context(&m_audio);
+    if (m_format)
+    {
+      if (m_format->pb && !(m_format->oformat->flags & AVFMT_NOFILE))
+        avio_closep(&m_format->pb);
+      avformat_free_context(m_format);
+    }
+  }
+
+  bool Open(const std::string &path, int width, int height)
+  {
+    if (avformat_alloc_output_context2(&m_format, nullptr, "asf", path.c_str()) < 0)
+      return false;
+
+    AVCodec *videoEncoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    AVCodec *audioEncoder = avcodec_find_encoder(AV_CODEC_ID_AC3);
+    if (!videoEncoder || !audioEncoder)
+      return false;
+
+    m_video = avcodec_alloc_context3(videoEncoder);
+    m_audio = avcodec_alloc_context3(audioEncoder);
+    if (!m_video || !m_audio)
+      return false;
+
+    m_video->width = width;
+    m_video->height = height;
+    m_video->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    m_video->time_base = av_make_q(1, TESTFILE_FPS);
+
+    m_audio->sample_fmt = AV_SAMPLE_FMT_FLTP;
+    m_audio->sample_rate = TESTFILE_SAMPLERATE;
+    m_audio->channel_layout = AV_CH_LAYOUT_STEREO;
+    m_audio->channels = av_get_channel_layout_nb_channels(m_audio->channel_layout);
+    m_audio->bit_rate = 192000;
+    m_audio->time_base = av_make_q(1, TESTFILE_SAMPLERATE);
+
+    if (m_format->oformat->flags & AVFMT_GLOBALHEADER)
+    {
+      m_video->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+      m_audio->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    if (avcodec_open2(m_video, videoEncoder, nullptr) < 0 ||
+        avcodec_open2(m_audio, audioEncoder, nullptr) < 0)
+      return false;
+
+    m_videoStream = AddStream(m_video);
+    m_audioStream = AddStream(m_audio);
+    if (!m_videoStream || !m_audioStream)
+      return false;
+
+    m_videoFrame = av_frame_alloc();
+    m_audioFrame = av_frame_alloc();
+    if (!m_videoFrame || !m_audioFrame)
+      return false;
+
+    m_videoFrame->format = m_video->pix_fmt;
+    m_videoFrame->width = m_video->width;
+    m_videoFrame->height = m_video->height;
+    m_audioFrame->format = m_audio->sample_fmt;
+    m_audioFrame->channel_layout = m_audio->channel_layout;
+    m_audioFrame->channels = m_audio->channels;
+    m_audioFrame->sample_rate = m_audio->sample_rate;
+    m_audioFrame->nb_samples = m_audio->frame_size;
+    if (av_frame_get_buffer(m_videoFrame, 32) < 0 || av_frame_get_buffer(m_audioFrame, 0) < 0)
+      return false;
+
+    if (!(m_format->oformat->flags & AVFMT_NOFILE) &&
+        avio_open(&m_format->pb, path.c_str(), AVIO_FLAG_WRITE) < 0)
+      return false;
+
+    return avformat_write_header(m_format, nullptr) >= 0;
+  }
+
+  bool Write(int seconds)
+  {
+    const int64_t videoEnd = static_cast<int64_t>(seconds) * TESTFILE_FPS;
+    const int64_t audioEnd = static_cast<int64_t>(seconds) * TESTFILE_SAMPLERATE;
+    int64_t videoPts = 0;
+    int64_t audioPts = 0;
+
+    while (videoPts < videoEnd || audioPts < audioEnd)
+    {
+      bool video = audioPts >= audioEnd ||
+                   (videoPts < videoEnd && av_compare_ts(videoPts, m_video->time_base, audioPts, m_audio->time_base) <= 0);
+      if (video)
+      {
+        if (av_frame_make_writable(m_videoFrame) < 0)
+          return false;
+        FillPicture(m_videoFrame, videoPts);
+        m_videoFrame->pts = videoPts++;
+        if (!Encode(m_video, m_videoStream, m_videoFrame))
+          return false;
+      }
+      else
+      {
+        if (av_frame_make_writable(m_audioFrame) < 0)
+          return false;
+        FillTone(m_audioFrame, audioPts);
+        m_audioFrame->pts = audioPts;
+        audioPts += m_audioFrame->nb_samples;
+        if (!Encode(m_audio, m_audioStream, m_audioFrame))
+          return false;
+      }
+    }
+
+    if (!Encode(m_video, m_videoStream, nullptr) || !Encode(m_audio, m_audioStream, nullptr))
+      return false;
+
+    return av_write_trailer(m_format) >= 0;
+  }
+
+private:
+  AVStream* AddStream(AVCodecContext *context)
+  {
+    AVStream *stream = avformat_new_stream(m_format, nullptr);
+    if (!stream || avcodec_parameters_from_context(stream->codecpar, context) < 0)
+      return nullptr;
+    stream->time_base = context->time_base;
+    return stream;
+  }
+
+  // a gradient moving across the picture, so no two frames are the same
+  static void FillPicture(AVFrame *frame, int64_t index)
+  {
+    for (int y = 0; y < frame->height; y++)
+    {
+      for (int x = 0; x < frame->width; x++)
+        frame->data[0][y * frame->linesize[0] + x] = static_cast<uint8_t>(x + y + index * 3);
+    }
+    for (int y = 0; y < frame->height / 2; y++)
+    {
+      for (int x = 0; x < frame->width / 2; x++)
+      {
+        frame->data[1][y * frame->linesize[1] + x] = static_cast<uint8_t>(128 + y + index * 2);
+        frame->data[2][y * frame->linesize[2] + x] = static_cast<uint8_t>(64 + x + index * 5);
+      }
+    }
+  }
+
+  static void FillTone(AVFrame *frame, int64_t start)
+  {
+    for (int i = 0; i < frame->nb_samples; i++)
+    {
+      float value = static_cast<float>(0.5 * sin(2.0 * M_PI * TESTFILE_TONE * (start + i) / TESTFILE_SAMPLERATE));
+      for (int c = 0; c < frame->channels; c++)
+        reinterpret_cast<float*>(frame->data[c])[i] = value;
+    }
+  }
+
+  bool Encode(AVCodecContext *context, AVStream *stream, AVFrame *frame)
+  {
+    if (avcodec_send_frame(context, frame) < 0)
+      return false;
+
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = nullptr;
+    packet.size = 0;
+
+    int ret;
+    while ((ret = avcodec_receive_packet(context, &packet)) == 0)
+    {
+      av_packet_rescale_ts(&packet, context->time_base, stream->time_base);
+      packet.stream_index = stream->index;
+      ret = av_interleaved_write_frame(m_format, &packet);
+      av_packet_unref(&packet);
+      if (ret < 0)
+        return false;
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+  }
+
+  AVFormatContext *m_format = nullptr;
+  AVCodecContext *m_video = nullptr;
+  AVCodecContext *m_audio = nullptr;
+  AVStream *m_videoStream = nullptr;
+  AVStream *m_audioStream = nullptr;
+  AVFrame *m_videoFrame = nullptr;
+  AVFrame *m_audioFrame = nullptr;
+};
+
+}
+
+bool CVideoPlayerBenchmark::Run(const std::string &path, const SOptions &options, SResult &result)
+{
+  RegisterFFmpeg();
+
+  std::string redactPath = CURL::GetRedacted(path);
+  int64_t start = CurrentHostCounter();
+
+  std::unique_ptr<CDVDInputStream> inputStream;
+  std::unique_ptr<CDVDDemux> demuxer;
+  std::unique_ptr<CProcessInfo> processInfo(CProcessInfo::CreateInstance());
+  std::unique_ptr<CDVDVideoCodec> videoCodec;
+  std::unique_ptr<CDVDAudioCodec> audioCodec;
+  CDemuxStream *videoStream = nullptr;
+  CDemuxStream *audioStream = nullptr;
+
+  {
+    CStageTimer timer(result.open);
+
+    CFileItem item(path, false);
+    item.SetMimeTypeForInternetFile();
+    inputStream.reset(CDVDFactoryInputStream::CreateInputStream(nullptr, item));
+    if (!inputStream || !inputStream->Open())
+    {
+      CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - error opening %s", __FUNCTION__, redactPath.c_str());
+      return false;
+    }
+
+    demuxer.reset(CDVDFactoryDemuxer::CreateDemuxer(inputStream.get()));
+    if (!demuxer)
+    {
+      CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - error creating demuxer for %s", __FUNCTION__, redactPath.c_str());
+      return false;
+    }
+
+    CDVDDemuxFFmpeg *demuxerFFmpeg = dynamic_cast<CDVDDemuxFFmpeg*>(demuxer.get());
+    result.cachedStreamInfo = demuxerFFmpeg && demuxerFFmpeg->HasCachedStreamInfo();
+
+    // the first stream of each type, like the player picks them without any preferences
+    for (CDemuxStream *stream : demuxer->GetStreams())
+    {
+      if (!stream)
+        continue;
+      if (options.video && !videoStream && stream->type == STREAM_VIDEO && !(stream->flags & AV_DISPOSITION_ATTACHED_PIC))
+        videoStream = stream;
+      else if (options.audio && !audioStream && stream->type == STREAM_AUDIO)
+        audioStream = stream;
+      else
+        demuxer->EnableStream(stream->demuxerId, stream->uniqueId, false);
+    }
+
+    if (videoStream)
+    {
+      CDVDStreamInfo hint(*videoStream, true);
+      hint.codecOptions = CODEC_FORCE_SOFTWARE;
+      CRenderInfo renderInfo;
+      renderInfo.directBufferPool = options.directBufferPool;
+      // software decoding is single threaded unless asked for otherwise
+      std::vector<CDVDCodecOption> codecOptions;
+      if (options.threads > 0)
+        codecOptions.push_back(CDVDCodecOption("threads", StringUtils::Format("%d", options.threads)));
+      if (!options.threadType.empty())
+        codecOptions.push_back(CDVDCodecOption("thread_type", options.threadType));
+      videoCodec.reset(CDVDFactoryCodec::CreateVideoCodec(hint, *processInfo, renderInfo, codecOptions));
+      if (!videoCodec)
+      {
+        CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - no video decoder for %s", __FUNCTION__, redactPath.c_str());
+        return false;
+      }
+      result.videoCodec = videoCodec->GetName();
+    }
+
+    if (audioStream)
+    {
+      CDVDStreamInfo hint(*audioStream, true);
+      audioCodec.reset(CDVDFactoryCodec::CreateAudioCodec(hint, *processInfo, false, true, CAEStreamInfo::STREAM_TYPE_NULL));
+      if (!audioCodec)
+      {
+        CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - no audio decoder for %s", __FUNCTION__, redactPath.c_str());
+        return false;
+      }
+      result.audioCodec = audioCodec->GetName();
+    }
+  }
+
+  if (!videoCodec && !audioCodec)
+  {
+    CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - nothing to decode in %s", __FUNCTION__, redactPath.c_str());
+    return false;
+  }
+
+  CNullRenderer nullRenderer;
+  CNullRenderer *renderer = options.render ? &nullRenderer : nullptr;
+  std::deque<DemuxPacket*> videoQueue;
+  std::deque<DemuxPacket*> audioQueue;
+  int64_t firstVideoPacket = 0;
+  bool ok = true;
+
+  while (ok)
+  {
+    DemuxPacket *packet;
+    {
+      CStageTimer timer(result.demux);
+      packet = demuxer->Read();
+    }
+    if (!packet)
+      break;
+
+    if (result.packets == 0)
+      result.firstPacket = static_cast<double>(CurrentHostCounter() - start) / CurrentHostFrequency();
+    result.packets++;
+    result.packetBytes += packet->iSize;
+
+    if (videoCodec && packet->demuxerId == videoStream->demuxerId && packet->iStreamId == videoStream->uniqueId)
+    {
+      if (result.videoPackets++ == 0)
+        firstVideoPacket = CurrentHostCounter();
+      videoQueue.push_back(packet);
+      result.maxVideoQueue = std::max(result.maxVideoQueue, static_cast<unsigned int>(videoQueue.size()));
+      ok = DecodeVideo(*videoCodec, videoQueue, renderer, result, firstVideoPacket, false);
+    }
+    else if (audioCodec && packet->demuxerId == audioStream->demuxerId && packet->iStreamId == audioStream->uniqueId)
+    {
+      result.audioPackets++;
+      audioQueue.push_back(packet);
+      result.maxAudioQueue = std::max(result.maxAudioQueue, static_cast<unsigned int>(audioQueue.size()));
+      ok = DecodeAudio(*audioCodec, audioQueue, result);
+    }
+    else
+      CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+    if (options.maxPackets && result.packets >= options.maxPackets)
+      break;
+  }
+
+  if (ok && videoCodec)
+    ok = DecodeVideo(*videoCodec, videoQueue, renderer, result, firstVideoPacket, true);
+  if (ok && audioCodec)
+    ok = DecodeAudio(*audioCodec, audioQueue, result);
+
+  FreePackets(videoQueue);
+  FreePackets(audioQueue);
+
+  result.total = static_cast<double>(CurrentHostCounter() - start) / CurrentHostFrequency();
+  return ok;
+}
+
+std::string CVideoPlayerBenchmark::Report(const SResult &result)
+{
+  double run = result.total - result.open;
+  if (run <= 0.0)
+    run = 1e-9;
+
+  auto Share = [&result](double seconds)
+  {
+    return result.total > 0.0 ? 100.0 * seconds / result.total : 0.0;
+  };
+
+  std::string report;
+  report += StringUtils::Format("video codec: %s\n", result.videoCodec.c_str());
+  report += StringUtils::Format("audio codec: %s\n", result.audioCodec.c_str());
+  report += StringUtils::Format("packets: %u (%.1f/s)\n", result.packets, result.packets / run);
+  report += StringUtils::Format("video packets: %u\n", result.videoPackets);
+  report += StringUtils::Format("audio packets: %u\n", result.audioPackets);
+  report += StringUtils::Format("video frames: %u (%.1f/s)\n", result.videoFrames, result.videoFrames / run);
+  report += StringUtils::Format("dropped frames: %u\n", result.droppedFrames);
+  report += StringUtils::Format("direct frames: %u\n", result.directFrames);
+  report += StringUtils::Format("audio samples: %" PRIu64 " (%.1f/s)\n", result.audioSamples, result.audioSamples / run);
+  report += StringUtils::Format("packet bytes: %" PRIu64 "\n", result.packetBytes);
+  report += StringUtils::Format("render buffers: %u (%" PRIu64 " bytes)\n", result.renderBuffers, result.renderBufferBytes);
+  report += StringUtils::Format("max video queue: %u\n", result.maxVideoQueue);
+  report += StringUtils::Format("max audio queue: %u\n", result.maxAudioQueue);
+  report += StringUtils::Format("time total: %.3f s\n", result.total);
+  report += StringUtils::Format("time open: %.3f s (%.1f%%)\n", result.open, Share(result.open));
+  report += StringUtils::Format("time to first packet: %.3f s (stream info %s)\n", result.firstPacket,
+                                result.cachedStreamInfo ? "cached" : "probed");
+  report += StringUtils::Format("time to first picture: %.3f s\n", result.firstPicture);
+  report += StringUtils::Format("time demux: %.3f s (%.1f%%)\n", result.demux, Share(result.demux));
+  report += StringUtils::Format("time video decode: %.3f s (%.1f%%)\n", result.videoDecode, Share(result.videoDecode));
+  report += StringUtils::Format("time audio decode: %.3f s (%.1f%%)\n", result.audioDecode, Share(result.audioDecode));
+  report += StringUtils::Format("time render: %.3f s (%.1f%%)\n", result.render, Share(result.render));
+  return report;
+}
+
+std::string CVideoPlayerBenchmark::ReportThreading(const std::vector<SOptions> &options, const std::vector<SResult> &results)
+{
+  std::string report = StringUtils::Format("%-8s %-12s %8s %10s %14s\n", "threads", "thread type", "frames", "fps", "first picture");
+  for (size_t i = 0; i < options.size() && i < results.size(); i++)
+  {
+    const SResult &result = results[i];
+    unsigned int frames = result.videoFrames + result.droppedFrames;
+    std::string threads = options[i].threads > 0 ? StringUtils::Format("%d", options[i].threads) : "default";
+    std::string threadType = options[i].threadType.empty() ? "default" : options[i].threadType;
+
+    report += StringUtils::Format("%-8s %-12s %8u %10.1f %11.1f ms\n", threads.c_str(), threadType.c_str(), frames,
+                                  result.videoDecode > 0.0 ? frames / result.videoDecode : 0.0,
+                                  result.firstPicture * 1000.0);
+  }
+  return report;
+}
+
+bool CVideoPlayerBenchmark::CreateTestFile(const std::string &path, int seconds, int width, int height)
+{
+  RegisterFFmpeg();
+
+  CTestFileWriter writer;
+  if (!writer.Open(path, width, height) || !writer.Write(seconds))
+  {
+    CLog::Log(LOGERROR, "CVideoPlayerBenchmark::%s - failed to write %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+  return true;
+}
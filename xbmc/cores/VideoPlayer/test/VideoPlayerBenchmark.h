@@ -0,0 +1,104 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IDirectBufferPool;
+
+/*!
+ * Runs the input stream, demuxer and software decoders of VideoPlayer on a file
+ * as fast as they can go, without a display, audio device or clock, and
+ * measures where the time goes.
+ *
+ * Decoded pictures are copied into buffers like a renderer would upload them,
+ * decoded audio is counted and dropped.
+ */
+class CVideoPlayerBenchmark
+{
+public:
+  struct SOptions
+  {
+    bool video = true;
+    bool audio = true;
+    bool render = true;          //!< copy decoded pictures into render buffers
+    unsigned int maxPackets = 0; //!< stop after this many packets, 0 for the whole file
+    IDirectBufferPool *directBufferPool = nullptr; //!< buffers of the renderer the video decoder may decode into
+    int threads = 0;             //!< video decoder threads, 0 to let the decoder choose
+    std::string threadType;      //!< "frame", "slice" or "frame+slice", empty to let the decoder choose
+  };
+
+  struct SResult
+  {
+    std::string videoCodec;
+    std::string audioCodec;
+
+    unsigned int packets = 0;
+    unsigned int videoPackets = 0;
+    unsigned int audioPackets = 0;
+    unsigned int videoFrames = 0;
+    unsigned int droppedFrames = 0;
+    unsigned int directFrames = 0;   //!< pictures decoded into a buffer of the direct buffer pool, taken without a copy
+    uint64_t audioSamples = 0;
+
+    uint64_t packetBytes = 0;        //!< payload of the demuxed packets
+    unsigned int renderBuffers = 0;  //!< render buffers (re)allocated for a new picture size
+    uint64_t renderBufferBytes = 0;
+    unsigned int maxVideoQueue = 0; //!< packets waiting for the video decoder to take them
+    unsigned int maxAudioQueue = 0;
+    bool cachedStreamInfo = false;  //!< the demuxer took the stream info from the demux cache
+
+    // seconds
+    double total = 0.0;
+    double open = 0.0;
+    double firstPacket = 0.0;  //!< from the start of the open until the first packet is demuxed
+    double firstPicture = 0.0; //!< from the first video packet until the first picture of the decoder
+    double demux = 0.0;
+    double videoDecode = 0.0;
+    double audioDecode = 0.0;
+    double render = 0.0;
+  };
+
+  /*!
+   * Play the file once.
+   * \return false if the file can't be opened or a decoder failed
+   */
+  static bool Run(const std::string &path, const SOptions &options, SResult &result);
+
+  /*!
+   * Format the result for humans and scripts, one "name: value" per line.
+   */
+  static std::string Report(const SResult &result);
+
+  /*!
+   * Format the decode rate and the latency of the first picture of runs with
+   * different decoder threading, one line per run.
+   */
+  static std::string ReportThreading(const std::vector<SOptions> &options, const std::vector<SResult> &results);
+
+  /*!
+   * Write a test file with a moving MJPEG picture and an AC3 sine tone in an
+   * ASF container, which every ffmpeg build of Kodi can encode.
+   */
+  static bool CreateTestFile(const std::string &path, int seconds, int width, int height);
+};
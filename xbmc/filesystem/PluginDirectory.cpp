@@ -429,11 +429,15 @@ void CPluginDirectory::AddSortMethod(int handle, SORT_METHOD sortMethod, const s
 bool CPluginDirectory::GetDirectory(const CURL& url, CFileItemList& items)
 {
   const std::string pathToUrl(url.Get());
+  unsigned int start = XbmcThreads::SystemClockMillis();
   bool success = StartScript(pathToUrl, true);
 
   // append the items to the list
   items.Assign(*m_listItems, true); // true to keep the current items
   m_listItems->Clear();
+
+  CLog::Log(LOGDEBUG, "CPluginDirectory::%s - listing %s took %u ms", __FUNCTION__,
+            CURL::GetRedacted(pathToUrl).c_str(), XbmcThreads::SystemClockMillis() - start);
   return success;
 }
 
@@ -47,12 +47,25 @@
 
 #include <libsmbclient.h>
 
+#include <map>
+
 struct CachedDirEntry
 {
   unsigned int type;
   std::string name;
 };
 
+#ifdef HAVE_SMBC_READDIRPLUS
+// attributes returned together with the directory listing
+struct CachedDirAttributes
+{
+  int64_t size;
+  int64_t time;
+  bool isDir;
+  bool hidden;
+};
+#endif
+
 using namespace XFILE;
 
 CSMBDirectory::CSMBDirectory(void)
@@ -93,6 +106,9 @@ bool CSMBDirectory::GetDirectory(const CURL& url, CFileItemList &items)
   // "stat" is locked each time. that way the lock is freed between stat requests
   std::vector<CachedDirEntry> vecEntries;
   struct smbc_dirent* dirEnt;
+#ifdef HAVE_SMBC_READDIRPLUS
+  std::map<std::string, CachedDirAttributes> attributes;
+#endif
 
   lock.Enter();
   while ((dirEnt = smbc_readdir(fd)))
@@ -102,6 +118,31 @@ bool CSMBDirectory::GetDirectory(const CURL& url, CFileItemList &items)
     aDir.name = dirEnt->name;
     vecEntries.push_back(aDir);
   }
+
+#ifdef HAVE_SMBC_READDIRPLUS
+  // the server already sent the attributes of every file and folder of a share with the
+  // listing so there's no need for two more round-trips (stat and getxattr) per entry.
+  // smbc_readdirplus() keeps its own position so it still starts at the first entry.
+  if ((m_flags & DIR_FLAG_NO_FILE_INFO) == 0 && g_advancedSettings.m_sambastatfiles)
+  {
+    const struct libsmb_file_info *fileInfo;
+    while ((fileInfo = smbc_readdirplus(fd)))
+    {
+      if (fileInfo->name == NULL)
+        continue;
+
+      CachedDirAttributes attr;
+      attr.size = fileInfo->size;
+      attr.time = fileInfo->mtime_ts.tv_sec;
+      if (attr.time == 0) // if modification date is missing, use create date
+        attr.time = fileInfo->ctime_ts.tv_sec;
+      attr.isDir = (fileInfo->attrs & SMBC_DOS_MODE_DIRECTORY) != 0;
+      attr.hidden = (fileInfo->attrs & SMBC_DOS_MODE_HIDDEN) != 0;
+      attributes[fileInfo->name] = attr;
+    }
+  }
+#endif
+
   smbc_closedir(fd);
   lock.Leave();
 
@@ -135,6 +176,18 @@ bool CSMBDirectory::GetDirectory(const CURL& url, CFileItemList &items)
         bIsDir = (aDir.type == SMBC_DIR);
 
         struct stat info = {0};
+#ifdef HAVE_SMBC_READDIRPLUS
+        std::map<std::string, CachedDirAttributes>::const_iterator attr = attributes.find(aDir.name);
+        if (attr != attributes.end())
+        {
+          bIsDir = attr->second.isDir;
+          lTimeDate = attr->second.time;
+          iSize = attr->second.size;
+          if (attr->second.hidden)
+            hidden = true;
+        }
+        else
+#endif
         if ((m_flags & DIR_FLAG_NO_FILE_INFO)==0 && g_advancedSettings.m_sambastatfiles)
         {
           // make sure we use the authenticated path wich contains any default username
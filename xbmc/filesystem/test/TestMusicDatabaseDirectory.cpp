@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DatabaseManager.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/DirectoryCache.h"
+#include "filesystem/SpecialProtocol.h"
+#include "music/MusicDatabase.h"
+#include "music/tags/MusicInfoTag.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "XBDateTime.h"
+
+#include "gtest/gtest.h"
+
+class TestMusicDatabaseDirectory : public ::testing::Test
+{
+protected:
+  // more songs than are kept as full info tags
+  static const int Songs = 1500;
+
+  void SetUp() override
+  {
+    settings = g_advancedSettings.m_databaseMusic;
+    g_advancedSettings.m_databaseMusic.type = "sqlite3";
+    g_advancedSettings.m_databaseMusic.name = "TestMusicDatabaseDirectory";
+    g_advancedSettings.m_databaseMusic.host = CSpecialProtocol::TranslatePath("special://temp/");
+
+    // creates the test database with the current schema
+    CDatabaseManager::GetInstance().Initialize();
+
+    CMusicDatabase database;
+    ASSERT_TRUE(database.Open());
+    if (database.GetSongsCount() > 0)
+      return;
+
+    database.BeginTransaction();
+    int idArtist = database.AddArtist("Artist", "");
+    int idAlbum = database.AddAlbum("Album", "", "Artist", "", "Genre", 2017, "", "", false, CAlbum::Album);
+    for (int i = 0; i < Songs; i++)
+    {
+      std::string title = StringUtils::Format("Song %04i", i);
+      int idSong = database.AddSong(idAlbum, title, "", "/music/" + title + ".mp3", "", "", "", "Artist", "",
+                                    std::vector<std::string>(1, "Genre"), i + 1, 180, 2017, 0, 0, 0,
+                                    CDateTime(), 0, 0, 0, ReplayGain());
+      database.AddSongArtist(idArtist, idSong, ROLE_ARTIST, "Artist", 0);
+    }
+    database.CommitTransaction();
+  }
+
+  void TearDown() override
+  {
+    g_directoryCache.Clear();
+    g_advancedSettings.m_databaseMusic = settings;
+    CDatabaseManager::GetInstance().Initialize();
+  }
+
+  DatabaseSettings settings;
+};
+
+TEST_F(TestMusicDatabaseDirectory, HugeListingKeepsTagSource)
+{
+  CFileItemList items;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory("musicdb://songs/", items));
+  ASSERT_EQ(Songs, items.Size());
+  for (int i = 0; i < items.Size(); i++)
+    ASSERT_TRUE(items[i]->GetMusicInfoTagSource() != nullptr) << i;
+  EXPECT_EQ("Artist", items[0]->GetMusicInfoTag()->GetArtistString());
+
+  // the listing is copied into and out of the directory cache
+  CFileItemList cached;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory("musicdb://songs/", cached, "", XFILE::DIR_FLAG_READ_CACHE));
+  ASSERT_EQ(Songs, cached.Size());
+  for (int i = 0; i < cached.Size(); i++)
+  {
+    ASSERT_EQ(items[0]->GetMusicInfoTagSource(), cached[i]->GetMusicInfoTagSource()) << i;
+    EXPECT_EQ(items[i]->GetPath(), cached[i]->GetPath());
+  }
+  EXPECT_EQ(items[0]->GetMusicInfoTag()->GetTitle(), cached[0]->GetMusicInfoTag()->GetTitle());
+}
@@ -46,6 +46,7 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "utils/URIUtils.h"
 #include "Application.h"
 #include "FileItem.h"
@@ -57,6 +58,9 @@
 #include <iterator>
 #include <utility>
 
+// Number of frames with input to average the time until the renderer over
+#define INPUT_TO_RENDERER_SAMPLES  100
+
 using namespace KODI;
 using namespace GAME;
 
@@ -130,7 +134,14 @@ CGameClient::CGameClient(ADDON::CAddonInfo addonInfo) :
   m_serializeSize(0),
   m_audio(nullptr),
   m_video(nullptr),
-  m_region(GAME_REGION_UNKNOWN)
+  m_region(GAME_REGION_UNKNOWN),
+  m_bOutputVideo(true),
+  m_bOutputAudio(true),
+  m_inputTime(0),
+  m_frameInputTime(0),
+  m_inputToRendererTotal(0),
+  m_inputToRendererMax(0),
+  m_inputToRendererCount(0)
 {
   const ADDON::InfoMap& extraInfo = m_addonInfo.extrainfo;
   ADDON::InfoMap::const_iterator it;
@@ -535,16 +546,29 @@ void CGameClient::CloseFile()
   m_audio = nullptr;
   m_video = nullptr;
   m_timing.Reset();
+  ResetInputToRenderer();
 }
 
-void CGameClient::RunFrame()
+void CGameClient::RunFrame(bool bOutputVideo /* = true */, bool bOutputAudio /* = true */)
 {
   CSingleLock lock(m_critSection);
 
   if (m_bIsPlaying)
   {
+    // Input events received until now are polled by this frame. It's measured
+    // until the next frame is shown, which is a later one when running ahead.
+    if (m_frameInputTime == 0)
+      m_frameInputTime = m_inputTime.exchange(0);
+
+    // The stream data is added from within the frame on this thread
+    m_bOutputVideo = bOutputVideo;
+    m_bOutputAudio = bOutputAudio;
+
     try { LogError(m_struct.toAddon.RunFrame(), "RunFrame()"); }
     catch (...) { LogException("RunFrame()"); }
+
+    m_bOutputVideo = true;
+    m_bOutputAudio = true;
   }
 }
 
@@ -654,14 +678,17 @@ void CGameClient::AddStreamData(GAME_STREAM_TYPE stream, const uint8_t* data, un
   {
   case GAME_STREAM_AUDIO:
   {
-    if (m_audio)
+    if (m_audio && m_bOutputAudio)
       m_audio->AddData(data, size);
     break;
   }
   case GAME_STREAM_VIDEO:
   {
-    if (m_video)
+    if (m_video && m_bOutputVideo)
+    {
       m_video->AddData(data, size);
+      UpdateInputToRenderer();
+    }
     break;
   }
   default:
@@ -821,6 +848,47 @@ bool CGameClient::AcceptsInput(void) const
          g_windowManager.GetActiveWindowID() == WINDOW_FULLSCREEN_GAME;
 }
 
+void CGameClient::OnInputEvent()
+{
+  // Only the first event before a frame is measured
+  int64_t none = 0;
+  m_inputTime.compare_exchange_strong(none, CurrentHostCounter());
+}
+
+void CGameClient::UpdateInputToRenderer()
+{
+  if (m_frameInputTime == 0)
+    return;
+
+  // Time from the input event until the frame that saw it was handed to the
+  // renderer, which includes the time the game waited for the next frame,
+  // but not the time until the renderer shows it
+  const int64_t time = CurrentHostCounter() - m_frameInputTime;
+  m_frameInputTime = 0;
+
+  m_inputToRendererTotal += time;
+  m_inputToRendererMax = std::max(m_inputToRendererMax, time);
+
+  if (++m_inputToRendererCount >= INPUT_TO_RENDERER_SAMPLES)
+  {
+    const double msPerTick = 1000.0 / CurrentHostFrequency();
+    CLog::Log(LOGDEBUG, "GAME: input until handed to renderer over %u frames: average %.2f ms, maximum %.2f ms",
+              m_inputToRendererCount,
+              m_inputToRendererTotal * msPerTick / m_inputToRendererCount,
+              m_inputToRendererMax * msPerTick);
+    ResetInputToRenderer();
+  }
+}
+
+void CGameClient::ResetInputToRenderer()
+{
+  m_inputTime = 0;
+  m_frameInputTime = 0;
+  m_inputToRendererTotal = 0;
+  m_inputToRendererMax = 0;
+  m_inputToRendererCount = 0;
+}
+
 void CGameClient::ClearPorts(void)
 {
   while (!m_ports.empty())
@@ -89,7 +89,14 @@ public:
   bool IsPlaying() const { return m_bIsPlaying; }
   IGameClientPlayback* GetPlayback() { return m_playback.get(); }
   const CGameClientTiming& Timing() const { return m_timing; }
-  void RunFrame();
+
+  /*!
+   * \brief Run a single frame of the game
+   *
+   * \param bOutputVideo False to discard the video of the frame
+   * \param bOutputAudio False to discard the audio of the frame
+   */
+  void RunFrame(bool bOutputVideo = true, bool bOutputAudio = true);
 
   // Audio/video callbacks
   bool OpenPixelStream(GAME_PIXEL_FORMAT format, unsigned int width, unsigned int height, GAME_VIDEO_ROTATION rotation);
@@ -112,6 +119,13 @@ public:
   // Input functions
   bool AcceptsInput(void) const;
 
+  /*!
+   * \brief Called by the input handlers when an event is sent to the game
+   *
+   * The time until the next frame is handed to the renderer is logged.
+   */
+  void OnInputEvent();
+
   /*!
     * @brief To get the interface table used between addon and kodi
     * @todo This function becomes removed after old callback library system
@@ -138,6 +152,8 @@ private:
   void OpenMouse(void);
   void CloseMouse(void);
   ControllerVector GetControllers(void) const;
+  void UpdateInputToRenderer();
+  void ResetInputToRenderer();
 
   // Private memory stream functions
   size_t GetSerializeSize();
@@ -189,6 +205,8 @@ private:
   PERIPHERALS::EventRateHandle m_inputRateHandle; // Handle while keeping the input sampling rate at the frame rate
   std::unique_ptr<IGameClientPlayback> m_playback; // Interface to control playback
   GAME_REGION           m_region;              // Region of the loaded game
+  bool                  m_bOutputVideo;        // False while running a frame whose video is discarded
+  bool                  m_bOutputAudio;        // False while running a frame whose audio is discarded
 
   // In-game saves
   std::unique_ptr<CGameClientInGameSaves> m_inGameSaves;
@@ -198,6 +216,13 @@ private:
   std::unique_ptr<CGameClientKeyboard> m_keyboard;
   std::unique_ptr<CGameClientMouse> m_mouse;
 
+  // Time from input until the frame is handed to the renderer
+  std::atomic<int64_t> m_inputTime;            // Host counter of the first input event not yet seen by a frame, or 0
+  int64_t               m_frameInputTime;      // Host counter of the first input event seen by a frame not yet shown, or 0
+  int64_t               m_inputToRendererTotal;
+  int64_t               m_inputToRendererMax;
+  unsigned int          m_inputToRendererCount;
+
   CCriticalSection m_critSection;
 
   AddonInstance_Game m_struct;
@@ -83,6 +83,9 @@ bool CGameClientJoystick::OnButtonPress(const std::string& feature, bool bPresse
   event.feature_name           = feature.c_str();
   event.digital_button.pressed = bPressed;
 
+  if (bPressed)
+    m_gameClient->OnInputEvent();
+
   try
   {
     bHandled = m_dllStruct->InputEvent(&event);
@@ -65,7 +65,7 @@ namespace GAME
     bool SetRumble(const std::string& feature, float magnitude);
 
   private:
-    const CGameClient* const  m_gameClient;
+    CGameClient* const        m_gameClient;
     const int                 m_port;
     const ControllerPtr       m_controller;
     const KodiToAddonFuncTable_Game* const m_dllStruct;
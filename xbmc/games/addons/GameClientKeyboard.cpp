@@ -31,7 +31,7 @@ using namespace GAME;
 
 #define BUTTON_INDEX_MASK  0x01ff
 
-CGameClientKeyboard::CGameClientKeyboard(const CGameClient* gameClient, const KodiToAddonFuncTable_Game* dllStruct) :
+CGameClientKeyboard::CGameClientKeyboard(CGameClient* gameClient, const KodiToAddonFuncTable_Game* dllStruct) :
   m_gameClient(gameClient),
   m_dllStruct(dllStruct)
 {
@@ -66,6 +66,8 @@ bool CGameClientKeyboard::OnKeyPress(const CKey& key)
 
   if (event.key.character != 0)
   {
+    m_gameClient->OnInputEvent();
+
     try
     {
       bHandled = m_dllStruct->InputEvent(&event);
@@ -43,7 +43,7 @@ namespace GAME
      * \param gameClient The game client implementation.
      * \param dllStruct The emulator or game to which the events are sent.
      */
-    CGameClientKeyboard(const CGameClient* gameClient, const KodiToAddonFuncTable_Game* dllStruct);
+    CGameClientKeyboard(CGameClient* gameClient, const KodiToAddonFuncTable_Game* dllStruct);
 
     /*!
      * \brief Destructor unregisters from keyboard events from CInputManager.
@@ -56,7 +56,7 @@ namespace GAME
 
   private:
     // Construction parameters
-    const CGameClient* const m_gameClient;
+    CGameClient* const       m_gameClient;
     const KodiToAddonFuncTable_Game* const m_dllStruct;
   };
 }
@@ -22,13 +22,15 @@
 #include "ServiceBroker.h"
 #include "games/addons/GameClient.h"
 #include "games/addons/savestates/BasicMemoryStream.h"
-#include "games/addons/savestates/DeltaPairMemoryStream.h"
+#include "games/addons/savestates/CompressedMemoryStream.h"
 #include "games/addons/savestates/Savestate.h"
 #include "games/addons/savestates/SavestateReader.h"
 #include "games/addons/savestates/SavestateWriter.h"
 #include "games/GameSettings.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
+#include "utils/log.h"
 #include "utils/MathUtils.h"
 
 #include <algorithm>
@@ -41,6 +43,7 @@ using namespace GAME;
 CGameClientReversiblePlayback::CGameClientReversiblePlayback(CGameClient* gameClient, double fps, size_t serializeSize) :
   m_gameClient(gameClient),
   m_gameLoop(this, fps),
+  m_runAheadFrames(0),
   m_savestateWriter(new CSavestateWriter),
   m_savestateReader(new CSavestateReader),
   m_totalFrameCount(0),
@@ -52,6 +55,14 @@ CGameClientReversiblePlayback::CGameClientReversiblePlayback(CGameClient* gameCl
 {
   UpdateMemoryStream();
 
+  // Running ahead needs to restore the state of the game after every frame
+  if (serializeSize > 0 && g_advancedSettings.m_gamesRunAheadFrames > 0)
+  {
+    m_runAheadFrames = g_advancedSettings.m_gamesRunAheadFrames;
+    m_runAheadState.resize(serializeSize);
+  }
+  m_gameLoop.SetFrameDelay(g_advancedSettings.m_gamesFrameDelay);
+
   CGameSettings::GetInstance().RegisterObserver(this);
 
   m_gameLoop.Start();
@@ -216,9 +227,19 @@ bool CGameClientReversiblePlayback::LoadSavestate(const std::string& path)
 
 void CGameClientReversiblePlayback::FrameEvent()
 {
-  m_gameClient->RunFrame();
-
-  AddFrame();
+  if (m_runAheadFrames > 0 && GetSpeed() == 1.0)
+  {
+    // The picture of this frame is outdated by the frames the game lags
+    // behind its input, one of the frames run ahead is shown instead
+    m_gameClient->RunFrame(false, true);
+    AddFrame();
+    RunAhead();
+  }
+  else
+  {
+    m_gameClient->RunFrame();
+    AddFrame();
+  }
 }
 
 void CGameClientReversiblePlayback::RewindEvent()
@@ -244,6 +265,27 @@ void CGameClientReversiblePlayback::AddFrame()
   m_totalFrameCount++;
 }
 
+void CGameClientReversiblePlayback::RunAhead()
+{
+  if (!m_gameClient->Serialize(m_runAheadState.data(), m_runAheadState.size()))
+  {
+    CLog::Log(LOGERROR, "GAME: Failed to save the state to run ahead, disabling run-ahead");
+    m_runAheadFrames = 0;
+    return;
+  }
+
+  // Only the last frame is shown, the audio of the frames is played when
+  // they are run for real
+  for (unsigned int i = 1; i <= m_runAheadFrames; i++)
+    m_gameClient->RunFrame(i == m_runAheadFrames, false);
+
+  if (!m_gameClient->Deserialize(m_runAheadState.data(), m_runAheadState.size()))
+  {
+    CLog::Log(LOGERROR, "GAME: Failed to restore the state after running ahead, disabling run-ahead");
+    m_runAheadFrames = 0;
+  }
+}
+
 void CGameClientReversiblePlayback::RewindFrames(unsigned int frames)
 {
   CSingleLock lock(m_mutex);
@@ -317,7 +359,9 @@ void CGameClientReversiblePlayback::UpdateMemoryStream()
 
     if (!m_memoryStream)
     {
-      m_memoryStream.reset(new CDeltaPairMemoryStream);
+      CCompressedMemoryStream* memoryStream = new CCompressedMemoryStream;
+      memoryStream->SetMemoryLimit(static_cast<size_t>(g_advancedSettings.m_gamesRewindMemory) * 1024 * 1024);
+      m_memoryStream.reset(memoryStream);
       m_memoryStream->Init(m_gameClient->SerializeSize(), frameCount);
     }
 
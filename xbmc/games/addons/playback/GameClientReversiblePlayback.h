@@ -27,6 +27,7 @@
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
+#include <vector>
 
 namespace KODI
 {
@@ -68,6 +69,7 @@ namespace GAME
 
   private:
     void AddFrame();
+    void RunAhead();
     void RewindFrames(unsigned int frames);
     void AdvanceFrames(unsigned int frames);
     void UpdatePlaybackStats();
@@ -81,6 +83,10 @@ namespace GAME
     std::unique_ptr<IMemoryStream> m_memoryStream;
     CCriticalSection               m_mutex;
 
+    // Run-ahead functionality
+    unsigned int         m_runAheadFrames;
+    std::vector<uint8_t> m_runAheadState;
+
     // Savestate functionality
     std::unique_ptr<CSavestateWriter> m_savestateWriter;
     std::unique_ptr<CSavestateReader> m_savestateReader;
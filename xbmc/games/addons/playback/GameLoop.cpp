@@ -23,6 +23,7 @@
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace KODI;
@@ -36,6 +37,7 @@ CGameLoop::CGameLoop(IGameLoopCallback* callback, double fps) :
   m_callback(callback),
   m_fps(fps ? fps : DEFAULT_FPS),
   m_speedFactor(0.0),
+  m_frameDelayMs(0.0),
   m_lastFrameMs(0.0)
 {
 }
@@ -66,6 +68,12 @@ void CGameLoop::SetSpeed(double speedFactor)
   m_sleepEvent.Set();
 }
 
+void CGameLoop::SetFrameDelay(double delayMs)
+{
+  CSingleLock lock(m_mutex);
+  m_frameDelayMs = std::min(std::max(delayMs, 0.0), 1000.0 / m_fps / 2);
+}
+
 void CGameLoop::Process(void)
 {
   double nextFrameMs = NowMs();
@@ -124,10 +132,20 @@ double CGameLoop::FrameTimeMs() const
     return FOREVER_MS;
 }
 
+double CGameLoop::FrameDelayMs() const
+{
+  // Fast-forward and rewind don't need recent input
+  if (m_speedFactor == 1.0)
+    return m_frameDelayMs;
+  else
+    return 0.0;
+}
+
 double CGameLoop::SleepTimeMs(double nowMs) const
 {
-  // Calculate next frame time
-  const double nextFrameMs = m_lastFrameMs + FrameTimeMs();
+  // Calculate next frame time, the frame runs delayed, but the schedule
+  // isn't moved by the delay
+  const double nextFrameMs = m_lastFrameMs + FrameTimeMs() + FrameDelayMs();
 
   // Calculate sleep time
   const double sleepTimeMs = nextFrameMs - nowMs;
@@ -58,18 +58,28 @@ namespace GAME
     double GetSpeed() const { return m_speedFactor; }
     void SetSpeed(double speedFactor);
 
+    /*!
+     * \brief Run frames this much later than scheduled during gameplay
+     *
+     * The game polls more recent input, the frame rate stays the same. The
+     * delay is limited to half a frame to leave time for running it.
+     */
+    void SetFrameDelay(double delayMs);
+
   protected:
     // implementation of CThread
     virtual void Process() override;
 
   private:
     double FrameTimeMs() const;
+    double FrameDelayMs() const;
     double SleepTimeMs(double nowMs) const;
     double NowMs() const;
 
     IGameLoopCallback* const m_callback;
     const double             m_fps;
     double                   m_speedFactor;
+    double                   m_frameDelayMs;
     double                   m_lastFrameMs;
     CEvent                   m_sleepEvent;
     CCriticalSection         m_mutex;
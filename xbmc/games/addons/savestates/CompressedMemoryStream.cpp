@@ -0,0 +1,317 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CompressedMemoryStream.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+#include <lzo/lzo1x.h>
+
+#ifdef TARGET_WINDOWS
+#ifdef NDEBUG
+#pragma comment(lib,"lzo2.lib")
+#elif defined _WIN64
+#pragma comment(lib, "lzo2d.lib")
+#else
+#pragma comment(lib, "lzo2-no_idb.lib")
+#endif
+#endif
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace KODI;
+using namespace GAME;
+
+// A run of changed words continues over this many unchanged words, as
+// starting a new run costs two words
+#define RLE_MAX_GAP  2
+
+namespace
+{
+  // XOR two buffers of 32-bit words, output may be the same as either input
+  void XorWords(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t count)
+  {
+    size_t i = 0;
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(x, y));
+    }
+#endif
+
+    for (; i < count; i++)
+      out[i] = a[i] ^ b[i];
+  }
+
+  // Return the position of the first word that differs, or size if none does
+  size_t FindChange(const uint32_t* a, const uint32_t* b, size_t pos, size_t size)
+  {
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    // Most of a savestate doesn't change from one frame to the next, so skip
+    // four words at a time
+    for (; pos + 4 <= size; pos += 4)
+    {
+      const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + pos));
+      const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + pos));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, y)) != 0xFFFF)
+        break;
+    }
+#endif
+
+    while (pos < size && a[pos] == b[pos])
+      pos++;
+
+    return pos;
+  }
+}
+
+CCompressedMemoryStream::CCompressedMemoryStream(unsigned int keyframeInterval /* = 60 */) :
+  m_keyframeInterval(keyframeInterval),
+  m_framesSinceKeyframe(0),
+  m_memoryLimit(0),
+  m_memoryUsage(0)
+{
+}
+
+void CCompressedMemoryStream::Reset()
+{
+  CLinearMemoryStream::Reset();
+
+  m_rewindBuffer.clear();
+  m_framesSinceKeyframe = 0;
+  m_memoryUsage = 0;
+}
+
+void CCompressedMemoryStream::SetMemoryLimit(size_t maxBytes)
+{
+  m_memoryLimit = maxBytes;
+
+  CullToMemoryLimit();
+}
+
+void CCompressedMemoryStream::SubmitFrameInternal()
+{
+  m_rewindBuffer.push_back(MemoryFrame());
+  MemoryFrame& frame = m_rewindBuffer.back();
+
+  // Record frame history
+  frame.frameHistoryCount = m_currentFrameHistory++;
+
+  // Encode into the scratch buffer so the stored delta is allocated only once
+  // and at its final size
+  EncodeDelta(m_currentFrame.get(), m_nextFrame.get(), m_paddedFrameSize, m_delta);
+  frame.delta.assign(m_delta.begin(), m_delta.end());
+
+  if (m_keyframeInterval > 0 && ++m_framesSinceKeyframe >= m_keyframeInterval)
+  {
+    if (PackKeyframe(m_currentFrame.get(), frame.keyframe))
+      m_framesSinceKeyframe = 0;
+  }
+
+  m_memoryUsage += FrameMemory(frame);
+
+  // Delta is generated, bring the new frame forward (m_nextFrame is now disposable)
+  std::swap(m_currentFrame, m_nextFrame);
+
+  m_bHasNextFrame = false;
+
+  if (PastFramesAvailable() + 1 > MaxFrameCount())
+    CullPastFrames(1);
+
+  CullToMemoryLimit();
+}
+
+unsigned int CCompressedMemoryStream::PastFramesAvailable() const
+{
+  return static_cast<unsigned int>(m_rewindBuffer.size());
+}
+
+unsigned int CCompressedMemoryStream::RewindFrames(unsigned int frameCount)
+{
+  const unsigned int rewound = std::min(frameCount, PastFramesAvailable());
+  if (rewound == 0)
+    return 0;
+
+  const size_t target = m_rewindBuffer.size() - rewound;
+
+  // Start from the oldest keyframe at or after the target, so at most one
+  // keyframe interval of deltas has to be applied
+  size_t position = m_rewindBuffer.size();
+  for (size_t i = target; i < m_rewindBuffer.size(); i++)
+  {
+    if (!m_rewindBuffer[i].keyframe.empty())
+    {
+      // m_nextFrame is disposable between frames
+      if (UnpackKeyframe(m_rewindBuffer[i].keyframe, m_nextFrame.get()))
+      {
+        std::swap(m_currentFrame, m_nextFrame);
+        position = i;
+      }
+      break;
+    }
+  }
+
+  while (position > target)
+    ApplyDelta(m_rewindBuffer[--position].delta, m_currentFrame.get(), m_paddedFrameSize);
+
+  // Restore frame history
+  m_currentFrameHistory = m_rewindBuffer[target].frameHistoryCount;
+
+  while (m_rewindBuffer.size() > target)
+  {
+    m_memoryUsage -= FrameMemory(m_rewindBuffer.back());
+    m_rewindBuffer.pop_back();
+  }
+
+  // The next keyframe is due one interval after the last one kept
+  m_framesSinceKeyframe = 0;
+  for (auto it = m_rewindBuffer.rbegin(); it != m_rewindBuffer.rend() && it->keyframe.empty(); ++it)
+  {
+    if (++m_framesSinceKeyframe >= m_keyframeInterval)
+      break;
+  }
+
+  return rewound;
+}
+
+void CCompressedMemoryStream::CullPastFrames(unsigned int frameCount)
+{
+  for (unsigned int removedCount = 0; removedCount < frameCount; removedCount++)
+  {
+    if (m_rewindBuffer.empty())
+    {
+      CLog::Log(LOGDEBUG, "CCompressedMemoryStream: Tried to cull %d frames too many. Check your math!", frameCount - removedCount);
+      break;
+    }
+    m_memoryUsage -= FrameMemory(m_rewindBuffer.front());
+    m_rewindBuffer.pop_front();
+  }
+}
+
+void CCompressedMemoryStream::CullToMemoryLimit()
+{
+  // Keep at least one frame to rewind to
+  while (m_memoryLimit > 0 && m_memoryUsage > m_memoryLimit && m_rewindBuffer.size() > 1)
+    CullPastFrames(1);
+}
+
+void CCompressedMemoryStream::EncodeDelta(const uint32_t* frame, const uint32_t* nextFrame, size_t size, std::vector<uint32_t>& delta)
+{
+  // The delta is a sequence of runs: the number of unchanged words to skip,
+  // the number of changed words and the XOR of the changed words
+  delta.clear();
+
+  size_t pos = 0;
+  while (true)
+  {
+    const size_t start = FindChange(frame, nextFrame, pos, size);
+    if (start == size)
+      break;
+
+    size_t end = start + 1;
+    for (size_t i = end; i < size && i - end < RLE_MAX_GAP; i++)
+    {
+      if (frame[i] != nextFrame[i])
+        end = i + 1;
+    }
+
+    const size_t count = end - start;
+    const size_t offset = delta.size();
+    delta.resize(offset + 2 + count);
+    delta[offset] = static_cast<uint32_t>(start - pos);
+    delta[offset + 1] = static_cast<uint32_t>(count);
+    XorWords(frame + start, nextFrame + start, delta.data() + offset + 2, count);
+
+    pos = end;
+  }
+}
+
+void CCompressedMemoryStream::ApplyDelta(const std::vector<uint32_t>& delta, uint32_t* frame, size_t size)
+{
+  const uint32_t* run = delta.data();
+  const uint32_t* const end = run + delta.size();
+
+  size_t pos = 0;
+  while (end - run >= 2)
+  {
+    pos += run[0];
+    const size_t count = run[1];
+    run += 2;
+
+    if (static_cast<size_t>(end - run) < count || size - pos < count)
+      break; // Can't happen for deltas created by EncodeDelta()
+
+    XorWords(frame + pos, run, frame + pos, count);
+
+    pos += count;
+    run += count;
+  }
+}
+
+bool CCompressedMemoryStream::PackKeyframe(const uint32_t* frame, std::vector<uint8_t>& keyframe)
+{
+  const lzo_uint size = static_cast<lzo_uint>(m_paddedFrameSize * sizeof(uint32_t));
+
+  if (!m_lzoWorkMem)
+  {
+    if (lzo_init() != LZO_E_OK)
+    {
+      CLog::Log(LOGERROR, "CCompressedMemoryStream: failed to initialize lzo");
+      return false;
+    }
+    m_lzoWorkMem.reset(new uint8_t[LZO1X_1_MEM_COMPRESS]);
+  }
+
+  m_packed.resize(size + size / 16 + 64 + 3); // see simple.c in lzo
+
+  lzo_uint packedSize = static_cast<lzo_uint>(m_packed.size());
+  if (lzo1x_1_compress(reinterpret_cast<const uint8_t*>(frame), size, m_packed.data(), &packedSize, m_lzoWorkMem.get()) != LZO_E_OK)
+    return false;
+
+  keyframe.assign(m_packed.begin(), m_packed.begin() + packedSize);
+
+  return true;
+}
+
+bool CCompressedMemoryStream::UnpackKeyframe(const std::vector<uint8_t>& keyframe, uint32_t* frame) const
+{
+  const lzo_uint size = static_cast<lzo_uint>(m_paddedFrameSize * sizeof(uint32_t));
+
+  lzo_uint unpackedSize = size;
+  if (lzo1x_decompress_safe(keyframe.data(), static_cast<lzo_uint>(keyframe.size()), reinterpret_cast<uint8_t*>(frame), &unpackedSize, nullptr) != LZO_E_OK ||
+      unpackedSize != size)
+  {
+    CLog::Log(LOGERROR, "CCompressedMemoryStream: failed to unpack keyframe");
+    return false;
+  }
+
+  return true;
+}
+
+size_t CCompressedMemoryStream::FrameMemory(const MemoryFrame& frame)
+{
+  return sizeof(MemoryFrame) + frame.delta.capacity() * sizeof(uint32_t) + frame.keyframe.capacity();
+}
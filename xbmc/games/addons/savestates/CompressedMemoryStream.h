@@ -0,0 +1,110 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "LinearMemoryStream.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace KODI
+{
+namespace GAME
+{
+  /*!
+   * \brief Implementation of a linear memory stream using compressed XOR
+   *        deltas and periodic keyframes
+   *
+   * Like CDeltaPairMemoryStream, every past frame is stored as the XOR delta
+   * to the frame after it. The deltas are run-length encoded: unchanged words
+   * are skipped and changed words are stored in runs, which takes a fraction
+   * of the memory of a position per changed word and allows diffing and
+   * applying them with SIMD.
+   *
+   * Every few frames, the full state is kept as well, packed with LZO. When
+   * rewinding far, the closest keyframe is restored instead of applying all
+   * deltas in between.
+   *
+   * Besides the frame count, the stream can be limited by the memory used by
+   * past frames, so the length of the rewind buffer adapts to the size and
+   * volatility of the savestates.
+   */
+  class CCompressedMemoryStream : public CLinearMemoryStream
+  {
+  public:
+    /*!
+     * \param keyframeInterval Number of frames between keyframes, or 0 to
+     *        disable keyframes
+     */
+    explicit CCompressedMemoryStream(unsigned int keyframeInterval = 60);
+
+    virtual ~CCompressedMemoryStream() = default;
+
+    // implementation of IMemoryStream via CLinearMemoryStream
+    virtual void         Reset() override;
+    virtual unsigned int PastFramesAvailable() const override;
+    virtual unsigned int RewindFrames(unsigned int frameCount) override;
+
+    /*!
+     * \brief Limit the memory used by past frames
+     *
+     * \param maxBytes The memory limit, or 0 for no limit
+     */
+    void SetMemoryLimit(size_t maxBytes);
+
+    /*!
+     * \brief Return the memory currently used by past frames
+     */
+    size_t MemoryUsage() const { return m_memoryUsage; }
+
+  protected:
+    // implementation of CLinearMemoryStream
+    virtual void SubmitFrameInternal() override;
+    virtual void CullPastFrames(unsigned int frameCount) override;
+
+  private:
+    struct MemoryFrame
+    {
+      std::vector<uint32_t> delta;    // Run-length encoded delta to the next frame
+      std::vector<uint8_t>  keyframe; // LZO packed frame, or empty
+      uint64_t              frameHistoryCount;
+    };
+
+    static void EncodeDelta(const uint32_t* frame, const uint32_t* nextFrame, size_t size, std::vector<uint32_t>& delta);
+    static void ApplyDelta(const std::vector<uint32_t>& delta, uint32_t* frame, size_t size);
+    bool PackKeyframe(const uint32_t* frame, std::vector<uint8_t>& keyframe);
+    bool UnpackKeyframe(const std::vector<uint8_t>& keyframe, uint32_t* frame) const;
+    static size_t FrameMemory(const MemoryFrame& frame);
+    void CullToMemoryLimit();
+
+    const unsigned int m_keyframeInterval;
+    std::deque<MemoryFrame> m_rewindBuffer;
+    unsigned int m_framesSinceKeyframe;
+    size_t m_memoryLimit;
+    size_t m_memoryUsage;
+
+    // Scratch buffers, kept to avoid allocations per frame
+    std::vector<uint32_t> m_delta;
+    std::vector<uint8_t> m_packed;
+    std::unique_ptr<uint8_t[]> m_lzoWorkMem;
+  };
+}
+}
@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "games/addons/savestates/CompressedMemoryStream.h"
+#include "games/addons/savestates/DeltaPairMemoryStream.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+using namespace KODI;
+using namespace GAME;
+
+namespace
+{
+  // Not a multiple of 4 to test padding
+  const size_t FRAME_SIZE = 256 * 1024 + 3;
+  const unsigned int FRAME_COUNT = 200;
+}
+
+class TestCompressedMemoryStream : public testing::Test
+{
+protected:
+  TestCompressedMemoryStream()
+  {
+    // Synthetic savestates: random memory with scattered changes and a
+    // moving block, like RAM and a framebuffer
+    std::mt19937 rng(0);
+    std::vector<uint8_t> state(FRAME_SIZE);
+    for (auto& byte : state)
+      byte = static_cast<uint8_t>(rng());
+
+    for (unsigned int frame = 0; frame < FRAME_COUNT; frame++)
+    {
+      for (unsigned int i = 0; i < 2000; i++)
+        state[rng() % FRAME_SIZE] ^= static_cast<uint8_t>(rng());
+      for (unsigned int i = 0; i < 4096; i++)
+        state[16384 + frame * 16 + i]++;
+      m_states.push_back(state);
+    }
+  }
+
+  void Submit(IMemoryStream& stream, unsigned int first, unsigned int last)
+  {
+    for (unsigned int frame = first; frame < last; frame++)
+    {
+      memcpy(stream.BeginFrame(), m_states[frame].data(), FRAME_SIZE);
+      stream.SubmitFrame();
+    }
+  }
+
+  bool IsFrame(const IMemoryStream& stream, unsigned int frame)
+  {
+    return stream.CurrentFrame() != nullptr && memcmp(stream.CurrentFrame(), m_states[frame].data(), FRAME_SIZE) == 0;
+  }
+
+  std::vector<std::vector<uint8_t>> m_states;
+};
+
+TEST_F(TestCompressedMemoryStream, Rewind)
+{
+  CCompressedMemoryStream stream(16);
+  stream.Init(FRAME_SIZE, FRAME_COUNT);
+  Submit(stream, 0, FRAME_COUNT);
+  EXPECT_EQ(FRAME_COUNT - 1, stream.PastFramesAvailable());
+  EXPECT_TRUE(IsFrame(stream, FRAME_COUNT - 1));
+
+  // Single frames and jumps over keyframes
+  unsigned int frame = FRAME_COUNT - 1;
+  for (unsigned int frames : { 1, 3, 16, 40, 1, 7 })
+  {
+    EXPECT_EQ(frames, stream.RewindFrames(frames));
+    frame -= frames;
+    EXPECT_TRUE(IsFrame(stream, frame));
+    EXPECT_EQ(static_cast<uint64_t>(frame), stream.GetFrameCounter());
+  }
+
+  // Playing on after a rewind
+  Submit(stream, frame + 1, FRAME_COUNT);
+  EXPECT_TRUE(IsFrame(stream, FRAME_COUNT - 1));
+
+  EXPECT_EQ(FRAME_COUNT - 1, stream.RewindFrames(FRAME_COUNT));
+  EXPECT_TRUE(IsFrame(stream, 0));
+  EXPECT_EQ(0U, stream.PastFramesAvailable());
+  EXPECT_EQ(0U, stream.MemoryUsage());
+}
+
+TEST_F(TestCompressedMemoryStream, MaxFrameCount)
+{
+  CCompressedMemoryStream stream;
+  stream.Init(FRAME_SIZE, 50);
+  Submit(stream, 0, FRAME_COUNT);
+  EXPECT_EQ(49U, stream.PastFramesAvailable());
+
+  stream.SetMaxFrameCount(20);
+  EXPECT_EQ(19U, stream.PastFramesAvailable());
+  EXPECT_EQ(19U, stream.RewindFrames(100));
+  EXPECT_TRUE(IsFrame(stream, FRAME_COUNT - 20));
+}
+
+TEST_F(TestCompressedMemoryStream, MemoryLimit)
+{
+  const size_t limit = 8 * FRAME_SIZE;
+
+  CCompressedMemoryStream stream(16);
+  stream.Init(FRAME_SIZE, FRAME_COUNT);
+  stream.SetMemoryLimit(limit);
+  Submit(stream, 0, FRAME_COUNT);
+  EXPECT_LE(stream.MemoryUsage(), limit);
+
+  const unsigned int past = stream.PastFramesAvailable();
+  EXPECT_GT(past, 0U);
+  EXPECT_LT(past, FRAME_COUNT - 1);
+  EXPECT_EQ(past, stream.RewindFrames(past));
+  EXPECT_TRUE(IsFrame(stream, FRAME_COUNT - 1 - past));
+}
+
+TEST_F(TestCompressedMemoryStream, Benchmark)
+{
+  CCompressedMemoryStream compressed;
+  CDeltaPairMemoryStream deltaPair;
+  IMemoryStream* streams[] = { &compressed, &deltaPair };
+  const char* names[] = { "compressed", "deltapair" };
+
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    IMemoryStream& stream = *streams[i];
+    stream.Init(FRAME_SIZE, FRAME_COUNT);
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    Submit(stream, 0, FRAME_COUNT);
+    const unsigned int submitMs = XbmcThreads::SystemClockMillis() - start;
+
+    start = XbmcThreads::SystemClockMillis();
+    stream.RewindFrames(FRAME_COUNT / 2);
+    const unsigned int rewindMs = XbmcThreads::SystemClockMillis() - start;
+
+    EXPECT_TRUE(IsFrame(stream, FRAME_COUNT / 2 - 1));
+
+    RecordProperty(std::string(names[i]) + "_submit_ms", submitMs);
+    RecordProperty(std::string(names[i]) + "_rewind_ms", rewindMs);
+  }
+
+  RecordProperty("compressed_bytes_per_frame", static_cast<int>(compressed.MemoryUsage() / compressed.PastFramesAvailable()));
+}
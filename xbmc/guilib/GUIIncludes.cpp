@@ -108,6 +108,10 @@ void CGUIIncludes::Clear()
 
 void CGUIIncludes::Load(const std::string &file)
 {
+  // nothing new to flatten
+  if (HasLoaded(file))
+    return;
+
   if (!Load_Internal(file))
     return;
   FlattenExpressions();
@@ -149,7 +149,7 @@ public:
   CGUIListItemLayout *GetFocusedLayout();
 
   void FreeIcons();
-  void FreeMemory(bool immediately = false);
+  virtual void FreeMemory(bool immediately = false);
   void SetInvalid();
 
   bool m_bIsFolder;     ///< is item a folder or a file
@@ -142,33 +142,65 @@ bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLowerPath)
 {
-  // load window xml if we don't have it stored yet
-  if (!m_windowXMLRootElement)
+  int64_t start = CurrentHostCounter();
+
+  // a window resolved before, saves parsing and resolving includes
+  std::unique_ptr<TiXmlElement> preparedRoot;
+  bool cached = false;
+  if (g_SkinInfo)
   {
-    CXBMCTinyXML xmlDoc;
-    std::string strPathLower = strPath;
-    StringUtils::ToLower(strPathLower);
-    if (!xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(strPathLower) && !xmlDoc.LoadFile(strLowerPath))
-    {
-      CLog::Log(LOGERROR, "Unable to load window XML: %s. Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
-      SetID(WINDOW_INVALID);
-      return false;
-    }
+    preparedRoot = g_SkinInfo->GetCachedWindow(strPath, &m_xmlIncludeConditions);
+    cached = preparedRoot != nullptr;
+  }
 
-    // xml need a <window> root element
-    if (!StringUtils::EqualsNoCase(xmlDoc.RootElement()->Value(), "window"))
+  int64_t parsed = start;
+  if (!cached)
+  {
+    // load window xml if we don't have it stored yet
+    if (!m_windowXMLRootElement)
     {
-      CLog::Log(LOGERROR, "XML file %s does not contain a <window> root element", GetProperty("xmlfile").c_str());
-      return false;
+      CXBMCTinyXML xmlDoc;
+      std::string strPathLower = strPath;
+      StringUtils::ToLower(strPathLower);
+      if (!xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(strPathLower) && !xmlDoc.LoadFile(strLowerPath))
+      {
+        CLog::Log(LOGERROR, "Unable to load window XML: %s. Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
+        SetID(WINDOW_INVALID);
+        return false;
+      }
+
+      // xml need a <window> root element
+      if (!StringUtils::EqualsNoCase(xmlDoc.RootElement()->Value(), "window"))
+      {
+        CLog::Log(LOGERROR, "XML file %s does not contain a <window> root element", GetProperty("xmlfile").c_str());
+        return false;
+      }
+
+      // store XML for further processing if window's load type is LOAD_EVERY_TIME or a reload is needed
+      m_windowXMLRootElement = static_cast<TiXmlElement*>(xmlDoc.RootElement()->Clone());
     }
+    else
+      CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-    // store XML for further processing if window's load type is LOAD_EVERY_TIME or a reload is needed
-    m_windowXMLRootElement = static_cast<TiXmlElement*>(xmlDoc.RootElement()->Clone());
+    parsed = CurrentHostCounter();
+    preparedRoot = Prepare(m_windowXMLRootElement);
+    if (preparedRoot && g_SkinInfo)
+      g_SkinInfo->CacheWindow(strPath, preparedRoot.get(), m_xmlIncludeConditions);
   }
+
+  int64_t prepared = CurrentHostCounter();
+  bool ret = Load(preparedRoot.get());
+
+  int64_t end = CurrentHostCounter();
+  double ms = 1000.0 / CurrentHostFrequency();
+  if (cached)
+    CLog::Log(LOGDEBUG, "Window %s loaded in %.2fms (cached xml %.2fms, controls %.2fms)", strPath.c_str(),
+              (end - start) * ms, (prepared - start) * ms, (end - prepared) * ms);
   else
-    CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
+    CLog::Log(LOGDEBUG, "Window %s loaded in %.2fms (parse %.2fms, resolve %.2fms, controls %.2fms)", strPath.c_str(),
+              (end - start) * ms, (parsed - start) * ms, (prepared - parsed) * ms, (end - prepared) * ms);
 
-  return Load(Prepare(m_windowXMLRootElement).get());
+  return ret;
 }
 
 std::unique_ptr<TiXmlElement> CGUIWindow::Prepare(TiXmlElement *pRootElement)
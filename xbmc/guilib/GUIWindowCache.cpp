@@ -0,0 +1,450 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIWindowCache.h"
+
+#include <map>
+
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/BinarySerializer.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#define SKINCACHE_DIRECTORY "special://temp/skincache/"
+#define SKINCACHE_MAGIC     "KSWC"
+#define SKINCACHE_VERSION   1
+// upper limits to reject broken entries early
+#define SKINCACHE_MAX_SIZE  (16 * 1024 * 1024)
+#define SKINCACHE_MAX_DEPTH 256
+#define SKINCACHE_MAX_ITEMS 1000
+#define SKINCACHE_MAX_FILES 500
+
+namespace
+{
+
+// number of entries in the cache directory, counted when the first entry is added
+CCriticalSection g_cacheFilesSection;
+std::string g_cacheDirectory = SKINCACHE_DIRECTORY;
+int g_cacheFiles = -1;
+
+enum NodeType : uint8_t
+{
+  NODE_ELEMENT = 0,
+  NODE_TEXT,
+  NODE_CDATA
+};
+
+/*!
+ \brief Writes the nodes of a window depth first. Names and values are written
+ to a string table once and referenced by index, as the same few dozen tags and
+ attributes make up most of a window.
+ */
+class CTreeWriter
+{
+public:
+  CTreeWriter() : m_writer(m_nodes) {}
+
+  void WriteNode(const TiXmlNode *node)
+  {
+    const TiXmlText *text = node->ToText();
+    if (text)
+    {
+      m_writer.Write(static_cast<uint8_t>(text->CDATA() ? NODE_CDATA : NODE_TEXT));
+      m_writer.Write(Intern(text->ValueStr()));
+      return;
+    }
+
+    const TiXmlElement *element = node->ToElement();
+    m_writer.Write(static_cast<uint8_t>(NODE_ELEMENT));
+    m_writer.Write(Intern(element->ValueStr()));
+
+    uint16_t attributes = 0;
+    for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+      attributes++;
+    m_writer.Write(attributes);
+    for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    {
+      m_writer.Write(Intern(attribute->Name()));
+      m_writer.Write(Intern(attribute->ValueStr()));
+    }
+
+    // comments and declarations don't matter to the controls
+    uint32_t children = 0;
+    for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+    {
+      if (child->ToElement() || child->ToText())
+        children++;
+    }
+    m_writer.Write(children);
+    for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+    {
+      if (child->ToElement() || child->ToText())
+        WriteNode(child);
+    }
+  }
+
+  void Finish(CBinaryWriter &writer) const
+  {
+    writer.WriteStrings(m_strings);
+    writer.WriteArray(m_nodes.c_str(), m_nodes.size());
+  }
+
+private:
+  uint32_t Intern(const std::string &value)
+  {
+    auto it = m_index.find(value);
+    if (it != m_index.end())
+      return it->second;
+
+    uint32_t index = static_cast<uint32_t>(m_strings.size());
+    m_strings.push_back(value);
+    m_index.insert(std::make_pair(value, index));
+    return index;
+  }
+
+  std::map<std::string, uint32_t> m_index;
+  std::vector<std::string> m_strings;
+  std::string m_nodes;
+  CBinaryWriter m_writer;
+};
+
+class CTreeReader
+{
+public:
+  explicit CTreeReader(CBinaryReader &reader) : m_reader(reader) {}
+
+  bool ReadStrings()
+  {
+    return m_reader.ReadStrings(m_strings, SKINCACHE_MAX_SIZE / sizeof(uint32_t));
+  }
+
+  std::unique_ptr<TiXmlNode> ReadNode(int depth)
+  {
+    uint8_t type;
+    const std::string *value;
+    if (depth > SKINCACHE_MAX_DEPTH || !m_reader.Read(type) || !ReadString(value))
+      return nullptr;
+
+    if (type == NODE_TEXT || type == NODE_CDATA)
+    {
+      std::unique_ptr<TiXmlText> text(new TiXmlText(*value));
+      text->SetCDATA(type == NODE_CDATA);
+      return std::move(text);
+    }
+    else if (type != NODE_ELEMENT)
+      return nullptr;
+
+    std::unique_ptr<TiXmlElement> element(new TiXmlElement(*value));
+
+    uint16_t attributes;
+    if (!m_reader.Read(attributes))
+      return nullptr;
+    for (uint16_t i = 0; i < attributes; i++)
+    {
+      const std::string *name;
+      const std::string *attribute;
+      if (!ReadString(name) || !ReadString(attribute))
+        return nullptr;
+      element->SetAttribute(*name, *attribute);
+    }
+
+    uint32_t children;
+    if (!m_reader.Read(children))
+      return nullptr;
+    for (uint32_t i = 0; i < children; i++)
+    {
+      std::unique_ptr<TiXmlNode> child = ReadNode(depth + 1);
+      if (!child)
+        return nullptr;
+      element->LinkEndChild(child.release());
+    }
+
+    return std::move(element);
+  }
+
+private:
+  bool ReadString(const std::string *&value)
+  {
+    uint32_t index;
+    if (!m_reader.Read(index) || index >= m_strings.size())
+      return false;
+    value = &m_strings[index];
+    return true;
+  }
+
+  CBinaryReader &m_reader;
+  std::vector<std::string> m_strings;
+};
+
+/*!
+ \brief Maps a local file into memory, the entries are read once front to back
+ and the pages come straight from the page cache. Falls back to reading the
+ file where mmap isn't available.
+ */
+class CMappedFile
+{
+public:
+  CMappedFile() : m_data(nullptr), m_size(0), m_mapped(false) {}
+
+  ~CMappedFile()
+  {
+#if defined(TARGET_POSIX)
+    if (m_mapped)
+      munmap(const_cast<char*>(m_data), m_size);
+#endif
+  }
+
+  bool Open(const std::string &path)
+  {
+#if defined(TARGET_POSIX)
+    int fd = open(CSpecialProtocol::TranslatePath(path).c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size <= SKINCACHE_MAX_SIZE)
+    {
+      void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        m_data = static_cast<const char*>(data);
+        m_size = st.st_size;
+        m_mapped = true;
+      }
+    }
+    close(fd);
+    return m_mapped;
+#else
+    XFILE::CFile file;
+    if (!file.Open(path))
+      return false;
+
+    int64_t length = file.GetLength();
+    if (length <= 0 || length > SKINCACHE_MAX_SIZE)
+      return false;
+
+    m_buffer.resize(static_cast<size_t>(length));
+    if (file.Read(&m_buffer[0], m_buffer.size()) != static_cast<ssize_t>(m_buffer.size()))
+      return false;
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#endif
+  }
+
+  const char* GetData() const { return m_data; }
+  size_t GetSize() const { return m_size; }
+
+private:
+  const char *m_data;
+  size_t m_size;
+  bool m_mapped;
+  std::string m_buffer;
+};
+
+}
+
+bool CGUIWindowCache::Load(const std::string &path, SEntry &entry) const
+{
+  int64_t size, modified;
+  if (m_skinKey.empty() || !GetFileInfo(path, size, modified))
+    return false;
+
+  std::string cacheFile = GetCacheFile(GetDirectory(), path);
+  if (!XFILE::CFile::Exists(cacheFile))
+    return false;
+
+  CMappedFile file;
+  if (!file.Open(cacheFile))
+    return false;
+
+  CBinaryReader reader(file.GetData(), file.GetSize());
+
+  uint32_t version;
+  std::string skinKey, windowPath;
+  int64_t windowSize, windowModified;
+  if (!reader.ReadMagic(SKINCACHE_MAGIC) ||
+      !reader.Read(version) || version != SKINCACHE_VERSION ||
+      !reader.ReadString(skinKey) || skinKey != m_skinKey ||
+      !reader.ReadString(windowPath) || windowPath != path ||
+      !reader.Read(windowSize) || windowSize != size ||
+      !reader.Read(windowModified) || windowModified != modified)
+    return false;
+
+  uint32_t count;
+  if (!reader.Read(count) || count > SKINCACHE_MAX_ITEMS)
+    return false;
+  entry.conditions.resize(count);
+  for (auto &condition : entry.conditions)
+  {
+    uint8_t value;
+    if (!reader.ReadString(condition.first) || !reader.Read(value))
+      return false;
+    condition.second = value != 0;
+  }
+
+  if (!reader.ReadStrings(entry.includeFiles, SKINCACHE_MAX_ITEMS))
+    return false;
+
+  CTreeReader tree(reader);
+  if (!tree.ReadStrings())
+    return false;
+
+  std::unique_ptr<TiXmlNode> root = tree.ReadNode(0);
+  if (!root || !root->ToElement() || !reader.AtEnd())
+  {
+    CLog::Log(LOGWARNING, "CGUIWindowCache::%s - invalid entry for %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+
+  entry.window.reset(root.release()->ToElement());
+  return true;
+}
+
+bool CGUIWindowCache::Store(const std::string &path, const TiXmlElement &window,
+                            const std::vector<std::pair<std::string, bool>> &conditions,
+                            const std::vector<std::string> &includeFiles) const
+{
+  int64_t size, modified;
+  if (m_skinKey.empty() || !GetFileInfo(path, size, modified) ||
+      conditions.size() > SKINCACHE_MAX_ITEMS || includeFiles.size() > SKINCACHE_MAX_ITEMS)
+    return false;
+
+  std::string data;
+  CBinaryWriter writer(data);
+  writer.WriteMagic(SKINCACHE_MAGIC);
+  writer.Write(static_cast<uint32_t>(SKINCACHE_VERSION));
+  writer.WriteString(m_skinKey);
+  writer.WriteString(path);
+  writer.Write(size);
+  writer.Write(modified);
+
+  writer.Write(static_cast<uint32_t>(conditions.size()));
+  for (const auto &condition : conditions)
+  {
+    writer.WriteString(condition.first);
+    writer.Write(static_cast<uint8_t>(condition.second ? 1 : 0));
+  }
+
+  writer.WriteStrings(includeFiles);
+
+  CTreeWriter tree;
+  tree.WriteNode(&window);
+  tree.Finish(writer);
+
+  if (data.size() > SKINCACHE_MAX_SIZE)
+    return false;
+
+  std::string directory = GetDirectory();
+  if (!XFILE::CDirectory::Exists(directory))
+    XFILE::CDirectory::Create(directory);
+
+  std::string cacheFile = GetCacheFile(directory, path);
+  bool added = !XFILE::CFile::Exists(cacheFile);
+  XFILE::CFile file;
+  if (!file.OpenForWrite(cacheFile, true) ||
+      file.Write(data.c_str(), data.size()) != static_cast<ssize_t>(data.size()))
+  {
+    CLog::Log(LOGWARNING, "CGUIWindowCache::%s - failed to write %s", __FUNCTION__, cacheFile.c_str());
+    file.Close();
+    XFILE::CFile::Delete(cacheFile);
+    return false;
+  }
+  file.Close();
+
+  CLog::Log(LOGDEBUG, "CGUIWindowCache::%s - stored %zu bytes for %s", __FUNCTION__, data.size(), path.c_str());
+
+  // only a new entry can exceed the limit
+  if (!added)
+    return true;
+
+  CSingleLock lock(g_cacheFilesSection);
+  if (directory != g_cacheDirectory)
+    return true;
+  if (g_cacheFiles < 0 || ++g_cacheFiles > SKINCACHE_MAX_FILES)
+    g_cacheFiles = Prune(directory);
+  return true;
+}
+
+void CGUIWindowCache::SetDirectory(const std::string &directory)
+{
+  CSingleLock lock(g_cacheFilesSection);
+  g_cacheDirectory = directory.empty() ? SKINCACHE_DIRECTORY : directory;
+  g_cacheFiles = -1;
+}
+
+std::string CGUIWindowCache::GetDirectory()
+{
+  CSingleLock lock(g_cacheFilesSection);
+  return g_cacheDirectory;
+}
+
+bool CGUIWindowCache::GetFileInfo(const std::string &path, int64_t &size, int64_t &modified) const
+{
+  // without a modification time a changed window couldn't be told apart
+  struct __stat64 buffer;
+  if (XFILE::CFile::Stat(path, &buffer) != 0 || buffer.st_mtime == 0)
+    return false;
+
+  size = buffer.st_size;
+  modified = buffer.st_mtime;
+  return true;
+}
+
+std::string CGUIWindowCache::GetCacheFile(const std::string &directory, const std::string &path)
+{
+  return URIUtils::AddFileToFolder(directory, StringUtils::Format("%08x.bin", static_cast<uint32_t>(Crc32::Compute(path))));
+}
+
+int CGUIWindowCache::Prune(const std::string &directory)
+{
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(directory, items, ".bin", XFILE::DIR_FLAG_NO_FILE_DIRS))
+    return 0;
+
+  int count = items.Size();
+  if (count <= SKINCACHE_MAX_FILES)
+    return count;
+
+  // drop the oldest entries, mostly windows of skins which aren't used anymore
+  items.Sort(SortByDate, SortOrderAscending);
+  for (int i = 0; i < items.Size() - SKINCACHE_MAX_FILES; i++)
+  {
+    if (XFILE::CFile::Delete(items[i]->GetPath()))
+      count--;
+  }
+  return count;
+}
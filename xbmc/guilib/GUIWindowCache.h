@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TiXmlElement;
+
+/*!
+ \brief Stores window XML with all includes, constants, variables and expressions
+ resolved, so opening a window again doesn't have to parse and resolve it.
+
+ Entries are kept in special://temp/skincache/ in a compact binary format and
+ are read from a memory mapped file. An entry is valid for the skin key it was
+ stored with, which covers the skin version and its include files, and for the
+ size and modification time of the window XML.
+ */
+class CGUIWindowCache
+{
+public:
+  struct SEntry
+  {
+    std::unique_ptr<TiXmlElement> window;
+    std::vector<std::pair<std::string, bool>> conditions; //!< include conditions and the values they were resolved with
+    std::vector<std::string> includeFiles;                //!< include files loaded while resolving
+  };
+
+  /*!
+   \brief Set the key of the loaded skin, entries stored with another key are ignored
+   */
+  void SetSkinKey(const std::string &key) { m_skinKey = key; }
+  const std::string& GetSkinKey() const { return m_skinKey; }
+
+  /*!
+   \brief Load the resolved window
+   \param path the window XML the entry was stored for
+   \param entry [out] the resolved window and what it was resolved with
+   \return false if there is no valid entry
+   */
+  bool Load(const std::string &path, SEntry &entry) const;
+
+  /*!
+   \brief Store the resolved window
+   \param path the window XML
+   \param window the window with includes resolved
+   \param conditions include conditions and the values they were resolved with
+   \param includeFiles include files loaded while resolving
+   */
+  bool Store(const std::string &path, const TiXmlElement &window,
+             const std::vector<std::pair<std::string, bool>> &conditions,
+             const std::vector<std::string> &includeFiles) const;
+
+  /*!
+   \brief Keep the entries in another directory from now on
+   \param directory the directory, empty for the default one
+   */
+  static void SetDirectory(const std::string &directory);
+
+private:
+  bool GetFileInfo(const std::string &path, int64_t &size, int64_t &modified) const;
+  static std::string GetDirectory();
+  static std::string GetCacheFile(const std::string &directory, const std::string &path);
+  static int Prune(const std::string &directory);
+
+  std::string m_skinKey;
+};
@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIWindowCache.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+#include <time.h>
+#if defined(TARGET_POSIX)
+#include <utime.h>
+#endif
+
+#define TEMP_PATH "special://temp/TestGUIWindowCache/"
+
+static const char *windowXML =
+  "<window>"
+    "<defaultcontrol always=\"true\">50</defaultcontrol>"
+    "<controls>"
+      "<control type=\"label\" id=\"1\">"
+        "<left>10</left><top>20</top>"
+        "<label><![CDATA[a < b]]></label>"
+        "<visible>Skin.HasSetting(foo) + !Window.IsVisible(home)</visible>"
+      "</control>"
+      "<!-- dropped -->"
+      "<control type=\"group\"><control type=\"image\"><texture>a.png</texture></control></control>"
+    "</controls>"
+  "</window>";
+
+class TestGUIWindowCache : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ASSERT_TRUE(XFILE::CDirectory::Create(TEMP_PATH));
+    m_path = TEMP_PATH "window.xml";
+    ASSERT_TRUE(WriteWindow(windowXML));
+    CGUIWindowCache::SetDirectory(TEMP_PATH "skincache/");
+  }
+
+  void TearDown() override
+  {
+    CGUIWindowCache::SetDirectory("");
+    if (XFILE::CDirectory::Exists(TEMP_PATH))
+      XFILE::CDirectory::RemoveRecursive(TEMP_PATH);
+  }
+
+  bool WriteWindow(const std::string &xml)
+  {
+    XFILE::CFile file;
+    return file.OpenForWrite(m_path, true) &&
+           file.Write(xml.c_str(), xml.size()) == static_cast<ssize_t>(xml.size());
+  }
+
+  static std::string Print(const TiXmlNode *node)
+  {
+    TiXmlPrinter printer;
+    node->Accept(&printer);
+    return printer.Str();
+  }
+
+  std::string m_path;
+};
+
+TEST_F(TestGUIWindowCache, StoreAndLoad)
+{
+  CXBMCTinyXML doc;
+  ASSERT_TRUE(doc.Parse(std::string(windowXML)));
+  doc.RootElement()->FirstChildElement("controls")->RemoveChild(
+    doc.RootElement()->FirstChildElement("controls")->FirstChild()->NextSibling());
+
+  std::vector<std::pair<std::string, bool>> conditions = { { "skin.hassetting(foo)", true }, { "system.platform.linux", false } };
+  std::vector<std::string> includeFiles = { "special://skin/xml/Extra.xml" };
+
+  CGUIWindowCache cache;
+  cache.SetSkinKey("skin.test|1.0.0");
+  ASSERT_TRUE(cache.Store(m_path, *doc.RootElement(), conditions, includeFiles));
+
+  CGUIWindowCache::SEntry entry;
+  ASSERT_TRUE(cache.Load(m_path, entry));
+  ASSERT_TRUE(entry.window != nullptr);
+  EXPECT_EQ(Print(doc.RootElement()), Print(entry.window.get()));
+  EXPECT_EQ(conditions, entry.conditions);
+  EXPECT_EQ(includeFiles, entry.includeFiles);
+
+  const TiXmlElement *label = entry.window->FirstChildElement("controls")->FirstChildElement("control")->FirstChildElement("label");
+  ASSERT_TRUE(label && label->FirstChild() && label->FirstChild()->ToText());
+  EXPECT_TRUE(label->FirstChild()->ToText()->CDATA());
+}
+
+TEST_F(TestGUIWindowCache, OtherSkinKey)
+{
+  CXBMCTinyXML doc;
+  ASSERT_TRUE(doc.Parse(std::string(windowXML)));
+
+  CGUIWindowCache cache;
+  cache.SetSkinKey("skin.test|1.0.0");
+  ASSERT_TRUE(cache.Store(m_path, *doc.RootElement(), {}, {}));
+
+  CGUIWindowCache::SEntry entry;
+  cache.SetSkinKey("skin.test|1.0.1");
+  EXPECT_FALSE(cache.Load(m_path, entry));
+
+  cache.SetSkinKey("");
+  EXPECT_FALSE(cache.Load(m_path, entry));
+}
+
+TEST_F(TestGUIWindowCache, ChangedWindow)
+{
+  CXBMCTinyXML doc;
+  ASSERT_TRUE(doc.Parse(std::string(windowXML)));
+
+  CGUIWindowCache cache;
+  cache.SetSkinKey("skin.test|1.0.0");
+  ASSERT_TRUE(cache.Store(m_path, *doc.RootElement(), {}, {}));
+
+  CGUIWindowCache::SEntry entry;
+  ASSERT_TRUE(cache.Load(m_path, entry));
+  EXPECT_TRUE(XFILE::CDirectory::Exists(TEMP_PATH "skincache/"));
+
+  // another size
+  ASSERT_TRUE(WriteWindow(std::string(windowXML) + "\n"));
+  EXPECT_FALSE(cache.Load(m_path, entry));
+
+#if defined(TARGET_POSIX)
+  // the same size, but modified later on
+  ASSERT_TRUE(WriteWindow(windowXML));
+  ASSERT_TRUE(cache.Store(m_path, *doc.RootElement(), {}, {}));
+  ASSERT_TRUE(cache.Load(m_path, entry));
+
+  struct utimbuf times;
+  times.actime = times.modtime = time(nullptr) + 3600;
+  ASSERT_EQ(0, utime(CSpecialProtocol::TranslatePath(m_path).c_str(), &times));
+  EXPECT_FALSE(cache.Load(m_path, entry));
+#endif
+}
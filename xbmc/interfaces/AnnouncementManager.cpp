@@ -33,10 +33,13 @@
 #include "ServiceBroker.h"
 
 #define LOOKUP_PROPERTY "database-lookup"
+// queue depth from which on a growing announcement backlog is logged
+#define QUEUE_DEPTH_LOG_THRESHOLD 100
 
 using namespace ANNOUNCEMENT;
 
-CAnnouncementManager::CAnnouncementManager() : CThread("Announce")
+CAnnouncementManager::CAnnouncementManager() : CThread("Announce"),
+  m_queuePeakDepth(0)
 {
 }
 
@@ -287,22 +290,33 @@ void CAnnouncementManager::Process()
 {
   SetPriority(GetMinPriority());
 
+  std::list<CAnnounceData> announcements;
   while (!m_bStop)
   {
-    CSingleLock lock (m_critSection);
-    if (!m_announcementQueue.empty())
     {
-      auto announcement = m_announcementQueue.front();
-      m_announcementQueue.pop_front();
+      // take all pending announcements at once instead of locking for every single one
+      CSingleLock lock (m_critSection);
+      announcements.swap(m_announcementQueue);
+
+      if (announcements.size() > m_queuePeakDepth)
       {
-        CSingleExit ex(m_critSection);
-        DoAnnounce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.item, announcement.data);
+        m_queuePeakDepth = announcements.size();
+        if (m_queuePeakDepth >= QUEUE_DEPTH_LOG_THRESHOLD)
+          CLog::Log(LOGDEBUG, "CAnnouncementManager - %zu announcements were waiting to be delivered", m_queuePeakDepth);
       }
     }
-    else
+
+    if (announcements.empty())
     {
-      CSingleExit ex(m_critSection);
       m_queueEvent.Wait();
+      continue;
+    }
+
+    while (!announcements.empty() && !m_bStop)
+    {
+      const CAnnounceData& announcement = announcements.front();
+      DoAnnounce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.item, announcement.data);
+      announcements.pop_front();
     }
   }
 }
@@ -67,6 +67,7 @@ namespace ANNOUNCEMENT
     };
     std::list<CAnnounceData> m_announcementQueue;
     CEvent m_queueEvent;
+    size_t m_queuePeakDepth; ///< highest number of announcements which were waiting to be delivered
 
   private:
     CAnnouncementManager(const CAnnouncementManager&);
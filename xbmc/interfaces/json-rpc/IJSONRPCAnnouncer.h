@@ -19,6 +19,8 @@
  *
  */
 
+#include <string.h>
+
 #include "interfaces/IAnnouncer.h"
 #include "utils/JSONVariantWriter.h"
 #include "utils/Variant.h"
@@ -49,5 +51,38 @@ namespace JSONRPC
 
       return str;
     }
+
+    /*!
+     \brief Get the key under which a notification may be merged with a newer one.
+
+     Only notifications which are sent at a high frequency and which only carry
+     the latest state of something are coalescable. Library updates are merged
+     per item and only if they carry the same set of properties so no
+     information gets lost.
+
+     \return the coalescing key or an empty string if the notification must not be merged
+     */
+    static std::string GetCoalescingKey(ANNOUNCEMENT::AnnouncementFlag flag, const char *method, const CVariant &data)
+    {
+      std::string key = ANNOUNCEMENT::AnnouncementFlagToString(flag);
+      key += ".";
+      key += method;
+
+      if (flag == ANNOUNCEMENT::Application && strcmp(method, "OnVolumeChanged") == 0)
+        return key;
+
+      if ((flag != ANNOUNCEMENT::VideoLibrary && flag != ANNOUNCEMENT::AudioLibrary) ||
+          strcmp(method, "OnUpdate") != 0 ||
+          !data.isObject() || !data.isMember("item") ||
+          !data["item"].isMember("type") || !data["item"].isMember("id"))
+        return "";
+
+      key += "/" + data["item"]["type"].asString();
+      key += "/" + data["item"]["id"].asString();
+      for (CVariant::const_iterator_map it = data.begin_map(); it != data.end_map(); ++it)
+        key += "/" + it->first;
+
+      return key;
+    }
   };
 }
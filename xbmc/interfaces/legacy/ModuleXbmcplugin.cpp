@@ -20,8 +20,10 @@
 
 #include "ModuleXbmcplugin.h"
 
+#include "Exception.h"
 #include "filesystem/PluginDirectory.h"
 #include "FileItem.h"
+#include "utils/StringUtils.h"
 
 namespace XBMCAddon
 {
@@ -60,6 +62,77 @@ namespace XBMCAddon
       return XFILE::CPluginDirectory::AddItems(handle, &fitems, totalItems);
     }
 
+    bool addDirectoryEntries(int handle, const std::vector<DirectoryEntry>& entries, int totalItems)
+    {
+      static const Dictionary<EntryInfoValue> noDictionary;
+      CFileItemList fitems;
+      fitems.Reserve(static_cast<int>(entries.size()));
+      for (const auto& entry : entries)
+      {
+        String url, label, label2, isFolder, mimetype, infoType("video");
+        const Dictionary<EntryInfoValue>* art = &noDictionary;
+        const Dictionary<EntryInfoValue>* properties = &noDictionary;
+        const Dictionary<EntryInfoValue>* info = &noDictionary;
+        for (const auto& it : entry)
+        {
+          if (it.second.which() == second)
+          {
+            if (it.first == "art")
+              art = &it.second.later();
+            else if (it.first == "properties")
+              properties = &it.second.later();
+            else if (it.first == "info")
+              info = &it.second.later();
+          }
+          else if (it.first == "url")
+            url = it.second.former();
+          else if (it.first == "label")
+            label = it.second.former();
+          else if (it.first == "label2")
+            label2 = it.second.former();
+          else if (it.first == "isFolder")
+            isFolder = it.second.former();
+          else if (it.first == "mimetype")
+            mimetype = it.second.former();
+          else if (it.first == "infoType")
+            infoType = it.second.former();
+        }
+
+        // the url is required, as in the tuples of addDirectoryItems()
+        if (url.empty())
+          throw WrongTypeException("Directory entry %d has no url", fitems.Size());
+
+        // an offscreen item doesn't lock the gui for every field set
+        AddonClass::Ref<xbmcgui::ListItem> listItem(new xbmcgui::ListItem(label, label2, emptyString, emptyString, url, true));
+        listItem->item->m_bIsFolder = isFolder == "1" || StringUtils::EqualsNoCase(isFolder, "true");
+        if (!mimetype.empty())
+          listItem->item->SetMimeType(mimetype);
+
+        if (!art->empty())
+        {
+          Properties artDict;
+          for (const auto& it : *art)
+          {
+            if (it.second.which() == first)
+              artDict[it.first] = it.second.former();
+          }
+          listItem->setArt(artDict);
+        }
+        for (const auto& it : *properties)
+        {
+          if (it.second.which() == first)
+            listItem->setProperty(it.first.c_str(), it.second.former());
+        }
+        if (!info->empty())
+          listItem->setInfo(infoType.c_str(), *info);
+
+        fitems.Add(listItem->item);
+      }
+
+      // call the directory class to add our items
+      return XFILE::CPluginDirectory::AddItems(handle, &fitems, totalItems);
+    }
+
     void endOfDirectory(int handle, bool succeeded, bool updateListing, 
                         bool cacheToDisc)
     {
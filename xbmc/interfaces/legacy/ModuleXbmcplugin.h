@@ -116,6 +116,68 @@ namespace XBMCAddon
                            int totalItems = 0);
 #endif
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // A value of a directory entry is either a String or a dictionary of the
+    // same type as xbmcgui::InfoLabelDict. It's spelled out because SWIG only
+    // parses this header for the module and doesn't follow the include of
+    // ListItem.h, so it couldn't resolve the typedef.
+    typedef Alternative<StringOrInt, std::vector<Alternative<StringOrInt, Tuple<String, StringOrInt> > > > EntryInfoValue;
+    typedef Alternative<StringOrInt, Dictionary<EntryInfoValue> > EntryValue;
+    typedef Dictionary<EntryValue> DirectoryEntry;
+#endif
+
+#ifdef DOXYGEN_SHOULD_USE_THIS
+    ///
+    /// \ingroup python_xbmcplugin
+    /// @brief \python_func{ xbmcplugin.addDirectoryEntries(handle, entries[, totalItems]) }
+    ///-------------------------------------------------------------------------
+    /// Callback function to pass directory contents back to Kodi as a list of
+    /// dictionaries, without creating a ListItem for every entry.
+    ///
+    /// @param handle               integer - handle the plugin was started
+    ///                             with.
+    /// @param entries              List - list of dictionaries describing the
+    ///                             entries to add.
+    /// @param totalItems           [opt] integer - total number of items
+    ///                             that will be passed.(used for progressbar)
+    /// @return                     Returns a bool for successful completion.
+    /// @throws WrongTypeException  if an entry has no url.
+    ///
+    /// | Key        | Value                                                    |
+    /// |-----------:|:---------------------------------------------------------|
+    /// | url        | string - url of the entry, required
+    /// | label      | string - label of the entry
+    /// | label2     | string - second label of the entry
+    /// | isFolder   | bool - True=folder / False=not a folder(default)
+    /// | mimetype   | string - mimetype of the entry
+    /// | art        | dictionary - as in ListItem.setArt()
+    /// | properties | dictionary - as in ListItem.setProperty()
+    /// | infoType   | string - type of info, as in ListItem.setInfo(), default video
+    /// | info       | dictionary - info labels, as in ListItem.setInfo()
+    ///
+    /// @remark The entries are converted in one call, which is considerably
+    /// faster than setting up a ListItem per entry for large directories.
+    /// You may call this more than once to add entries in chunks.
+    ///
+    ///
+    /// ------------------------------------------------------------------------
+    ///
+    /// @python_v18 New function added.
+    ///
+    /// **Example:**
+    /// ~~~~~~~~~~~~~{.py}
+    /// ..
+    /// entries = [{'url': url, 'label': title, 'isFolder': False,
+    ///             'art': {'thumb': thumb}, 'info': {'title': title, 'year': 2017}}]
+    /// if not xbmcplugin.addDirectoryEntries(int(sys.argv[1]), entries): raise
+    /// ..
+    /// ~~~~~~~~~~~~~
+    ///
+    addDirectoryEntries(...);
+#else
+    bool addDirectoryEntries(int handle, const std::vector<DirectoryEntry>& entries, int totalItems = 0);
+#endif
+
 #ifdef DOXYGEN_SHOULD_USE_THIS
     ///
     /// \ingroup python_xbmcplugin
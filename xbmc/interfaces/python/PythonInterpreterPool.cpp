@@ -0,0 +1,92 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// python.h should always be included first before any other includes
+#include <Python.h>
+
+#include "PythonInterpreterPool.h"
+
+#include <iterator>
+
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+bool CPythonInterpreterPool::Acquire(const std::string &key, SInterpreter &interpreter)
+{
+  CSingleLock lock(m_section);
+  // the most recently used one has the most of the add-on's modules imported
+  for (auto it = m_idle.rbegin(); it != m_idle.rend(); ++it)
+  {
+    if (it->key == key)
+    {
+      interpreter = it->interpreter;
+      m_idle.erase(std::next(it).base());
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<CPythonInterpreterPool::SInterpreter> CPythonInterpreterPool::Release(const std::string &key, const SInterpreter &interpreter, unsigned int maxIdle)
+{
+  CSingleLock lock(m_section);
+  SEntry entry;
+  entry.key = key;
+  entry.interpreter = interpreter;
+  entry.released = XbmcThreads::SystemClockMillis();
+  m_idle.push_back(entry);
+
+  std::vector<SInterpreter> evicted;
+  while (m_idle.size() > maxIdle)
+  {
+    evicted.push_back(m_idle.front().interpreter);
+    m_idle.pop_front();
+  }
+  return evicted;
+}
+
+std::vector<CPythonInterpreterPool::SInterpreter> CPythonInterpreterPool::Expire(unsigned int timeout)
+{
+  CSingleLock lock(m_section);
+  unsigned int now = XbmcThreads::SystemClockMillis();
+
+  std::vector<SInterpreter> expired;
+  while (!m_idle.empty() && (timeout == 0 || now - m_idle.front().released > timeout))
+  {
+    expired.push_back(m_idle.front().interpreter);
+    m_idle.pop_front();
+  }
+  return expired;
+}
+
+bool CPythonInterpreterPool::IsEmpty() const
+{
+  CSingleLock lock(m_section);
+  return m_idle.empty();
+}
+
+void CPythonInterpreterPool::End(const SInterpreter &interpreter)
+{
+  // Py_EndInterpreter() wants the interpreter's only thread state to be the current one
+  PyThreadState *state = PyThreadState_New(static_cast<PyInterpreterState*>(interpreter.interpreter));
+  PyThreadState_Swap(state);
+  Py_EndInterpreter(state);
+  PyThreadState_Swap(NULL);
+}
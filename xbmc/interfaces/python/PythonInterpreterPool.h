@@ -0,0 +1,87 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+
+/*!
+ \brief Idle python sub-interpreters kept for the next invocation of the same
+ add-on, so browsing a plugin doesn't create an interpreter and import the
+ modules the plugin depends on for every directory.
+
+ The pool only does the bookkeeping and doesn't need the GIL, interpreters
+ taken out of it are ended with End() by the caller.
+ */
+class CPythonInterpreterPool
+{
+public:
+  struct SInterpreter
+  {
+    SInterpreter() : interpreter(nullptr) {}
+
+    void *interpreter;      //!< actually a PyInterpreterState*, without any thread state
+    std::string pythonPath; //!< sys.path the interpreter was set up with
+  };
+
+  /*!
+   \brief Take an idle interpreter last used by an add-on.
+   \param key identifies the add-on and its version
+   \return false if there's none
+   */
+  bool Acquire(const std::string &key, SInterpreter &interpreter);
+
+  /*!
+   \brief Keep an interpreter after its invocation finished.
+   \param key identifies the add-on and its version
+   \param maxIdle the number of idle interpreters to keep at most
+   \return interpreters which don't fit anymore, least recently used first
+   */
+  std::vector<SInterpreter> Release(const std::string &key, const SInterpreter &interpreter, unsigned int maxIdle);
+
+  /*!
+   \brief Take interpreters which have been idle for too long.
+   \param timeout milliseconds an interpreter may be idle, 0 to take all
+   */
+  std::vector<SInterpreter> Expire(unsigned int timeout);
+
+  bool IsEmpty() const;
+
+  /*!
+   \brief End an interpreter taken out of the pool. Has to be called with the
+   GIL held and without a current thread state.
+   */
+  static void End(const SInterpreter &interpreter);
+
+private:
+  struct SEntry
+  {
+    std::string key;
+    SInterpreter interpreter;
+    unsigned int released;
+  };
+
+  mutable CCriticalSection m_section;
+  std::deque<SEntry> m_idle; //!< least recently used first
+};
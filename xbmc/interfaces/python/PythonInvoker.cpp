@@ -20,6 +20,7 @@
 
 // python.h should always be included first before any other includes
 #include <Python.h>
+#include <algorithm>
 #include <iterator>
 #include <osdefs.h>
 
@@ -39,7 +40,9 @@
 #include "interfaces/python/pythreadstate.h"
 #include "interfaces/python/swig.h"
 #include "interfaces/python/XBPython.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #if defined(TARGET_WINDOWS)
 #include "utils/CharsetConverter.h"
 #endif // defined(TARGET_WINDOWS)
@@ -166,11 +169,20 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): start processing", GetId(), m_sourceFile.c_str());
 
+  unsigned int setupStart = XbmcThreads::SystemClockMillis();
+
+  // plugins may reuse an interpreter of their previous invocation
+  std::string poolKey = getPoolKey();
+  CPythonInterpreterPool::SInterpreter pooled;
+  bool reused = !poolKey.empty() && g_pythonParser.GetInterpreterPool().Acquire(poolKey, pooled);
+
   // get the global lock
   PyEval_AcquireLock();
-  PyThreadState* state = Py_NewInterpreter();
+  PyThreadState* state = reused ? PyThreadState_New(static_cast<PyInterpreterState*>(pooled.interpreter)) : Py_NewInterpreter();
   if (state == NULL)
   {
+    if (reused)
+      CPythonInterpreterPool::End(pooled);
     PyEval_ReleaseLock();
     CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): FAILED to get thread state!", GetId(), m_sourceFile.c_str());
     return false;
@@ -181,7 +193,10 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook(new XBMCAddon::Python::PythonLanguageHook(state->interp));
   languageHook->RegisterMe();
 
-  onInitialization();
+  if (reused)
+    onReuse();
+  else
+    onInitialization();
   setState(InvokerStateInitialized);
 
   std::string realFilename(CSpecialProtocol::TranslatePath(m_sourceFile));
@@ -194,47 +209,56 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   // this is used for python so it will search modules from script path first
   std::string scriptDir = URIUtils::GetDirectory(realFilename);
   URIUtils::RemoveSlashAtEnd(scriptDir);
-  addPath(scriptDir);
 
-  // add all addon module dependencies to path
-  if (m_addon)
+  if (reused)
   {
-    std::set<std::string> paths;
-    getAddonModuleDeps(m_addon, paths);
-    for (std::set<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
-      addPath(*it);
+    // the same add-on in the same version ends up with the same path
+    m_pythonPath = pooled.pythonPath;
   }
   else
-  { // for backwards compatibility.
-    // we don't have any addon so just add all addon modules installed
-    CLog::Log(LOGWARNING, "CPythonInvoker(%d): Script invoked without an addon. Adding all addon "
-        "modules installed to python path as fallback. This behaviour will be removed in future "
-        "version.", GetId());
-    ADDON::VECADDONS addons;
-    ADDON::CAddonMgr::GetInstance().GetAddons(addons, ADDON::ADDON_SCRIPT_MODULE);
-    for (unsigned int i = 0; i < addons.size(); ++i)
-      addPath(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
-  }
+  {
+    addPath(scriptDir);
 
-  // we want to use sys.path so it includes site-packages
-  // if this fails, default to using Py_GetPath
-  PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
-  PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
-  PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
+    // add all addon module dependencies to path
+    if (m_addon)
+    {
+      std::set<std::string> paths;
+      getAddonModuleDeps(m_addon, paths);
+      for (std::set<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+        addPath(*it);
+    }
+    else
+    { // for backwards compatibility.
+      // we don't have any addon so just add all addon modules installed
+      CLog::Log(LOGWARNING, "CPythonInvoker(%d): Script invoked without an addon. Adding all addon "
+          "modules installed to python path as fallback. This behaviour will be removed in future "
+          "version.", GetId());
+      ADDON::VECADDONS addons;
+      ADDON::CAddonMgr::GetInstance().GetAddons(addons, ADDON::ADDON_SCRIPT_MODULE);
+      for (unsigned int i = 0; i < addons.size(); ++i)
+        addPath(CSpecialProtocol::TranslatePath(addons[i]->LibPath()));
+    }
 
-  if (pathObj != NULL && PyList_Check(pathObj))
-  {
-    for (int i = 0; i < PyList_Size(pathObj); i++)
+    // we want to use sys.path so it includes site-packages
+    // if this fails, default to using Py_GetPath
+    PyObject *sysMod(PyImport_ImportModule((char*)"sys")); // must call Py_DECREF when finished
+    PyObject *sysModDict(PyModule_GetDict(sysMod)); // borrowed ref, no need to delete
+    PyObject *pathObj(PyDict_GetItemString(sysModDict, "path")); // borrowed ref, no need to delete
+
+    if (pathObj != NULL && PyList_Check(pathObj))
     {
-      PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
-      if (e != NULL && PyString_Check(e))
-        addNativePath(PyString_AsString(e)); // returns internal data, don't delete or modify
+      for (int i = 0; i < PyList_Size(pathObj); i++)
+      {
+        PyObject *e = PyList_GetItem(pathObj, i); // borrowed ref, no need to delete
+        if (e != NULL && PyString_Check(e))
+          addNativePath(PyString_AsString(e)); // returns internal data, don't delete or modify
+      }
     }
-  }
-  else
-    addNativePath(Py_GetPath());
+    else
+      addNativePath(Py_GetPath());
 
-  Py_DECREF(sysMod); // release ref to sysMod
+    Py_DECREF(sysMod); // release ref to sysMod
+  }
 
   // set current directory and python's path.
   PySys_SetArgv(argc, &argv[0]);
@@ -252,6 +276,9 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
   PyObject* module = PyImport_AddModule((char*)"__main__");
   PyObject* moduleDict = PyModule_GetDict(module);
 
+  CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): %s interpreter set up in %u ms", GetId(), m_sourceFile.c_str(),
+            reused ? "pooled" : "new", XbmcThreads::SystemClockMillis() - setupStart);
+
   // when we are done initing we store thread state so we can be aborted
   PyThreadState_Swap(NULL);
   PyEval_ReleaseLock();
@@ -415,7 +442,23 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
       PyRun_SimpleString(GC_SCRIPT) == -1)
     CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): failed to run the gc to clean up after running prior to shutting down the Interpreter", GetId(), m_sourceFile.c_str());
 
-  Py_EndInterpreter(state);
+  // only keep interpreters of plugins which finished cleanly
+  if (!poolKey.empty() && stateToSet == InvokerStateDone && !m_stop && !languageHook->HasRegisteredAddonClasses())
+  {
+    CPythonInterpreterPool::SInterpreter interpreter;
+    interpreter.interpreter = state->interp;
+    interpreter.pythonPath = m_pythonPath;
+
+    // the thread state belongs to this thread, the next invocation creates its own
+    PyThreadState_Clear(state);
+    PyThreadState_Swap(NULL);
+    PyThreadState_Delete(state);
+
+    for (const auto& evicted : g_pythonParser.GetInterpreterPool().Release(poolKey, interpreter, g_advancedSettings.m_pythonInterpreterPool))
+      CPythonInterpreterPool::End(evicted);
+  }
+  else
+    Py_EndInterpreter(state);
 
   // If we still have objects left around, produce an error message detailing what's been left behind
   if (languageHook->HasRegisteredAddonClasses())
@@ -554,6 +597,69 @@ void CPythonInvoker::onInitialization()
     initializeModules(getModules());
   }
 
+  runInitializationScript();
+}
+
+void CPythonInvoker::onReuse()
+{
+  XBMC_TRACE;
+  PyObject *modules = PyImport_GetModuleDict(); // borrowed ref, no need to delete
+
+  // drop the add-on's own modules, they may hold state of the last invocation
+  // like the handle read from sys.argv at import. Modules of its dependencies
+  // stay imported, that's what makes reusing the interpreter worthwhile.
+  std::string addonPath = CSpecialProtocol::TranslatePath(m_addon->Path());
+  std::vector<std::string> dropped;
+  PyObject *name, *module;
+  Py_ssize_t pos = 0;
+  while (PyDict_Next(modules, &pos, &name, &module))
+  {
+    if (!PyString_Check(name) || module == Py_None)
+      continue;
+
+    PyObject *file = PyObject_GetAttrString(module, "__file__");
+    if (file == NULL)
+    {
+      PyErr_Clear();
+      continue;
+    }
+    if (PyString_Check(file) && StringUtils::StartsWith(PyString_AsString(file), addonPath))
+      dropped.push_back(PyString_AsString(name));
+    Py_DECREF(file);
+  }
+
+  // and the relative import misses cached for them
+  pos = 0;
+  std::vector<std::string> misses;
+  while (PyDict_Next(modules, &pos, &name, &module))
+  {
+    if (!PyString_Check(name) || module != Py_None)
+      continue;
+
+    std::string miss = PyString_AsString(name);
+    if (std::any_of(dropped.begin(), dropped.end(), [&miss](const std::string& package) { return StringUtils::StartsWith(miss, package + "."); }))
+      misses.push_back(miss);
+  }
+
+  for (const auto& it : dropped)
+    PyDict_DelItemString(modules, it.c_str());
+  for (const auto& it : misses)
+    PyDict_DelItemString(modules, it.c_str());
+
+  // the script runs in a fresh __main__
+  PyObject *mainModule = PyModule_New("__main__");
+  PyDict_SetItemString(PyModule_GetDict(mainModule), "__builtins__", PyEval_GetBuiltins());
+  PyDict_SetItemString(modules, "__main__", mainModule);
+  Py_DECREF(mainModule);
+
+  CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): reusing interpreter, dropped %u modules of the add-on", GetId(), m_sourceFile.c_str(), static_cast<unsigned int>(dropped.size()));
+
+  // resets xbmc.abortRequested and the output redirection
+  runInitializationScript();
+}
+
+void CPythonInvoker::runInitializationScript()
+{
   // get a possible initialization script
   const char* runscript = getInitializationScript();
   if (runscript!= NULL && strlen(runscript) > 0)
@@ -564,6 +670,16 @@ void CPythonInvoker::onInitialization()
   }
 }
 
+std::string CPythonInvoker::getPoolKey() const
+{
+  // plugins are invoked for every directory and usually finish right away,
+  // scripts and services may run for long and keep threads around
+  if (g_advancedSettings.m_pythonInterpreterPool == 0 || !m_addon || m_addon->Type() != ADDON::ADDON_PLUGIN)
+    return "";
+
+  return m_addon->ID() + "-" + m_addon->Version().asString();
+}
+
 void CPythonInvoker::onPythonModuleInitialization(void* moduleDict)
 {
   if (m_addon.get() == NULL || moduleDict == NULL)
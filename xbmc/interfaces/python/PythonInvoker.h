@@ -50,6 +50,8 @@ protected:
   virtual std::map<std::string, PythonModuleInitialization> getModules() const;
   virtual const char* getInitializationScript() const;
   virtual void onInitialization();
+  // called instead of onInitialization() when a pooled interpreter is reused
+  virtual void onReuse();
   // actually a PyObject* but don't wanna draw Python.h include into the header
   virtual void onPythonModuleInitialization(void* moduleDict);
   virtual void onDeinitialization();
@@ -62,6 +64,8 @@ protected:
   CCriticalSection m_critical;
 
 private:
+  void runInitializationScript();
+  std::string getPoolKey() const;
   void initializeModules(const std::map<std::string, PythonModuleInitialization> &modules);
   bool initializeModule(PythonModuleInitialization module);
   void addPath(const std::string& path); // add path in UTF-8 encoding
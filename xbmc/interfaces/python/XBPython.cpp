@@ -46,6 +46,9 @@
 #include "interfaces/python/AddonPythonInvoker.h"
 #include "interfaces/python/PythonInvoker.h"
 
+// idle interpreters of plugins are ended after this time
+#define PYTHON_POOL_IDLE_TIMEOUT 300000 // ms
+
 using namespace ANNOUNCEMENT;
 
 XBPython::XBPython()
@@ -460,6 +463,8 @@ void XBPython::Finalize()
     {
       CSingleExit exit(m_critSection);
       PyEval_AcquireLock();
+      for (const auto &interpreter : m_interpreterPool.Expire(0))
+        CPythonInterpreterPool::End(interpreter);
       PyThreadState_Swap(curTs);
 
       Py_Finalize();
@@ -522,8 +527,18 @@ void XBPython::Process()
     //delete scripts which are done
     tmpvec.clear(); // boost releases the XBPyThreads which, if deleted, calls OnScriptFinalized
 
+    std::vector<CPythonInterpreterPool::SInterpreter> expired = m_interpreterPool.Expire(PYTHON_POOL_IDLE_TIMEOUT);
+    if (!expired.empty())
+    {
+      PyEval_AcquireLock();
+      for (const auto &interpreter : expired)
+        CPythonInterpreterPool::End(interpreter);
+      PyEval_ReleaseLock();
+    }
+
     CSingleLock l2(m_critSection);
-    if(m_iDllScriptCounter == 0 && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 )
+    if(m_iDllScriptCounter == 0 && (XbmcThreads::SystemClockMillis() - m_endtime) > 10000 &&
+       m_interpreterPool.IsEmpty())
     {
       Finalize();
     }
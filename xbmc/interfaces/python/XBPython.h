@@ -26,6 +26,7 @@
 #include "threads/Thread.h"
 #include "interfaces/IAnnouncer.h"
 #include "interfaces/generic/ILanguageInvocationHandler.h"
+#include "interfaces/python/PythonInterpreterPool.h"
 #include "ServiceBroker.h"
 
 #include <memory>
@@ -106,6 +107,8 @@ public:
 
   bool WaitForEvent(CEvent& hEvent, unsigned int milliseconds);
 
+  CPythonInterpreterPool& GetInterpreterPool() { return m_interpreterPool; }
+
   void RegisterExtensionLib(LibraryLoader *pLib);
   void UnregisterExtensionLib(LibraryLoader *pLib);
   void UnloadExtensionLibs();
@@ -131,6 +134,9 @@ private:
   // any global events that scripts should be using
   CEvent m_globalEvent;
 
+  // idle interpreters of plugins, see CPythonInvoker
+  CPythonInterpreterPool m_interpreterPool;
+
   // in order to finalize and unload the python library, need to save all the extension libraries that are
   // loaded by it and unload them first (not done by finalize)
   PythonExtensionLibraries m_extensions;
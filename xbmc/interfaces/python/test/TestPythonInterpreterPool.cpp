@@ -0,0 +1,78 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "../PythonInterpreterPool.h"
+
+#include "gtest/gtest.h"
+
+static CPythonInterpreterPool::SInterpreter MakeInterpreter(intptr_t id)
+{
+  CPythonInterpreterPool::SInterpreter interpreter;
+  interpreter.interpreter = reinterpret_cast<void*>(id);
+  interpreter.pythonPath = "path";
+  return interpreter;
+}
+
+TEST(TestPythonInterpreterPool, ReusePerAddon)
+{
+  CPythonInterpreterPool pool;
+  CPythonInterpreterPool::SInterpreter interpreter;
+  EXPECT_FALSE(pool.Acquire("plugin.a-1.0.0", interpreter));
+
+  EXPECT_TRUE(pool.Release("plugin.a-1.0.0", MakeInterpreter(1), 4).empty());
+  EXPECT_TRUE(pool.Release("plugin.b-1.0.0", MakeInterpreter(2), 4).empty());
+
+  EXPECT_FALSE(pool.Acquire("plugin.a-1.0.1", interpreter));
+  ASSERT_TRUE(pool.Acquire("plugin.a-1.0.0", interpreter));
+  EXPECT_EQ(reinterpret_cast<void*>(1), interpreter.interpreter);
+  EXPECT_EQ("path", interpreter.pythonPath);
+  EXPECT_FALSE(pool.Acquire("plugin.a-1.0.0", interpreter));
+  EXPECT_FALSE(pool.IsEmpty());
+}
+
+TEST(TestPythonInterpreterPool, EvictLeastRecentlyUsed)
+{
+  CPythonInterpreterPool pool;
+  EXPECT_TRUE(pool.Release("plugin.a-1.0.0", MakeInterpreter(1), 2).empty());
+  EXPECT_TRUE(pool.Release("plugin.b-1.0.0", MakeInterpreter(2), 2).empty());
+
+  std::vector<CPythonInterpreterPool::SInterpreter> evicted = pool.Release("plugin.c-1.0.0", MakeInterpreter(3), 2);
+  ASSERT_EQ(1U, evicted.size());
+  EXPECT_EQ(reinterpret_cast<void*>(1), evicted[0].interpreter);
+
+  CPythonInterpreterPool::SInterpreter interpreter;
+  EXPECT_FALSE(pool.Acquire("plugin.a-1.0.0", interpreter));
+
+  // a limit of 0 keeps nothing
+  evicted = pool.Release("plugin.d-1.0.0", MakeInterpreter(4), 0);
+  EXPECT_EQ(3U, evicted.size());
+  EXPECT_TRUE(pool.IsEmpty());
+}
+
+TEST(TestPythonInterpreterPool, Expire)
+{
+  CPythonInterpreterPool pool;
+  pool.Release("plugin.a-1.0.0", MakeInterpreter(1), 4);
+  pool.Release("plugin.b-1.0.0", MakeInterpreter(2), 4);
+
+  EXPECT_TRUE(pool.Expire(60000).empty());
+  EXPECT_EQ(2U, pool.Expire(0).size());
+  EXPECT_TRUE(pool.IsEmpty());
+}
@@ -43,5 +43,6 @@ using namespace xbmcplugin;
 
 %include "interfaces/legacy/swighelper.h"
 %include "interfaces/legacy/AddonString.h"
+%include "interfaces/legacy/Dictionary.h"
 %include "interfaces/legacy/ModuleXbmcplugin.h"
 
@@ -0,0 +1,74 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MediaLibraryChanges.h"
+
+#include "threads/SingleLock.h"
+
+const size_t CMediaLibraryChanges::MaxChanges;
+
+CMediaLibraryChanges::CMediaLibraryChanges()
+  : m_revision(0),
+    m_invalidRevision(0)
+{ }
+
+void CMediaLibraryChanges::Add(const MediaType &mediaType, int id, ChangeType type)
+{
+  CSingleLock lock(m_critical);
+
+  if (m_changes.size() >= MaxChanges)
+    m_changes.pop_front();
+
+  m_changes.push_back(Change{ mediaType, id, type });
+  m_revision++;
+}
+
+void CMediaLibraryChanges::Invalidate()
+{
+  CSingleLock lock(m_critical);
+
+  m_changes.clear();
+  m_revision++;
+  m_invalidRevision = m_revision;
+}
+
+uint64_t CMediaLibraryChanges::GetRevision() const
+{
+  CSingleLock lock(m_critical);
+  return m_revision;
+}
+
+bool CMediaLibraryChanges::GetChanges(uint64_t &revision, std::vector<Change> &changes) const
+{
+  CSingleLock lock(m_critical);
+
+  changes.clear();
+  if (revision > m_revision)
+    return false;
+
+  // the changes up to the oldest one we still have are gone
+  const uint64_t firstRevision = m_revision - m_changes.size() + 1;
+  if (revision < m_invalidRevision || revision + 1 < firstRevision)
+    return false;
+
+  changes.assign(m_changes.begin() + static_cast<size_t>(revision + 1 - firstRevision), m_changes.end());
+  revision = m_revision;
+  return true;
+}
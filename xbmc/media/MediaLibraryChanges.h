@@ -0,0 +1,94 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <stdint.h>
+#include <vector>
+
+#include "media/MediaType.h"
+#include "threads/CriticalSection.h"
+
+/*!
+ \brief Feed of the items added to, updated in or removed from a media library.
+
+ Every change increases the revision of the feed. A listing remembers the
+ revision at the time it was fetched and later asks for the changes made
+ since then to update its items instead of fetching all of them again. Only
+ the most recent changes are kept, so if too many happened (or the library
+ changed in a way not described by single items, see Invalidate()) the
+ listing has to be fetched again.
+ */
+class CMediaLibraryChanges
+{
+public:
+  enum ChangeType
+  {
+    Added,
+    Updated,
+    Removed
+  };
+
+  struct Change
+  {
+    MediaType mediaType;
+    int id;
+    ChangeType type;
+  };
+
+  static const size_t MaxChanges = 1000;
+
+  CMediaLibraryChanges();
+  ~CMediaLibraryChanges() = default;
+
+  /*!
+   \brief Adds a change of the item with the given media type and database id.
+   */
+  void Add(const MediaType &mediaType, int id, ChangeType type);
+
+  /*!
+   \brief Marks all previous revisions as outdated, e.g. after an import.
+   */
+  void Invalidate();
+
+  /*!
+   \brief Gets the current revision.
+   */
+  uint64_t GetRevision() const;
+
+  /*!
+   \brief Gets the changes made after the given revision.
+
+   \param revision Revision of a listing, updated to the current revision
+   \param changes Changes made after the given revision in the order they were made
+   \return false if the changes aren't known anymore
+   */
+  bool GetChanges(uint64_t &revision, std::vector<Change> &changes) const;
+
+private:
+  CMediaLibraryChanges(const CMediaLibraryChanges&) = delete;
+  CMediaLibraryChanges& operator=(const CMediaLibraryChanges&) = delete;
+
+  // the last change has the current revision
+  std::deque<Change> m_changes;
+  uint64_t m_revision;
+  uint64_t m_invalidRevision;
+  mutable CCriticalSection m_critical;
+};
@@ -0,0 +1,102 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "media/MediaLibraryChanges.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestMediaLibraryChanges, GetChanges)
+{
+  CMediaLibraryChanges feed;
+  std::vector<CMediaLibraryChanges::Change> changes;
+
+  uint64_t revision = feed.GetRevision();
+  EXPECT_TRUE(feed.GetChanges(revision, changes));
+  EXPECT_TRUE(changes.empty());
+
+  feed.Add(MediaTypeMovie, 1, CMediaLibraryChanges::Updated);
+  feed.Add(MediaTypeEpisode, 2, CMediaLibraryChanges::Removed);
+
+  uint64_t latest = revision;
+  EXPECT_TRUE(feed.GetChanges(latest, changes));
+  ASSERT_EQ(2U, changes.size());
+  EXPECT_EQ(MediaTypeMovie, changes[0].mediaType);
+  EXPECT_EQ(1, changes[0].id);
+  EXPECT_EQ(CMediaLibraryChanges::Updated, changes[0].type);
+  EXPECT_EQ(MediaTypeEpisode, changes[1].mediaType);
+  EXPECT_EQ(2, changes[1].id);
+  EXPECT_EQ(CMediaLibraryChanges::Removed, changes[1].type);
+  EXPECT_EQ(feed.GetRevision(), latest);
+
+  // only the changes after the given revision
+  revision++;
+  EXPECT_TRUE(feed.GetChanges(revision, changes));
+  ASSERT_EQ(1U, changes.size());
+  EXPECT_EQ(2, changes[0].id);
+
+  EXPECT_TRUE(feed.GetChanges(latest, changes));
+  EXPECT_TRUE(changes.empty());
+}
+
+TEST(TestMediaLibraryChanges, Overflow)
+{
+  CMediaLibraryChanges feed;
+  std::vector<CMediaLibraryChanges::Change> changes;
+
+  uint64_t first = feed.GetRevision();
+  for (size_t i = 0; i < CMediaLibraryChanges::MaxChanges; i++)
+    feed.Add(MediaTypeSong, static_cast<int>(i), CMediaLibraryChanges::Updated);
+
+  uint64_t revision = first;
+  EXPECT_TRUE(feed.GetChanges(revision, changes));
+  EXPECT_EQ(CMediaLibraryChanges::MaxChanges, changes.size());
+
+  // the first change is dropped
+  feed.Add(MediaTypeSong, -1, CMediaLibraryChanges::Added);
+  revision = first;
+  EXPECT_FALSE(feed.GetChanges(revision, changes));
+
+  revision = first + 1;
+  EXPECT_TRUE(feed.GetChanges(revision, changes));
+  ASSERT_EQ(CMediaLibraryChanges::MaxChanges, changes.size());
+  EXPECT_EQ(1, changes.front().id);
+  EXPECT_EQ(-1, changes.back().id);
+}
+
+TEST(TestMediaLibraryChanges, Invalidate)
+{
+  CMediaLibraryChanges feed;
+  std::vector<CMediaLibraryChanges::Change> changes;
+
+  feed.Add(MediaTypeAlbum, 1, CMediaLibraryChanges::Updated);
+  uint64_t revision = feed.GetRevision();
+
+  feed.Invalidate();
+  EXPECT_FALSE(feed.GetChanges(revision, changes));
+
+  revision = feed.GetRevision();
+  feed.Add(MediaTypeAlbum, 2, CMediaLibraryChanges::Updated);
+  EXPECT_TRUE(feed.GetChanges(revision, changes));
+  ASSERT_EQ(1U, changes.size());
+  EXPECT_EQ(2, changes[0].id);
+
+  uint64_t future = revision + 1;
+  EXPECT_FALSE(feed.GetChanges(future, changes));
+}
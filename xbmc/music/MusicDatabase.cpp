@@ -45,6 +45,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "messaging/helpers/DialogHelper.h"
 #include "music/tags/MusicInfoTag.h"
+#include "music/tags/MusicInfoTagSource.h"
 #include "network/cddb.h"
 #include "network/Network.h"
 #include "playlists/SmartPlayList.h"
@@ -75,6 +76,7 @@ using KODI::MESSAGING::HELPERS::DialogResponse;
 
 #define RECENTLY_PLAYED_LIMIT 25
 #define MIN_FULL_SEARCH_LENGTH 3
+#define SONG_ROWS_MIN_COMPACT 1000 // listings with more rows create the tags of their songs when accessed
 
 #ifdef HAS_DVD_DRIVE
 using namespace CDDB;
@@ -83,6 +85,8 @@ using namespace MEDIA_DETECT;
 
 static void AnnounceRemove(const std::string& content, int id)
 {
+  CMusicDatabase::GetLibraryChanges().Add(content, id, CMediaLibraryChanges::Removed);
+
   CVariant data;
   data["type"] = content;
   data["id"] = id;
@@ -93,6 +97,8 @@ static void AnnounceRemove(const std::string& content, int id)
 
 static void AnnounceUpdate(const std::string& content, int id)
 {
+  CMusicDatabase::GetLibraryChanges().Add(content, id, CMediaLibraryChanges::Updated);
+
   CVariant data;
   data["type"] = content;
   data["id"] = id;
@@ -101,6 +107,12 @@ static void AnnounceUpdate(const std::string& content, int id)
   ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::AudioLibrary, "xbmc", "OnUpdate", data);
 }
 
+CMediaLibraryChanges& CMusicDatabase::GetLibraryChanges()
+{
+  static CMediaLibraryChanges changes;
+  return changes;
+}
+
 CMusicDatabase::CMusicDatabase(void)
 {
   m_translateBlankArtist = true;
@@ -627,6 +639,7 @@ int CMusicDatabase::AddSong(const int idAlbum,
                       iTimesPlayed, iStartOffset, iEndOffset, rating, userrating, votes, strComment.c_str(), strMood.c_str(), replayGain.Get().c_str());
       m_pDS->exec(strSQL);
       idSong = (int)m_pDS->lastinsertid();
+      GetLibraryChanges().Add(MediaTypeSong, idSong, CMediaLibraryChanges::Added);
     }
     else
     {
@@ -836,7 +849,9 @@ int CMusicDatabase::AddAlbum(const std::string& strAlbum, const std::string& str
       strSQL += ")";
       m_pDS->exec(strSQL);
 
-      return (int)m_pDS->lastinsertid();
+      int idAlbum = (int)m_pDS->lastinsertid();
+      GetLibraryChanges().Add(MediaTypeAlbum, idAlbum, CMediaLibraryChanges::Added);
+      return idAlbum;
     }
     else
     {
@@ -1251,6 +1266,7 @@ int CMusicDatabase::AddArtist(const std::string& strArtist, const std::string& s
 
     m_pDS->exec(strSQL);
     int idArtist = (int)m_pDS->lastinsertid();
+    GetLibraryChanges().Add(MediaTypeArtist, idArtist, CMediaLibraryChanges::Added);
     return idArtist;
   }
   catch (...)
@@ -2715,6 +2731,7 @@ void CMusicDatabase::IncrementPlayCount(const CFileItem& item)
 
     std::string sql=PrepareSQL("UPDATE song SET iTimesPlayed=iTimesPlayed+1, lastplayed=CURRENT_TIMESTAMP where idSong=%i", idSong);
     m_pDS->exec(sql);
+    GetLibraryChanges().Add(MediaTypeSong, idSong, CMediaLibraryChanges::Updated);
   }
   catch (...)
   {
@@ -4241,6 +4258,100 @@ bool CMusicDatabase::GetAlbumsByWhere(const std::string &baseDir, const Filter &
   return false;
 }
 
+/*!
+ \brief Compact copy of the rows of a song query, see GetSongsFullByWhere().
+
+ The field values of all rows are kept in a single string instead of a full
+ info tag per song, and the tag of a song is created from its rows when the
+ item is accessed.
+ */
+class CMusicDatabase::CSongRows : public CMusicInfoTagSource
+{
+public:
+  CSongRows(const CMusicDbUrl &baseUrl, unsigned int fieldCount, bool artistData)
+    : m_baseUrl(baseUrl),
+      m_fieldCount(fieldCount),
+      m_artistData(artistData)
+  { }
+
+  /*!
+   \brief Adds a record of the query, which either starts the next song or adds an artist to the last one.
+   */
+  void AddRecord(const dbiplus::sql_record &record, bool newSong)
+  {
+    if (newSong)
+      m_songs.push_back(static_cast<uint32_t>(GetRecordCount()));
+
+    // the songview fields are the same in all records of a song
+    const unsigned int firstField = newSong ? 0 : song_enumCount;
+    for (unsigned int field = 0; field < m_fieldCount; field++)
+    {
+      m_offsets.push_back(static_cast<uint32_t>(m_values.size()));
+      if (field >= firstField)
+        m_values.append(record.at(field).get_asString());
+    }
+  }
+
+  void Shrink()
+  {
+    m_values.shrink_to_fit();
+    m_offsets.shrink_to_fit();
+    m_songs.shrink_to_fit();
+  }
+
+  CMusicInfoTag* CreateTag(unsigned int row) const override
+  {
+    if (row >= m_songs.size())
+      return NULL;
+
+    const size_t firstRecord = m_songs[row];
+    const size_t endRecord = row + 1 < m_songs.size() ? m_songs[row + 1] : GetRecordCount();
+
+    dbiplus::sql_record record(m_fieldCount);
+    GetRecord(firstRecord, 0, record);
+
+    CFileItem item;
+    GetFileItemFromDataset(&record, &item, m_baseUrl);
+    if (m_artistData)
+    {
+      VECARTISTCREDITS artistCredits;
+      for (size_t i = firstRecord; i < endRecord; i++)
+      {
+        GetRecord(i, song_enumCount, record);
+        if (record.at(song_enumCount + artistCredit_idRole).get_asInt() == ROLE_ARTIST)
+          artistCredits.push_back(GetArtistCreditFromDataset(&record, song_enumCount));
+        else
+          item.GetMusicInfoTag()->AppendArtistRole(GetArtistRoleFromDataset(&record, song_enumCount));
+      }
+      if (!artistCredits.empty())
+        GetFileItemFromArtistCredits(artistCredits, &item);
+    }
+
+    return new CMusicInfoTag(*item.GetMusicInfoTag());
+  }
+
+private:
+  size_t GetRecordCount() const { return m_offsets.size() / m_fieldCount; }
+
+  void GetRecord(size_t index, unsigned int firstField, dbiplus::sql_record &record) const
+  {
+    for (unsigned int field = firstField; field < m_fieldCount; field++)
+    {
+      const size_t value = index * m_fieldCount + field;
+      const size_t start = m_offsets[value];
+      const size_t end = value + 1 < m_offsets.size() ? m_offsets[value + 1] : m_values.size();
+      record[field].set_asString(m_values.substr(start, end - start));
+    }
+  }
+
+  CMusicDbUrl m_baseUrl;
+  unsigned int m_fieldCount;
+  bool m_artistData;
+  std::string m_values;
+  std::vector<uint32_t> m_offsets; // start of every field of every record in m_values
+  std::vector<uint32_t> m_songs;   // first record of every song
+};
+
 bool CMusicDatabase::GetSongsFullByWhere(const std::string &baseDir, const Filter &filter, CFileItemList &items, const SortDescription &sortDescription /* = SortDescription() */, bool artistData /* = false*/)
 {
   if (m_pDB.get() == NULL || m_pDS.get() == NULL)
@@ -4328,6 +4439,12 @@ bool CMusicDatabase::GetSongsFullByWhere(const std::string &baseDir, const Filte
     if (!SortUtils::SortFromDataset(sorting, MediaTypeSong, m_pDS, results))
       return false;
 
+    // Keep the rows of huge listings in a compact form, the tags of their
+    // songs are only created when the items are accessed
+    std::shared_ptr<CSongRows> songRows;
+    if (iRowsFound > SONG_ROWS_MIN_COMPACT)
+      songRows = std::make_shared<CSongRows>(musicUrl, m_pDS->fieldCount(), artistData);
+
     // Get songs from returned rows. If join songartistview then there is a row for every artist
     items.Reserve(total);
     int songArtistOffset = song_enumCount;
@@ -4350,13 +4467,19 @@ bool CMusicDatabase::GetSongsFullByWhere(const std::string &baseDir, const Filte
             GetFileItemFromArtistCredits(artistCredits, items[items.Size()-1].get());
             artistCredits.clear();
           }
+          if (songRows && count > 0)
+            items[items.Size() - 1]->SetMusicInfoTagSource(songRows, count - 1);
           songId = record->at(song_idSong).get_asInt();
           CFileItemPtr item(new CFileItem);
           GetFileItemFromDataset(record, item.get(), musicUrl);
           // HACK for sorting by database returned order
           item->m_iprogramCount = ++count;
           items.Add(item);
+          if (songRows)
+            songRows->AddRecord(*record, true);
         }
+        else if (songRows)
+          songRows->AddRecord(*record, false);
         // Get song artist credits and contributors
         if (artistData)
         {
@@ -4380,6 +4503,11 @@ bool CMusicDatabase::GetSongsFullByWhere(const std::string &baseDir, const Filte
       GetFileItemFromArtistCredits(artistCredits, items[items.Size() - 1].get());
       artistCredits.clear();
     }
+    if (songRows && count > 0)
+    {
+      items[items.Size() - 1]->SetMusicInfoTagSource(songRows, count - 1);
+      songRows->Shrink();
+    }
     // cleanup
     m_pDS->close();
 
@@ -5769,6 +5897,7 @@ bool CMusicDatabase::SetSongUserrating(const std::string &filePath, int userrati
 
     std::string sql = PrepareSQL("UPDATE song SET userrating='%i' WHERE idSong = %i", userrating, songID);
     m_pDS->exec(sql);
+    GetLibraryChanges().Add(MediaTypeSong, songID, CMediaLibraryChanges::Updated);
     return true;
   }
   catch (...)
@@ -5789,6 +5918,7 @@ bool CMusicDatabase::SetAlbumUserrating(const int idAlbum, int userrating)
 
     std::string sql = PrepareSQL("UPDATE album SET iUserrating='%i' WHERE idAlbum = %i", userrating, idAlbum);
     m_pDS->exec(sql);
+    GetLibraryChanges().Add(MediaTypeAlbum, idAlbum, CMediaLibraryChanges::Updated);
     return true;
   }
   catch (...)
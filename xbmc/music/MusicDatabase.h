@@ -28,6 +28,7 @@
 #include "addons/Scraper.h"
 #include "Album.h"
 #include "dbwrappers/Database.h"
+#include "media/MediaLibraryChanges.h"
 #include "MusicDbUrl.h"
 #include "utils/SortUtils.h"
 
@@ -536,6 +537,11 @@ public:
   */
   void SetMusicTagScanVersion(int version = 0);
 
+  /*! \brief Feed of the changes made to the items of the music library
+  Used by listings of the library to update their items instead of fetching all of them again.
+  */
+  static CMediaLibraryChanges& GetLibraryChanges();
+
 protected:
   std::map<std::string, int> m_genreCache;
   std::map<std::string, int> m_pathCache;
@@ -548,6 +554,8 @@ protected:
   const char *GetBaseDBName() const { return "MyMusic"; };
 
 private:
+  class CSongRows;
+
   /*! \brief (Re)Create the generic database views for songs and albums
    */
   virtual void CreateViews();
@@ -558,8 +566,8 @@ private:
   CArtist GetArtistFromDataset(const dbiplus::sql_record* const record, int offset = 0, bool needThumb = true);
   CAlbum GetAlbumFromDataset(dbiplus::Dataset* pDS, int offset = 0, bool imageURL = false);
   CAlbum GetAlbumFromDataset(const dbiplus::sql_record* const record, int offset = 0, bool imageURL = false);
-  CArtistCredit GetArtistCreditFromDataset(const dbiplus::sql_record* const record, int offset = 0);
-  CMusicRole GetArtistRoleFromDataset(const dbiplus::sql_record* const record, int offset = 0);
+  static CArtistCredit GetArtistCreditFromDataset(const dbiplus::sql_record* const record, int offset = 0);
+  static CMusicRole GetArtistRoleFromDataset(const dbiplus::sql_record* const record, int offset = 0);
   /*! \brief Updates the dateAdded field in the song table for the file
   with the given songId and the given path based on the files modification date
   \param songId id of the song in the song table
@@ -567,8 +575,8 @@ private:
   */
   void UpdateFileDateAdded(int songId, const std::string& strFileNameAndPath);
   void GetFileItemFromDataset(CFileItem* item, const CMusicDbUrl &baseUrl);
-  void GetFileItemFromDataset(const dbiplus::sql_record* const record, CFileItem* item, const CMusicDbUrl &baseUrl);
-  void GetFileItemFromArtistCredits(VECARTISTCREDITS& artistCredits, CFileItem* item);
+  static void GetFileItemFromDataset(const dbiplus::sql_record* const record, CFileItem* item, const CMusicDbUrl &baseUrl);
+  static void GetFileItemFromArtistCredits(VECARTISTCREDITS& artistCredits, CFileItem* item);
   CSong GetAlbumInfoSongFromDataset(const dbiplus::sql_record* const record, int offset = 0);
   bool CleanupSongs();
   bool CleanupSongsByIds(const std::string &strSongIds);
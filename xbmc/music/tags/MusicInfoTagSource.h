@@ -0,0 +1,60 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+namespace MUSIC_INFO
+{
+  class CMusicInfoTag;
+
+  /*!
+   \brief Creates the info tags of the items of a listing when they are accessed.
+
+   Huge library listings keep the rows of their database query in a compact
+   form instead of a full info tag per item. The tag of an item is created
+   from its row when it's accessed and released again when the item isn't
+   visible anymore, see CFileItem::SetMusicInfoTagSource().
+   */
+  class CMusicInfoTagSource
+  {
+  public:
+    virtual ~CMusicInfoTagSource() = default;
+
+    /*!
+     \brief Creates the info tag of the given row.
+
+     \param row Row of an item of the listing
+     \return New info tag owned by the caller or NULL if there's no such row
+     */
+    virtual CMusicInfoTag* CreateTag(unsigned int row) const = 0;
+
+    /*!
+     \brief Gets the lock held while a tag of the listing is created or released.
+
+     It's only held for a short time, background loaders lock the tag of the
+     item they work on instead, see CFileItem::LockMusicInfoTag().
+     */
+    CCriticalSection& GetLock() const { return m_critical; }
+
+  private:
+    mutable CCriticalSection m_critical;
+  };
+}
@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AnnouncementQueue.h"
+
+#include <iterator>
+
+using namespace JSONRPC;
+
+CAnnouncementQueue::CAnnouncementQueue(size_t maxSize, unsigned int coalesceTime)
+  : m_maxSize(maxSize > 0 ? maxSize : 1),
+    m_coalesceTime(coalesceTime),
+    m_immediateCount(0),
+    m_statistics()
+{ }
+
+CAnnouncementQueue::CAnnouncementQueue(const CAnnouncementQueue& other)
+{
+  Copy(other);
+}
+
+CAnnouncementQueue& CAnnouncementQueue::operator=(const CAnnouncementQueue& other)
+{
+  if (this != &other)
+    Copy(other);
+
+  return *this;
+}
+
+void CAnnouncementQueue::Push(const std::string &coalescingKey, const AnnouncementPayload &payload, unsigned int now)
+{
+  if (payload == nullptr)
+    return;
+
+  m_statistics.queued++;
+
+  // without a coalescing time every notification is sent on its own
+  const std::string key = m_coalesceTime > 0 ? coalescingKey : std::string();
+
+  if (!key.empty())
+  {
+    auto existing = m_keys.find(key);
+    if (existing != m_keys.end())
+    {
+      // the newer notification supersedes the one which hasn't been sent yet
+      // but it mustn't overtake anything queued after the superseded one
+      existing->second->payload = payload;
+      m_entries.splice(m_entries.end(), m_entries, existing->second);
+      m_statistics.merged++;
+      return;
+    }
+  }
+
+  if (m_entries.size() >= m_maxSize)
+  {
+    auto victim = m_entries.begin();
+    while (victim != m_entries.end() && victim->key.empty())
+      ++victim;
+    if (victim == m_entries.end())
+      victim = m_entries.begin();
+
+    Erase(victim);
+    m_statistics.dropped++;
+  }
+
+  Entry entry = { key, payload, key.empty() ? now : now + m_coalesceTime };
+  m_entries.push_back(entry);
+
+  if (key.empty())
+    m_immediateCount++;
+  else
+    m_keys.insert(std::make_pair(key, std::prev(m_entries.end())));
+
+  m_statistics.depth = m_entries.size();
+  if (m_statistics.depth > m_statistics.peakDepth)
+    m_statistics.peakDepth = m_statistics.depth;
+}
+
+bool CAnnouncementQueue::IsReady(unsigned int now) const
+{
+  if (m_entries.empty())
+    return false;
+
+  // anything queued before a notification which can't be held back has to go out first
+  if (m_immediateCount > 0)
+    return true;
+
+  return static_cast<int>(now - m_entries.front().deadline) >= 0;
+}
+
+AnnouncementPayload CAnnouncementQueue::Pop()
+{
+  if (m_entries.empty())
+    return nullptr;
+
+  AnnouncementPayload payload = m_entries.front().payload;
+  Erase(m_entries.begin());
+
+  return payload;
+}
+
+void CAnnouncementQueue::Copy(const CAnnouncementQueue& other)
+{
+  m_maxSize = other.m_maxSize;
+  m_coalesceTime = other.m_coalesceTime;
+  m_entries = other.m_entries;
+  m_immediateCount = other.m_immediateCount;
+  m_statistics = other.m_statistics;
+
+  // the key index has to point into our own list
+  m_keys.clear();
+  for (auto entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+  {
+    if (!entry->key.empty())
+      m_keys.insert(std::make_pair(entry->key, entry));
+  }
+}
+
+void CAnnouncementQueue::Erase(Entries::iterator entry)
+{
+  if (entry->key.empty())
+    m_immediateCount--;
+  else
+    m_keys.erase(entry->key);
+
+  m_entries.erase(entry);
+  m_statistics.depth = m_entries.size();
+}
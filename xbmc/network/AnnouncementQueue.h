@@ -0,0 +1,110 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+namespace JSONRPC
+{
+  /*!
+   \brief A serialized notification which is shared by all clients it is sent to.
+   */
+  typedef std::shared_ptr<const std::string> AnnouncementPayload;
+
+  /*!
+   \brief Bounded queue of serialized notifications waiting to be sent to a single client.
+
+   Notifications which are pushed with a coalescing key are held back for the
+   coalescing time. If another notification with the same key is pushed in the
+   meantime it replaces the payload of the queued one and moves it to the back
+   of the queue (keeping its deadline) instead of being queued again.
+   Notifications without a key are ready to be sent immediately and release
+   all notifications queued before them so the order of notifications is
+   always preserved. With a coalescing time of 0 notifications are neither
+   held back nor merged.
+
+   If the queue is full the oldest coalescable notification is dropped (or the
+   oldest notification if none of them is coalescable).
+
+   The queue isn't thread-safe, the owner has to take care of locking.
+   */
+  class CAnnouncementQueue
+  {
+  public:
+    typedef struct Statistics
+    {
+      size_t depth;      ///< number of currently queued notifications
+      size_t peakDepth;  ///< highest number of queued notifications so far
+      uint64_t queued;   ///< number of notifications pushed into the queue
+      uint64_t merged;   ///< number of notifications merged into a queued one
+      uint64_t dropped;  ///< number of notifications dropped because the queue was full
+    } Statistics;
+
+    CAnnouncementQueue(size_t maxSize, unsigned int coalesceTime);
+    CAnnouncementQueue(const CAnnouncementQueue& other);
+    CAnnouncementQueue& operator=(const CAnnouncementQueue& other);
+
+    /*!
+     \brief Queue a notification.
+     \param key coalescing key of the notification, empty if it must not be merged
+     \param payload the serialized notification
+     \param now the current time in milliseconds
+     */
+    void Push(const std::string &key, const AnnouncementPayload &payload, unsigned int now);
+
+    /*!
+     \brief Whether the notification at the front of the queue may be sent.
+     */
+    bool IsReady(unsigned int now) const;
+
+    /*!
+     \brief Remove the notification at the front of the queue.
+     \return the serialized notification or nullptr if the queue is empty
+     */
+    AnnouncementPayload Pop();
+
+    bool IsEmpty() const { return m_entries.empty(); }
+    size_t GetSize() const { return m_entries.size(); }
+    const Statistics& GetStatistics() const { return m_statistics; }
+
+  private:
+    typedef struct Entry
+    {
+      std::string key;
+      AnnouncementPayload payload;
+      unsigned int deadline;
+    } Entry;
+    typedef std::list<Entry> Entries;
+
+    void Copy(const CAnnouncementQueue& other);
+    void Erase(Entries::iterator entry);
+
+    size_t m_maxSize;
+    unsigned int m_coalesceTime;
+    Entries m_entries;
+    std::map<std::string, Entries::iterator> m_keys;
+    size_t m_immediateCount; ///< number of queued notifications without a coalescing key
+    Statistics m_statistics;
+  };
+}
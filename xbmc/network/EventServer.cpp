@@ -26,6 +26,7 @@
 #include "EventPacket.h"
 #include "EventClient.h"
 #include "Socket.h"
+#include "SocketReactor.h"
 #include "threads/CriticalSection.h"
 #include "Application.h"
 #include "ServiceBroker.h"
@@ -154,7 +155,8 @@ void CEventServer::Process()
 
 void CEventServer::Run()
 {
-  CSocketListener listener;
+  CSocketReactor reactor;
+  std::vector<CSocketReactor::ReadyEvent> events;
   int packetSize = 0;
 
   CLog::Log(LOGNOTICE, "ES: Starting UDP Event server on port %d", m_iPort);
@@ -197,30 +199,39 @@ void CEventServer::Run()
                                m_iPort,
                                txt);
 
-  // add our socket to the 'select' listener
-  listener.AddSocket(m_pSocket);
+  // add our (non-blocking) socket to the reactor
+  if (!reactor.Initialize() ||
+      !CSocketReactor::SetNonBlocking(m_pSocket->Socket()) ||
+      !reactor.Add(m_pSocket->Socket(), CSocketReactor::EVENT_READ))
+  {
+    CLog::Log(LOGERROR, "ES: Could not wait for packets on port %d", m_iPort);
+    return;
+  }
 
   m_bRunning = true;
 
   while (!m_bStop)
   {
-    try
+    // start listening until we timeout
+    int ready = reactor.Wait(events, m_iListenTimeout);
+    if (ready < 0)
+    {
+      CLog::Log(LOGERROR, "ES: Error while listening for socket");
+      break;
+    }
+
+    if (ready > 0)
     {
-      // start listening until we timeout
-      if (listener.Listen(m_iListenTimeout))
+      // process all queued packets at once instead of one per wakeup
+      while (!m_bStop)
       {
         CAddress addr;
-        if ((packetSize = m_pSocket->Read(addr, PACKET_SIZE, (void *)m_pPacketBuffer)) > -1)
-        {
-          ProcessPacket(addr, packetSize);
-        }
+        if ((packetSize = m_pSocket->Read(addr, PACKET_SIZE, (void *)m_pPacketBuffer)) < 0)
+          break;
+
+        ProcessPacket(addr, packetSize);
       }
     }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "ES: Exception caught while listening for socket");
-      break;
-    }
 
     // process events and queue the necessary actions and button codes
     ProcessEvents();
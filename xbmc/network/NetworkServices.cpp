@@ -70,6 +70,7 @@
 #include "network/WebServer.h"
 #include "network/httprequesthandler/HTTPImageHandler.h"
 #include "network/httprequesthandler/HTTPImageTransformationHandler.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
 #include "network/httprequesthandler/HTTPVfsHandler.h"
 #ifdef HAS_JSONRPC
 #include "network/httprequesthandler/HTTPJsonRpcHandler.h"
@@ -532,6 +533,8 @@ bool CNetworkServices::StartWebserver()
   if (!m_webserver.Start(webPort, CServiceBroker::GetSettings().GetString(CSettings::SETTING_SERVICES_WEBSERVERUSERNAME), CServiceBroker::GetSettings().GetString(CSettings::SETTING_SERVICES_WEBSERVERPASSWORD)))
     return false;
 
+  CHTTPResponseCache::GetInstance().Start();
+
 #ifdef HAS_ZEROCONF
   std::vector<std::pair<std::string, std::string> > txt;
   // publish web frontend and API services
@@ -567,6 +570,9 @@ bool CNetworkServices::StopWebserver()
     CLog::Log(LOGWARNING, "Webserver: Failed to stop.");
     return false;
   }
+
+  // release the memory and the files used by cached responses
+  CHTTPResponseCache::GetInstance().Stop();
   
 #ifdef HAS_ZEROCONF
 #ifdef HAS_WEB_INTERFACE
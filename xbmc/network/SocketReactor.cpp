@@ -0,0 +1,378 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SocketReactor.h"
+
+#include <errno.h>
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/select.h>
+#endif
+#if defined(TARGET_LINUX)
+#include <sys/epoll.h>
+#endif
+
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+using namespace SOCKETS;
+
+// maximum number of events returned by a single call to epoll_wait()
+#define REACTOR_MAX_EVENTS 256
+
+CSocketReactor::CSocketReactor()
+  : m_epoll(-1),
+    m_waiting(0),
+    m_waitDone(true, true)
+{
+  m_wakeup[0] = m_wakeup[1] = -1;
+}
+
+CSocketReactor::~CSocketReactor()
+{
+  Deinitialize();
+}
+
+bool CSocketReactor::Initialize()
+{
+  Deinitialize();
+
+  CSingleLock lock(m_critSection);
+
+#if defined(TARGET_LINUX)
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll < 0)
+  {
+    CLog::Log(LOGERROR, "CSocketReactor: failed to create epoll instance, error %d", errno);
+    return false;
+  }
+#else
+  // there's nothing to create for select() but we still need to be "initialized"
+  m_epoll = 0;
+#endif
+
+#if defined(TARGET_POSIX)
+  if (pipe(m_wakeup) != 0)
+  {
+    CLog::Log(LOGERROR, "CSocketReactor: failed to create wakeup pipe, error %d", errno);
+    m_wakeup[0] = m_wakeup[1] = -1;
+  }
+  else
+  {
+    for (int i = 0; i < 2; i++)
+    {
+      fcntl(m_wakeup[i], F_SETFD, FD_CLOEXEC);
+      SetNonBlocking(m_wakeup[i]);
+    }
+
+#if defined(TARGET_LINUX)
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = m_wakeup[0];
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup[0], &event);
+#endif
+  }
+#endif
+
+  return true;
+}
+
+void CSocketReactor::Deinitialize()
+{
+  CSingleLock lock(m_critSection);
+
+  // the descriptors must not be closed while another thread waits on them
+  while (m_waiting > 0)
+  {
+    WakeUp();
+    lock.Leave();
+    m_waitDone.Wait();
+    lock.Enter();
+  }
+
+  m_sockets.clear();
+
+#if defined(TARGET_LINUX)
+  if (m_epoll >= 0)
+    close(m_epoll);
+#endif
+  m_epoll = -1;
+
+#if defined(TARGET_POSIX)
+  for (int i = 0; i < 2; i++)
+  {
+    if (m_wakeup[i] >= 0)
+      close(m_wakeup[i]);
+    m_wakeup[i] = -1;
+  }
+#endif
+}
+
+bool CSocketReactor::IsInitialized() const
+{
+  return m_epoll >= 0;
+}
+
+bool CSocketReactor::Add(SOCKET socket, int events)
+{
+  CSingleLock lock(m_critSection);
+  if (!IsInitialized() || socket == INVALID_SOCKET)
+    return false;
+
+#if defined(TARGET_LINUX)
+  struct epoll_event event = {};
+  event.events = EPOLLET | EPOLLRDHUP;
+  if (events & EVENT_READ)
+    event.events |= EPOLLIN;
+  if (events & EVENT_WRITE)
+    event.events |= EPOLLOUT;
+  event.data.fd = socket;
+
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) != 0)
+  {
+    CLog::Log(LOGERROR, "CSocketReactor: failed to add socket %d, error %d", (int)socket, errno);
+    return false;
+  }
+#else
+  // select() can't watch sockets which don't fit into an fd_set
+#if defined(TARGET_POSIX)
+  if (socket >= FD_SETSIZE)
+#else
+  if (m_sockets.size() >= FD_SETSIZE && m_sockets.find(socket) == m_sockets.end())
+#endif
+  {
+    CLog::Log(LOGERROR, "CSocketReactor: can't add socket %d, select() is limited to %d sockets", (int)socket, FD_SETSIZE);
+    return false;
+  }
+#endif
+
+  m_sockets[socket] = events;
+  return true;
+}
+
+bool CSocketReactor::Modify(SOCKET socket, int events)
+{
+  CSingleLock lock(m_critSection);
+
+  auto it = m_sockets.find(socket);
+  if (it == m_sockets.end())
+    return false;
+
+  if (it->second == events)
+    return true;
+
+#if defined(TARGET_LINUX)
+  struct epoll_event event = {};
+  event.events = EPOLLET | EPOLLRDHUP;
+  if (events & EVENT_READ)
+    event.events |= EPOLLIN;
+  if (events & EVENT_WRITE)
+    event.events |= EPOLLOUT;
+  event.data.fd = socket;
+
+  if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket, &event) != 0)
+  {
+    CLog::Log(LOGERROR, "CSocketReactor: failed to modify socket %d, error %d", (int)socket, errno);
+    return false;
+  }
+#else
+  // make sure a thread blocked in select() picks up the new interest set
+  WakeUp();
+#endif
+
+  it->second = events;
+  return true;
+}
+
+void CSocketReactor::Remove(SOCKET socket)
+{
+  CSingleLock lock(m_critSection);
+
+  auto it = m_sockets.find(socket);
+  if (it == m_sockets.end())
+    return;
+
+#if defined(TARGET_LINUX)
+  epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, NULL);
+#endif
+
+  m_sockets.erase(it);
+}
+
+int CSocketReactor::Wait(std::vector<ReadyEvent> &events, int timeoutMs)
+{
+  events.clear();
+
+#if defined(TARGET_LINUX)
+  int epoll;
+  int wakeup;
+  {
+    CSingleLock lock(m_critSection);
+    if (m_epoll < 0)
+      return -1;
+
+    // keeps Deinitialize() from closing the descriptors until we're done
+    epoll = m_epoll;
+    wakeup = m_wakeup[0];
+    m_waiting++;
+    m_waitDone.Reset();
+  }
+
+  struct epoll_event ready[REACTOR_MAX_EVENTS];
+  int count = epoll_wait(epoll, ready, REACTOR_MAX_EVENTS, timeoutMs);
+  int error = errno;
+
+  for (int i = 0; i < count; i++)
+  {
+    if (ready[i].data.fd == wakeup)
+    {
+      DrainWakeUp();
+      continue;
+    }
+
+    ReadyEvent event = { ready[i].data.fd, 0 };
+    if (ready[i].events & (EPOLLIN | EPOLLRDHUP))
+      event.events |= EVENT_READ;
+    if (ready[i].events & EPOLLOUT)
+      event.events |= EVENT_WRITE;
+    if (ready[i].events & (EPOLLERR | EPOLLHUP))
+      event.events |= EVENT_ERROR;
+    events.push_back(event);
+  }
+
+  {
+    CSingleLock lock(m_critSection);
+    if (--m_waiting == 0)
+      m_waitDone.Set();
+  }
+
+  if (count < 0)
+    return error == EINTR ? 0 : -1;
+#else
+  fd_set rfds, wfds;
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+  SOCKET maxfd = 0;
+
+  {
+    CSingleLock lock(m_critSection);
+    if (!IsInitialized())
+      return -1;
+
+    for (const auto& socket : m_sockets)
+    {
+      if (socket.second & EVENT_READ)
+        FD_SET(socket.first, &rfds);
+      if (socket.second & EVENT_WRITE)
+        FD_SET(socket.first, &wfds);
+      if ((intptr_t)socket.first > (intptr_t)maxfd)
+        maxfd = socket.first;
+    }
+
+#if defined(TARGET_POSIX)
+    if (m_wakeup[0] >= 0)
+    {
+      FD_SET(m_wakeup[0], &rfds);
+      if (m_wakeup[0] > (intptr_t)maxfd)
+        maxfd = m_wakeup[0];
+    }
+#endif
+
+    m_waiting++;
+    m_waitDone.Reset();
+  }
+
+  struct timeval to = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+  int count = select((intptr_t)maxfd + 1, &rfds, &wfds, NULL, timeoutMs < 0 ? NULL : &to);
+  int error = errno;
+
+  CSingleLock lock(m_critSection);
+  if (--m_waiting == 0)
+    m_waitDone.Set();
+
+  if (count < 0)
+    return error == EINTR ? 0 : -1;
+  if (count == 0 || !IsInitialized())
+    return 0;
+
+#if defined(TARGET_POSIX)
+  if (m_wakeup[0] >= 0 && FD_ISSET(m_wakeup[0], &rfds))
+    DrainWakeUp();
+#endif
+
+  for (const auto& socket : m_sockets)
+  {
+    ReadyEvent event = { socket.first, 0 };
+    if (FD_ISSET(socket.first, &rfds))
+      event.events |= EVENT_READ;
+    if (FD_ISSET(socket.first, &wfds))
+      event.events |= EVENT_WRITE;
+    if (event.events != 0)
+      events.push_back(event);
+  }
+#endif
+
+  return static_cast<int>(events.size());
+}
+
+void CSocketReactor::WakeUp()
+{
+#if defined(TARGET_POSIX)
+  if (m_wakeup[1] >= 0)
+  {
+    char c = 0;
+    if (write(m_wakeup[1], &c, 1) < 0 && errno != EAGAIN)
+      CLog::Log(LOGDEBUG, "CSocketReactor: failed to wake up, error %d", errno);
+  }
+#endif
+}
+
+void CSocketReactor::DrainWakeUp()
+{
+#if defined(TARGET_POSIX)
+  char buffer[64];
+  while (read(m_wakeup[0], buffer, sizeof(buffer)) > 0)
+    ;
+#endif
+}
+
+bool CSocketReactor::SetNonBlocking(SOCKET socket)
+{
+#if defined(TARGET_WINDOWS)
+  u_long nonBlocking = 1;
+  return ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+#else
+  int flags = fcntl(socket, F_GETFL, 0);
+  if (flags < 0)
+    return false;
+
+  return fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool CSocketReactor::WouldBlock()
+{
+#if defined(TARGET_WINDOWS)
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
@@ -0,0 +1,108 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <vector>
+
+#include "system.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+namespace SOCKETS
+{
+  /**********************************************************************/
+  /* Waits for readiness events on many sockets                         */
+  /**********************************************************************/
+
+  /*!
+   \brief Readiness notification for a set of sockets.
+
+   On Linux (and Android) the reactor is backed by an edge-triggered epoll
+   instance so the cost of a wakeup only depends on the number of ready
+   sockets. Other platforms fall back to select(), which only takes sockets
+   that fit into an fd_set (see FD_SETSIZE).
+
+   Because notifications may be edge-triggered, a socket reported as readable
+   must be read until the read would block and a socket reported as writable
+   must be written until the write would block (or nothing is left to write).
+   All sockets added to the reactor should therefore be non-blocking.
+
+   Add(), Modify(), Remove() and WakeUp() may be called from any thread while
+   another thread is blocked in Wait(). Deinitialize() wakes up such a thread
+   and waits for it to return before it closes the descriptors.
+   */
+  class CSocketReactor
+  {
+  public:
+    enum
+    {
+      EVENT_READ  = 0x01,
+      EVENT_WRITE = 0x02,
+      EVENT_ERROR = 0x04
+    };
+
+    typedef struct ReadyEvent
+    {
+      SOCKET socket;
+      int events;
+    } ReadyEvent;
+
+    CSocketReactor();
+    ~CSocketReactor();
+
+    bool Initialize();
+    void Deinitialize();
+    bool IsInitialized() const;
+
+    bool Add(SOCKET socket, int events);
+    bool Modify(SOCKET socket, int events);
+    void Remove(SOCKET socket);
+
+    /*!
+     \brief Wait for events on the registered sockets.
+     \param events [out] the sockets which are ready
+     \param timeoutMs maximum time to wait in milliseconds (-1 waits forever)
+     \return the number of ready sockets, 0 on timeout or wakeup and -1 on error
+     */
+    int Wait(std::vector<ReadyEvent> &events, int timeoutMs);
+
+    /*!
+     \brief Interrupt a thread currently blocked in Wait().
+     */
+    void WakeUp();
+
+    static bool SetNonBlocking(SOCKET socket);
+    static bool WouldBlock();
+
+  private:
+    CSocketReactor(const CSocketReactor&) = delete;
+    CSocketReactor& operator=(const CSocketReactor&) = delete;
+
+    void DrainWakeUp();
+
+    CCriticalSection m_critSection;
+    std::map<SOCKET, int> m_sockets;
+    int m_epoll;
+    int m_wakeup[2];
+    int m_waiting; ///< number of threads in Wait()
+    CEvent m_waitDone;
+  };
+}
@@ -19,6 +19,8 @@
  */
 
 #include "TCPServer.h"
+#include <algorithm>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
@@ -31,6 +33,7 @@
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "websocket/WebSocketManager.h"
 #include "Network.h"
 
@@ -59,8 +62,13 @@ static const bdaddr_t bt_bdaddr_local = {{0, 0, 0, 0xff, 0xff, 0xff}};
 
 using namespace JSONRPC;
 using namespace ANNOUNCEMENT;
+using namespace SOCKETS;
 
 #define RECEIVEBUFFER 1024
+// maximum number of bytes queued for a client which doesn't read fast enough
+#define MAX_SEND_BUFFER (4 * 1024 * 1024)
+// notifications stay in the announcement queue (where they can still be merged) while more than this is unsent
+#define ANNOUNCEMENT_SEND_THRESHOLD (64 * 1024)
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -112,7 +120,8 @@ bool CTCPServer::IsRunning()
   return ((CThread*)ServerInstance)->IsRunning();
 }
 
-CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
+CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer"),
+  m_announcementsPending(false)
 {
   m_port = port;
   m_nonlocal = nonlocal;
@@ -123,112 +132,185 @@ void CTCPServer::Process()
 {
   m_bStop = false;
 
+  std::vector<CSocketReactor::ReadyEvent> events;
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    // while notifications are held back wake up often enough to send them when they are due,
+    // without coalescing nothing is held back and slow clients report when they can take more
+    int timeout = 1000;
+    if (m_announcementsPending && g_advancedSettings.m_jsonAnnouncementCoalesceTime > 0)
+      timeout = std::min(timeout, static_cast<int>(g_advancedSettings.m_jsonAnnouncementCoalesceTime));
 
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
-    {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
-    }
+    bool failed = m_reactor.Wait(events, timeout) < 0;
+    if (failed)
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for socket events failed");
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    for (const auto& event : events)
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      if (failed)
+        break;
+
+      if (std::find(m_servers.begin(), m_servers.end(), event.socket) != m_servers.end())
+      {
+        failed = !AcceptConnections(event.socket);
+        continue;
+      }
+
+      // only this thread adds or removes connections so no lock is needed for the lookup
+      auto connection = m_connections.find(event.socket);
+      if (connection == m_connections.end())
+        continue;
+
+      CTCPClient *client = connection->second;
+      bool close = false;
+      if (event.events & CSocketReactor::EVENT_WRITE)
+      {
+        close = !client->Flush();
+        if (!close && client->SendAnnouncements())
+          m_announcementsPending = true;
+      }
+      if (!close && (event.events & (CSocketReactor::EVENT_READ | CSocketReactor::EVENT_ERROR)))
+        close = !ReadFromClient(client);
+
+      if (close)
+      {
+        CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+        RemoveConnection(client);
+      }
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
-    if (res < 0)
+    // the sockets are only set up again once all events have been handled
+    if (failed)
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
+      continue;
     }
-    else if (res > 0)
+
+    if (m_announcementsPending)
+      SendAnnouncements();
+  }
+
+  Deinitialize();
+}
+
+bool CTCPServer::AcceptConnections(SOCKET server)
+{
+  // the listening sockets are non-blocking so accept everything that is pending
+  while (!m_bStop)
+  {
+    CTCPClient *newconnection = new CTCPClient();
+    newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+    if (newconnection->m_socket == INVALID_SOCKET)
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (!response.empty())
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
-
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+      int error = errno;
+      bool wouldBlock = CSocketReactor::WouldBlock();
+      delete newconnection;
+
+      if (wouldBlock)
+        return true;
+
+      CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", error);
+      // the listening socket is gone, the caller sets the server up again
+      return EBADF != error;
+    }
+
+    CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+    AddConnection(newconnection);
+  }
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+  return true;
+}
+
+bool CTCPServer::ReadFromClient(CTCPClient *&client)
+{
+  // notifications may be edge-triggered so read until the socket would block
+  while (true)
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int nread = recv(client->m_socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    if (nread < 0 && CSocketReactor::WouldBlock())
+      return true;
+    if (nread <= 0)
+      return false;
+
+    std::string response;
+    if (client->IsNew())
+    {
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+      if (!response.empty())
+        client->Send(response.c_str(), response.size());
+
+      if (websocket != NULL)
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+        // Replace the CTCPClient with a CWebSocketClient
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *client);
+        ReplaceConnection(client, websocketClient);
+        client = websocketClient;
       }
     }
+
+    if (response.size() <= 0)
+      client->PushBuffer(this, buffer, nread);
+
+    if (client->Closing())
+      return false;
   }
+}
 
-  Deinitialize();
+void CTCPServer::AddConnection(CTCPClient *client)
+{
+  client->m_reactor = &m_reactor;
+  CSocketReactor::SetNonBlocking(client->m_socket);
+
+  {
+    CSingleLock lock(m_connectionsSection);
+    m_connections[client->m_socket] = client;
+  }
+
+  // register the socket last so that events can't arrive for an unknown connection
+  if (!m_reactor.Add(client->m_socket, CSocketReactor::EVENT_READ))
+    RemoveConnection(client);
+}
+
+void CTCPServer::ReplaceConnection(CTCPClient *client, CTCPClient *replacement)
+{
+  {
+    CSingleLock lock(m_connectionsSection);
+    m_connections[client->m_socket] = replacement;
+  }
+
+  delete client;
+}
+
+void CTCPServer::RemoveConnection(CTCPClient *client)
+{
+  SOCKET socket = client->m_socket;
+  m_reactor.Remove(socket);
+
+  CSingleLock lock(m_connectionsSection);
+  m_connections.erase(socket);
+  client->Disconnect();
+  delete client;
+}
+
+void CTCPServer::SendAnnouncements()
+{
+  // reset the flag first so that notifications queued while sending aren't missed
+  m_announcementsPending = false;
+
+  // only this thread adds or removes connections so no lock is needed for the iteration
+  bool pending = false;
+  for (const auto& connection : m_connections)
+  {
+    if (connection.second->SendAnnouncements())
+      pending = true;
+  }
+
+  if (pending)
+    m_announcementsPending = true;
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -248,24 +330,39 @@ int CTCPServer::GetCapabilities()
 
 void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
-  std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
+  // the notification is serialized once and the same buffer is queued for every client
+  AnnouncementPayload payload = std::make_shared<const std::string>(IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact));
+  std::string key = IJSONRPCAnnouncer::GetCoalescingKey(flag, message, data);
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  // sending only queues the data on slow connections so this never blocks on a client
+  bool pending = false;
   {
+    CSingleLock connectionsLock(m_connectionsSection);
+    for (const auto& connection : m_connections)
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
-        continue;
-    }
+      {
+        CSingleLock lock (connection.second->m_critSection);
+        if ((connection.second->GetAnnouncementFlags() & flag) == 0)
+          continue;
+      }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+      if (connection.second->QueueAnnouncement(key, payload))
+        pending = true;
+    }
   }
+
+  // make sure the server thread wakes up in time to send the held back notifications
+  if (pending && !m_announcementsPending.exchange(true))
+    m_reactor.WakeUp();
 }
 
 bool CTCPServer::Initialize()
 {
   Deinitialize();
 
+  if (!m_reactor.Initialize())
+    return false;
+
   bool started = false;
 
   started |= InitializeBlue();
@@ -273,6 +370,12 @@ bool CTCPServer::Initialize()
 
   if (started)
   {
+    for (std::vector<SOCKET>::const_iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+    {
+      CSocketReactor::SetNonBlocking(*it);
+      m_reactor.Add(*it, CSocketReactor::EVENT_READ);
+    }
+
     CAnnouncementManager::GetInstance().AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
@@ -467,8 +570,6 @@ bool CTCPServer::InitializeTCP()
 {
   SOCKET fd;
 
-  Deinitialize();
-
   if ((fd = CreateTCPServerSocket(m_port, !m_nonlocal, 10, "JSONRPC")) == INVALID_SOCKET)
     return false;
 
@@ -478,13 +579,16 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock(m_connectionsSection);
+    for (auto& connection : m_connections)
+    {
+      connection.second->Disconnect();
+      delete connection.second;
+    }
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -497,14 +601,18 @@ void CTCPServer::Deinitialize()
   m_sdpd = NULL;
 #endif
 
+  m_reactor.Deinitialize();
+
   CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
 }
 
 CTCPServer::CTCPClient::CTCPClient()
+  : m_announcements(g_advancedSettings.m_jsonAnnouncementQueueSize, g_advancedSettings.m_jsonAnnouncementCoalesceTime)
 {
   m_new = true;
   m_announcementflags = ANNOUNCE_ALL;
   m_socket = INVALID_SOCKET;
+  m_reactor = NULL;
   m_beginBrackets = 0;
   m_endBrackets = 0;
   m_beginChar = 0;
@@ -514,6 +622,7 @@ CTCPServer::CTCPClient::CTCPClient()
 }
 
 CTCPServer::CTCPClient::CTCPClient(const CTCPClient& client)
+  : m_announcements(client.m_announcements)
 {
   Copy(client);
 }
@@ -542,12 +651,77 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  // a client which doesn't read its data must not make us buffer without limit
+  if (m_sendBuffer.size() + size > MAX_SEND_BUFFER)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    CLog::Log(LOGWARNING, "JSONRPC Server: Dropping connection because its send buffer exceeded %d bytes", MAX_SEND_BUFFER);
+    // the reactor will report the shutdown and the connection will be removed
+    shutdown(m_socket, SHUT_RDWR);
+    m_sendBuffer.clear();
+    return;
+  }
+
+  m_sendBuffer.append(data, size);
+  Flush();
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+
+  size_t sent = 0;
+  while (sent < m_sendBuffer.size())
+  {
+    int res = send(m_socket, m_sendBuffer.c_str() + sent, m_sendBuffer.size() - sent, 0);
+    if (res < 0)
+    {
+      if (!CSocketReactor::WouldBlock())
+      {
+        m_sendBuffer.clear();
+        return false;
+      }
+      break;
+    }
+    sent += res;
+  }
+  m_sendBuffer.erase(0, sent);
+
+  // only ask for write notifications while there is pending data
+  if (m_reactor != NULL)
+    m_reactor->Modify(m_socket, m_sendBuffer.empty() ? CSocketReactor::EVENT_READ : CSocketReactor::EVENT_READ | CSocketReactor::EVENT_WRITE);
+
+  return true;
+}
+
+bool CTCPServer::CTCPClient::QueueAnnouncement(const std::string &key, const AnnouncementPayload &payload)
+{
+  CSingleLock lock (m_critSection);
+
+  uint64_t dropped = m_announcements.GetStatistics().dropped;
+  m_announcements.Push(key, payload, XbmcThreads::SystemClockMillis());
+  if (dropped == 0 && m_announcements.GetStatistics().dropped > 0)
+    CLog::Log(LOGWARNING, "JSONRPC Server: Announcement queue of a client is full, dropping notifications");
+
+  return SendAnnouncements();
+}
+
+bool CTCPServer::CTCPClient::SendAnnouncements()
+{
+  CSingleLock lock (m_critSection);
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  while (m_sendBuffer.size() < ANNOUNCEMENT_SEND_THRESHOLD && m_announcements.IsReady(now))
+  {
+    AnnouncementPayload payload = m_announcements.Pop();
+    Send(payload->c_str(), payload->size());
+  }
+
+  // a full send buffer is flushed (and the queue emptied) once the reactor reports the socket as writable
+  return m_sendBuffer.size() < ANNOUNCEMENT_SEND_THRESHOLD && !m_announcements.IsEmpty();
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -592,6 +766,12 @@ void CTCPServer::CTCPClient::Disconnect()
   if (m_socket > 0)
   {
     CSingleLock lock (m_critSection);
+
+    const CAnnouncementQueue::Statistics& statistics = m_announcements.GetStatistics();
+    if (statistics.queued > 0)
+      CLog::Log(LOGDEBUG, "JSONRPC Server: Announcement queue statistics: peak depth %zu, %" PRIu64 " queued, %" PRIu64 " merged, %" PRIu64 " dropped",
+                statistics.peakDepth, statistics.queued, statistics.merged, statistics.dropped);
+
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -602,6 +782,7 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
 {
   m_new               = client.m_new;
   m_socket            = client.m_socket;
+  m_reactor           = client.m_reactor;
   m_cliaddr           = client.m_cliaddr;
   m_addrlen           = client.m_addrlen;
   m_announcementflags = client.m_announcementflags;
@@ -610,6 +791,8 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_sendBuffer        = client.m_sendBuffer;
+  m_announcements     = client.m_announcements;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -645,13 +828,21 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
 
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
+  // notifications and responses are sent from different threads
+  CSingleLock lock (m_critSection);
+
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
-  if (msg == NULL || !msg->IsComplete())
+  if (msg == NULL)
     return;
 
-  std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
-  for (unsigned int index = 0; index < frames.size(); index++)
-    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+  if (msg->IsComplete())
+  {
+    const std::vector<const CWebSocketFrame *>& frames = msg->GetFrames();
+    for (unsigned int index = 0; index < frames.size(); index++)
+      CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+  }
+
+  delete msg;
 }
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -666,8 +857,9 @@ void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buff
       std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
       if (send)
       {
+        // these are complete control frames which must not be wrapped into another frame
         for (unsigned int index = 0; index < frames.size(); index++)
-          Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+          CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
       }
       else
       {
@@ -692,7 +884,10 @@ void CTCPServer::CWebSocketClient::Disconnect()
     {
       const CWebSocketFrame *closeFrame = m_websocket->Close();
       if (closeFrame)
-        Send(closeFrame->GetFrameData(), (unsigned int)closeFrame->GetFrameLength());
+      {
+        CTCPClient::Send(closeFrame->GetFrameData(), (unsigned int)closeFrame->GetFrameLength());
+        delete closeFrame;
+      }
     }
 
     if (m_websocket->GetState() == WebSocketStateClosed)
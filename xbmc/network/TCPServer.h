@@ -19,6 +19,8 @@
  *
  */
 
+#include <atomic>
+#include <map>
 #include <vector>
 #include <sys/socket.h>
 
@@ -28,6 +30,8 @@
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "network/AnnouncementQueue.h"
+#include "network/SocketReactor.h"
 #include "websocket/WebSocket.h"
 
 class CVariant;
@@ -55,6 +59,14 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
+    class CTCPClient;
+    bool AcceptConnections(SOCKET server);
+    bool ReadFromClient(CTCPClient *&client);
+    void AddConnection(CTCPClient *client);
+    void ReplaceConnection(CTCPClient *client, CTCPClient *replacement);
+    void RemoveConnection(CTCPClient *client);
+    void SendAnnouncements();
+
     class CTCPClient : public IClient
     {
     public:
@@ -76,10 +88,31 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Write as much of the pending send buffer as the socket accepts.
+       \return false if the connection is broken, true otherwise
+       */
+      bool Flush();
+
+      /*!
+       \brief Queue a notification for the client and send everything which is due.
+       \param key coalescing key of the notification, empty if it must not be merged
+       \param payload the serialized notification
+       \return true if notifications are still waiting in the queue, false otherwise
+       */
+      bool QueueAnnouncement(const std::string &key, const AnnouncementPayload &payload);
+
+      /*!
+       \brief Move due notifications from the queue into the send buffer.
+       \return true if notifications are held back until they are due, false otherwise
+       */
+      bool SendAnnouncements();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
       CCriticalSection m_critSection;
+      SOCKETS::CSocketReactor *m_reactor;
 
     protected:
       void Copy(const CTCPClient& client);
@@ -89,6 +122,8 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendBuffer;
+      CAnnouncementQueue m_announcements;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -111,7 +146,10 @@ namespace JSONRPC
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    SOCKETS::CSocketReactor m_reactor;
+    CCriticalSection m_connectionsSection;
+    std::map<SOCKET, CTCPClient*> m_connections;
+    std::atomic<bool> m_announcementsPending;
     std::vector<SOCKET> m_servers;
     int m_port;
     bool m_nonlocal;
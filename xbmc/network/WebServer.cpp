@@ -222,6 +222,10 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
       // if we got a GET request we need to check if it should be cached
       if (request.method == GET)
       {
+        // handle If-None-Match if the entity tag is known before handling the request
+        if (IsRequestNotModified(request, handler->GetETag()))
+          return SendNotModifiedResponse(handler);
+
         if (handler->CanBeCached())
         {
           bool cacheable = IsRequestCacheable(request);
@@ -239,16 +243,7 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
             if (cacheable &&
               ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince) &&
               lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
-            {
-              struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
-              if (response == nullptr)
-              {
-                CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP 304 response", m_port);
-                return MHD_NO;
-              }
-
-              return FinalizeRequest(handler, MHD_HTTP_NOT_MODIFIED, response);
-            }
+              return SendNotModifiedResponse(handler);
             // handle If-Unmodified-Since
             else if (ifUnmodifiedSinceDate.SetFromRFC1123DateTime(ifUnmodifiedSince) &&
               lastModified.GetAsUTCDateTime() > ifUnmodifiedSinceDate)
@@ -349,6 +344,12 @@ int CWebServer::HandleRequest(const std::shared_ptr<IHTTPRequestHandler>& handle
   }
 
   const HTTPResponseDetails &responseDetails = handler->GetResponseDetails();
+
+  // handle If-None-Match if the entity tag is only known after handling the request
+  if (request.method == GET && responseDetails.status == MHD_HTTP_OK &&
+      IsRequestNotModified(request, handler->GetETag()))
+    return SendNotModifiedResponse(handler);
+
   struct MHD_Response *response = nullptr;
   switch (responseDetails.type)
   {
@@ -406,6 +407,11 @@ int CWebServer::FinalizeRequest(const std::shared_ptr<IHTTPRequestHandler>& hand
   if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
     handler->AddResponseHeader(MHD_HTTP_HEADER_LAST_MODIFIED, lastModified.GetAsRFC1123DateTime());
 
+  // if the request handler has provided an entity tag and it hasn't been set as a header, add it
+  std::string etag = handler->GetETag();
+  if (!etag.empty())
+    handler->AddResponseHeader(MHD_HTTP_HEADER_ETAG, etag);
+
   // check if the request handler has set Cache-Control and add it if not
   if (!handler->HasResponseHeader(MHD_HTTP_HEADER_CACHE_CONTROL))
   {
@@ -498,6 +504,33 @@ bool CWebServer::IsRequestCacheable(HTTPRequest request) const
   return true;
 }
 
+bool CWebServer::IsRequestNotModified(HTTPRequest request, const std::string &etag) const
+{
+  if (etag.empty())
+    return false;
+
+  std::string ifNoneMatch = HTTPRequestHandlerUtils::GetRequestHeaderValue(request.connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+  if (ifNoneMatch.empty())
+    return false;
+
+  // If-None-Match uses the weak comparison function so ignore any W/ prefixes
+  std::vector<std::string> entityTags = StringUtils::Split(ifNoneMatch, ",");
+  for (auto entityTag : entityTags)
+  {
+    entityTag = StringUtils::Trim(entityTag);
+    if (entityTag == "*")
+      return true;
+
+    if (StringUtils::StartsWith(entityTag, "W/"))
+      entityTag.erase(0, 2);
+
+    if (entityTag == etag)
+      return true;
+  }
+
+  return false;
+}
+
 bool CWebServer::IsRequestRanged(HTTPRequest request, const CDateTime &lastModified) const
 {
   // parse the Range header and store it in the request object
@@ -930,6 +963,18 @@ int CWebServer::CreateMemoryDownloadResponse(struct MHD_Connection *connection,
   return MHD_YES;
 }
 
+int CWebServer::SendNotModifiedResponse(const std::shared_ptr<IHTTPRequestHandler>& handler)
+{
+  struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
+  if (response == nullptr)
+  {
+    CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP 304 response", m_port);
+    return MHD_NO;
+  }
+
+  return FinalizeRequest(handler, MHD_HTTP_NOT_MODIFIED, response);
+}
+
 int CWebServer::SendResponse(HTTPRequest request, int responseStatus, MHD_Response *response) const
 {
   LogResponse(request, responseStatus);
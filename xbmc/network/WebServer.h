@@ -83,6 +83,7 @@ private:
   bool IsAuthenticated(HTTPRequest request) const;
 
   bool IsRequestCacheable(HTTPRequest request) const;
+  bool IsRequestNotModified(HTTPRequest request, const std::string &etag) const;
   bool IsRequestRanged(HTTPRequest request, const CDateTime &lastModified) const;
 
   void SetupPostDataProcessing(HTTPRequest request, ConnectionHandler *connectionHandler, std::shared_ptr<IHTTPRequestHandler> handler, void **con_cls) const;
@@ -97,6 +98,7 @@ private:
   int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response) const;
   int CreateMemoryDownloadResponse(struct MHD_Connection *connection, const void *data, size_t size, bool free, bool copy, struct MHD_Response *&response) const;
 
+  int SendNotModifiedResponse(const std::shared_ptr<IHTTPRequestHandler>& handler);
   int SendResponse(HTTPRequest request, int responseStatus, MHD_Response *response) const;
   int SendErrorResponse(HTTPRequest request, int errorType, HTTPMethod method) const;
 
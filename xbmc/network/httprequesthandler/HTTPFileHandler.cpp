@@ -20,6 +20,7 @@
 
 #include "system.h"
 #include "HTTPFileHandler.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
 #include "utils/Mime.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -29,7 +30,8 @@ CHTTPFileHandler::CHTTPFileHandler()
     m_url(),
     m_canHandleRanges(true),
     m_canBeCached(true),
-    m_lastModified()
+    m_lastModified(),
+    m_etag()
 { }
 
 CHTTPFileHandler::CHTTPFileHandler(const HTTPRequest &request)
@@ -37,7 +39,8 @@ CHTTPFileHandler::CHTTPFileHandler(const HTTPRequest &request)
     m_url(),
     m_canHandleRanges(true),
     m_canBeCached(true),
-    m_lastModified()
+    m_lastModified(),
+    m_etag()
 { }
 
 int CHTTPFileHandler::HandleRequest()
@@ -88,7 +91,10 @@ void CHTTPFileHandler::SetFile(const std::string& file, int responseStatus)
     {
       struct __stat64 statBuffer;
       if (fileObj.Stat(&statBuffer) == 0)
+      {
         SetLastModifiedDate(&statBuffer);
+        m_etag = CHTTPResponseCache::CreateETag(m_url, statBuffer.st_mtime, statBuffer.st_size);
+      }
     }
   }
 
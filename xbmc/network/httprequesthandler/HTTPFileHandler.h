@@ -35,6 +35,7 @@ public:
   virtual bool CanHandleRanges() const override { return m_canHandleRanges; }
   virtual bool CanBeCached() const override { return m_canBeCached; }
   virtual bool GetLastModifiedDate(CDateTime &lastModified) const override;
+  virtual std::string GetETag() const override { return m_etag; }
 
   virtual std::string GetRedirectUrl() const override { return m_url; }
   virtual std::string GetResponseFile() const override { return m_url; }
@@ -56,5 +57,5 @@ private:
   bool m_canBeCached;
 
   CDateTime m_lastModified;
-
+  std::string m_etag;
 };
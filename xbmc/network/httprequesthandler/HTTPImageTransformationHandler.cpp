@@ -38,16 +38,18 @@ static const std::string ImageBasePath = "/image/";
 
 CHTTPImageTransformationHandler::CHTTPImageTransformationHandler()
   : m_url(),
+    m_imagePath(),
     m_lastModified(),
-    m_buffer(NULL),
+    m_cachedResponse(),
     m_responseData()
 { }
 
 CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPRequest &request)
   : IHTTPRequestHandler(request),
     m_url(),
+    m_imagePath(),
     m_lastModified(),
-    m_buffer(NULL),
+    m_cachedResponse(),
     m_responseData()
 {
   m_url = m_request.pathUrl.substr(ImageBasePath.size());
@@ -79,27 +81,29 @@ CHTTPImageTransformationHandler::CHTTPImageTransformationHandler(const HTTPReque
 
   // determine the last modified date
   struct __stat64 statBuffer;
-  if (imageFile.Stat(pathToUrl, &statBuffer) != 0)
-    return;
-
-  struct tm *time;
+  if (imageFile.Stat(pathToUrl, &statBuffer) == 0)
+  {
+    struct tm *time;
 #ifdef HAVE_LOCALTIME_R
-  struct tm result = {};
-  time = localtime_r((time_t*)&statBuffer.st_mtime, &result);
+    struct tm result = {};
+    time = localtime_r((time_t*)&statBuffer.st_mtime, &result);
 #else
-  time = localtime((time_t *)&statBuffer.st_mtime);
+    time = localtime((time_t *)&statBuffer.st_mtime);
 #endif
-  if (time == NULL)
-    return;
+    if (time != NULL)
+      m_lastModified = *time;
+  }
 
-  m_lastModified = *time;
+  // check if the transformed image has already been created by a previous request
+  m_imagePath = GetTransformedImagePath();
+  m_cachedResponse = CHTTPResponseCache::GetInstance().Get(m_imagePath);
+  if (m_cachedResponse != nullptr && m_cachedResponse->GetLastModified() != m_lastModified)
+    m_cachedResponse.reset();
 }
 
 CHTTPImageTransformationHandler::~CHTTPImageTransformationHandler()
 {
   m_responseData.clear();
-  delete m_buffer;
-  m_buffer = NULL;
 }
 
 bool CHTTPImageTransformationHandler::CanHandleRequest(const HTTPRequest &request) const
@@ -130,52 +134,38 @@ int CHTTPImageTransformationHandler::HandleRequest()
     return MHD_YES;
   }
 
-  // get the transformation options
-  std::map<std::string, std::string> options;
-  HTTPRequestHandlerUtils::GetRequestHeaderValues(m_request.connection, MHD_GET_ARGUMENT_KIND, options);
-
-  std::vector<std::string> urlOptions;
-  std::map<std::string, std::string>::const_iterator option = options.find(TRANSFORMATION_OPTION_WIDTH);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_WIDTH "=" + option->second);
-
-  option = options.find(TRANSFORMATION_OPTION_HEIGHT);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_HEIGHT "=" + option->second);
-
-  option = options.find(TRANSFORMATION_OPTION_SCALING_ALGORITHM);
-  if (option != options.end())
-    urlOptions.push_back(TRANSFORMATION_OPTION_SCALING_ALGORITHM "=" + option->second);
-
-  std::string imagePath = m_url;
-  if (!urlOptions.empty())
+  // transform the image unless it is already available from the response cache
+  if (m_cachedResponse == nullptr)
   {
-    imagePath += "?";
-    imagePath += StringUtils::Join(urlOptions, "&");
+    // resize the image into a local buffer
+    uint8_t *buffer = NULL;
+    size_t bufferSize;
+    if (!CTextureCacheJob::ResizeTexture(m_imagePath, buffer, bufferSize))
+    {
+      m_response.status = MHD_HTTP_INTERNAL_SERVER_ERROR;
+      m_response.type = HTTPError;
+
+      return MHD_YES;
+    }
+
+    m_cachedResponse = CHTTPResponseCache::GetInstance().Put(m_imagePath, m_url, m_response.contentType, m_lastModified, buffer, bufferSize);
+    delete[] buffer;
   }
 
-  // resize the image into the local buffer
-  size_t bufferSize;
-  if (!CTextureCacheJob::ResizeTexture(imagePath, m_buffer, bufferSize))
-  {
-    m_response.status = MHD_HTTP_INTERNAL_SERVER_ERROR;
-    m_response.type = HTTPError;
-
-    return MHD_YES;
-  }
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(m_cachedResponse->GetData());
 
   // store the size of the image
-  m_response.totalLength = bufferSize;
+  m_response.totalLength = m_cachedResponse->GetSize();
 
   // nothing else to do if the request is not ranged
   if (!GetRequestedRanges(m_response.totalLength))
   {
-    m_responseData.push_back(CHttpResponseRange(m_buffer, 0, m_response.totalLength - 1));
+    m_responseData.push_back(CHttpResponseRange(data, 0, m_response.totalLength - 1));
     return MHD_YES;
   }
 
   for (HttpRanges::const_iterator range = m_request.ranges.Begin(); range != m_request.ranges.End(); ++range)
-    m_responseData.push_back(CHttpResponseRange(m_buffer + range->GetFirstPosition(), range->GetFirstPosition(), range->GetLastPosition()));
+    m_responseData.push_back(CHttpResponseRange(data + range->GetFirstPosition(), range->GetFirstPosition(), range->GetLastPosition()));
 
   return MHD_YES;
 }
@@ -188,3 +178,40 @@ bool CHTTPImageTransformationHandler::GetLastModifiedDate(CDateTime &lastModifie
   lastModified = m_lastModified;
   return true;
 }
+
+std::string CHTTPImageTransformationHandler::GetETag() const
+{
+  if (m_cachedResponse == nullptr)
+    return "";
+
+  return m_cachedResponse->GetETag();
+}
+
+std::string CHTTPImageTransformationHandler::GetTransformedImagePath() const
+{
+  // get the transformation options
+  std::map<std::string, std::string> options;
+  HTTPRequestHandlerUtils::GetRequestHeaderValues(m_request.connection, MHD_GET_ARGUMENT_KIND, options);
+
+  std::vector<std::string> urlOptions;
+  std::map<std::string, std::string>::const_iterator option = options.find(TRANSFORMATION_OPTION_WIDTH);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_WIDTH "=" + option->second);
+
+  option = options.find(TRANSFORMATION_OPTION_HEIGHT);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_HEIGHT "=" + option->second);
+
+  option = options.find(TRANSFORMATION_OPTION_SCALING_ALGORITHM);
+  if (option != options.end())
+    urlOptions.push_back(TRANSFORMATION_OPTION_SCALING_ALGORITHM "=" + option->second);
+
+  std::string imagePath = m_url;
+  if (!urlOptions.empty())
+  {
+    imagePath += "?";
+    imagePath += StringUtils::Join(urlOptions, "&");
+  }
+
+  return imagePath;
+}
@@ -23,6 +23,7 @@
 #include <string>
 
 #include "XBDateTime.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 
 class CHTTPImageTransformationHandler : public IHTTPRequestHandler
@@ -39,6 +40,7 @@ public:
   bool CanHandleRanges() const override { return true; }
   bool CanBeCached() const override { return true; }
   bool GetLastModifiedDate(CDateTime &lastModified) const override;
+  std::string GetETag() const override;
 
   HttpResponseRanges GetResponseData() const override { return m_responseData; }
 
@@ -49,9 +51,12 @@ protected:
   explicit CHTTPImageTransformationHandler(const HTTPRequest &request);
 
 private:
+  std::string GetTransformedImagePath() const;
+
   std::string m_url;
+  std::string m_imagePath;
   CDateTime m_lastModified;
 
-  uint8_t* m_buffer;
+  CHTTPCachedResponsePtr m_cachedResponse;
   HttpResponseRanges m_responseData;
 };
@@ -26,6 +26,7 @@
 #include "interfaces/json-rpc/JSONUtils.h"
 #include "network/WebServer.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
 #include "utils/JSONVariantWriter.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
@@ -114,6 +115,10 @@ int CHTTPJsonRpcHandler::HandleRequest()
 
   m_responseRange.SetData(m_responseData.c_str(), m_responseData.size());
 
+  // allow clients to revalidate the response of GET requests using If-None-Match
+  if (m_request.method == GET)
+    m_etag = CHTTPResponseCache::CreateETag(m_responseData.c_str(), m_responseData.size());
+
   m_response.type = HTTPMemoryDownloadNoFreeCopy;
   m_response.status = MHD_HTTP_OK;
   m_response.contentType = "application/json";
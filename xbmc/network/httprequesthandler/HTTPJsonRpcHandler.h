@@ -38,6 +38,7 @@ public:
   int HandleRequest() override;
 
   HttpResponseRanges GetResponseData() const override;
+  std::string GetETag() const override { return m_etag; }
 
   int GetPriority() const override { return 5; }
 
@@ -55,6 +56,7 @@ protected:
 private:
   std::string m_requestData;
   std::string m_responseData;
+  std::string m_etag;
   CHttpResponseRange m_responseRange;
 
   class CHTTPTransportLayer : public JSONRPC::ITransportLayer
@@ -0,0 +1,322 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <inttypes.h>
+
+#include "HTTPResponseCache.h"
+#include "TextureDatabase.h"
+#include "URL.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/auto_buffer.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#define RESPONSE_CACHE_DISK_PATH "special://temp/webcache/"
+// the disk tier may grow to four times the size of the memory tier
+#define RESPONSE_CACHE_DISK_FACTOR 4
+
+CHTTPCachedResponse::CHTTPCachedResponse(const std::string &source, const std::string &contentType,
+                                         const CDateTime &lastModified, const uint8_t *data, size_t size)
+  : m_source(source),
+    m_contentType(contentType),
+    m_lastModified(lastModified),
+    m_data(reinterpret_cast<const char*>(data), size)
+{
+  m_etag = CHTTPResponseCache::CreateETag(m_data.c_str(), m_data.size());
+}
+
+CHTTPResponseCache& CHTTPResponseCache::GetInstance()
+{
+  static CHTTPResponseCache s_cache(static_cast<size_t>(g_advancedSettings.m_webserverResponseCacheSize) * 1024 * 1024,
+                                    g_advancedSettings.m_webserverResponseDiskCache ? RESPONSE_CACHE_DISK_PATH : "");
+  return s_cache;
+}
+
+CHTTPResponseCache::CHTTPResponseCache(size_t maxMemorySize, const std::string &diskPath)
+  : m_maxMemorySize(maxMemorySize),
+    m_memorySize(0),
+    m_diskCachePath(diskPath),
+    m_maxDiskSize(0),
+    m_diskSize(0),
+    m_diskFileCounter(0)
+{ }
+
+CHTTPResponseCache::~CHTTPResponseCache() = default;
+
+void CHTTPResponseCache::Start()
+{
+  CSingleLock lock(m_critSection);
+
+  if (!m_diskPath.empty() || m_maxMemorySize == 0 || m_diskCachePath.empty())
+    return;
+
+  // remove any leftovers from a previous run
+  if (XFILE::CDirectory::Exists(m_diskCachePath))
+    XFILE::CDirectory::RemoveRecursive(m_diskCachePath);
+  if (!XFILE::CDirectory::Create(m_diskCachePath))
+  {
+    CLog::Log(LOGWARNING, "CHTTPResponseCache: unable to create %s, disabling the disk cache", m_diskCachePath.c_str());
+    return;
+  }
+
+  m_diskPath = m_diskCachePath;
+  m_maxDiskSize = m_maxMemorySize * RESPONSE_CACHE_DISK_FACTOR;
+}
+
+void CHTTPResponseCache::Stop()
+{
+  CSingleLock lock(m_critSection);
+
+  Clear();
+
+  if (!m_diskPath.empty())
+  {
+    XFILE::CDirectory::RemoveRecursive(m_diskPath);
+    m_diskPath.clear();
+    m_maxDiskSize = 0;
+  }
+}
+
+CHTTPCachedResponsePtr CHTTPResponseCache::Get(const std::string &key)
+{
+  CSingleLock lock(m_critSection);
+
+  auto entry = m_memoryEntries.find(key);
+  if (entry != m_memoryEntries.end())
+  {
+    // move the key to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, entry->second.lruPosition);
+    return entry->second.response;
+  }
+
+  CHTTPCachedResponsePtr response = ReadFromDisk(key);
+  if (response != nullptr)
+    AddToMemory(key, response);
+
+  return response;
+}
+
+CHTTPCachedResponsePtr CHTTPResponseCache::Put(const std::string &key, const std::string &source, const std::string &contentType,
+                                               const CDateTime &lastModified, const uint8_t *data, size_t size)
+{
+  CHTTPCachedResponsePtr response = std::make_shared<CHTTPCachedResponse>(GetSourceIdentity(source), contentType, lastModified, data, size);
+
+  CSingleLock lock(m_critSection);
+
+  // replace any existing (outdated) version
+  auto memoryEntry = m_memoryEntries.find(key);
+  if (memoryEntry != m_memoryEntries.end())
+  {
+    m_memorySize -= memoryEntry->second.response->GetSize();
+    m_lru.erase(memoryEntry->second.lruPosition);
+    m_memoryEntries.erase(memoryEntry);
+  }
+  auto diskEntry = m_diskEntries.find(key);
+  if (diskEntry != m_diskEntries.end())
+    RemoveFromDisk(diskEntry);
+
+  // responses which would take up more than a quarter of the cache aren't worth keeping
+  if (size <= m_maxMemorySize / 4)
+    AddToMemory(key, response);
+
+  return response;
+}
+
+void CHTTPResponseCache::Invalidate(const std::string &source)
+{
+  const std::string identity = GetSourceIdentity(source);
+  if (identity.empty())
+    return;
+
+  CSingleLock lock(m_critSection);
+
+  for (auto entry = m_memoryEntries.begin(); entry != m_memoryEntries.end();)
+  {
+    if (entry->second.response->GetSource() == identity)
+    {
+      m_memorySize -= entry->second.response->GetSize();
+      m_lru.erase(entry->second.lruPosition);
+      entry = m_memoryEntries.erase(entry);
+    }
+    else
+      ++entry;
+  }
+
+  for (auto entry = m_diskEntries.begin(); entry != m_diskEntries.end();)
+  {
+    auto current = entry++;
+    if (current->second.source == identity)
+      RemoveFromDisk(current);
+  }
+}
+
+void CHTTPResponseCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+
+  m_memoryEntries.clear();
+  m_lru.clear();
+  m_memorySize = 0;
+
+  while (!m_diskEntries.empty())
+    RemoveFromDisk(m_diskEntries.begin());
+}
+
+std::string CHTTPResponseCache::CreateETag(const char *data, size_t size)
+{
+  Crc32 crc;
+  crc.Compute(data, size);
+
+  return StringUtils::Format("\"%08x-%zx\"", static_cast<uint32_t>(crc), size);
+}
+
+std::string CHTTPResponseCache::CreateETag(const std::string &path, int64_t modificationTime, int64_t size)
+{
+  return StringUtils::Format("\"%08x-%" PRIx64 "-%" PRIx64 "\"", Crc32::Compute(path), modificationTime, size);
+}
+
+std::string CHTTPResponseCache::GetSourceIdentity(const std::string &source)
+{
+  // the texture cache refers to images by their unwrapped URL
+  std::string identity = CTextureUtils::UnwrapImageURL(source);
+
+  // unwrapping isn't possible if the image:// URL contains options
+  if (StringUtils::StartsWith(identity, "image://"))
+    identity = CURL(identity).GetHostName();
+
+  return identity;
+}
+
+void CHTTPResponseCache::AddToMemory(const std::string &key, const CHTTPCachedResponsePtr &response)
+{
+  if (m_maxMemorySize == 0)
+    return;
+
+  m_lru.push_front(key);
+  m_memoryEntries[key] = { response, m_lru.begin() };
+  m_memorySize += response->GetSize();
+
+  EvictFromMemory();
+}
+
+void CHTTPResponseCache::EvictFromMemory()
+{
+  while (m_memorySize > m_maxMemorySize && !m_lru.empty())
+  {
+    const std::string key = m_lru.back();
+    m_lru.pop_back();
+
+    auto entry = m_memoryEntries.find(key);
+    if (entry == m_memoryEntries.end())
+      continue;
+
+    CHTTPCachedResponsePtr response = entry->second.response;
+    m_memorySize -= response->GetSize();
+    m_memoryEntries.erase(entry);
+
+    // keep the response around on disk (if enabled)
+    WriteToDisk(key, response);
+  }
+}
+
+bool CHTTPResponseCache::WriteToDisk(const std::string &key, const CHTTPCachedResponsePtr &response)
+{
+  if (m_diskPath.empty() || response->GetSize() > m_maxDiskSize)
+    return false;
+
+  if (m_diskEntries.find(key) != m_diskEntries.end())
+    return true;
+
+  // make room for the new response
+  while (m_diskSize + response->GetSize() > m_maxDiskSize && !m_diskOrder.empty())
+  {
+    auto oldest = m_diskEntries.find(m_diskOrder.front());
+    if (oldest != m_diskEntries.end())
+      RemoveFromDisk(oldest);
+    else
+      m_diskOrder.pop_front();
+  }
+
+  DiskEntry diskEntry;
+  diskEntry.file = URIUtils::AddFileToFolder(m_diskPath, StringUtils::Format("%u.bin", ++m_diskFileCounter));
+  diskEntry.source = response->GetSource();
+  diskEntry.contentType = response->GetContentType();
+  diskEntry.lastModified = response->GetLastModified();
+  diskEntry.size = response->GetSize();
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(diskEntry.file, true))
+    return false;
+
+  ssize_t written = file.Write(response->GetData(), response->GetSize());
+  file.Close();
+  if (written < 0 || static_cast<size_t>(written) != response->GetSize())
+  {
+    CLog::Log(LOGWARNING, "CHTTPResponseCache: failed to write %s", diskEntry.file.c_str());
+    XFILE::CFile::Delete(diskEntry.file);
+    return false;
+  }
+
+  m_diskSize += diskEntry.size;
+  m_diskEntries.insert(std::make_pair(key, diskEntry));
+  m_diskOrder.push_back(key);
+
+  return true;
+}
+
+CHTTPCachedResponsePtr CHTTPResponseCache::ReadFromDisk(const std::string &key)
+{
+  auto entry = m_diskEntries.find(key);
+  if (entry == m_diskEntries.end())
+    return nullptr;
+
+  XFILE::CFile file;
+  XUTILS::auto_buffer buffer;
+  if (file.LoadFile(entry->second.file, buffer) < 0 || buffer.size() != entry->second.size)
+  {
+    RemoveFromDisk(entry);
+    return nullptr;
+  }
+
+  return std::make_shared<CHTTPCachedResponse>(entry->second.source, entry->second.contentType, entry->second.lastModified,
+                                               reinterpret_cast<const uint8_t*>(buffer.get()), buffer.size());
+}
+
+void CHTTPResponseCache::RemoveFromDisk(std::map<std::string, DiskEntry>::iterator entry)
+{
+  XFILE::CFile::Delete(entry->second.file);
+  m_diskSize -= entry->second.size;
+
+  for (auto key = m_diskOrder.begin(); key != m_diskOrder.end(); ++key)
+  {
+    if (*key == entry->first)
+    {
+      m_diskOrder.erase(key);
+      break;
+    }
+  }
+
+  m_diskEntries.erase(entry);
+}
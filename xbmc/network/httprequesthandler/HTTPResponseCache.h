@@ -0,0 +1,174 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#include "XBDateTime.h"
+#include "threads/CriticalSection.h"
+
+/*!
+ \brief A HTTP response body which has been stored in the response cache.
+ */
+class CHTTPCachedResponse
+{
+public:
+  CHTTPCachedResponse(const std::string &source, const std::string &contentType,
+                      const CDateTime &lastModified, const uint8_t *data, size_t size);
+
+  const std::string& GetSource() const { return m_source; }
+  const std::string& GetContentType() const { return m_contentType; }
+  const CDateTime& GetLastModified() const { return m_lastModified; }
+  const std::string& GetETag() const { return m_etag; }
+
+  const char* GetData() const { return m_data.c_str(); }
+  size_t GetSize() const { return m_data.size(); }
+
+private:
+  std::string m_source;
+  std::string m_contentType;
+  CDateTime m_lastModified;
+  std::string m_etag;
+  std::string m_data;
+};
+
+typedef std::shared_ptr<const CHTTPCachedResponse> CHTTPCachedResponsePtr;
+
+/*!
+ \brief Server-side cache of generated HTTP responses.
+
+ Responses which are expensive to generate (e.g. re-scaled images) are kept in
+ a size bounded in-memory LRU list. Optionally responses evicted from memory
+ are written to special://temp/webcache/ and promoted back into memory on the
+ next request. Every entry is tagged with the source it was generated from so
+ that it can be invalidated when the source changes (see CTextureCache).
+ */
+class CHTTPResponseCache
+{
+public:
+  static CHTTPResponseCache& GetInstance();
+
+  /*!
+   \brief Create a cache independent of the one used by the webserver.
+   \param maxMemorySize maximum size of the responses kept in memory (in bytes)
+   \param diskPath directory of the disk tier, empty to keep responses in memory only
+   */
+  CHTTPResponseCache(size_t maxMemorySize, const std::string &diskPath);
+  ~CHTTPResponseCache();
+
+  /*!
+   \brief Prepare the disk tier (if any), removing the files left behind by a previous run.
+   Called when the webserver is started, until then responses are only kept in memory.
+   */
+  void Start();
+
+  /*!
+   \brief Remove all responses from the cache and the files of the disk tier.
+   Called when the webserver is stopped.
+   */
+  void Stop();
+
+  /*!
+   \brief Retrieve a cached response.
+   \param key unique key of the response (URL including all relevant options)
+   \return the cached response or nullptr if it isn't cached
+   */
+  CHTTPCachedResponsePtr Get(const std::string &key);
+
+  /*!
+   \brief Add a response to the cache.
+   \param key unique key of the response (URL including all relevant options)
+   \param source the source the response has been generated from (used for invalidation)
+   \param contentType the MIME type of the response
+   \param lastModified the last modification date of the source
+   \param data raw data of the response
+   \param size size of the raw data of the response
+   \return the cached response (even if it was too large to be kept in the cache)
+   */
+  CHTTPCachedResponsePtr Put(const std::string &key, const std::string &source, const std::string &contentType,
+                             const CDateTime &lastModified, const uint8_t *data, size_t size);
+
+  /*!
+   \brief Remove all responses generated from the given source.
+   \param source the source (e.g. the URL of an image) which has changed
+   */
+  void Invalidate(const std::string &source);
+
+  /*!
+   \brief Remove all responses from the cache.
+   */
+  void Clear();
+
+  /*!
+   \brief Create a strong entity tag (including the quotes) for the given data.
+   */
+  static std::string CreateETag(const char *data, size_t size);
+
+  /*!
+   \brief Create an entity tag (including the quotes) from the identity of a file.
+   */
+  static std::string CreateETag(const std::string &path, int64_t modificationTime, int64_t size);
+
+private:
+  CHTTPResponseCache(const CHTTPResponseCache&) = delete;
+  CHTTPResponseCache& operator=(const CHTTPResponseCache&) = delete;
+
+  typedef struct DiskEntry
+  {
+    std::string file;
+    std::string source;
+    std::string contentType;
+    CDateTime lastModified;
+    size_t size;
+  } DiskEntry;
+
+  typedef struct MemoryEntry
+  {
+    CHTTPCachedResponsePtr response;
+    std::list<std::string>::iterator lruPosition;
+  } MemoryEntry;
+
+  static std::string GetSourceIdentity(const std::string &source);
+
+  void AddToMemory(const std::string &key, const CHTTPCachedResponsePtr &response);
+  void EvictFromMemory();
+  bool WriteToDisk(const std::string &key, const CHTTPCachedResponsePtr &response);
+  CHTTPCachedResponsePtr ReadFromDisk(const std::string &key);
+  void RemoveFromDisk(std::map<std::string, DiskEntry>::iterator entry);
+
+  CCriticalSection m_critSection;
+
+  size_t m_maxMemorySize;
+  size_t m_memorySize;
+  std::map<std::string, MemoryEntry> m_memoryEntries;
+  std::list<std::string> m_lru; ///< most recently used keys first
+
+  std::string m_diskCachePath; ///< directory of the disk tier once it's started
+  std::string m_diskPath;
+  size_t m_maxDiskSize;
+  size_t m_diskSize;
+  std::map<std::string, DiskEntry> m_diskEntries;
+  std::list<std::string> m_diskOrder; ///< oldest keys first
+  unsigned int m_diskFileCounter;
+};
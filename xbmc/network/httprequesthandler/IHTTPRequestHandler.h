@@ -150,6 +150,15 @@ public:
   * \details This is only used if the response can be cached.
   */
   virtual bool GetLastModifiedDate(CDateTime &lastModified) const { return false; }
+
+  /*!
+  * \brief Returns the entity tag (including the quotes) of the response data.
+  *
+  * \details An empty entity tag means that the response data can't be validated
+  * using If-None-Match. The entity tag may only be available after HandleRequest()
+  * has been called.
+  */
+  virtual std::string GetETag() const { return ""; }
  
   /*!
    * \brief Returns the ranges with raw data belonging to the response.
@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "network/AnnouncementQueue.h"
+
+using namespace JSONRPC;
+
+static AnnouncementPayload CreatePayload(const std::string &data)
+{
+  return std::make_shared<const std::string>(data);
+}
+
+TEST(TestAnnouncementQueue, SendsImmediateNotificationsRightAway)
+{
+  CAnnouncementQueue queue(10, 250);
+  queue.Push("", CreatePayload("a"), 1000);
+
+  EXPECT_TRUE(queue.IsReady(1000));
+  EXPECT_EQ("a", *queue.Pop());
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(nullptr, queue.Pop());
+}
+
+TEST(TestAnnouncementQueue, HoldsBackCoalescableNotifications)
+{
+  CAnnouncementQueue queue(10, 250);
+  queue.Push("key", CreatePayload("a"), 1000);
+
+  EXPECT_FALSE(queue.IsReady(1000));
+  EXPECT_FALSE(queue.IsReady(1249));
+  EXPECT_TRUE(queue.IsReady(1250));
+}
+
+TEST(TestAnnouncementQueue, MergesNotificationsWithTheSameKey)
+{
+  CAnnouncementQueue queue(10, 250);
+  queue.Push("key1", CreatePayload("a"), 1000);
+  queue.Push("key2", CreatePayload("b"), 1010);
+  queue.Push("key1", CreatePayload("c"), 1020);
+
+  EXPECT_EQ(2U, queue.GetSize());
+  EXPECT_EQ(1U, queue.GetStatistics().merged);
+  EXPECT_EQ(3U, queue.GetStatistics().queued);
+
+  // the merged notification carries the newest payload at the newest position
+  EXPECT_EQ("b", *queue.Pop());
+  EXPECT_EQ("c", *queue.Pop());
+}
+
+TEST(TestAnnouncementQueue, MergedNotificationDoesNotOvertakeImmediateOnes)
+{
+  CAnnouncementQueue queue(10, 250);
+  queue.Push("key", CreatePayload("a"), 1000);
+  queue.Push("", CreatePayload("b"), 1010);
+  queue.Push("key", CreatePayload("c"), 1020);
+
+  EXPECT_EQ(2U, queue.GetSize());
+  ASSERT_TRUE(queue.IsReady(1020));
+  EXPECT_EQ("b", *queue.Pop());
+
+  // the merged notification keeps the deadline of the superseded one
+  EXPECT_FALSE(queue.IsReady(1249));
+  ASSERT_TRUE(queue.IsReady(1250));
+  EXPECT_EQ("c", *queue.Pop());
+}
+
+TEST(TestAnnouncementQueue, ImmediateNotificationReleasesEarlierOnes)
+{
+  CAnnouncementQueue queue(10, 250);
+  queue.Push("key", CreatePayload("a"), 1000);
+  queue.Push("", CreatePayload("b"), 1010);
+
+  ASSERT_TRUE(queue.IsReady(1010));
+  EXPECT_EQ("a", *queue.Pop());
+  ASSERT_TRUE(queue.IsReady(1010));
+  EXPECT_EQ("b", *queue.Pop());
+  EXPECT_FALSE(queue.IsReady(1010));
+}
+
+TEST(TestAnnouncementQueue, DropsOldestCoalescableNotificationWhenFull)
+{
+  CAnnouncementQueue queue(3, 250);
+  queue.Push("", CreatePayload("a"), 1000);
+  queue.Push("key1", CreatePayload("b"), 1000);
+  queue.Push("key2", CreatePayload("c"), 1000);
+  queue.Push("", CreatePayload("d"), 1000);
+
+  EXPECT_EQ(3U, queue.GetSize());
+  EXPECT_EQ(1U, queue.GetStatistics().dropped);
+  EXPECT_EQ(3U, queue.GetStatistics().peakDepth);
+
+  EXPECT_EQ("a", *queue.Pop());
+  EXPECT_EQ("c", *queue.Pop());
+  EXPECT_EQ("d", *queue.Pop());
+
+  // a dropped notification can't be merged into anymore
+  queue.Push("key1", CreatePayload("e"), 1000);
+  EXPECT_EQ(0U, queue.GetStatistics().merged);
+}
+
+TEST(TestAnnouncementQueue, CopyKeepsMergingIntoOwnEntries)
+{
+  CAnnouncementQueue queue(10, 250);
+  queue.Push("key", CreatePayload("a"), 1000);
+
+  CAnnouncementQueue copy(queue);
+  copy.Push("key", CreatePayload("b"), 1010);
+
+  EXPECT_EQ("a", *queue.Pop());
+  EXPECT_EQ("b", *copy.Pop());
+}
+
+TEST(TestAnnouncementQueue, SendsEverythingWithoutCoalescingTime)
+{
+  CAnnouncementQueue queue(10, 0);
+  queue.Push("key", CreatePayload("a"), 1000);
+  queue.Push("key", CreatePayload("b"), 1000);
+
+  EXPECT_EQ(2U, queue.GetSize());
+  EXPECT_EQ(0U, queue.GetStatistics().merged);
+  ASSERT_TRUE(queue.IsReady(1000));
+  EXPECT_EQ("a", *queue.Pop());
+  ASSERT_TRUE(queue.IsReady(1000));
+  EXPECT_EQ("b", *queue.Pop());
+}
@@ -0,0 +1,164 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "network/httprequesthandler/HTTPResponseCache.h"
+
+#define RESPONSE_SIZE 70
+// four responses fit into memory, larger ones than a quarter aren't kept
+#define CACHE_SIZE    (4 * RESPONSE_SIZE + RESPONSE_SIZE / 2)
+#define DISK_PATH     "special://temp/TestHTTPResponseCache/"
+
+class TestHTTPResponseCache : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    if (XFILE::CDirectory::Exists(DISK_PATH))
+      XFILE::CDirectory::RemoveRecursive(DISK_PATH);
+  }
+
+  static CHTTPCachedResponsePtr Put(CHTTPResponseCache &cache, const std::string &key,
+                                    const std::string &source = "/pictures/image.jpg", size_t size = RESPONSE_SIZE)
+  {
+    // make the data of every key different
+    std::string data(size, key.empty() ? ' ' : key[0]);
+    return cache.Put(key, source, "image/jpeg", CDateTime(2017, 1, 1, 12, 0, 0),
+                     reinterpret_cast<const uint8_t*>(data.c_str()), data.size());
+  }
+};
+
+TEST_F(TestHTTPResponseCache, EvictsLeastRecentlyUsed)
+{
+  CHTTPResponseCache cache(CACHE_SIZE, "");
+  Put(cache, "a");
+  Put(cache, "b");
+  Put(cache, "c");
+  Put(cache, "d");
+
+  // a has been used more recently than b now
+  EXPECT_NE(nullptr, cache.Get("a"));
+
+  Put(cache, "e");
+  EXPECT_EQ(nullptr, cache.Get("b"));
+  EXPECT_NE(nullptr, cache.Get("a"));
+  EXPECT_NE(nullptr, cache.Get("c"));
+  EXPECT_NE(nullptr, cache.Get("d"));
+  EXPECT_NE(nullptr, cache.Get("e"));
+
+  Put(cache, "f");
+  EXPECT_EQ(nullptr, cache.Get("a"));
+  EXPECT_NE(nullptr, cache.Get("f"));
+}
+
+TEST_F(TestHTTPResponseCache, SizeLimit)
+{
+  CHTTPResponseCache cache(CACHE_SIZE, "");
+
+  // too large responses are handed back, but not kept
+  CHTTPCachedResponsePtr response = Put(cache, "large", "/pictures/image.jpg", CACHE_SIZE / 4 + 1);
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ(static_cast<size_t>(CACHE_SIZE / 4 + 1), response->GetSize());
+  EXPECT_EQ(nullptr, cache.Get("large"));
+
+  EXPECT_NE(nullptr, Put(cache, "small", "/pictures/image.jpg", CACHE_SIZE / 4));
+  EXPECT_NE(nullptr, cache.Get("small"));
+
+  // without memory nothing is kept at all
+  CHTTPResponseCache disabled(0, "");
+  EXPECT_NE(nullptr, Put(disabled, "a"));
+  EXPECT_EQ(nullptr, disabled.Get("a"));
+}
+
+TEST_F(TestHTTPResponseCache, ReplacesResponses)
+{
+  CHTTPResponseCache cache(CACHE_SIZE, "");
+  CHTTPCachedResponsePtr first = Put(cache, "a");
+  CHTTPCachedResponsePtr second = Put(cache, "a", "/pictures/image.jpg", RESPONSE_SIZE - 1);
+
+  CHTTPCachedResponsePtr response = cache.Get("a");
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ(second->GetETag(), response->GetETag());
+  EXPECT_NE(first->GetETag(), response->GetETag());
+}
+
+TEST_F(TestHTTPResponseCache, Invalidate)
+{
+  CHTTPResponseCache cache(CACHE_SIZE, "");
+  Put(cache, "a1", "/pictures/a.jpg");
+  Put(cache, "a2", "/pictures/a.jpg");
+  Put(cache, "b", "/pictures/b.jpg");
+
+  cache.Invalidate("/pictures/a.jpg");
+  EXPECT_EQ(nullptr, cache.Get("a1"));
+  EXPECT_EQ(nullptr, cache.Get("a2"));
+  EXPECT_NE(nullptr, cache.Get("b"));
+
+  cache.Invalidate("/pictures/unknown.jpg");
+  EXPECT_NE(nullptr, cache.Get("b"));
+
+  cache.Clear();
+  EXPECT_EQ(nullptr, cache.Get("b"));
+}
+
+TEST_F(TestHTTPResponseCache, DiskTier)
+{
+  CHTTPResponseCache cache(CACHE_SIZE, DISK_PATH);
+  cache.Start();
+  ASSERT_TRUE(XFILE::CDirectory::Exists(DISK_PATH));
+
+  CHTTPCachedResponsePtr original = Put(cache, "a", "/pictures/a.jpg");
+  Put(cache, "b");
+  Put(cache, "c");
+  Put(cache, "d");
+  // a is moved to disk
+  Put(cache, "e");
+
+  CFileItemList files;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(DISK_PATH, files));
+  EXPECT_EQ(1, files.Size());
+
+  // and promoted back into memory
+  CHTTPCachedResponsePtr response = cache.Get("a");
+  ASSERT_NE(nullptr, response);
+  EXPECT_NE(original, response);
+  EXPECT_EQ(original->GetSource(), response->GetSource());
+  EXPECT_EQ(original->GetContentType(), response->GetContentType());
+  EXPECT_EQ(original->GetLastModified(), response->GetLastModified());
+  EXPECT_EQ(original->GetETag(), response->GetETag());
+  ASSERT_EQ(original->GetSize(), response->GetSize());
+  EXPECT_EQ(0, memcmp(original->GetData(), response->GetData(), response->GetSize()));
+
+  // invalidated responses are removed from disk as well
+  Put(cache, "f", "/pictures/f.jpg");
+  ASSERT_NE(nullptr, cache.Get("b"));
+  cache.Invalidate("/pictures/image.jpg");
+  EXPECT_EQ(nullptr, cache.Get("b"));
+  EXPECT_EQ(nullptr, cache.Get("c"));
+  EXPECT_NE(nullptr, cache.Get("f"));
+
+  cache.Stop();
+  EXPECT_FALSE(XFILE::CDirectory::Exists(DISK_PATH));
+  EXPECT_EQ(nullptr, cache.Get("a"));
+}
@@ -0,0 +1,233 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#if defined(TARGET_POSIX)
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "network/SocketReactor.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+using namespace SOCKETS;
+
+// number of simulated clients, each of them needs two descriptors
+#define TEST_CLIENT_COUNT 5000
+
+class TestSocketReactor : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    ASSERT_TRUE(reactor.Initialize());
+  }
+
+  virtual void TearDown()
+  {
+    reactor.Deinitialize();
+
+    for (auto pair : pairs)
+    {
+      close(pair.first);
+      close(pair.second);
+    }
+    pairs.clear();
+  }
+
+  // the first socket is registered with the reactor, the second one simulates the client
+  bool CreatePair(int events)
+  {
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+      return false;
+
+    pairs.push_back(std::make_pair(sockets[0], sockets[1]));
+    return CSocketReactor::SetNonBlocking(sockets[0]) && reactor.Add(sockets[0], events);
+  }
+
+  CSocketReactor reactor;
+  std::vector<std::pair<SOCKET, SOCKET> > pairs;
+};
+
+TEST_F(TestSocketReactor, TimesOutWithoutEvents)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+
+  std::vector<CSocketReactor::ReadyEvent> events;
+  EXPECT_EQ(0, reactor.Wait(events, 10));
+  EXPECT_TRUE(events.empty());
+}
+
+TEST_F(TestSocketReactor, ReportsReadableSocket)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+  ASSERT_EQ(1, write(pairs[1].second, "x", 1));
+
+  std::vector<CSocketReactor::ReadyEvent> events;
+  ASSERT_EQ(1, reactor.Wait(events, 1000));
+  EXPECT_EQ(pairs[1].first, events[0].socket);
+  EXPECT_TRUE((events[0].events & CSocketReactor::EVENT_READ) != 0);
+
+  // drain the socket until it would block
+  char buffer[16];
+  EXPECT_EQ(1, read(pairs[1].first, buffer, sizeof(buffer)));
+  EXPECT_EQ(-1, read(pairs[1].first, buffer, sizeof(buffer)));
+  EXPECT_TRUE(CSocketReactor::WouldBlock());
+}
+
+TEST_F(TestSocketReactor, ReportsWritableSocketOnlyWhenRequested)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+
+  std::vector<CSocketReactor::ReadyEvent> events;
+  EXPECT_EQ(0, reactor.Wait(events, 10));
+
+  ASSERT_TRUE(reactor.Modify(pairs[0].first, CSocketReactor::EVENT_READ | CSocketReactor::EVENT_WRITE));
+  ASSERT_EQ(1, reactor.Wait(events, 1000));
+  EXPECT_TRUE((events[0].events & CSocketReactor::EVENT_WRITE) != 0);
+}
+
+TEST_F(TestSocketReactor, IgnoresRemovedSocket)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+  reactor.Remove(pairs[0].first);
+  ASSERT_EQ(1, write(pairs[0].second, "x", 1));
+
+  std::vector<CSocketReactor::ReadyEvent> events;
+  EXPECT_EQ(0, reactor.Wait(events, 10));
+}
+
+TEST_F(TestSocketReactor, ReportsClosedPeer)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+  close(pairs[0].second);
+  pairs[0].second = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  std::vector<CSocketReactor::ReadyEvent> events;
+  ASSERT_EQ(1, reactor.Wait(events, 1000));
+
+  char buffer[16];
+  EXPECT_EQ(0, read(pairs[0].first, buffer, sizeof(buffer)));
+}
+
+TEST_F(TestSocketReactor, DeinitializeWhileWaiting)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+
+  class CWaiter : public IRunnable
+  {
+  public:
+    explicit CWaiter(CSocketReactor &reactor) : m_reactor(reactor), m_result(1) { }
+    void Run() override
+    {
+      std::vector<CSocketReactor::ReadyEvent> events;
+      m_result = m_reactor.Wait(events, 10000);
+    }
+
+    CSocketReactor &m_reactor;
+    int m_result;
+  } waiter(reactor);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CThread thread(&waiter, "TestSocketReactor");
+  thread.Create();
+  usleep(100 * 1000);
+
+  // wakes up the waiting thread instead of closing the descriptors under it
+  reactor.Deinitialize();
+  thread.StopThread(true);
+  EXPECT_EQ(0, waiter.m_result);
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 5000U);
+  EXPECT_FALSE(reactor.IsInitialized());
+}
+
+#if defined(TARGET_LINUX)
+// the select() fallback is limited to FD_SETSIZE descriptors
+TEST_F(TestSocketReactor, ScalesToManyClients)
+{
+  // make sure there are enough descriptors for all the clients
+  int clients = TEST_CLIENT_COUNT;
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+  {
+    if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < limit.rlim_max)
+    {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &limit);
+      getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur != RLIM_INFINITY && static_cast<rlim_t>(2 * clients + 64) > limit.rlim_cur)
+      clients = static_cast<int>((limit.rlim_cur - 64) / 2);
+  }
+  if (clients < TEST_CLIENT_COUNT)
+    CLog::Log(LOGWARNING, "TestSocketReactor: descriptor limit only allows %d of %d clients", clients, TEST_CLIENT_COUNT);
+
+  for (int i = 0; i < clients; i++)
+    ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+
+  // every wakeup only reports the one client which has sent something
+  std::vector<CSocketReactor::ReadyEvent> events;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < clients; i++)
+  {
+    ASSERT_EQ(1, write(pairs[i].second, "x", 1));
+    ASSERT_EQ(1, reactor.Wait(events, 1000));
+    ASSERT_EQ(pairs[i].first, events[0].socket);
+
+    char buffer[16];
+    ASSERT_EQ(1, read(pairs[i].first, buffer, sizeof(buffer)));
+  }
+  unsigned int duration = XbmcThreads::SystemClockMillis() - start;
+
+  CLog::Log(LOGDEBUG, "TestSocketReactor: %d single client wakeups took %u ms", clients, duration);
+}
+#else
+TEST_F(TestSocketReactor, RejectsSocketsBeyondFdSetSize)
+{
+  ASSERT_TRUE(CreatePair(CSocketReactor::EVENT_READ));
+
+  // move a socket to a descriptor which doesn't fit into an fd_set
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur <= FD_SETSIZE)
+    return;
+
+  int socket = fcntl(pairs[0].second, F_DUPFD, FD_SETSIZE);
+  ASSERT_GE(socket, FD_SETSIZE);
+  EXPECT_FALSE(reactor.Add(socket, CSocketReactor::EVENT_READ));
+  close(socket);
+
+  // the registered sockets are still served
+  ASSERT_EQ(1, write(pairs[0].second, "x", 1));
+  std::vector<CSocketReactor::ReadyEvent> events;
+  EXPECT_EQ(1, reactor.Wait(events, 1000));
+}
+#endif
+
+#endif
@@ -493,6 +493,50 @@ TEST_F(TestWebServer, CanGetCachedFileWithOlderIfModifiedSince)
   CheckRangesTestFileResponse(curl);
 }
 
+TEST_F(TestWebServer, CanGetFileWithNonMatchingIfNoneMatch)
+{
+  // get the file and its entity tag
+  std::string result;
+  CCurlFile curl;
+  curl.SetRequestHeader(MHD_HTTP_HEADER_RANGE, "");
+  ASSERT_TRUE(curl.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
+  std::string etag = curl.GetHttpHeader().GetValue(MHD_HTTP_HEADER_ETAG);
+  ASSERT_FALSE(etag.empty());
+
+  // get the file with a different If-None-Match value
+  result.clear();
+  CCurlFile curl_etag;
+  curl_etag.SetRequestHeader(MHD_HTTP_HEADER_RANGE, "");
+  curl_etag.SetRequestHeader(MHD_HTTP_HEADER_IF_NONE_MATCH, "\"0123456789\"");
+  ASSERT_TRUE(curl_etag.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
+  EXPECT_STREQ(TEST_FILES_DATA_RANGES, result.c_str());
+  CheckRangesTestFileResponse(curl_etag);
+  EXPECT_STREQ(etag.c_str(), curl_etag.GetHttpHeader().GetValue(MHD_HTTP_HEADER_ETAG).c_str());
+}
+
+TEST_F(TestWebServer, CanGetCachedFileWithMatchingIfNoneMatch)
+{
+  // get the file and its entity tag
+  std::string result;
+  CCurlFile curl;
+  curl.SetRequestHeader(MHD_HTTP_HEADER_RANGE, "");
+  ASSERT_TRUE(curl.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
+  std::string etag = curl.GetHttpHeader().GetValue(MHD_HTTP_HEADER_ETAG);
+  ASSERT_FALSE(etag.empty());
+
+  // get the file with the matching (weak) If-None-Match value
+  result.clear();
+  CCurlFile curl_etag;
+  curl_etag.SetRequestHeader(MHD_HTTP_HEADER_RANGE, "");
+  curl_etag.SetRequestHeader(MHD_HTTP_HEADER_IF_NONE_MATCH, "\"0123456789\", W/" + etag);
+  ASSERT_TRUE(curl_etag.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
+  ASSERT_TRUE(result.empty());
+
+  std::string protocolLine = curl_etag.GetHttpHeader().GetProtoLine();
+  EXPECT_TRUE(protocolLine.find(StringUtils::Format(" %d ", MHD_HTTP_NOT_MODIFIED)) != std::string::npos);
+  EXPECT_STREQ(etag.c_str(), curl_etag.GetHttpHeader().GetValue(MHD_HTTP_HEADER_ETAG).c_str());
+}
+
 /** @todo Fix these two tests, they keep failing and
  *  we want to enable the test suite on PR
  */
@@ -0,0 +1,283 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#if defined(TARGET_POSIX)
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "network/websocket/WebSocket.h"
+#include "network/websocket/WebSocketDeflate.h"
+#include "network/websocket/WebSocketV13.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+#define WEBSOCKET_HANDSHAKE "GET /jsonrpc HTTP/1.1\r\n" \
+                            "Host: localhost\r\n" \
+                            "Upgrade: websocket\r\n" \
+                            "Connection: Upgrade\r\n" \
+                            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n" \
+                            "Sec-WebSocket-Version: 13\r\n"
+
+// creates something looking like a large JSON-RPC response
+static std::string CreateResponse(unsigned int items)
+{
+  std::string response = "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":{\"movies\":[";
+  for (unsigned int i = 0; i < items; i++)
+  {
+    if (i > 0)
+      response += ",";
+    // braces would be taken as a format string by StringUtils::Format()
+    response += "{";
+    response += StringUtils::Format("\"label\":\"Movie %u\",\"movieid\":%u,\"playcount\":%u,\"rating\":%u.%u,\"year\":%u,"
+                                    "\"file\":\"smb://server/movies/Movie %u (%u)/movie.mkv\"",
+                                    i, i + 1, i % 3, i % 10, i % 7, 1950 + i % 70, i, 1950 + i % 70);
+    response += "}";
+  }
+  response += "]}}";
+
+  return response;
+}
+
+static CWebSocket* Connect(const std::string &extensions, std::string &response)
+{
+  std::string handshake = WEBSOCKET_HANDSHAKE;
+  if (!extensions.empty())
+    handshake += "Sec-WebSocket-Extensions: " + extensions + "\r\n";
+  handshake += "\r\n";
+
+  CWebSocket *websocket = new CWebSocketV13();
+  if (!websocket->Handshake(handshake.c_str(), handshake.size(), response) ||
+      websocket->GetState() != WebSocketStateConnected)
+  {
+    delete websocket;
+    return NULL;
+  }
+
+  return websocket;
+}
+
+// reassembles the (possibly compressed) payload of a message sent by the server
+static bool ReadMessage(const CWebSocketMessage *msg, CWebSocketDeflate *deflate, std::string &payload)
+{
+  std::string data;
+  bool compressed = false;
+  const std::vector<const CWebSocketFrame *>& frames = msg->GetFrames();
+  for (unsigned int index = 0; index < frames.size(); index++)
+  {
+    CWebSocketFrame frame(frames[index]->GetFrameData(), frames[index]->GetFrameLength());
+    if (!frame.IsValid() || frame.IsFinal() != (index == frames.size() - 1))
+      return false;
+    if (index == 0)
+      compressed = (frame.GetExtension() & WebSocketExtensionRSV1) != 0;
+    else if (frame.GetOpcode() != WebSocketContinuationFrame)
+      return false;
+
+    data.append(frame.GetApplicationData(), (size_t)frame.GetLength());
+  }
+
+  if (!compressed)
+  {
+    payload = data;
+    return true;
+  }
+
+  return deflate != NULL && deflate->Decompress(data.c_str(), data.size(), payload);
+}
+
+TEST(TestWebSocket, NegotiatesPermessageDeflate)
+{
+  std::string response;
+  std::unique_ptr<CWebSocketDeflate> deflate(CWebSocketDeflate::Negotiate("permessage-deflate; client_max_window_bits", response));
+  ASSERT_TRUE(deflate != nullptr);
+  EXPECT_EQ("permessage-deflate", response);
+
+  // the first offer can't be accepted because zlib doesn't support a window of 8 bits
+  deflate.reset(CWebSocketDeflate::Negotiate("permessage-deflate; server_max_window_bits=8, "
+                                             "permessage-deflate; server_no_context_takeover; server_max_window_bits=\"10\"", response));
+  ASSERT_TRUE(deflate != nullptr);
+  EXPECT_EQ("permessage-deflate; server_no_context_takeover; server_max_window_bits=10", response);
+
+  deflate.reset(CWebSocketDeflate::Negotiate("permessage-deflate; unknown_parameter", response));
+  EXPECT_TRUE(deflate == nullptr);
+  EXPECT_TRUE(response.empty());
+
+  deflate.reset(CWebSocketDeflate::Negotiate("x-webkit-deflate-frame", response));
+  EXPECT_TRUE(deflate == nullptr);
+}
+
+TEST(TestWebSocket, HandshakeAcceptsDeflateOffer)
+{
+  std::string response;
+  std::unique_ptr<CWebSocket> websocket(Connect("permessage-deflate; client_max_window_bits", response));
+  ASSERT_TRUE(websocket != nullptr);
+  EXPECT_NE(std::string::npos, response.find("Sec-WebSocket-Extensions: permessage-deflate\r\n"));
+
+  websocket.reset(Connect("", response));
+  ASSERT_TRUE(websocket != nullptr);
+  EXPECT_EQ(std::string::npos, response.find("Sec-WebSocket-Extensions"));
+}
+
+TEST(TestWebSocket, SharesCompressionContextBetweenMessages)
+{
+  std::string response;
+  std::unique_ptr<CWebSocketDeflate> server(CWebSocketDeflate::Negotiate("permessage-deflate", response));
+  std::unique_ptr<CWebSocketDeflate> client(CWebSocketDeflate::Negotiate("permessage-deflate", response));
+  ASSERT_TRUE(server != nullptr && client != nullptr);
+
+  std::string message = CreateResponse(20);
+  std::string first, second, decompressed;
+  ASSERT_TRUE(server->Compress(message.c_str(), message.size(), first));
+  ASSERT_TRUE(server->Compress(message.c_str(), message.size(), second));
+
+  // the second message can refer to the first one
+  EXPECT_LT(second.size(), first.size());
+
+  ASSERT_TRUE(client->Decompress(first.c_str(), first.size(), decompressed));
+  EXPECT_EQ(message, decompressed);
+  ASSERT_TRUE(client->Decompress(second.c_str(), second.size(), decompressed));
+  EXPECT_EQ(message, decompressed);
+}
+
+TEST(TestWebSocket, FragmentsLargeCompressedMessages)
+{
+  std::string response;
+  std::unique_ptr<CWebSocket> websocket(Connect("permessage-deflate", response));
+  std::unique_ptr<CWebSocketDeflate> client(CWebSocketDeflate::Negotiate("permessage-deflate", response));
+  ASSERT_TRUE(websocket != nullptr && client != nullptr);
+
+  // random data doesn't compress so it has to be split into several frames
+  std::string message;
+  srand(0);
+  for (unsigned int i = 0; i < 256 * 1024; i++)
+    message.push_back((char)(rand() & 0xFF));
+
+  std::unique_ptr<const CWebSocketMessage> msg(websocket->Send(WebSocketBinaryFrame, message.c_str(), message.size()));
+  ASSERT_TRUE(msg != nullptr);
+  EXPECT_TRUE(msg->IsComplete());
+  EXPECT_GT(msg->GetFrames().size(), 1U);
+
+  std::string payload;
+  ASSERT_TRUE(ReadMessage(msg.get(), client.get(), payload));
+  EXPECT_EQ(message, payload);
+}
+
+TEST(TestWebSocket, DecompressesClientMessages)
+{
+  std::string response;
+  std::unique_ptr<CWebSocket> websocket(Connect("permessage-deflate", response));
+  std::unique_ptr<CWebSocketDeflate> client(CWebSocketDeflate::Negotiate("permessage-deflate", response));
+  ASSERT_TRUE(websocket != nullptr && client != nullptr);
+
+  std::string request = "{\"jsonrpc\":\"2.0\",\"method\":\"VideoLibrary.GetMovies\",\"params\":{\"properties\":[\"title\",\"year\"]},\"id\":1}";
+  std::string compressed;
+  ASSERT_TRUE(client->Compress(request.c_str(), request.size(), compressed));
+
+  CWebSocketFrame frame(WebSocketTextFrame, compressed.c_str(), compressed.size(), true, true, 0x12345678, WebSocketExtensionRSV1);
+  std::vector<char> data(frame.GetFrameData(), frame.GetFrameData() + frame.GetFrameLength());
+
+  const char *buffer = data.data();
+  size_t length = data.size();
+  bool send;
+  std::unique_ptr<const CWebSocketMessage> msg(websocket->Handle(buffer, length, send));
+  ASSERT_TRUE(msg != nullptr);
+  EXPECT_FALSE(send);
+  EXPECT_EQ(0U, length);
+  ASSERT_EQ(1U, msg->GetFrames().size());
+
+  const CWebSocketFrame *received = msg->GetFrames().front();
+  EXPECT_EQ(WebSocketTextFrame, received->GetOpcode());
+  EXPECT_EQ(request, std::string(received->GetApplicationData(), (size_t)received->GetLength()));
+}
+
+TEST(TestWebSocket, RejectsCompressedMessagesWithoutNegotiation)
+{
+  std::string response;
+  std::unique_ptr<CWebSocket> websocket(Connect("", response));
+  ASSERT_TRUE(websocket != nullptr);
+
+  CWebSocketFrame frame(WebSocketTextFrame, "abc", 3, true, true, 0x12345678, WebSocketExtensionRSV1);
+  std::vector<char> data(frame.GetFrameData(), frame.GetFrameData() + frame.GetFrameLength());
+
+  const char *buffer = data.data();
+  size_t length = data.size();
+  bool send;
+  EXPECT_TRUE(websocket->Handle(buffer, length, send) == NULL);
+}
+
+#if defined(TARGET_POSIX)
+TEST(TestWebSocket, LoopbackThroughput)
+{
+  const unsigned int messages = 50;
+  std::string message = CreateResponse(500);
+
+  for (int compression = 0; compression < 2; compression++)
+  {
+    std::string response;
+    std::unique_ptr<CWebSocket> websocket(Connect(compression ? "permessage-deflate" : "", response));
+    ASSERT_TRUE(websocket != nullptr);
+
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+    size_t total = 0;
+    std::thread reader([&]() {
+      char buffer[65536];
+      ssize_t res;
+      while ((res = read(sockets[1], buffer, sizeof(buffer))) > 0)
+        total += res;
+    });
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (unsigned int i = 0; i < messages; i++)
+    {
+      std::unique_ptr<const CWebSocketMessage> msg(websocket->Send(WebSocketTextFrame, message.c_str(), message.size()));
+      ASSERT_TRUE(msg != nullptr);
+      for (const auto& frame : msg->GetFrames())
+      {
+        size_t written = 0;
+        while (written < frame->GetFrameLength())
+        {
+          ssize_t res = write(sockets[0], frame->GetFrameData() + written, (size_t)frame->GetFrameLength() - written);
+          ASSERT_GT(res, 0);
+          written += res;
+        }
+      }
+    }
+    close(sockets[0]);
+    reader.join();
+    close(sockets[1]);
+    unsigned int duration = XbmcThreads::SystemClockMillis() - start;
+
+    EXPECT_GE(total, compression ? 1U : messages * message.size());
+    CLog::Log(LOGDEBUG, "TestWebSocket: %u messages of %zu bytes %s compression: %zu bytes on the wire in %u ms",
+              messages, message.size(), compression ? "with" : "without", total, duration);
+  }
+}
+#endif
@@ -18,10 +18,12 @@
  *
  */
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
 #include "WebSocket.h"
+#include "WebSocketDeflate.h"
 #include "utils/EndianSwap.h"
 #include "utils/log.h"
 #include "utils/HttpParser.h"
@@ -42,6 +44,11 @@
 
 #define LENGTH_MIN    0x2
 
+// maximum payload of a single frame, larger messages are fragmented
+#define FRAGMENT_SIZE 32768
+// messages smaller than this aren't worth being compressed
+#define COMPRESSION_MIN_LENGTH 64
+
 CWebSocketFrame::CWebSocketFrame(const char* data, uint64_t length)
 {
   reset();
@@ -55,10 +62,8 @@ CWebSocketFrame::CWebSocketFrame(const char* data, uint64_t length)
 
   // Get the FIN flag
   m_final = ((m_data[0] & MASK_FIN) == MASK_FIN);
-  // Get the RSV1 - RSV3 flags
-  m_extension |= m_data[0] & MASK_RSV1;
-  m_extension |= (m_data[0] & MASK_RSV2) << 1;
-  m_extension |= (m_data[0] & MASK_RSV3) << 2;
+  // Get the RSV1 - RSV3 flags (in the same representation used when creating a frame)
+  m_extension = (m_data[0] & MASK_RSV) >> 4;
   // Get the opcode
   m_opcode = (WebSocketFrameOpcode)(m_data[0] & MASK_OPCODE);
   if (m_opcode >= WebSocketUnknownFrame)
@@ -242,7 +247,7 @@ CWebSocketFrame::~CWebSocketFrame()
 
   if (m_free && m_data != NULL)
   {
-    delete m_data;
+    delete[] m_data;
     m_data = NULL;
   }
 }
@@ -298,6 +303,12 @@ void CWebSocketMessage::Clear()
   m_frames.clear();
 }
 
+CWebSocket::~CWebSocket()
+{
+  delete m_message;
+  delete m_deflate;
+}
+
 const CWebSocketMessage* CWebSocket::Handle(const char* &buffer, size_t &length, bool &send)
 {
   send = false;
@@ -320,6 +331,13 @@ const CWebSocketMessage* CWebSocket::Handle(const char* &buffer, size_t &length,
         length -= (size_t)frame->GetFrameLength();
         buffer += frame->GetFrameLength();
 
+        if (!IsValidExtension(frame))
+        {
+          CLog::Log(LOGINFO, "WebSocket: Frame with unexpected extension bits received");
+          delete frame;
+          return NULL;
+        }
+
         if (frame->IsControlFrame())
         {
           if (!frame->IsFinal())
@@ -382,7 +400,7 @@ const CWebSocketMessage* CWebSocket::Handle(const char* &buffer, size_t &length,
 
         CWebSocketMessage *msg = m_message;
         m_message = NULL;
-        return msg;
+        return Decompress(msg);
       }
 
       case WebSocketStateClosing:
@@ -421,11 +439,16 @@ const CWebSocketMessage* CWebSocket::Handle(const char* &buffer, size_t &length,
 
 const CWebSocketMessage* CWebSocket::Send(WebSocketFrameOpcode opcode, const char* data /* = NULL */, uint32_t length /* = 0 */)
 {
-  CWebSocketFrame *frame = GetFrame(opcode, data, length);
-  if (frame == NULL || !frame->IsValid())
+  bool isDataFrame = opcode == WebSocketTextFrame || opcode == WebSocketBinaryFrame;
+
+  std::string compressed;
+  int8_t extension = WebSocketExtensionNone;
+  if (m_deflate != NULL && isDataFrame && data != NULL && length >= COMPRESSION_MIN_LENGTH &&
+      m_deflate->Compress(data, length, compressed))
   {
-    CLog::Log(LOGINFO, "WebSocket: Trying to send an invalid frame");
-    return NULL;
+    data = compressed.c_str();
+    length = static_cast<uint32_t>(compressed.size());
+    extension = WebSocketExtensionRSV1;
   }
 
   CWebSocketMessage *msg = GetMessage();
@@ -435,9 +458,74 @@ const CWebSocketMessage* CWebSocket::Send(WebSocketFrameOpcode opcode, const cha
     return NULL;
   }
 
-  msg->AddFrame(frame);
-  if (msg->IsComplete())
-    return msg;
+  // control frames must not be fragmented
+  uint32_t fragmentSize = isDataFrame ? FRAGMENT_SIZE : length;
+  uint32_t offset = 0;
+  do
+  {
+    uint32_t fragmentLength = std::min(length - offset, fragmentSize);
+    bool final = offset + fragmentLength >= length;
+    bool first = offset == 0;
 
-  return NULL;
+    CWebSocketFrame *frame = GetFrame(first ? opcode : WebSocketContinuationFrame, data != NULL ? data + offset : NULL, fragmentLength,
+                                      final, false, 0, first ? extension : WebSocketExtensionNone);
+    if (frame == NULL || !frame->IsValid())
+    {
+      CLog::Log(LOGINFO, "WebSocket: Trying to send an invalid frame");
+      delete frame;
+      delete msg;
+      return NULL;
+    }
+
+    msg->AddFrame(frame);
+    offset += fragmentLength;
+  } while (offset < length);
+
+  return msg;
+}
+
+bool CWebSocket::IsValidExtension(const CWebSocketFrame *frame) const
+{
+  if (frame->GetExtension() == WebSocketExtensionNone)
+    return true;
+
+  // only the first frame of a compressed data message may have RSV1 set
+  return m_deflate != NULL && frame->GetExtension() == WebSocketExtensionRSV1 &&
+         (frame->GetOpcode() == WebSocketTextFrame || frame->GetOpcode() == WebSocketBinaryFrame);
+}
+
+CWebSocketMessage* CWebSocket::Decompress(CWebSocketMessage *message)
+{
+  const std::vector<const CWebSocketFrame *>& frames = message->GetFrames();
+  if (m_deflate == NULL || frames.empty() || (frames.front()->GetExtension() & WebSocketExtensionRSV1) == 0)
+    return message;
+
+  std::string payload;
+  for (std::vector<const CWebSocketFrame *>::const_iterator frame = frames.begin(); frame != frames.end(); ++frame)
+  {
+    if ((*frame)->GetApplicationData() != NULL)
+      payload.append((*frame)->GetApplicationData(), (size_t)(*frame)->GetLength());
+  }
+
+  WebSocketFrameOpcode opcode = frames.front()->GetOpcode();
+  delete message;
+
+  std::string decompressed;
+  if (!m_deflate->Decompress(payload.c_str(), payload.size(), decompressed))
+    return NULL;
+
+  // hand out the decompressed payload as a single, complete frame
+  CWebSocketMessage *msg = GetMessage();
+  if (msg == NULL)
+    return NULL;
+
+  CWebSocketFrame *frame = GetFrame(opcode, decompressed.c_str(), static_cast<uint32_t>(decompressed.size()));
+  if (frame == NULL || !frame->IsValid() || !msg->AddFrame(frame))
+  {
+    delete frame;
+    delete msg;
+    return NULL;
+  }
+
+  return msg;
 }
@@ -20,8 +20,11 @@
 #pragma once
  
 #include <stdint.h>
+#include <string>
 #include <vector>
 
+class CWebSocketDeflate;
+
 enum WebSocketFrameOpcode
 {
   WebSocketContinuationFrame  = 0x00,
@@ -35,6 +38,14 @@ enum WebSocketFrameOpcode
   WebSocketUnknownFrame       = 0x10
 };
 
+enum WebSocketExtensionFlag
+{
+  WebSocketExtensionNone        = 0x00,
+  WebSocketExtensionRSV3        = 0x01,
+  WebSocketExtensionRSV2        = 0x02,
+  WebSocketExtensionRSV1        = 0x04  // marks compressed messages when "permessage-deflate" is used
+};
+
 enum WebSocketState
 {
   WebSocketStateNotConnected    = 0,
@@ -115,14 +126,23 @@ protected:
 class CWebSocket
 {
 public:
-  CWebSocket() { m_state = WebSocketStateNotConnected; m_message = NULL; }
-  virtual ~CWebSocket() { if (m_message) delete m_message; };
+  CWebSocket() { m_state = WebSocketStateNotConnected; m_message = NULL; m_deflate = NULL; }
+  virtual ~CWebSocket();
 
   int GetVersion() { return m_version; }
   WebSocketState GetState() { return m_state; }
 
   virtual bool Handshake(const char* data, size_t length, std::string &response) = 0;
   virtual const CWebSocketMessage* Handle(const char* &buffer, size_t &length, bool &send);
+  /*!
+   \brief Create the frames of a message to be sent.
+
+   If "permessage-deflate" has been negotiated data messages are compressed and
+   large messages are split into several frames so that the client can start
+   processing them before the whole message has been received.
+
+   \return the message (to be deleted by the caller) or NULL on failure
+   */
   virtual const CWebSocketMessage* Send(WebSocketFrameOpcode opcode, const char* data = NULL, uint32_t length = 0);
   virtual const CWebSocketFrame* Ping(const char* data = NULL) const = 0;
   virtual const CWebSocketFrame* Pong(const char* data = NULL) const = 0;
@@ -133,8 +153,13 @@ protected:
   int m_version;
   WebSocketState m_state;
   CWebSocketMessage *m_message;
+  CWebSocketDeflate *m_deflate;
 
   virtual CWebSocketFrame* GetFrame(const char* data, uint64_t length) = 0;
   virtual CWebSocketFrame* GetFrame(WebSocketFrameOpcode opcode, const char* data = NULL, uint32_t length = 0, bool final = true, bool masked = false, int32_t mask = 0, int8_t extension = 0) = 0;
   virtual CWebSocketMessage* GetMessage() = 0;
+
+private:
+  bool IsValidExtension(const CWebSocketFrame *frame) const;
+  CWebSocketMessage* Decompress(CWebSocketMessage *message);
 };
@@ -0,0 +1,272 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "WebSocketDeflate.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+#define WS_EXTENSION_DEFLATE                  "permessage-deflate"
+#define WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER "server_no_context_takeover"
+#define WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER "client_no_context_takeover"
+#define WS_DEFLATE_SERVER_MAX_WINDOW_BITS     "server_max_window_bits"
+#define WS_DEFLATE_CLIENT_MAX_WINDOW_BITS     "client_max_window_bits"
+
+#define WS_DEFLATE_MAX_WINDOW_BITS            15
+// zlib can't produce raw deflate streams with a window of 8 bits
+#define WS_DEFLATE_MIN_SERVER_WINDOW_BITS     9
+#define WS_DEFLATE_MIN_CLIENT_WINDOW_BITS     8
+#define WS_DEFLATE_CHUNK_SIZE                 16384
+// upper limit for the size of a decompressed message sent by a client
+#define WS_DEFLATE_MAX_MESSAGE_SIZE           (16 * 1024 * 1024)
+
+// every message compressed with Z_SYNC_FLUSH ends with this empty stored block which isn't transmitted
+static const char DeflateTrailer[] = { 0x00, 0x00, (char)0xFF, (char)0xFF };
+
+static bool ParseWindowBits(const std::string &value, int minimum, int &bits)
+{
+  if (value.empty() || value.size() > 2 || !StringUtils::IsNaturalNumber(value))
+    return false;
+
+  bits = atoi(value.c_str());
+  return bits >= minimum && bits <= WS_DEFLATE_MAX_WINDOW_BITS;
+}
+
+CWebSocketDeflate::CWebSocketDeflate(int serverWindowBits, bool serverNoContextTakeover, bool clientNoContextTakeover)
+  : m_serverWindowBits(serverWindowBits),
+    m_serverNoContextTakeover(serverNoContextTakeover),
+    m_clientNoContextTakeover(clientNoContextTakeover),
+    m_initialized(false)
+{
+  memset(&m_deflate, 0, sizeof(m_deflate));
+  memset(&m_inflate, 0, sizeof(m_inflate));
+}
+
+CWebSocketDeflate::~CWebSocketDeflate()
+{
+  if (m_initialized)
+  {
+    deflateEnd(&m_deflate);
+    inflateEnd(&m_inflate);
+  }
+}
+
+CWebSocketDeflate* CWebSocketDeflate::Negotiate(const std::string &offers, std::string &response)
+{
+  response.clear();
+
+  std::vector<std::string> extensions = StringUtils::Split(offers, ",");
+  for (std::vector<std::string>::const_iterator extension = extensions.begin(); extension != extensions.end(); ++extension)
+  {
+    std::vector<std::string> parameters = StringUtils::Split(*extension, ";");
+    if (parameters.empty() || !StringUtils::EqualsNoCase(StringUtils::Trim(parameters.front()), WS_EXTENSION_DEFLATE))
+      continue;
+
+    bool valid = true;
+    bool serverNoContextTakeover = false, clientNoContextTakeover = false;
+    bool hasServerWindowBits = false, hasClientWindowBits = false;
+    int serverWindowBits = WS_DEFLATE_MAX_WINDOW_BITS, clientWindowBits = WS_DEFLATE_MAX_WINDOW_BITS;
+
+    for (std::vector<std::string>::iterator parameter = parameters.begin() + 1; parameter != parameters.end() && valid; ++parameter)
+    {
+      std::string name = *parameter;
+      std::string value;
+      size_t pos = name.find('=');
+      if (pos != std::string::npos)
+      {
+        value = name.substr(pos + 1);
+        name.erase(pos);
+        StringUtils::Trim(value);
+        StringUtils::Trim(value, "\"");
+      }
+      StringUtils::Trim(name);
+      StringUtils::ToLower(name);
+
+      // every parameter may only be used once per offer
+      if (name == WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER)
+      {
+        valid = pos == std::string::npos && !serverNoContextTakeover;
+        serverNoContextTakeover = true;
+      }
+      else if (name == WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER)
+      {
+        valid = pos == std::string::npos && !clientNoContextTakeover;
+        clientNoContextTakeover = true;
+      }
+      else if (name == WS_DEFLATE_SERVER_MAX_WINDOW_BITS)
+      {
+        valid = !hasServerWindowBits && ParseWindowBits(value, WS_DEFLATE_MIN_SERVER_WINDOW_BITS, serverWindowBits);
+        hasServerWindowBits = true;
+      }
+      else if (name == WS_DEFLATE_CLIENT_MAX_WINDOW_BITS)
+      {
+        // we always decompress with the largest window so the value doesn't matter to us
+        valid = !hasClientWindowBits && (pos == std::string::npos || ParseWindowBits(value, WS_DEFLATE_MIN_CLIENT_WINDOW_BITS, clientWindowBits));
+        hasClientWindowBits = true;
+      }
+      else
+        valid = false;
+    }
+
+    if (!valid)
+    {
+      CLog::Log(LOGDEBUG, "WebSocket: declining \"%s\" offer \"%s\"", WS_EXTENSION_DEFLATE, extension->c_str());
+      continue;
+    }
+
+    CWebSocketDeflate *deflate = new CWebSocketDeflate(serverWindowBits, serverNoContextTakeover, clientNoContextTakeover);
+    if (!deflate->Initialize())
+    {
+      delete deflate;
+      return NULL;
+    }
+
+    response = WS_EXTENSION_DEFLATE;
+    if (serverNoContextTakeover)
+      response += "; " WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER;
+    if (clientNoContextTakeover)
+      response += "; " WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER;
+    if (hasServerWindowBits)
+      response += StringUtils::Format("; " WS_DEFLATE_SERVER_MAX_WINDOW_BITS "=%d", serverWindowBits);
+
+    return deflate;
+  }
+
+  return NULL;
+}
+
+bool CWebSocketDeflate::Initialize()
+{
+  if (deflateInit2(&m_deflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -m_serverWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    CLog::Log(LOGERROR, "WebSocket: failed to initialize compression");
+    return false;
+  }
+
+  if (inflateInit2(&m_inflate, -WS_DEFLATE_MAX_WINDOW_BITS) != Z_OK)
+  {
+    CLog::Log(LOGERROR, "WebSocket: failed to initialize decompression");
+    deflateEnd(&m_deflate);
+    return false;
+  }
+
+  m_initialized = true;
+  return true;
+}
+
+bool CWebSocketDeflate::Compress(const char *data, size_t length, std::string &compressed)
+{
+  compressed.clear();
+  if (!m_initialized || data == NULL || length == 0)
+    return false;
+
+  m_deflate.next_in = (Bytef *)data;
+  m_deflate.avail_in = (uInt)length;
+
+  char buffer[WS_DEFLATE_CHUNK_SIZE];
+  do
+  {
+    m_deflate.next_out = (Bytef *)buffer;
+    m_deflate.avail_out = sizeof(buffer);
+
+    int res = deflate(&m_deflate, Z_SYNC_FLUSH);
+    if (res != Z_OK && res != Z_BUF_ERROR)
+    {
+      CLog::Log(LOGERROR, "WebSocket: failed to compress message (%d)", res);
+      deflateReset(&m_deflate);
+      compressed.clear();
+      return false;
+    }
+
+    compressed.append(buffer, sizeof(buffer) - m_deflate.avail_out);
+  } while (m_deflate.avail_out == 0);
+
+  if (m_serverNoContextTakeover)
+    deflateReset(&m_deflate);
+
+  if (compressed.size() < sizeof(DeflateTrailer) ||
+      compressed.compare(compressed.size() - sizeof(DeflateTrailer), sizeof(DeflateTrailer), DeflateTrailer, sizeof(DeflateTrailer)) != 0)
+  {
+    CLog::Log(LOGERROR, "WebSocket: unexpected end of compressed message");
+    deflateReset(&m_deflate);
+    compressed.clear();
+    return false;
+  }
+
+  compressed.erase(compressed.size() - sizeof(DeflateTrailer));
+  return true;
+}
+
+bool CWebSocketDeflate::Decompress(const char *data, size_t length, std::string &decompressed)
+{
+  decompressed.clear();
+  if (!m_initialized)
+    return false;
+
+  std::string input(data != NULL ? data : "", data != NULL ? length : 0);
+  input.append(DeflateTrailer, sizeof(DeflateTrailer));
+
+  m_inflate.next_in = (Bytef *)input.c_str();
+  m_inflate.avail_in = (uInt)input.size();
+
+  char buffer[WS_DEFLATE_CHUNK_SIZE];
+  do
+  {
+    m_inflate.next_out = (Bytef *)buffer;
+    m_inflate.avail_out = sizeof(buffer);
+
+    int res = inflate(&m_inflate, Z_SYNC_FLUSH);
+    if (res != Z_OK && res != Z_BUF_ERROR && res != Z_STREAM_END)
+    {
+      CLog::Log(LOGINFO, "WebSocket: failed to decompress message (%d)", res);
+      inflateReset(&m_inflate);
+      decompressed.clear();
+      return false;
+    }
+
+    decompressed.append(buffer, sizeof(buffer) - m_inflate.avail_out);
+    if (decompressed.size() > WS_DEFLATE_MAX_MESSAGE_SIZE)
+    {
+      CLog::Log(LOGINFO, "WebSocket: decompressed message exceeds %d bytes", WS_DEFLATE_MAX_MESSAGE_SIZE);
+      inflateReset(&m_inflate);
+      decompressed.clear();
+      return false;
+    }
+
+    // a client may end a message with a final block, the context can't be used any further after it
+    if (res == Z_STREAM_END)
+    {
+      inflateReset(&m_inflate);
+      return true;
+    }
+
+    // no progress is possible anymore
+    if (res == Z_BUF_ERROR && m_inflate.avail_out > 0)
+      break;
+  } while (m_inflate.avail_in > 0 || m_inflate.avail_out == 0);
+
+  if (m_clientNoContextTakeover)
+    inflateReset(&m_inflate);
+
+  return true;
+}
@@ -0,0 +1,73 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <zlib.h>
+
+/*!
+ \brief Compression state of a WebSocket connection using the
+ "permessage-deflate" extension (RFC 7692).
+
+ Unless the client asked for "server_no_context_takeover" the compression
+ context is shared by all messages sent over the connection so repeating
+ parts (e.g. the property names of JSON-RPC responses and notifications)
+ compress a lot better than they would on their own.
+ */
+class CWebSocketDeflate
+{
+public:
+  ~CWebSocketDeflate();
+
+  /*!
+   \brief Pick the first acceptable "permessage-deflate" offer.
+   \param offers value of the Sec-WebSocket-Extensions header sent by the client
+   \param response [out] value of the Sec-WebSocket-Extensions header to send back
+   \return the compression state of the connection or NULL if no offer could be accepted
+   */
+  static CWebSocketDeflate* Negotiate(const std::string &offers, std::string &response);
+
+  /*!
+   \brief Compress the payload of a whole message.
+   \return false if the message couldn't be compressed (and has to be sent uncompressed)
+   */
+  bool Compress(const char *data, size_t length, std::string &compressed);
+
+  /*!
+   \brief Decompress the payload of a whole message sent by the client.
+   \return false if the payload is corrupt or too large
+   */
+  bool Decompress(const char *data, size_t length, std::string &decompressed);
+
+private:
+  CWebSocketDeflate(int serverWindowBits, bool serverNoContextTakeover, bool clientNoContextTakeover);
+  CWebSocketDeflate(const CWebSocketDeflate&) = delete;
+  CWebSocketDeflate& operator=(const CWebSocketDeflate&) = delete;
+
+  bool Initialize();
+
+  int m_serverWindowBits;
+  bool m_serverNoContextTakeover;
+  bool m_clientNoContextTakeover;
+
+  bool m_initialized;
+  z_stream m_deflate;
+  z_stream m_inflate;
+};
@@ -395,6 +395,16 @@ namespace PVR
      */
     int GetEPGAll(CFileItemList &results, bool bIncludeChannelsWithoutEPG = false) const;
 
+    /*!
+     * @brief Get the entries of all EPG tables which are (partly) running in the given time window.
+     * @param results The fileitem list to store the results in.
+     * @param start The start of the time window in UTC.
+     * @param end The end of the time window in UTC.
+     * @param bIncludeChannelsWithoutEPG, for channels without EPG data in the time window, put an empty EPG tag associated with the channel into results
+     * @return The amount of entries that were added.
+     */
+    int GetEPGBetween(CFileItemList &results, const CDateTime &start, const CDateTime &end, bool bIncludeChannelsWithoutEPG = false) const;
+
     /*!
      * @brief Get all entries that are active now.
      * @param results The fileitem list to store the results in.
@@ -20,11 +20,13 @@
 
 #include "Epg.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "addons/kodi-addon-dev-kit/include/kodi/xbmc_epg_types.h"
 #include "EpgContainer.h"
 #include "EpgDatabase.h"
+#include "EpgIndex.h"
 #include "ServiceBroker.h"
 #include "guilib/LocalizeStrings.h"
 #include "pvr/addons/PVRClients.h"
@@ -37,6 +39,9 @@
 #include "utils/log.h"
 
 
+// the search filter compares local times, allow for a different UTC offset at the start and end of the time window
+#define EPG_SEARCH_TIME_MARGIN (24 * 60 * 60)
+
 using namespace PVR;
 
 CPVREpg::CPVREpg(int iEpgID, const std::string &strName /* = "" */, const std::string &strScraperName /* = "" */, bool bLoadedFromDb /* = false */) :
@@ -92,8 +97,11 @@ CPVREpg &CPVREpg::operator =(const CPVREpg &right)
   m_lastScanTime      = right.m_lastScanTime;
   m_pvrChannel        = right.m_pvrChannel;
 
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); ++it)
-    m_tags.insert(make_pair(it->first, it->second));
+  for (const auto &tag : right.m_tags.GetTags())
+  {
+    if (!m_tags.GetTag(tag->StartAsUTC()))
+      m_tags.Update(tag);
+  }
 
   return *this;
 }
@@ -133,14 +141,14 @@ bool CPVREpg::HasValidEntries(void) const
   CSingleLock lock(m_critSection);
 
   return (m_iEpgID > 0 && /* valid EPG ID */
-      !m_tags.empty()  && /* contains at least 1 tag */
-      m_tags.rbegin()->second->EndAsUTC() >= CDateTime::GetCurrentDateTime().GetAsUTCDateTime()); /* the last end time hasn't passed yet */
+      !m_tags.IsEmpty()  && /* contains at least 1 tag */
+      m_tags.GetTags().back()->EndAsUTC() >= CDateTime::GetCurrentDateTime().GetAsUTCDateTime()); /* the last end time hasn't passed yet */
 }
 
 void CPVREpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
-  m_tags.clear();
+  m_tags.Clear();
 }
 
 void CPVREpg::Cleanup(void)
@@ -153,21 +161,13 @@ void CPVREpg::Cleanup(void)
 void CPVREpg::Cleanup(const CDateTime &Time)
 {
   CSingleLock lock(m_critSection);
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end();)
+  for (const auto &tag : m_tags.RemoveEndedBefore(Time))
   {
-    if (it->second->EndAsUTC() < Time)
-    {
-      if (m_nowActiveStart == it->first)
-        m_nowActiveStart.SetValid(false);
+    if (m_nowActiveStart == tag->StartAsUTC())
+      m_nowActiveStart.SetValid(false);
 
-      it->second->ClearTimer();
-      it->second->ClearRecording();
-      it = m_tags.erase(it);
-    }
-    else
-    {
-      ++it;
-    }
+    tag->ClearTimer();
+    tag->ClearRecording();
   }
 }
 
@@ -176,9 +176,9 @@ CPVREpgInfoTagPtr CPVREpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
   CSingleLock lock(m_critSection);
   if (m_nowActiveStart.IsValid())
   {
-    std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.find(m_nowActiveStart);
-    if (it != m_tags.end() && it->second->IsActive())
-      return it->second;
+    CPVREpgInfoTagPtr tag = m_tags.GetTag(m_nowActiveStart);
+    if (tag && tag->IsActive())
+      return tag;
   }
 
   if (bUpdateIfNeeded)
@@ -186,15 +186,15 @@ CPVREpgInfoTagPtr CPVREpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
     CPVREpgInfoTagPtr lastActiveTag;
 
     /* one of the first items will always match if the list is sorted */
-    for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    for (const auto &tag : m_tags.GetTags())
     {
-      if (it->second->IsActive())
+      if (tag->IsActive())
       {
-        m_nowActiveStart = it->first;
-        return it->second;
+        m_nowActiveStart = tag->StartAsUTC();
+        return tag;
       }
-      else if (it->second->WasActive())
-        lastActiveTag = it->second;
+      else if (tag->WasActive())
+        lastActiveTag = tag;
     }
 
     /* there might be a gap between the last and next event. return the last if found and it ended not more than 5 minutes ago */
@@ -212,17 +212,18 @@ CPVREpgInfoTagPtr CPVREpg::GetTagNext() const
   if (nowTag)
   {
     CSingleLock lock(m_critSection);
-    std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.find(nowTag->StartAsUTC());
-    if (it != m_tags.end() && ++it != m_tags.end())
-      return it->second;
+    CPVREpgInfoTagPtr nextTag = m_tags.GetNextTag(nowTag->StartAsUTC());
+    if (nextTag)
+      return nextTag;
   }
   else if (Size() > 0)
   {
     /* return the first event that is in the future */
-    for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    CSingleLock lock(m_critSection);
+    for (const auto &tag : m_tags.GetTags())
     {
-      if (it->second->IsUpcoming())
-        return it->second;
+      if (tag->IsUpcoming())
+        return tag;
     }
   }
 
@@ -249,72 +250,60 @@ CPVREpgInfoTagPtr CPVREpg::GetTagByBroadcastId(unsigned int iUniqueBroadcastId)
   if (iUniqueBroadcastId != EPG_TAG_INVALID_UID)
   {
     CSingleLock lock(m_critSection);
-    for (const auto &infoTag : m_tags)
+    for (const auto &infoTag : m_tags.GetTags())
     {
-      if (infoTag.second->UniqueBroadcastID() == iUniqueBroadcastId)
-        return infoTag.second;
+      if (infoTag->UniqueBroadcastID() == iUniqueBroadcastId)
+        return infoTag;
     }
   }
   return CPVREpgInfoTagPtr();
 }
 
-CPVREpgInfoTagPtr CPVREpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime) const
+CPVREpgInfoTagPtr CPVREpg::GetTagByStartTime(const CDateTime &startTime) const
 {
   CSingleLock lock(m_critSection);
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
-  {
-    if (it->second->StartAsUTC() >= beginTime && it->second->EndAsUTC() <= endTime)
-      return it->second;
-  }
+  return m_tags.GetTag(startTime);
+}
 
-  return CPVREpgInfoTagPtr();
+CPVREpgInfoTagPtr CPVREpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime) const
+{
+  const std::vector<CPVREpgInfoTagPtr> epgTags(GetTagsBetween(beginTime, endTime));
+  return epgTags.empty() ? CPVREpgInfoTagPtr() : epgTags.front();
 }
 
 std::vector<CPVREpgInfoTagPtr> CPVREpg::GetTagsBetween(const CDateTime &beginTime, const CDateTime &endTime) const
 {
-  std::vector<CPVREpgInfoTagPtr> epgTags;
+  CPVREpgIndex::Query query;
+  beginTime.GetAsTime(query.minStart);
+  endTime.GetAsTime(query.maxEnd);
 
   CSingleLock lock(m_critSection);
-  for (const auto &infoTag : m_tags)
-  {
-    if (infoTag.second->StartAsUTC() >= beginTime)
-    {
-      if (infoTag.second->EndAsUTC() <= endTime)
-        epgTags.emplace_back(infoTag.second);
-      else
-        break; // done.
-    }
-  }
+  return m_tags.Find(query);
+}
 
-  return epgTags;
+std::vector<CPVREpgInfoTagPtr> CPVREpg::GetTimeline(const CDateTime &beginTime, const CDateTime &endTime) const
+{
+  CSingleLock lock(m_critSection);
+  return m_tags.GetTagsBetween(beginTime, endTime);
 }
 
 void CPVREpg::AddEntry(const CPVREpgInfoTag &tag)
 {
   CPVREpgInfoTagPtr newTag;
-  CPVRChannelPtr channel;
   {
     CSingleLock lock(m_critSection);
-    std::map<CDateTime, CPVREpgInfoTagPtr>::iterator itr = m_tags.find(tag.StartAsUTC());
-    if (itr != m_tags.end())
-      newTag = itr->second;
-    else
-    {
+    newTag = m_tags.GetTag(tag.StartAsUTC());
+    if (!newTag)
       newTag.reset(new CPVREpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : ""));
-      m_tags.insert(make_pair(tag.StartAsUTC(), newTag));
-    }
-
-    channel = m_pvrChannel;
-  }
 
-  if (newTag)
-  {
     newTag->Update(tag);
-    newTag->SetPVRChannel(channel);
+    newTag->SetPVRChannel(m_pvrChannel);
     newTag->SetEpg(this);
-    newTag->SetTimer(CServiceBroker::GetPVRManager().Timers()->GetTimerForEpgTag(newTag));
-    newTag->SetRecording(CServiceBroker::GetPVRManager().Recordings()->GetRecordingForEpgTag(newTag));
+    m_tags.Update(newTag);
   }
+
+  newTag->SetTimer(CServiceBroker::GetPVRManager().Timers()->GetTimerForEpgTag(newTag));
+  newTag->SetRecording(CServiceBroker::GetPVRManager().Recordings()->GetRecordingForEpgTag(newTag));
 }
 
 bool CPVREpg::Load(void)
@@ -338,7 +327,7 @@ bool CPVREpg::Load(void)
   {
     m_lastScanTime = GetLastScanTime();
 #if EPG_DEBUGGING
-    CLog::Log(LOGDEBUG, "EPG - %s - %d entries loaded for table '%s'.", __FUNCTION__, (int) m_tags.size(), m_strName.c_str());
+    CLog::Log(LOGDEBUG, "EPG - %s - %d entries loaded for table '%s'.", __FUNCTION__, (int) m_tags.Size(), m_strName.c_str());
 #endif
     bReturn = true;
   }
@@ -352,19 +341,19 @@ bool CPVREpg::UpdateEntries(const CPVREpg &epg, bool bStoreInDb /* = true */)
 {
   CSingleLock lock(m_critSection);
 #if EPG_DEBUGGING
-  CLog::Log(LOGDEBUG, "EPG - {0} - {1} entries in memory before merging", __FUNCTION__, m_tags.size());
+  CLog::Log(LOGDEBUG, "EPG - {0} - {1} entries in memory before merging", __FUNCTION__, m_tags.Size());
 #endif
   /* copy over tags */
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = epg.m_tags.begin(); it != epg.m_tags.end(); ++it)
-    UpdateEntry(it->second, bStoreInDb);
+  for (const auto &tag : epg.m_tags.GetTags())
+    UpdateEntry(tag, bStoreInDb);
 
 #if EPG_DEBUGGING
-  CLog::Log(LOGDEBUG, "EPG - {0} - {1} entries in memory after merging and before fixing", __FUNCTION__, m_tags.size());
+  CLog::Log(LOGDEBUG, "EPG - {0} - {1} entries in memory after merging and before fixing", __FUNCTION__, m_tags.Size());
 #endif
   FixOverlappingEvents(bStoreInDb);
 
 #if EPG_DEBUGGING
-  CLog::Log(LOGDEBUG, "EPG - {0} - {1} entries in memory after fixing", __FUNCTION__, m_tags.size());
+  CLog::Log(LOGDEBUG, "EPG - {0} - {1} entries in memory after fixing", __FUNCTION__, m_tags.Size());
 #endif
   /* update the last scan time of this table */
   m_lastScanTime = CDateTime::GetCurrentDateTime().GetAsUTCDateTime();
@@ -422,26 +411,27 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, bool bUpdateDatabase /*
 
   {
     CSingleLock lock(m_critSection);
-    std::map<CDateTime, CPVREpgInfoTagPtr>::iterator it = m_tags.find(tag->StartAsUTC());
+    infoTag = m_tags.GetTag(tag->StartAsUTC());
     bool bNewTag(false);
-    if (it != m_tags.end())
-    {
-      infoTag = it->second;
-    }
-    else
+    if (!infoTag)
     {
       infoTag.reset(new CPVREpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : ""));
       infoTag->SetUniqueBroadcastID(tag->UniqueBroadcastID());
-      m_tags.insert(std::make_pair(tag->StartAsUTC(), infoTag));
       bNewTag = true;
     }
 
-    infoTag->Update(*tag, bNewTag);
+    bool bChanged = infoTag->Update(*tag, bNewTag) || bNewTag;
     infoTag->SetEpg(this);
     infoTag->SetPVRChannel(m_pvrChannel);
 
-    if (bUpdateDatabase)
-      m_changedTags.insert(std::make_pair(infoTag->UniqueBroadcastID(), infoTag));
+    /* tags that are identical to the stored ones don't have to be written again */
+    if (bChanged)
+    {
+      m_tags.Update(infoTag);
+
+      if (bUpdateDatabase)
+        m_changedTags.insert(std::make_pair(infoTag->UniqueBroadcastID(), infoTag));
+    }
   }
 
   infoTag->SetTimer(CServiceBroker::GetPVRManager().Timers()->GetTimerForEpgTag(infoTag));
@@ -463,14 +453,17 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
   {
     CSingleLock lock(m_critSection);
 
-    auto it = m_tags.begin();
-    for (; it != m_tags.end(); ++it)
+    CPVREpgInfoTagPtr infoTag;
+    for (const auto &epgTag : m_tags.GetTags())
     {
-      if (it->second->UniqueBroadcastID() == tag->UniqueBroadcastID())
+      if (epgTag->UniqueBroadcastID() == tag->UniqueBroadcastID())
+      {
+        infoTag = epgTag;
         break;
+      }
     }
 
-    if (it == m_tags.end())
+    if (!infoTag)
     {
       bRet = false;
     }
@@ -478,14 +471,14 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
     {
       // Respect epg linger time.
       const CDateTime cleanupTime(CDateTime::GetUTCDateTime() - CDateTimeSpan(0, g_advancedSettings.m_iEpgLingerTime / 60, g_advancedSettings.m_iEpgLingerTime % 60, 0));
-      if (it->second->EndAsUTC() < cleanupTime)
+      if (infoTag->EndAsUTC() < cleanupTime)
       {
         if (bUpdateDatabase)
-          m_deletedTags.insert(std::make_pair(it->second->UniqueBroadcastID(), it->second));
+          m_deletedTags.insert(std::make_pair(infoTag->UniqueBroadcastID(), infoTag));
 
-        it->second->ClearTimer();
-        it->second->ClearRecording();
-        m_tags.erase(it);
+        infoTag->ClearTimer();
+        infoTag->ClearRecording();
+        m_tags.Remove(infoTag->StartAsUTC());
       }
       else
       {
@@ -510,7 +503,11 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
 
 bool CPVREpg::Update(const time_t start, const time_t end, int iUpdateTime, bool bForceUpdate /* = false */)
 {
-  bool bGrabSuccess(true);
+  return ExecuteUpdate(start, end, PrepareUpdate(iUpdateTime, bForceUpdate));
+}
+
+bool CPVREpg::PrepareUpdate(int iUpdateTime, bool bForceUpdate /* = false */)
+{
   bool bUpdate(false);
 
   /* load the entries from the db first */
@@ -525,7 +522,7 @@ bool CPVREpg::Update(const time_t start, const time_t end, int iUpdateTime, bool
   CDateTime lastScanTime = GetLastScanTime();
 
   /* enforce advanced settings update interval override for TV Channels with no EPG data */
-  if (m_tags.empty() && !bUpdate && ChannelID() > 0 && !Channel()->IsRadio())
+  if (m_tags.IsEmpty() && !bUpdate && ChannelID() > 0 && !Channel()->IsRadio())
     iUpdateTime = g_advancedSettings.m_iEpgUpdateEmptyTagsInterval;
 
   if (!bForceUpdate)
@@ -540,7 +537,14 @@ bool CPVREpg::Update(const time_t start, const time_t end, int iUpdateTime, bool
   else
     bUpdate = true;
 
-  if (bUpdate)
+  return bUpdate;
+}
+
+bool CPVREpg::ExecuteUpdate(const time_t start, const time_t end, bool bUpdateFromClient)
+{
+  bool bGrabSuccess(true);
+
+  if (bUpdateFromClient)
     bGrabSuccess = LoadFromClients(start, end);
 
   if (bGrabSuccess)
@@ -566,8 +570,8 @@ int CPVREpg::Get(CFileItemList &results) const
 
   CSingleLock lock(m_critSection);
 
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
-    results.Add(CFileItemPtr(new CFileItem(it->second)));
+  for (const auto &tag : m_tags.GetTags())
+    results.Add(CFileItemPtr(new CFileItem(tag)));
 
   return results.Size() - iInitialSize;
 }
@@ -581,10 +585,43 @@ int CPVREpg::Get(CFileItemList &results, const CPVREpgSearchFilter &filter) cons
 
   CSingleLock lock(m_critSection);
 
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  if (filter.ShouldSearchInDescription())
   {
-    if (filter.FilterEntry(it->second))
-      results.Add(CFileItemPtr(new CFileItem(it->second)));
+    /* descriptions aren't indexed */
+    for (const auto &tag : m_tags.GetTags())
+    {
+      if (filter.FilterEntry(tag))
+        results.Add(CFileItemPtr(new CFileItem(tag)));
+    }
+  }
+  else
+  {
+    CPVREpgIndex::Query query;
+    if (filter.GetStartDateTime().IsValid())
+    {
+      filter.GetStartDateTime().GetAsUTCDateTime().GetAsTime(query.minStart);
+      query.minStart = std::max<time_t>(query.minStart - EPG_SEARCH_TIME_MARGIN, 0);
+    }
+    if (filter.GetEndDateTime().IsValid())
+    {
+      filter.GetEndDateTime().GetAsUTCDateTime().GetAsTime(query.maxEnd);
+      query.maxEnd += EPG_SEARCH_TIME_MARGIN;
+    }
+    query.iGenreType = filter.GetGenreType();
+    query.bIncludeUnknownGenres = filter.ShouldIncludeUnknownGenres();
+    if (filter.GetMinimumDuration() != EPG_SEARCH_UNSET)
+      query.iMinimumDuration = filter.GetMinimumDuration() * 60;
+    if (filter.GetMaximumDuration() != EPG_SEARCH_UNSET)
+      query.iMaximumDuration = filter.GetMaximumDuration() * 60;
+    query.strSearchTerm = filter.GetSearchTerm();
+    query.bIsCaseSensitive = filter.IsCaseSensitive();
+
+    /* the index returns candidates, the remaining conditions are checked on the tags */
+    for (const auto &tag : m_tags.Find(query))
+    {
+      if (filter.FilterEntry(tag))
+        results.Add(CFileItemPtr(new CFileItem(tag)));
+    }
   }
 
   return results.Size() - iInitialSize;
@@ -606,23 +643,34 @@ bool CPVREpg::Persist(void)
     return false;
   }
 
+  std::vector<std::string> queries;
   {
     CSingleLock lock(m_critSection);
-    if (m_iEpgID <= 0 || m_bChanged)
+    if (m_iEpgID <= 0)
     {
-      int iId = database->Persist(*this, m_iEpgID > 0);
+      /* the ID of a new table is needed for its entries */
+      int iId = database->Persist(*this);
       if (iId > 0)
         m_iEpgID = iId;
     }
+    else if (m_bChanged)
+    {
+      queries.emplace_back(database->GetPersistQuery(*this));
+    }
 
+    std::vector<CPVREpgInfoTagPtr> tags;
+    tags.reserve(std::max(m_deletedTags.size(), m_changedTags.size()));
     for (std::map<int, CPVREpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); ++it)
-      database->Delete(*it->second);
+      tags.emplace_back(it->second);
+    database->GetDeleteQueries(tags, queries);
 
+    tags.clear();
     for (std::map<int, CPVREpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); ++it)
-      it->second->Persist(false);
+      tags.emplace_back(it->second);
+    database->GetPersistQueries(tags, queries);
 
     if (m_bUpdateLastScanTime)
-      database->PersistLastEpgScanTime(m_iEpgID, true);
+      queries.emplace_back(database->GetLastEpgScanTimeQuery(m_iEpgID));
 
     m_deletedTags.clear();
     m_changedTags.clear();
@@ -631,7 +679,10 @@ bool CPVREpg::Persist(void)
     m_bUpdateLastScanTime = false;
   }
 
-  return database->CommitInsertQueries();
+  /* the queries are executed by the database writer while it's running, don't wait for them */
+  CServiceBroker::GetPVRManager().EpgContainer().WriteToDatabase(queries);
+
+  return true;
 }
 
 CDateTime CPVREpg::GetFirstDate(void) const
@@ -639,8 +690,8 @@ CDateTime CPVREpg::GetFirstDate(void) const
   CDateTime first;
 
   CSingleLock lock(m_critSection);
-  if (!m_tags.empty())
-    first = m_tags.begin()->second->StartAsUTC();
+  if (!m_tags.IsEmpty())
+    first = m_tags.GetTags().front()->StartAsUTC();
 
   return first;
 }
@@ -650,8 +701,8 @@ CDateTime CPVREpg::GetLastDate(void) const
   CDateTime last;
 
   CSingleLock lock(m_critSection);
-  if (!m_tags.empty())
-    last = m_tags.rbegin()->second->StartAsUTC();
+  if (!m_tags.IsEmpty())
+    last = m_tags.GetTags().back()->StartAsUTC();
 
   return last;
 }
@@ -666,14 +717,16 @@ bool CPVREpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
   bool bReturn(true);
   CPVREpgInfoTagPtr previousTag, currentTag;
 
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); it != m_tags.end() ? it++ : it)
+  /* work on a copy, tags are removed from the table while iterating */
+  const std::vector<CPVREpgInfoTagPtr> tags(m_tags.GetTags());
+  for (const auto &tag : tags)
   {
     if (!previousTag)
     {
-      previousTag = it->second;
+      previousTag = tag;
       continue;
     }
-    currentTag = it->second;
+    currentTag = tag;
 
     if (previousTag->EndAsUTC() >= currentTag->EndAsUTC())
     {
@@ -681,24 +734,25 @@ bool CPVREpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
       if (bUpdateDb)
         m_deletedTags.insert(make_pair(currentTag->UniqueBroadcastID(), currentTag));
 
-      if (m_nowActiveStart == it->first)
+      if (m_nowActiveStart == currentTag->StartAsUTC())
         m_nowActiveStart.SetValid(false);
 
-      it->second->ClearTimer();
-      it->second->ClearRecording();
-      m_tags.erase(it++);
+      currentTag->ClearTimer();
+      currentTag->ClearRecording();
+      m_tags.Remove(currentTag->StartAsUTC());
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
     {
       previousTag->SetEndFromUTC(currentTag->StartAsUTC());
+      m_tags.Update(previousTag);
       if (bUpdateDb)
         m_changedTags.insert(make_pair(previousTag->UniqueBroadcastID(), previousTag));
 
-      previousTag = it->second;
+      previousTag = currentTag;
     }
     else
     {
-      previousTag = it->second;
+      previousTag = currentTag;
     }
   }
 
@@ -824,12 +878,7 @@ bool CPVREpg::LoadFromClients(time_t start, time_t end)
 CPVREpgInfoTagPtr CPVREpg::GetNextEvent(const CPVREpgInfoTag& tag) const
 {
   CSingleLock lock(m_critSection);
-  std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.find(tag.StartAsUTC());
-  if (it != m_tags.end() && ++it != m_tags.end())
-    return it->second;
-
-  CPVREpgInfoTagPtr retVal;
-  return retVal;
+  return m_tags.GetNextTag(tag.StartAsUTC());
 }
 
 CPVRChannelPtr CPVREpg::Channel(void) const
@@ -855,8 +904,8 @@ void CPVREpg::SetChannel(const PVR::CPVRChannelPtr &channel)
       channel->SetEpgID(m_iEpgID);
     }
     m_pvrChannel = channel;
-    for (std::map<CDateTime, CPVREpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); ++it)
-      it->second->SetPVRChannel(m_pvrChannel);
+    for (const auto &tag : m_tags.GetTags())
+      tag->SetPVRChannel(m_pvrChannel);
   }
 }
 
@@ -869,7 +918,7 @@ bool CPVREpg::UpdatePending(void) const
 size_t CPVREpg::Size(void) const
 {
   CSingleLock lock(m_critSection);
-  return m_tags.size();
+  return m_tags.Size();
 }
 
 bool CPVREpg::NeedsSave(void) const
@@ -885,4 +934,3 @@ bool CPVREpg::IsValid(void) const
     return m_pvrChannel != NULL;
   return true;
 }
-
@@ -24,6 +24,7 @@
 #include "threads/CriticalSection.h"
 #include "utils/Observer.h"
 
+#include "EpgIndex.h"
 #include "EpgInfoTag.h"
 #include "EpgSearchFilter.h"
 #include "pvr/PVRTypes.h"
@@ -178,6 +179,14 @@ namespace PVR
      */
     std::vector<CPVREpgInfoTagPtr> GetTagsBetween(const CDateTime &beginTime, const CDateTime &endTime) const;
 
+    /*!
+     * @brief Get all events which are (partly) running in the given time window.
+     * @param beginTime The start of the time window in UTC.
+     * @param endTime The end of the time window in UTC.
+     * @return The matching events, ordered by start time.
+     */
+    std::vector<CPVREpgInfoTagPtr> GetTimeline(const CDateTime &beginTime, const CDateTime &endTime) const;
+
     /*!
      * @brief Get the event matching the given unique broadcast id
      * @param iUniqueBroadcastId The uid to look up
@@ -185,6 +194,13 @@ namespace PVR
      */
     CPVREpgInfoTagPtr GetTagByBroadcastId(unsigned int iUniqueBroadcastId) const;
 
+    /*!
+     * @brief Get the event starting at the given time.
+     * @param startTime The start time in UTC.
+     * @return The matching event or NULL if it wasn't found.
+     */
+    CPVREpgInfoTagPtr GetTagByStartTime(const CDateTime &startTime) const;
+
     /*!
      * @brief Update an entry in this EPG.
      * @param data The tag to update.
@@ -220,6 +236,25 @@ namespace PVR
      */
     bool Update(const time_t start, const time_t end, int iUpdateTime, bool bForceUpdate = false);
 
+    /*!
+     * @brief Load the entries from the database if needed and check whether the table has to be updated from its client.
+     * This is the part of Update() that accesses the database.
+     * @param iUpdateTime Update the table after the given amount of time has passed.
+     * @param bForceUpdate Force update from client even if it's not the time to
+     * @return True if the table has to be updated from its client, false otherwise.
+     */
+    bool PrepareUpdate(int iUpdateTime, bool bForceUpdate = false);
+
+    /*!
+     * @brief Complete an update prepared by PrepareUpdate(). Doesn't access the database, so
+     * the updates of several tables can be executed in parallel.
+     * @param start The start time.
+     * @param end The end time.
+     * @param bUpdateFromClient True to fetch the entries from the client.
+     * @return True if the update was successful, false otherwise.
+     */
+    bool ExecuteUpdate(const time_t start, const time_t end, bool bUpdateFromClient);
+
     /*!
      * @brief Get all EPG entries.
      * @param results The file list to store the results in.
@@ -323,7 +358,7 @@ namespace PVR
      */
     bool UpdateEntries(const CPVREpg &epg, bool bStoreInDb = true);
 
-    std::map<CDateTime, CPVREpgInfoTagPtr> m_tags;
+    CPVREpgIndex                        m_tags;            /*!< the entries of this table */
     std::map<int, CPVREpgInfoTagPtr>       m_changedTags;
     std::map<int, CPVREpgInfoTagPtr>       m_deletedTags;
     bool                                m_bChanged;        /*!< true if anything changed that needs to be persisted, false otherwise */
@@ -20,6 +20,7 @@
 
 #include "EpgContainer.h"
 
+#include <climits>
 #include <utility>
 
 #include "Application.h"
@@ -27,8 +28,10 @@
 #include "dialogs/GUIDialogExtendedProgressBar.h"
 #include "Epg.h"
 #include "EpgSearchFilter.h"
+#include "EpgUpdateScheduler.h"
 #include "guilib/GUIWindowManager.h"
 #include "guilib/LocalizeStrings.h"
+#include "pvr/channels/PVRChannelGroup.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
 #include "pvr/PVRManager.h"
 #include "pvr/recordings/PVRRecordings.h"
@@ -37,9 +40,15 @@
 #include "settings/lib/Setting.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
 
+// the order in which EPG tables are updated
+#define EPG_UPDATE_PRIORITY_PLAYING 0
+#define EPG_UPDATE_PRIORITY_GROUP   1
+#define EPG_UPDATE_PRIORITY_OTHER   INT_MAX
+
 using namespace PVR;
 
 CPVREpgContainer::CPVREpgContainer(void) :
@@ -121,7 +130,11 @@ void CPVREpgContainer::Clear(bool bClearDb /* = false */)
       m_database.Open();
 
     if (m_database.IsOpen())
-      m_database.DeleteEpg();
+    {
+      std::vector<std::string> queries;
+      m_database.GetDeleteEpgQueries(queries);
+      WriteToDatabase(queries);
+    }
   }
 
   SetChanged();
@@ -174,6 +187,9 @@ void CPVREpgContainer::Start(bool bAsync)
 
   LoadFromDB();
 
+  if (!IgnoreDB())
+    m_databaseWriter.Start();
+
   bool bStop = false;
   {
     CSingleLock lock(m_critSection);
@@ -200,6 +216,9 @@ bool CPVREpgContainer::Stop(void)
 {
   StopThread();
 
+  /* write all pending changes before the database is used by anyone else */
+  m_databaseWriter.Stop();
+
   if (m_database.IsOpen())
     m_database.Close();
 
@@ -255,7 +274,8 @@ void CPVREpgContainer::LoadFromDB(void)
 
     const CDateTime cleanupTime(CDateTime::GetUTCDateTime() -
       CDateTimeSpan(0, g_advancedSettings.m_iEpgLingerTime / 60, g_advancedSettings.m_iEpgLingerTime % 60, 0));
-    m_database.DeleteEpgEntries(cleanupTime);
+    std::vector<std::string> queries(1, m_database.GetDeleteEpgEntriesQuery(cleanupTime));
+    WriteToDatabase(queries);
     m_database.Get(*this);
 
     for (const auto &epgEntry : m_epgs)
@@ -496,6 +516,17 @@ CPVREpgPtr CPVREpgContainer::CreateChannelEpg(const CPVRChannelPtr &channel)
   return epg;
 }
 
+void CPVREpgContainer::WriteToDatabase(std::vector<std::string> &queries)
+{
+  if (queries.empty() || m_databaseWriter.Queue(queries))
+    return;
+
+  /* the writer isn't running */
+  if (m_database.IsOpen())
+    CPVREpgDatabaseWriter::Execute(m_database, queries);
+  queries.clear();
+}
+
 bool CPVREpgContainer::RemoveOldEntries(void)
 {
   const CDateTime cleanupTime(CDateTime::GetUTCDateTime() -
@@ -505,9 +536,12 @@ bool CPVREpgContainer::RemoveOldEntries(void)
   for (const auto &epgEntry : m_epgs)
     epgEntry.second->Cleanup(cleanupTime);
 
-  /* remove the old entries from the database */
+  /* remove the old entries from the database, after the writes which are still queued */
   if (!IgnoreDB() && m_database.IsOpen())
-    m_database.DeleteEpgEntries(cleanupTime);
+  {
+    std::vector<std::string> queries(1, m_database.GetDeleteEpgEntriesQuery(cleanupTime));
+    WriteToDatabase(queries);
+  }
 
   CSingleLock lock(m_critSection);
   CDateTime::GetCurrentDateTime().GetAsUTCDateTime().GetAsTime(m_iLastEpgCleanup);
@@ -528,7 +562,11 @@ bool CPVREpgContainer::DeleteEpg(const CPVREpg &epg, bool bDeleteFromDatabase /*
 
   CLog::Log(LOGDEBUG, "deleting EPG table %s (%d)", epg.Name().c_str(), epg.EpgID());
   if (bDeleteFromDatabase && !IgnoreDB() && m_database.IsOpen())
-    m_database.Delete(*epgEntry->second);
+  {
+    std::vector<std::string> queries(1, m_database.GetDeleteQuery(*epgEntry->second));
+    if (!queries.front().empty())
+      WriteToDatabase(queries);
+  }
 
   epgEntry->second->UnregisterObserver(this);
   m_epgs.erase(epgEntry);
@@ -643,8 +681,14 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
 
   std::vector<CPVREpgPtr> invalidTables;
 
-  /* load or update all EPG tables */
-  unsigned int iCounter(0);
+  /* the channels of the group shown in the guide are updated first, starting with the playing channel */
+  const CPVRChannelPtr playingChannel = CServiceBroker::GetPVRManager().GetCurrentChannel();
+  const CPVRChannelGroupPtr playingGroups[] = { CServiceBroker::GetPVRManager().GetPlayingGroup(false),
+                                                CServiceBroker::GetPVRManager().GetPlayingGroup(true) };
+
+  CPVREpgUpdateScheduler scheduler(start, end, g_advancedSettings.m_iEpgMaxParallelUpdates, g_advancedSettings.m_iEpgMaxParallelUpdatesPerClient);
+
+  /* load all EPG tables and check which ones have to be updated. this part accesses the database and runs on this thread. */
   for (const auto &epgEntry : m_epgs)
   {
     if (InterruptUpdate())
@@ -657,9 +701,6 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
     if (!epg)
       continue;
 
-    if (bShowProgress && !bOnlyPending)
-      UpdateProgressDialog(++iCounter, m_epgs.size(), epg->Name());
-
     // we currently only support update via pvr add-ons. skip update when the pvr manager isn't started
     if (!CServiceBroker::GetPVRManager().IsStarted())
       continue;
@@ -672,13 +713,62 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
         epg->SetChannel(channel);
     }
 
-    if ((!bOnlyPending || epg->UpdatePending()) &&
-        epg->Update(start, end, m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60, bOnlyPending))
-      iUpdatedTables++;
+    if (!bOnlyPending || epg->UpdatePending())
+    {
+      bool bUpdateFromClient = epg->PrepareUpdate(m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60, bOnlyPending);
+
+      int iPriority = EPG_UPDATE_PRIORITY_OTHER;
+      const CPVRChannelPtr channel = epg->Channel();
+      if (channel)
+      {
+        const CPVRChannelGroupPtr &group = playingGroups[channel->IsRadio() ? 1 : 0];
+        if (playingChannel && *playingChannel == *channel)
+          iPriority = EPG_UPDATE_PRIORITY_PLAYING;
+        else if (group && group->IsGroupMember(channel))
+          iPriority = EPG_UPDATE_PRIORITY_GROUP + group->GetChannelNumber(channel);
+      }
+
+      scheduler.Add(epg, bUpdateFromClient, iPriority);
+    }
     else if (!epg->IsValid())
       invalidTables.push_back(epg);
   }
 
+  /* fetch the entries from the clients */
+  unsigned int iStart = XbmcThreads::SystemClockMillis();
+  if (!bInterrupted)
+    scheduler.Start();
+
+  while (!scheduler.Wait(100))
+  {
+    if (!bInterrupted && InterruptUpdate())
+    {
+      bInterrupted = true;
+      scheduler.Abort();
+    }
+
+    if (bShowProgress && !bOnlyPending)
+    {
+      std::string strLastTable;
+      unsigned int iDone = scheduler.GetProgress(strLastTable);
+      UpdateProgressDialog(iDone, scheduler.Size(), strLastTable);
+    }
+  }
+
+  std::string strLastTable;
+  unsigned int iDone = scheduler.GetProgress(strLastTable);
+  unsigned int iDuration = XbmcThreads::SystemClockMillis() - iStart;
+  iUpdatedTables = scheduler.GetUpdatedTables().size();
+  if (iDone > 0)
+    CLog::Log(LOGDEBUG, "EpgContainer - %s - %u of %u tables updated in %u ms (%.1f tables/s)", __FUNCTION__,
+              iDone, scheduler.Size(), iDuration, iDuration > 0 ? iDone * 1000.0f / iDuration : 0.0f);
+
+  for (const auto &epg : scheduler.GetFailedTables())
+  {
+    if (!epg->IsValid())
+      invalidTables.push_back(epg);
+  }
+
   for (auto it = invalidTables.begin(); it != invalidTables.end(); ++it)
     DeleteEpg(**it, true);
 
@@ -30,6 +30,7 @@
 
 #include "Epg.h"
 #include "EpgDatabase.h"
+#include "EpgDatabaseWriter.h"
 
 class CFileItemList;
 class CGUIDialogProgressBarHandle;
@@ -63,6 +64,13 @@ namespace PVR
      */
     CPVREpgDatabase *GetDatabase(void) { return &m_database; }
 
+    /*!
+     * @brief Write to the database. The queries are queued for the background writer while it's running,
+     * otherwise they are executed right away, after the queries that were queued before.
+     * @param queries The queries. Their contents are moved to the queue.
+     */
+    void WriteToDatabase(std::vector<std::string> &queries);
+
     /*!
      * @brief Start the EPG update thread.
      * @param bAsync Should the EPG container starts asynchronously
@@ -259,6 +267,7 @@ namespace PVR
     void InsertFromDatabase(int iEpgID, const std::string &strName, const std::string &strScraperName);
 
     CPVREpgDatabase m_database; /*!< the EPG database */
+    CPVREpgDatabaseWriter m_databaseWriter; /*!< writes the changes of the EPG tables to the database */
 
     /** @name Class state properties */
     //@{
@@ -33,6 +33,14 @@
 using namespace dbiplus;
 using namespace PVR;
 
+// the maximum number of rows and the (approximate) maximum size of a single bulk statement
+#define EPGDB_MAX_ROWS_PER_QUERY  250
+#define EPGDB_MAX_QUERY_SIZE      (256 * 1024)
+
+#define EPGDB_TAG_COLUMNS "idEpg, iStartTime, iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, " \
+                          "iYear, sIMDBNumber, sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, " \
+                          "iStarRating, bNotify, iSeriesId, iEpisodeId, iEpisodePart, sEpisodeName, iFlags, iBroadcastUid, idBroadcast"
+
 bool CPVREpgDatabase::Open(void)
 {
   return CDatabase::Open(g_advancedSettings.m_databaseEpg);
@@ -124,40 +132,54 @@ void CPVREpgDatabase::UpdateTables(int iVersion)
 
 bool CPVREpgDatabase::DeleteEpg(void)
 {
-  bool bReturn(false);
   CLog::Log(LOGDEBUG, "EpgDB - %s - deleting all EPG data from the database", __FUNCTION__);
 
-  bReturn = DeleteValues("epg") || bReturn;
-  bReturn = DeleteValues("epgtags") || bReturn;
-  bReturn = DeleteValues("lastepgscan") || bReturn;
+  std::vector<std::string> queries;
+  GetDeleteEpgQueries(queries);
+
+  bool bReturn(false);
+  for (const auto &query : queries)
+    bReturn = ExecuteQuery(query) || bReturn;
 
   return bReturn;
 }
 
+void CPVREpgDatabase::GetDeleteEpgQueries(std::vector<std::string> &queries) const
+{
+  queries.emplace_back(PrepareSQL("DELETE FROM epg"));
+  queries.emplace_back(PrepareSQL("DELETE FROM epgtags"));
+  queries.emplace_back(PrepareSQL("DELETE FROM lastepgscan"));
+}
+
 bool CPVREpgDatabase::Delete(const CPVREpg &table)
+{
+  const std::string strQuery(GetDeleteQuery(table));
+  return !strQuery.empty() && ExecuteQuery(strQuery);
+}
+
+std::string CPVREpgDatabase::GetDeleteQuery(const CPVREpg &table) const
 {
   /* invalid channel */
   if (table.EpgID() <= 0)
   {
     CLog::Log(LOGERROR, "EpgDB - %s - invalid channel id: %d", __FUNCTION__, table.EpgID());
-    return false;
+    return std::string();
   }
 
-  Filter filter;
-  filter.AppendWhere(PrepareSQL("idEpg = %u", table.EpgID()));
-
-  return DeleteValues("epg", filter);
+  return PrepareSQL("DELETE FROM epg WHERE idEpg = %u", table.EpgID());
 }
 
 bool CPVREpgDatabase::DeleteEpgEntries(const CDateTime &maxEndTime)
+{
+  return ExecuteQuery(GetDeleteEpgEntriesQuery(maxEndTime));
+}
+
+std::string CPVREpgDatabase::GetDeleteEpgEntriesQuery(const CDateTime &maxEndTime) const
 {
   time_t iMaxEndTime;
   maxEndTime.GetAsTime(iMaxEndTime);
 
-  Filter filter;
-  filter.AppendWhere(PrepareSQL("iEndTime < %u", iMaxEndTime));
-
-  return DeleteValues("epgtags", filter);
+  return PrepareSQL("DELETE FROM epgtags WHERE iEndTime < %u", iMaxEndTime);
 }
 
 bool CPVREpgDatabase::Delete(const CPVREpgInfoTag &tag)
@@ -247,7 +269,10 @@ int CPVREpgDatabase::Get(CPVREpg &epg)
         newTag->m_strIMDBNumber      = m_pDS->fv("sIMDBNumber").get_asString().c_str();
         newTag->m_iGenreType         = m_pDS->fv("iGenreType").get_asInt();
         newTag->m_iGenreSubType      = m_pDS->fv("iGenreSubType").get_asInt();
-        newTag->m_genre              = StringUtils::Split(m_pDS->fv("sGenre").get_asString().c_str(), g_advancedSettings.m_videoItemSeparator);
+        if (newTag->m_iGenreType == EPG_GENRE_USE_STRING)
+          newTag->m_genre            = StringUtils::Split(m_pDS->fv("sGenre").get_asString().c_str(), g_advancedSettings.m_videoItemSeparator);
+        else
+          newTag->m_genre            = StringUtils::Split(CPVREpg::ConvertGenreIdToString(newTag->m_iGenreType, newTag->m_iGenreSubType), g_advancedSettings.m_videoItemSeparator);
         newTag->m_iParentalRating    = m_pDS->fv("iParentalRating").get_asInt();
         newTag->m_iStarRating        = m_pDS->fv("iStarRating").get_asInt();
         newTag->m_bNotify            = m_pDS->fv("bNotify").get_asBool();
@@ -294,12 +319,17 @@ bool CPVREpgDatabase::GetLastEpgScanTime(int iEpgId, CDateTime *lastScan)
 
 bool CPVREpgDatabase::PersistLastEpgScanTime(int iEpgId /* = 0 */, bool bQueueWrite /* = false */)
 {
-  std::string strQuery = PrepareSQL("REPLACE INTO lastepgscan(idEpg, sLastScan) VALUES (%u, '%s');",
-      iEpgId, CDateTime::GetCurrentDateTime().GetAsUTCDateTime().GetAsDBDateTime().c_str());
+  std::string strQuery = GetLastEpgScanTimeQuery(iEpgId);
 
   return bQueueWrite ? QueueInsertQuery(strQuery) : ExecuteQuery(strQuery);
 }
 
+std::string CPVREpgDatabase::GetLastEpgScanTimeQuery(int iEpgId) const
+{
+  return PrepareSQL("REPLACE INTO lastepgscan(idEpg, sLastScan) VALUES (%u, '%s');",
+      iEpgId, CDateTime::GetCurrentDateTime().GetAsUTCDateTime().GetAsDBDateTime().c_str());
+}
+
 bool CPVREpgDatabase::Persist(const EPGMAP &epgs)
 {
   for (const auto &epgEntry : epgs)
@@ -317,8 +347,7 @@ int CPVREpgDatabase::Persist(const CPVREpg &epg, bool bQueueWrite /* = false */)
 
   std::string strQuery;
   if (epg.EpgID() > 0)
-    strQuery = PrepareSQL("REPLACE INTO epg (idEpg, sName, sScraperName) "
-        "VALUES (%u, '%s', '%s');", epg.EpgID(), epg.Name().c_str(), epg.ScraperName().c_str());
+    strQuery = GetPersistQuery(epg);
   else
     strQuery = PrepareSQL("INSERT INTO epg (sName, sScraperName) "
         "VALUES ('%s', '%s');", epg.Name().c_str(), epg.ScraperName().c_str());
@@ -337,58 +366,48 @@ int CPVREpgDatabase::Persist(const CPVREpg &epg, bool bQueueWrite /* = false */)
   return iReturn;
 }
 
-int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* = true */)
+std::string CPVREpgDatabase::GetPersistQuery(const CPVREpg &epg) const
 {
-  int iReturn(-1);
-
-  if (tag.EpgID() <= 0)
-  {
-    CLog::Log(LOGERROR, "%s - tag '%s' does not have a valid table", __FUNCTION__, tag.Title(true).c_str());
-    return iReturn;
-  }
+  return PrepareSQL("REPLACE INTO epg (idEpg, sName, sScraperName) "
+      "VALUES (%u, '%s', '%s');", epg.EpgID(), epg.Name().c_str(), epg.ScraperName().c_str());
+}
 
+std::string CPVREpgDatabase::GetTagValues(const CPVREpgInfoTag &tag) const
+{
   time_t iStartTime, iEndTime, iFirstAired;
   tag.StartAsUTC().GetAsTime(iStartTime);
   tag.EndAsUTC().GetAsTime(iEndTime);
   tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
 
-  int iBroadcastId = tag.BroadcastId();
-  std::string strQuery;
-
   /* Only store the genre string when needed */
   std::string strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING) ? StringUtils::Join(tag.Genre(), g_advancedSettings.m_videoItemSeparator) : "";
 
-  if (iBroadcastId < 0)
-  {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, iBroadcastUid) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, %i);",
-        tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
-        tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
-        tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(),
-        tag.UniqueBroadcastID());
-  }
-  else
+  /* tags without a database ID get a new one */
+  int iBroadcastId = tag.BroadcastId();
+  std::string strBroadcastId = iBroadcastId < 0 ? "NULL" : StringUtils::Format("%i", iBroadcastId);
+
+  return PrepareSQL("(%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, %i, %s)",
+      tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
+      tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
+      tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
+      tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
+      static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), tag.Notify(),
+      tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(),
+      tag.UniqueBroadcastID(), strBroadcastId.c_str());
+}
+
+int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* = true */)
+{
+  int iReturn(-1);
+
+  if (tag.EpgID() <= 0)
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, iBroadcastUid, idBroadcast) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, %i, %i);",
-        tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
-        tag.Title(true).c_str(), tag.PlotOutline(true).c_str(), tag.Plot(true).c_str(),
-        tag.OriginalTitle(true).c_str(), tag.Cast().c_str(), tag.Director().c_str(), tag.Writer().c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(),
-        tag.UniqueBroadcastID(), iBroadcastId);
+    CLog::Log(LOGERROR, "%s - tag '%s' does not have a valid table", __FUNCTION__, tag.Title(true).c_str());
+    return iReturn;
   }
 
+  std::string strQuery = "REPLACE INTO epgtags (" EPGDB_TAG_COLUMNS ") VALUES " + GetTagValues(tag) + ";";
+
   if (bSingleUpdate)
   {
     if (ExecuteQuery(strQuery))
@@ -403,6 +422,66 @@ int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* =
   return iReturn;
 }
 
+void CPVREpgDatabase::GetPersistQueries(const std::vector<CPVREpgInfoTagPtr> &tags, std::vector<std::string> &queries) const
+{
+  std::string strQuery;
+  unsigned int iRows = 0;
+
+  for (const auto &tag : tags)
+  {
+    if (tag->EpgID() <= 0)
+    {
+      CLog::Log(LOGERROR, "%s - tag '%s' does not have a valid table", __FUNCTION__, tag->Title(true).c_str());
+      continue;
+    }
+
+    if (iRows == 0)
+      strQuery = "REPLACE INTO epgtags (" EPGDB_TAG_COLUMNS ") VALUES ";
+    else
+      strQuery += ", ";
+
+    strQuery += GetTagValues(*tag);
+
+    if (++iRows == EPGDB_MAX_ROWS_PER_QUERY || strQuery.size() >= EPGDB_MAX_QUERY_SIZE)
+    {
+      queries.emplace_back(strQuery + ";");
+      iRows = 0;
+    }
+  }
+
+  if (iRows > 0)
+    queries.emplace_back(strQuery + ";");
+}
+
+void CPVREpgDatabase::GetDeleteQueries(const std::vector<CPVREpgInfoTagPtr> &tags, std::vector<std::string> &queries) const
+{
+  std::string strQuery;
+  unsigned int iRows = 0;
+
+  for (const auto &tag : tags)
+  {
+    /* tag without a database ID was not persisted */
+    if (tag->BroadcastId() <= 0)
+      continue;
+
+    if (iRows == 0)
+      strQuery = "DELETE FROM epgtags WHERE idBroadcast IN (";
+    else
+      strQuery += ", ";
+
+    strQuery += StringUtils::Format("%i", tag->BroadcastId());
+
+    if (++iRows == EPGDB_MAX_ROWS_PER_QUERY)
+    {
+      queries.emplace_back(strQuery + ");");
+      iRows = 0;
+    }
+  }
+
+  if (iRows > 0)
+    queries.emplace_back(strQuery + ");");
+}
+
 int CPVREpgDatabase::GetLastEPGId(void)
 {
   std::string strQuery = PrepareSQL("SELECT MAX(idEpg) FROM epg");
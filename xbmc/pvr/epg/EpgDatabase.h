@@ -19,6 +19,9 @@
  *
  */
 
+#include <string>
+#include <vector>
+
 #include "XBDateTime.h"
 #include "dbwrappers/Database.h"
 
@@ -71,6 +74,12 @@ namespace PVR
      */
     bool DeleteEpg(void);
 
+    /*!
+     * @brief Get the queries to remove all EPG information from the database.
+     * @param queries The list to append the queries to.
+     */
+    void GetDeleteEpgQueries(std::vector<std::string> &queries) const;
+
     /*!
      * @brief Delete an EPG table.
      * @param table The table to remove.
@@ -78,6 +87,13 @@ namespace PVR
      */
     bool Delete(const CPVREpg &table);
 
+    /*!
+     * @brief Get the query to delete an EPG table.
+     * @param table The table to remove.
+     * @return The query or an empty string if the table wasn't persisted.
+     */
+    std::string GetDeleteQuery(const CPVREpg &table) const;
+
     /*!
      * @brief Erase all EPG entries with an end time less than the given time.
      * @param maxEndTime The maximum allowed end time.
@@ -85,6 +101,13 @@ namespace PVR
      */
     bool DeleteEpgEntries(const CDateTime &maxEndTime);
 
+    /*!
+     * @brief Get the query to erase all EPG entries with an end time less than the given time.
+     * @param maxEndTime The maximum allowed end time.
+     * @return The query.
+     */
+    std::string GetDeleteEpgEntriesQuery(const CDateTime &maxEndTime) const;
+
     /*!
      * @brief Remove a single EPG entry.
      * @param tag The entry to remove.
@@ -122,6 +145,13 @@ namespace PVR
      */
     bool PersistLastEpgScanTime(int iEpgId = 0, bool bQueueWrite = false);
 
+    /*!
+     * @brief Get the query to update the last scan time.
+     * @param iEpgId The table to update the time for. Use 0 for a global value.
+     * @return The query.
+     */
+    std::string GetLastEpgScanTimeQuery(int iEpgId) const;
+
     bool Persist(const EPGMAP &epgs);
 
     /*!
@@ -132,6 +162,13 @@ namespace PVR
      */
     int Persist(const CPVREpg &epg, bool bQueueWrite = false);
 
+    /*!
+     * @brief Get the query to persist an EPG table that already has a database ID. It's entries are not persisted.
+     * @param epg The table to persist.
+     * @return The query.
+     */
+    std::string GetPersistQuery(const CPVREpg &epg) const;
+
     /*!
      * @brief Persist an infotag.
      * @param tag The tag to persist.
@@ -140,6 +177,20 @@ namespace PVR
      */
     int Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Get the queries to persist a list of infotags. Several tags are written by a single query.
+     * @param tags The tags to persist.
+     * @param queries The list to append the queries to.
+     */
+    void GetPersistQueries(const std::vector<CPVREpgInfoTagPtr> &tags, std::vector<std::string> &queries) const;
+
+    /*!
+     * @brief Get the queries to remove a list of infotags. Several tags are removed by a single query.
+     * @param tags The tags to remove.
+     * @param queries The list to append the queries to.
+     */
+    void GetDeleteQueries(const std::vector<CPVREpgInfoTagPtr> &tags, std::vector<std::string> &queries) const;
+
     /*!
      * @return Last EPG id in the database
      */
@@ -165,5 +216,13 @@ namespace PVR
     void UpdateTables(int version) override;
 
     int GetMinSchemaVersion() const override { return 4; }
+
+  private:
+    /*!
+     * @brief Get the values of an infotag in the order of the columns used by the persist queries.
+     * @param tag The tag.
+     * @return The values, enclosed in parentheses.
+     */
+    std::string GetTagValues(const CPVREpgInfoTag &tag) const;
   };
 }
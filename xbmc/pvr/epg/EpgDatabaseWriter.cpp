@@ -0,0 +1,154 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgDatabaseWriter.h"
+
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include "EpgDatabase.h"
+
+using namespace PVR;
+
+CPVREpgDatabaseWriter::CPVREpgDatabaseWriter(void) :
+  CThread("EPGDatabaseWriter"),
+  m_bAccepting(false)
+{
+}
+
+CPVREpgDatabaseWriter::~CPVREpgDatabaseWriter(void)
+{
+  Stop();
+}
+
+void CPVREpgDatabaseWriter::Start(void)
+{
+  CSingleLock lock(m_critSection);
+  if (!IsRunning())
+  {
+    m_bAccepting = true;
+    Create();
+    SetPriority(-1);
+  }
+}
+
+void CPVREpgDatabaseWriter::Stop(void)
+{
+  {
+    /* everything queued up to here is written before the thread ends */
+    CSingleLock lock(m_critSection);
+    m_bAccepting = false;
+  }
+
+  StopThread(false);
+  m_queueEvent.Set();
+  StopThread(true);
+}
+
+bool CPVREpgDatabaseWriter::Queue(std::vector<std::string> &queries)
+{
+  if (queries.empty())
+    return true;
+
+  bool bAccepted(false);
+  {
+    CSingleLock lock(m_critSection);
+    if (m_bAccepting)
+    {
+      bAccepted = true;
+      if (m_queries.empty())
+        m_queries.swap(queries);
+      else
+      {
+        m_queries.reserve(m_queries.size() + queries.size());
+        for (auto &query : queries)
+          m_queries.emplace_back(std::move(query));
+      }
+    }
+  }
+
+  if (!bAccepted)
+  {
+    /* the caller writes the queries itself, after the ones accepted before have been written */
+    StopThread(true);
+    return false;
+  }
+
+  queries.clear();
+  m_queueEvent.Set();
+
+  return true;
+}
+
+void CPVREpgDatabaseWriter::Process(void)
+{
+  CPVREpgDatabase database;
+  if (!database.Open())
+  {
+    CLog::Log(LOGERROR, "EpgDatabaseWriter - %s - could not open the database", __FUNCTION__);
+    CSingleLock lock(m_critSection);
+    m_bAccepting = false;
+    return;
+  }
+
+  while (!m_bStop)
+  {
+    m_queueEvent.Wait();
+    Write(database);
+  }
+
+  /* don't lose the queries queued during shutdown */
+  Write(database);
+
+  database.Close();
+}
+
+void CPVREpgDatabaseWriter::Write(CPVREpgDatabase &database)
+{
+  std::vector<std::string> queries;
+  {
+    CSingleLock lock(m_critSection);
+    queries.swap(m_queries);
+  }
+
+  if (!queries.empty())
+    Execute(database, queries);
+}
+
+void CPVREpgDatabaseWriter::Execute(CPVREpgDatabase &database, const std::vector<std::string> &queries)
+{
+  unsigned int iStart = XbmcThreads::SystemClockMillis();
+  unsigned int iFailed = 0;
+
+  database.BeginTransaction();
+  for (const auto &query : queries)
+  {
+    if (!database.ExecuteQuery(query))
+      ++iFailed;
+  }
+
+  if (!database.CommitTransaction())
+    CLog::Log(LOGERROR, "EpgDatabaseWriter - %s - failed to commit %zu queries", __FUNCTION__, queries.size());
+  else if (iFailed > 0)
+    CLog::Log(LOGERROR, "EpgDatabaseWriter - %s - %u of %zu queries failed", __FUNCTION__, iFailed, queries.size());
+  else
+    CLog::Log(LOGDEBUG, "EpgDatabaseWriter - %s - %zu queries written in %u ms", __FUNCTION__, queries.size(), XbmcThreads::SystemClockMillis() - iStart);
+}
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+namespace PVR
+{
+  class CPVREpgDatabase;
+
+  /*!
+   * @brief Executes EPG database writes on a thread with its own database connection,
+   * so that persisting a large guide update doesn't block the EPG update thread.
+   *
+   * Queries are executed in the order they were queued. All queries that are pending
+   * when the writer wakes up are written in a single transaction. Deletes have to be
+   * queued too, otherwise a write queued before them could bring back the deleted rows.
+   */
+  class CPVREpgDatabaseWriter : private CThread
+  {
+  public:
+    CPVREpgDatabaseWriter(void);
+    ~CPVREpgDatabaseWriter(void) override;
+
+    /*!
+     * @brief Start the writer thread.
+     */
+    void Start(void);
+
+    /*!
+     * @brief Stop the writer thread after all pending queries have been written.
+     */
+    void Stop(void);
+
+    /*!
+     * @brief Queue queries for execution.
+     * @param queries The queries. Their contents are moved to the queue if it was accepted.
+     * @return True if the queries were queued, false if the writer isn't running.
+     */
+    bool Queue(std::vector<std::string> &queries);
+
+    /*!
+     * @brief Execute queries in a single transaction.
+     * @param database The database to write to.
+     * @param queries The queries.
+     */
+    static void Execute(CPVREpgDatabase &database, const std::vector<std::string> &queries);
+
+  protected:
+    void Process(void) override;
+
+  private:
+    CPVREpgDatabaseWriter(const CPVREpgDatabaseWriter&) = delete;
+    CPVREpgDatabaseWriter& operator=(const CPVREpgDatabaseWriter&) = delete;
+
+    void Write(CPVREpgDatabase &database);
+
+    std::vector<std::string> m_queries;
+    bool m_bAccepting; /*!< true while queued queries are guaranteed to be written */
+    CEvent m_queueEvent;
+    CCriticalSection m_critSection;
+  };
+}
@@ -0,0 +1,515 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgIndex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_epg_types.h"
+#include "EpgInfoTag.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+// the string pool is rebuilt once more strings are unused than used, but not for a handful of them
+#define EPG_INDEX_MIN_DEAD_STRINGS 256
+
+using namespace PVR;
+
+namespace
+{
+  void Intersect(std::vector<unsigned int> &values, const std::vector<unsigned int> &other)
+  {
+    std::vector<unsigned int> result;
+    std::set_intersection(values.begin(), values.end(), other.begin(), other.end(), std::back_inserter(result));
+    values.swap(result);
+  }
+
+  void Unite(std::vector<unsigned int> &values, const std::vector<unsigned int> &other)
+  {
+    std::vector<unsigned int> result;
+    std::set_union(values.begin(), values.end(), other.begin(), other.end(), std::back_inserter(result));
+    values.swap(result);
+  }
+}
+
+CPVREpgIndex::Query::Query() :
+  minStart(-1),
+  maxEnd(-1),
+  iGenreType(-1),
+  bIncludeUnknownGenres(false),
+  iMinimumDuration(-1),
+  iMaximumDuration(-1),
+  bIsCaseSensitive(false)
+{
+}
+
+CPVREpgIndex::CPVREpgIndex(void) :
+  m_iValidMaxEnd(0),
+  m_iDeadStrings(0),
+  m_iPostings(0)
+{
+  Clear();
+}
+
+CPVREpgIndex::CPVREpgIndex(const CPVREpgIndex &right) :
+  CPVREpgIndex()
+{
+  *this = right;
+}
+
+CPVREpgIndex &CPVREpgIndex::operator =(const CPVREpgIndex &right)
+{
+  if (this != &right)
+  {
+    // the string pool points into its own map, so it is rebuilt instead of copied
+    Clear();
+    for (const auto &tag : right.m_tags)
+      Update(tag);
+  }
+  return *this;
+}
+
+CPVREpgInfoTagPtr CPVREpgIndex::GetTag(const CDateTime &start) const
+{
+  time_t iStart;
+  start.GetAsTime(iStart);
+
+  size_t iRecord = GetPosition(iStart);
+  if (iRecord < m_records.size() && m_records[iRecord].start == iStart)
+    return m_tags[iRecord];
+
+  return CPVREpgInfoTagPtr();
+}
+
+CPVREpgInfoTagPtr CPVREpgIndex::GetNextTag(const CDateTime &start) const
+{
+  time_t iStart;
+  start.GetAsTime(iStart);
+
+  size_t iRecord = GetPosition(iStart);
+  if (iRecord + 1 < m_records.size() && m_records[iRecord].start == iStart)
+    return m_tags[iRecord + 1];
+
+  return CPVREpgInfoTagPtr();
+}
+
+void CPVREpgIndex::Update(const CPVREpgInfoTagPtr &tag)
+{
+  Record record = CreateRecord(*tag);
+  size_t iRecord = GetPosition(record.start);
+
+  if (iRecord < m_records.size() && m_records[iRecord].start == record.start)
+  {
+    // the new strings have been referenced already, so unchanged ones stay alive
+    ReleaseRecord(m_records[iRecord]);
+    m_records[iRecord] = record;
+    m_tags[iRecord] = tag;
+  }
+  else
+  {
+    m_records.insert(m_records.begin() + iRecord, record);
+    m_tags.insert(m_tags.begin() + iRecord, tag);
+    m_maxEnd.insert(m_maxEnd.begin() + iRecord, record.end);
+  }
+
+  Invalidate(iRecord);
+}
+
+CPVREpgInfoTagPtr CPVREpgIndex::Remove(const CDateTime &start)
+{
+  time_t iStart;
+  start.GetAsTime(iStart);
+
+  CPVREpgInfoTagPtr tag;
+  size_t iRecord = GetPosition(iStart);
+  if (iRecord < m_records.size() && m_records[iRecord].start == iStart)
+  {
+    tag = m_tags[iRecord];
+    ReleaseRecord(m_records[iRecord]);
+    m_records.erase(m_records.begin() + iRecord);
+    m_tags.erase(m_tags.begin() + iRecord);
+    m_maxEnd.erase(m_maxEnd.begin() + iRecord);
+    Invalidate(iRecord);
+  }
+
+  return tag;
+}
+
+std::vector<CPVREpgInfoTagPtr> CPVREpgIndex::RemoveEndedBefore(const CDateTime &time)
+{
+  time_t iTime;
+  time.GetAsTime(iTime);
+
+  std::vector<CPVREpgInfoTagPtr> removed;
+  size_t iFirstRemoved = m_records.size();
+  size_t iKept = 0;
+  for (size_t iRecord = 0; iRecord < m_records.size(); iRecord++)
+  {
+    if (m_records[iRecord].end < iTime)
+    {
+      ReleaseRecord(m_records[iRecord]);
+      removed.push_back(m_tags[iRecord]);
+      iFirstRemoved = std::min(iFirstRemoved, iRecord);
+      continue;
+    }
+
+    if (iKept != iRecord)
+    {
+      m_records[iKept] = m_records[iRecord];
+      m_tags[iKept] = std::move(m_tags[iRecord]);
+    }
+    iKept++;
+  }
+
+  if (!removed.empty())
+  {
+    m_records.resize(iKept);
+    m_tags.resize(iKept);
+    m_maxEnd.resize(iKept);
+    Invalidate(iFirstRemoved);
+  }
+
+  return removed;
+}
+
+void CPVREpgIndex::Clear(void)
+{
+  m_tags.clear();
+  m_records.clear();
+  m_maxEnd.clear();
+  m_iValidMaxEnd = 0;
+  m_stringIds.clear();
+  m_strings.clear();
+  m_references.clear();
+  m_iDeadStrings = 0;
+  m_trigrams.clear();
+  m_iPostings = 0;
+
+  // ID 0 is used for empty strings
+  m_strings.push_back(&m_stringIds.insert(std::make_pair(std::string(), 0)).first->first);
+  m_references.push_back(0);
+}
+
+std::vector<CPVREpgInfoTagPtr> CPVREpgIndex::Find(const Query &query) const
+{
+  std::vector<CPVREpgInfoTagPtr> matches;
+
+  // check every distinct title and plot outline only once
+  std::vector<bool> matchingStrings;
+  if (!query.strSearchTerm.empty())
+  {
+    CTextSearch search(query.strSearchTerm, query.bIsCaseSensitive, SEARCH_DEFAULT_OR);
+    matchingStrings.assign(m_strings.size(), false);
+
+    std::vector<unsigned int> candidates;
+    if (GetCandidates(search, candidates))
+    {
+      for (unsigned int iString : candidates)
+      {
+        if (m_references[iString] > 0)
+          matchingStrings[iString] = search.Search(*m_strings[iString]);
+      }
+    }
+    else
+    {
+      for (unsigned int iString = 1; iString < m_strings.size(); iString++)
+      {
+        if (m_references[iString] > 0)
+          matchingStrings[iString] = search.Search(*m_strings[iString]);
+      }
+    }
+  }
+
+  size_t iRecord = query.minStart >= 0 ? GetPosition(query.minStart) : 0;
+
+  // an event starting after the end of the time window can't end within it
+  for (; iRecord < m_records.size() && (query.maxEnd < 0 || m_records[iRecord].start <= query.maxEnd); iRecord++)
+  {
+    const Record &record = m_records[iRecord];
+    if (query.maxEnd >= 0 && record.end > query.maxEnd)
+      continue;
+
+    if (query.iGenreType >= 0)
+    {
+      bool bIsUnknownGenre(record.iGenreType > EPG_EVENT_CONTENTMASK_USERDEFINED ||
+                           record.iGenreType < EPG_EVENT_CONTENTMASK_MOVIEDRAMA);
+      if (!(query.bIncludeUnknownGenres && bIsUnknownGenre) && record.iGenreType != query.iGenreType)
+        continue;
+    }
+
+    time_t duration = record.end - record.start;
+    if ((query.iMinimumDuration >= 0 && duration <= query.iMinimumDuration) ||
+        (query.iMaximumDuration >= 0 && duration >= query.iMaximumDuration))
+      continue;
+
+    if (!matchingStrings.empty() && !matchingStrings[record.iTitle] && !matchingStrings[record.iPlotOutline])
+      continue;
+
+    matches.push_back(m_tags[iRecord]);
+  }
+
+  return matches;
+}
+
+std::vector<CPVREpgInfoTagPtr> CPVREpgIndex::GetTagsBetween(const CDateTime &begin, const CDateTime &end) const
+{
+  time_t iBegin, iEnd;
+  begin.GetAsTime(iBegin);
+  end.GetAsTime(iEnd);
+
+  UpdateMaxEnd();
+
+  std::vector<CPVREpgInfoTagPtr> matches;
+
+  // all events before the first one with a running maximum end time after 'begin' are over already
+  size_t iRecord = std::upper_bound(m_maxEnd.begin(), m_maxEnd.end(), iBegin) - m_maxEnd.begin();
+  for (; iRecord < m_records.size() && m_records[iRecord].start < iEnd; iRecord++)
+  {
+    if (m_records[iRecord].end > iBegin)
+      matches.push_back(m_tags[iRecord]);
+  }
+
+  return matches;
+}
+
+CPVREpgIndex::Statistics CPVREpgIndex::GetStatistics(void) const
+{
+  Statistics statistics;
+  statistics.events = m_records.size();
+  statistics.strings = m_strings.size() - 1 - m_iDeadStrings;
+  statistics.deadStrings = m_iDeadStrings;
+  statistics.trigrams = m_trigrams.size();
+  statistics.postings = m_iPostings;
+
+  return statistics;
+}
+
+CPVREpgIndex::Record CPVREpgIndex::CreateRecord(const CPVREpgInfoTag &tag)
+{
+  Record record;
+  tag.StartAsUTC().GetAsTime(record.start);
+  tag.EndAsUTC().GetAsTime(record.end);
+  record.iTitle = Intern(tag.Title(true));
+  record.iPlotOutline = Intern(tag.PlotOutline(true));
+  record.iGenreType = tag.GenreType();
+  return record;
+}
+
+void CPVREpgIndex::Invalidate(size_t iRecord)
+{
+  m_iValidMaxEnd = std::min(m_iValidMaxEnd, iRecord);
+
+  if (m_iDeadStrings > EPG_INDEX_MIN_DEAD_STRINGS && m_iDeadStrings > m_strings.size() - m_iDeadStrings)
+    Compact();
+}
+
+void CPVREpgIndex::UpdateMaxEnd(void) const
+{
+  // the running maxima are only brought up to date before they are used, so loading a table stays linear
+  for (size_t iRecord = m_iValidMaxEnd; iRecord < m_records.size(); iRecord++)
+    m_maxEnd[iRecord] = iRecord == 0 ? m_records[iRecord].end : std::max(m_maxEnd[iRecord - 1], m_records[iRecord].end);
+  m_iValidMaxEnd = m_records.size();
+}
+
+size_t CPVREpgIndex::GetPosition(time_t start) const
+{
+  // new events are appended most of the time
+  if (m_records.empty() || m_records.back().start < start)
+    return m_records.size();
+
+  return std::lower_bound(m_records.begin(), m_records.end(), start,
+                          [](const Record &left, time_t start) { return left.start < start; }) - m_records.begin();
+}
+
+unsigned int CPVREpgIndex::Intern(const std::string &strValue)
+{
+  if (strValue.empty())
+    return 0;
+
+  auto it = m_stringIds.find(strValue);
+  if (it != m_stringIds.end())
+  {
+    if (m_references[it->second]++ == 0)
+      m_iDeadStrings--;
+    return it->second;
+  }
+
+  unsigned int iString = m_strings.size();
+  it = m_stringIds.insert(std::make_pair(strValue, iString)).first;
+  m_strings.push_back(&it->first);
+  m_references.push_back(1);
+  IndexString(iString);
+
+  return iString;
+}
+
+void CPVREpgIndex::Release(unsigned int iString)
+{
+  if (iString > 0 && --m_references[iString] == 0)
+    m_iDeadStrings++;
+}
+
+void CPVREpgIndex::ReleaseRecord(const Record &record)
+{
+  Release(record.iTitle);
+  Release(record.iPlotOutline);
+}
+
+void CPVREpgIndex::Compact(void)
+{
+  std::unordered_map<std::string, unsigned int> stringIds;
+  std::vector<const std::string*> strings;
+  std::vector<unsigned int> references;
+  std::vector<unsigned int> newIds(m_strings.size(), 0);
+
+  stringIds.reserve(m_strings.size() - m_iDeadStrings);
+  strings.reserve(m_strings.size() - m_iDeadStrings);
+  references.reserve(m_strings.size() - m_iDeadStrings);
+
+  strings.push_back(&stringIds.insert(std::make_pair(std::string(), 0)).first->first);
+  references.push_back(0);
+
+  for (unsigned int iString = 1; iString < m_strings.size(); iString++)
+  {
+    if (m_references[iString] == 0)
+      continue;
+
+    newIds[iString] = strings.size();
+    strings.push_back(&stringIds.insert(std::make_pair(*m_strings[iString], newIds[iString])).first->first);
+    references.push_back(m_references[iString]);
+  }
+
+  m_stringIds.swap(stringIds);
+  m_strings.swap(strings);
+  m_references.swap(references);
+  m_iDeadStrings = 0;
+
+  // the IDs keep their order, so the posting lists stay sorted
+  m_trigrams.clear();
+  m_iPostings = 0;
+  for (unsigned int iString = 1; iString < m_strings.size(); iString++)
+    IndexString(iString);
+
+  for (auto &record : m_records)
+  {
+    record.iTitle = newIds[record.iTitle];
+    record.iPlotOutline = newIds[record.iPlotOutline];
+  }
+}
+
+void CPVREpgIndex::IndexString(unsigned int iString)
+{
+  std::vector<uint32_t> trigrams;
+  GetTrigrams(*m_strings[iString], trigrams);
+
+  for (uint32_t trigram : trigrams)
+    m_trigrams[trigram].push_back(iString);
+  m_iPostings += trigrams.size();
+}
+
+bool CPVREpgIndex::GetCandidates(const CTextSearch &search, std::vector<unsigned int> &candidates) const
+{
+  // a matching string contains all AND terms
+  bool bRestricted(false);
+  for (const auto &strTerm : search.GetAndTerms())
+  {
+    std::vector<unsigned int> termCandidates;
+    if (!GetTermCandidates(strTerm, termCandidates))
+      continue;
+
+    if (bRestricted)
+      Intersect(candidates, termCandidates);
+    else
+      candidates.swap(termCandidates);
+    bRestricted = true;
+  }
+
+  if (bRestricted)
+    return true;
+
+  // or at least one of the OR terms
+  if (search.GetOrTerms().empty())
+    return false;
+
+  for (const auto &strTerm : search.GetOrTerms())
+  {
+    std::vector<unsigned int> termCandidates;
+    if (!GetTermCandidates(strTerm, termCandidates))
+      return false;
+
+    Unite(candidates, termCandidates);
+  }
+
+  return true;
+}
+
+bool CPVREpgIndex::GetTermCandidates(const std::string &strTerm, std::vector<unsigned int> &candidates) const
+{
+  std::vector<uint32_t> trigrams;
+  GetTrigrams(strTerm, trigrams);
+
+  // terms shorter than a trigram can't be looked up
+  if (trigrams.empty())
+    return false;
+
+  std::vector<const std::vector<unsigned int>*> postings;
+  for (uint32_t trigram : trigrams)
+  {
+    auto it = m_trigrams.find(trigram);
+    if (it == m_trigrams.end())
+    {
+      candidates.clear();
+      return true;
+    }
+    postings.push_back(&it->second);
+  }
+
+  // start with the rarest trigram to keep the intermediate results small
+  std::sort(postings.begin(), postings.end(),
+            [](const std::vector<unsigned int> *left, const std::vector<unsigned int> *right) { return left->size() < right->size(); });
+
+  candidates = *postings.front();
+  for (size_t iPosting = 1; iPosting < postings.size() && !candidates.empty(); iPosting++)
+    Intersect(candidates, *postings[iPosting]);
+
+  return true;
+}
+
+void CPVREpgIndex::GetTrigrams(const std::string &strValue, std::vector<uint32_t> &trigrams)
+{
+  trigrams.clear();
+  if (strValue.size() < 3)
+    return;
+
+  // case insensitive, a case sensitive search is checked against the original string afterwards
+  std::string strLower(strValue);
+  StringUtils::ToLower(strLower);
+
+  trigrams.reserve(strLower.size() - 2);
+  for (size_t iPos = 0; iPos + 3 <= strLower.size(); iPos++)
+    trigrams.push_back(((uint32_t)(unsigned char)strLower[iPos] << 16) |
+                       ((uint32_t)(unsigned char)strLower[iPos + 1] << 8) |
+                       (uint32_t)(unsigned char)strLower[iPos + 2]);
+
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
@@ -0,0 +1,196 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "XBDateTime.h"
+#include "pvr/PVRTypes.h"
+
+class CTextSearch;
+
+namespace PVR
+{
+  /*!
+   * @brief The events of an EPG table, sorted by start time.
+   *
+   * Next to the tags, the index keeps an array of fixed-size records with the
+   * properties that are searched for, together with the running maximum of
+   * their end times (the interval index), so time window queries don't have to
+   * walk all tags. Titles and plot outlines are interned in a string pool and
+   * every interned string is indexed by the trigrams it contains, so a search
+   * only has to look at the few distinct strings that can contain the search
+   * terms instead of at every event.
+   *
+   * Find() only returns candidates; callers are expected to check them against
+   * the complete filter. The index isn't thread safe, the table owning it has
+   * to lock it.
+   */
+  class CPVREpgIndex
+  {
+  public:
+    /*!
+     * @brief The conditions an event has to meet to be returned by Find().
+     * Negative values leave a condition unset.
+     */
+    struct Query
+    {
+      Query();
+
+      time_t minStart;             /*!< the earliest start time in UTC */
+      time_t maxEnd;               /*!< the latest end time in UTC */
+      int iGenreType;              /*!< the genre type of the event */
+      bool bIncludeUnknownGenres;  /*!< match events without a known genre too */
+      int iMinimumDuration;        /*!< the duration must be longer than this amount of seconds */
+      int iMaximumDuration;        /*!< the duration must be shorter than this amount of seconds */
+      std::string strSearchTerm;   /*!< the title or plot outline has to match this term (see CTextSearch) */
+      bool bIsCaseSensitive;       /*!< match the search term case sensitive */
+    };
+
+    struct Statistics
+    {
+      size_t events;
+      size_t strings;      /*!< the number of interned strings that are in use */
+      size_t deadStrings;  /*!< the number of interned strings that aren't used anymore */
+      size_t trigrams;
+      size_t postings;
+    };
+
+    CPVREpgIndex(void);
+    CPVREpgIndex(const CPVREpgIndex &right);
+    CPVREpgIndex &operator =(const CPVREpgIndex &right);
+
+    /*!
+     * @return True if the table doesn't contain any events.
+     */
+    bool IsEmpty(void) const { return m_tags.empty(); }
+
+    /*!
+     * @return The number of events in the table.
+     */
+    size_t Size(void) const { return m_tags.size(); }
+
+    /*!
+     * @return All events of the table, sorted by start time.
+     */
+    const std::vector<CPVREpgInfoTagPtr> &GetTags(void) const { return m_tags; }
+
+    /*!
+     * @brief Get the event starting at the given time.
+     * @param start The start time in UTC.
+     * @return The event or NULL if it wasn't found.
+     */
+    CPVREpgInfoTagPtr GetTag(const CDateTime &start) const;
+
+    /*!
+     * @brief Get the event following the one starting at the given time.
+     * @param start The start time in UTC.
+     * @return The event or NULL if there is no event starting at this time or it is the last one.
+     */
+    CPVREpgInfoTagPtr GetNextTag(const CDateTime &start) const;
+
+    /*!
+     * @brief Add an event or replace the one with the same start time. Has to be called again after the
+     * end time, title, plot outline or genre of an event in the table were changed.
+     * @param tag The event.
+     */
+    void Update(const CPVREpgInfoTagPtr &tag);
+
+    /*!
+     * @brief Remove the event starting at the given time.
+     * @param start The start time in UTC.
+     * @return The removed event or NULL if it wasn't found.
+     */
+    CPVREpgInfoTagPtr Remove(const CDateTime &start);
+
+    /*!
+     * @brief Remove all events that ended before the given time.
+     * @param time The time in UTC.
+     * @return The removed events.
+     */
+    std::vector<CPVREpgInfoTagPtr> RemoveEndedBefore(const CDateTime &time);
+
+    /*!
+     * @brief Remove all events.
+     */
+    void Clear(void);
+
+    /*!
+     * @brief Get all events which meet the conditions of a query.
+     * @param query The query.
+     * @return The matching events, ordered by start time.
+     */
+    std::vector<CPVREpgInfoTagPtr> Find(const Query &query) const;
+
+    /*!
+     * @brief Get all events which are (partly) running in the given time window.
+     * @param begin The start of the time window in UTC.
+     * @param end The end of the time window in UTC.
+     * @return The matching events, ordered by start time.
+     */
+    std::vector<CPVREpgInfoTagPtr> GetTagsBetween(const CDateTime &begin, const CDateTime &end) const;
+
+    Statistics GetStatistics(void) const;
+
+  private:
+    struct Record
+    {
+      time_t start;
+      time_t end;
+      unsigned int iTitle;
+      unsigned int iPlotOutline;
+      int iGenreType;
+    };
+
+    Record CreateRecord(const CPVREpgInfoTag &tag);
+    void Invalidate(size_t iRecord);
+    void UpdateMaxEnd(void) const;
+    size_t GetPosition(time_t start) const;
+
+    unsigned int Intern(const std::string &strValue);
+    void Release(unsigned int iString);
+    void ReleaseRecord(const Record &record);
+    void Compact(void);
+    void IndexString(unsigned int iString);
+
+    bool GetCandidates(const CTextSearch &search, std::vector<unsigned int> &candidates) const;
+    bool GetTermCandidates(const std::string &strTerm, std::vector<unsigned int> &candidates) const;
+
+    static void GetTrigrams(const std::string &strValue, std::vector<uint32_t> &trigrams);
+
+    std::vector<CPVREpgInfoTagPtr> m_tags;  /*!< sorted by start time */
+    std::vector<Record> m_records;          /*!< the indexed properties of the tags at the same position */
+    mutable std::vector<time_t> m_maxEnd;   /*!< the latest end time of all records up to the same position */
+    mutable size_t m_iValidMaxEnd;          /*!< the running maxima before this position are up to date */
+
+    std::unordered_map<std::string, unsigned int> m_stringIds;  /*!< the ID of every interned string */
+    std::vector<const std::string*> m_strings;                  /*!< interned strings by ID, owned by m_stringIds */
+    std::vector<unsigned int> m_references;                     /*!< the number of records using a string */
+    size_t m_iDeadStrings;
+
+    std::unordered_map<uint32_t, std::vector<unsigned int>> m_trigrams;  /*!< sorted IDs of the strings containing a trigram */
+    size_t m_iPostings;
+  };
+}
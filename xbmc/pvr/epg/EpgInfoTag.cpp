@@ -598,7 +598,7 @@ bool CPVREpgInfoTag::Update(const CPVREpgInfoTag &tag, bool bUpdateBroadcastId /
         m_strEpisodeName     != tag.m_strEpisodeName ||
         m_iUniqueBroadcastID != tag.m_iUniqueBroadcastID ||
         EpgID()              != tag.EpgID() ||
-        m_genre              != tag.m_genre ||
+        (m_iGenreType == EPG_GENRE_USE_STRING && m_genre != tag.m_genre) || // otherwise derived from type and sub type
         m_strIconPath        != tag.m_strIconPath ||
         m_iFlags             != tag.m_iFlags
     );
@@ -0,0 +1,209 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgUpdateScheduler.h"
+
+#include <algorithm>
+
+#include "threads/SingleLock.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+
+#include "pvr/channels/PVRChannel.h"
+
+#include "Epg.h"
+
+using namespace PVR;
+
+namespace
+{
+  class CPVREpgUpdateJob : public CJob
+  {
+  public:
+    explicit CPVREpgUpdateJob(CPVREpgUpdateScheduler &scheduler) : m_scheduler(scheduler) {}
+    ~CPVREpgUpdateJob(void) override { m_scheduler.OnJobEnded(); }
+
+    const char *GetType() const override { return "pvr-epg-update"; }
+
+    bool DoWork() override
+    {
+      m_scheduler.Process();
+      return true;
+    }
+
+  private:
+    CPVREpgUpdateScheduler &m_scheduler;
+  };
+}
+
+CPVREpgUpdateScheduler::CPVREpgUpdateScheduler(time_t start, time_t end, unsigned int iMaxJobs, unsigned int iMaxJobsPerClient) :
+  m_start(start),
+  m_end(end),
+  m_iMaxJobs(std::max(iMaxJobs, 1U)),
+  m_iMaxJobsPerClient(std::max(iMaxJobsPerClient, 1U)),
+  m_iRunningJobs(0),
+  m_bAborted(false),
+  m_iSize(0),
+  m_iDone(0),
+  m_finishedEvent(true, true)
+{
+}
+
+CPVREpgUpdateScheduler::~CPVREpgUpdateScheduler(void)
+{
+  /* the jobs refer to this instance */
+  Abort();
+  m_finishedEvent.Wait();
+}
+
+void CPVREpgUpdateScheduler::Add(const CPVREpgPtr &epg, bool bUpdateFromClient, int iPriority)
+{
+  const CPVRChannelPtr channel = epg->Channel();
+
+  Entry entry;
+  entry.epg = epg;
+  entry.bUpdateFromClient = bUpdateFromClient;
+  entry.iPriority = iPriority;
+  entry.iClientId = channel ? channel->ClientID() : -1;
+
+  CSingleLock lock(m_critSection);
+  m_entries.emplace_back(entry);
+  m_iSize++;
+}
+
+void CPVREpgUpdateScheduler::Start(void)
+{
+  unsigned int iJobs = 0;
+  {
+    CSingleLock lock(m_critSection);
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry &left, const Entry &right) { return left.iPriority < right.iPriority; });
+
+    /* there's no point in starting more jobs than clients can serve at a time */
+    std::map<int, unsigned int> tables;
+    for (const auto &entry : m_entries)
+      tables[entry.iClientId]++;
+    for (const auto &client : tables)
+      iJobs += std::min(client.second, m_iMaxJobsPerClient);
+    iJobs = std::min(iJobs, m_iMaxJobs);
+
+    if (iJobs == 0)
+      return;
+
+    m_iRunningJobs = iJobs;
+    m_finishedEvent.Reset();
+  }
+
+  for (unsigned int i = 0; i < iJobs; i++)
+  {
+    CPVREpgUpdateJob *job = new CPVREpgUpdateJob(*this);
+    if (CJobManager::GetInstance().AddJob(job, nullptr, CJob::PRIORITY_DEDICATED) == 0)
+    {
+      /* the job manager isn't running, update on this thread instead */
+      job->DoWork();
+      delete job;
+    }
+  }
+}
+
+bool CPVREpgUpdateScheduler::Wait(unsigned int iTimeoutMs)
+{
+  return m_finishedEvent.WaitMSec(iTimeoutMs);
+}
+
+void CPVREpgUpdateScheduler::Abort(void)
+{
+  CSingleLock lock(m_critSection);
+  m_bAborted = true;
+}
+
+unsigned int CPVREpgUpdateScheduler::GetProgress(std::string &strLastTable) const
+{
+  CSingleLock lock(m_critSection);
+  strLastTable = m_strLastTable;
+  return m_iDone;
+}
+
+unsigned int CPVREpgUpdateScheduler::Size(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_iSize;
+}
+
+std::vector<CPVREpgPtr> CPVREpgUpdateScheduler::GetUpdatedTables(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_updatedTables;
+}
+
+std::vector<CPVREpgPtr> CPVREpgUpdateScheduler::GetFailedTables(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_failedTables;
+}
+
+bool CPVREpgUpdateScheduler::GetNextEntry(Entry &entry)
+{
+  CSingleLock lock(m_critSection);
+  if (m_bAborted)
+    return false;
+
+  /* take the first table of a client that may get another request. if there's none, the
+   * remaining tables belong to clients which are busy with other jobs, and those jobs will
+   * continue with them. */
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    unsigned int &iActiveJobs = m_activeJobs[it->iClientId];
+    if (iActiveJobs < m_iMaxJobsPerClient)
+    {
+      iActiveJobs++;
+      entry = *it;
+      m_entries.erase(it);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void CPVREpgUpdateScheduler::Process(void)
+{
+  Entry entry;
+  while (GetNextEntry(entry))
+  {
+    bool bSuccess = entry.epg->ExecuteUpdate(m_start, m_end, entry.bUpdateFromClient);
+
+    CSingleLock lock(m_critSection);
+    m_activeJobs[entry.iClientId]--;
+    m_iDone++;
+    m_strLastTable = entry.epg->Name();
+    if (bSuccess)
+      m_updatedTables.emplace_back(entry.epg);
+    else
+      m_failedTables.emplace_back(entry.epg);
+  }
+}
+
+void CPVREpgUpdateScheduler::OnJobEnded(void)
+{
+  CSingleLock lock(m_critSection);
+  if (m_iRunningJobs > 0 && --m_iRunningJobs == 0)
+    m_finishedEvent.Set();
+}
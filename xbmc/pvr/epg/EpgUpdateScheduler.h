@@ -0,0 +1,145 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <time.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include "pvr/PVRTypes.h"
+
+namespace PVR
+{
+  /*!
+   * @brief Executes the client part of the updates of several EPG tables in parallel.
+   *
+   * Tables are updated in order of their priority by a bounded number of jobs. PVR add-ons
+   * don't declare whether they can handle concurrent requests, so the number of requests
+   * that are sent to the same client at a time is limited separately.
+   */
+  class CPVREpgUpdateScheduler
+  {
+  public:
+    /*!
+     * @brief Create a new scheduler.
+     * @param start The start of the time frame to update.
+     * @param end The end of the time frame to update.
+     * @param iMaxJobs The maximum number of tables that are updated at a time.
+     * @param iMaxJobsPerClient The maximum number of tables of the same client that are updated at a time.
+     */
+    CPVREpgUpdateScheduler(time_t start, time_t end, unsigned int iMaxJobs, unsigned int iMaxJobsPerClient);
+    ~CPVREpgUpdateScheduler(void);
+
+    /*!
+     * @brief Add a table that was prepared with CPVREpg::PrepareUpdate().
+     * @param epg The table.
+     * @param bUpdateFromClient The result of CPVREpg::PrepareUpdate().
+     * @param iPriority Tables with a lower value are updated first.
+     */
+    void Add(const CPVREpgPtr &epg, bool bUpdateFromClient, int iPriority);
+
+    /*!
+     * @brief Start the update of all added tables.
+     */
+    void Start(void);
+
+    /*!
+     * @brief Wait for the update to finish.
+     * @param iTimeoutMs The maximum time to wait in milliseconds.
+     * @return True if all tables were updated or the update was aborted, false if the timeout expired.
+     */
+    bool Wait(unsigned int iTimeoutMs);
+
+    /*!
+     * @brief Don't start the update of any more tables. Updates that are running are finished.
+     */
+    void Abort(void);
+
+    /*!
+     * @brief Get the progress of the update.
+     * @param strLastTable The name of the table that was updated last.
+     * @return The number of tables that were updated.
+     */
+    unsigned int GetProgress(std::string &strLastTable) const;
+
+    /*!
+     * @return The number of tables that were added.
+     */
+    unsigned int Size(void) const;
+
+    /*!
+     * @return The tables which were updated successfully.
+     */
+    std::vector<CPVREpgPtr> GetUpdatedTables(void) const;
+
+    /*!
+     * @return The tables which couldn't be updated.
+     */
+    std::vector<CPVREpgPtr> GetFailedTables(void) const;
+
+    /*!
+     * @brief Update tables until there's nothing left to do. Called by the update jobs.
+     */
+    void Process(void);
+
+    /*!
+     * @brief Called when an update job is destroyed, whether it was executed or not.
+     */
+    void OnJobEnded(void);
+
+  private:
+    CPVREpgUpdateScheduler(const CPVREpgUpdateScheduler&) = delete;
+    CPVREpgUpdateScheduler& operator=(const CPVREpgUpdateScheduler&) = delete;
+
+    struct Entry
+    {
+      CPVREpgPtr epg;
+      bool bUpdateFromClient;
+      int iPriority;
+      int iClientId;
+    };
+
+    bool GetNextEntry(Entry &entry);
+
+    time_t m_start;
+    time_t m_end;
+    unsigned int m_iMaxJobs;
+    unsigned int m_iMaxJobsPerClient;
+
+    std::vector<Entry> m_entries;              /*!< the tables that weren't updated yet, sorted by priority */
+    std::map<int, unsigned int> m_activeJobs;  /*!< the number of tables of every client that are being updated */
+    unsigned int m_iRunningJobs;
+    bool m_bAborted;
+
+    unsigned int m_iSize;
+    unsigned int m_iDone;
+    std::string m_strLastTable;
+    std::vector<CPVREpgPtr> m_updatedTables;
+    std::vector<CPVREpgPtr> m_failedTables;
+
+    CEvent m_finishedEvent;  /*!< set when no job is running */
+    mutable CCriticalSection m_critSection;
+  };
+}
@@ -0,0 +1,305 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_epg_types.h"
+#include "pvr/epg/EpgIndex.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+
+using namespace PVR;
+
+static CPVREpgInfoTagPtr CreateTag(time_t start, time_t end, unsigned int iUniqueBroadcastId,
+                                   const std::string &strTitle, const std::string &strPlotOutline = "",
+                                   int iGenreType = EPG_EVENT_CONTENTMASK_MOVIEDRAMA)
+{
+  EPG_TAG tag;
+  memset(&tag, 0, sizeof(tag));
+  tag.iUniqueBroadcastId = iUniqueBroadcastId;
+  tag.strTitle = strTitle.c_str();
+  tag.startTime = start;
+  tag.endTime = end;
+  tag.strPlotOutline = strPlotOutline.c_str();
+  tag.iGenreType = iGenreType;
+  return CPVREpgInfoTagPtr(new CPVREpgInfoTag(tag));
+}
+
+static void CreateSchedule(CPVREpgIndex &index)
+{
+  index.Update(CreateTag(1000, 2000, 1, "Morning News"));
+  index.Update(CreateTag(2000, 5000, 2, "The Great Escape", "War movie", EPG_EVENT_CONTENTMASK_MOVIEDRAMA));
+  index.Update(CreateTag(5000, 5600, 3, "Weather", "", EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS));
+  index.Update(CreateTag(5600, 9000, 4, "Football", "Live from the stadium", EPG_EVENT_CONTENTMASK_SPORTS));
+}
+
+static std::vector<unsigned int> GetBroadcastIds(const std::vector<CPVREpgInfoTagPtr> &tags)
+{
+  std::vector<unsigned int> ids;
+  for (const auto &tag : tags)
+    ids.push_back(tag->UniqueBroadcastID());
+  return ids;
+}
+
+TEST(TestEpgIndex, KeepsTagsSortedByStartTime)
+{
+  CPVREpgIndex index;
+  index.Update(CreateTag(5000, 5600, 3, "Weather"));
+  index.Update(CreateTag(1000, 2000, 1, "Morning News"));
+  index.Update(CreateTag(2000, 5000, 2, "The Great Escape"));
+  EXPECT_EQ(std::vector<unsigned int>({ 1, 2, 3 }), GetBroadcastIds(index.GetTags()));
+  EXPECT_EQ(3U, index.Size());
+
+  ASSERT_NE(nullptr, index.GetTag(CDateTime(2000)));
+  EXPECT_EQ(2U, index.GetTag(CDateTime(2000))->UniqueBroadcastID());
+  EXPECT_EQ(nullptr, index.GetTag(CDateTime(2001)));
+
+  ASSERT_NE(nullptr, index.GetNextTag(CDateTime(2000)));
+  EXPECT_EQ(3U, index.GetNextTag(CDateTime(2000))->UniqueBroadcastID());
+  EXPECT_EQ(nullptr, index.GetNextTag(CDateTime(5000)));
+  EXPECT_EQ(nullptr, index.GetNextTag(CDateTime(2001)));
+}
+
+TEST(TestEpgIndex, FindsEventsWithinTimeWindow)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+
+  CPVREpgIndex::Query query;
+  query.minStart = 2000;
+  query.maxEnd = 5600;
+  EXPECT_EQ(std::vector<unsigned int>({ 2, 3 }), GetBroadcastIds(index.Find(query)));
+}
+
+TEST(TestEpgIndex, FindsRunningEvents)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+  EXPECT_EQ(std::vector<unsigned int>({ 3 }), GetBroadcastIds(index.GetTagsBetween(CDateTime(5100), CDateTime(5200))));
+
+  // a long event overlapping the following ones, inserted after the running maxima were computed
+  index.Update(CreateTag(1500, 8000, 5, "Marathon"));
+  EXPECT_EQ(std::vector<unsigned int>({ 5, 3 }), GetBroadcastIds(index.GetTagsBetween(CDateTime(5100), CDateTime(5200))));
+  EXPECT_EQ(std::vector<unsigned int>({ 1, 5, 2 }), GetBroadcastIds(index.GetTagsBetween(CDateTime(1900), CDateTime(2001))));
+  EXPECT_TRUE(index.GetTagsBetween(CDateTime(9000), CDateTime(10000)).empty());
+
+  index.Remove(CDateTime(1500));
+  EXPECT_EQ(std::vector<unsigned int>({ 3 }), GetBroadcastIds(index.GetTagsBetween(CDateTime(5100), CDateTime(5200))));
+}
+
+TEST(TestEpgIndex, MatchesSearchTerms)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+
+  CPVREpgIndex::Query query;
+  query.strSearchTerm = "escape";
+  EXPECT_EQ(std::vector<unsigned int>({ 2 }), GetBroadcastIds(index.Find(query)));
+
+  // the plot outline is searched too
+  query.strSearchTerm = "stadium";
+  EXPECT_EQ(std::vector<unsigned int>({ 4 }), GetBroadcastIds(index.Find(query)));
+
+  // terms shorter than a trigram
+  query.strSearchTerm = "ws";
+  EXPECT_EQ(std::vector<unsigned int>({ 1 }), GetBroadcastIds(index.Find(query)));
+
+  query.strSearchTerm = "news | weather";
+  EXPECT_EQ(std::vector<unsigned int>({ 1, 3 }), GetBroadcastIds(index.Find(query)));
+
+  query.strSearchTerm = "great and escape";
+  EXPECT_EQ(std::vector<unsigned int>({ 2 }), GetBroadcastIds(index.Find(query)));
+
+  // title and plot outline are matched separately
+  query.strSearchTerm = "great and movie";
+  EXPECT_TRUE(index.Find(query).empty());
+
+  query.strSearchTerm = "\"Great Escape\"";
+  query.bIsCaseSensitive = true;
+  EXPECT_EQ(std::vector<unsigned int>({ 2 }), GetBroadcastIds(index.Find(query)));
+  query.strSearchTerm = "\"great escape\"";
+  EXPECT_TRUE(index.Find(query).empty());
+}
+
+TEST(TestEpgIndex, FiltersGenreAndDuration)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+
+  CPVREpgIndex::Query query;
+  query.iGenreType = EPG_EVENT_CONTENTMASK_SPORTS;
+  EXPECT_EQ(std::vector<unsigned int>({ 4 }), GetBroadcastIds(index.Find(query)));
+
+  query.iGenreType = -1;
+  query.iMinimumDuration = 1000;
+  query.iMaximumDuration = 3400;
+  EXPECT_EQ(std::vector<unsigned int>({ 2 }), GetBroadcastIds(index.Find(query)));
+}
+
+TEST(TestEpgIndex, ReplacesAndRemovesEvents)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+  EXPECT_EQ(4U, index.GetStatistics().events);
+  EXPECT_EQ(6U, index.GetStatistics().strings);
+
+  // an event with the same start time replaces the stored one
+  index.Update(CreateTag(1000, 2000, 10, "Evening News"));
+  EXPECT_EQ(4U, index.Size());
+  EXPECT_EQ(1U, index.GetStatistics().deadStrings);
+
+  CPVREpgIndex::Query query;
+  query.strSearchTerm = "news";
+  EXPECT_EQ(std::vector<unsigned int>({ 10 }), GetBroadcastIds(index.Find(query)));
+
+  // changes of a stored event are picked up when it is updated again
+  CPVREpgInfoTagPtr tag = index.GetTag(CDateTime(5000));
+  ASSERT_NE(nullptr, tag);
+  tag->SetEndFromUTC(CDateTime(5500));
+  index.Update(tag);
+  query.strSearchTerm.clear();
+  query.minStart = 5000;
+  query.maxEnd = 5500;
+  EXPECT_EQ(std::vector<unsigned int>({ 3 }), GetBroadcastIds(index.Find(query)));
+
+  ASSERT_NE(nullptr, index.Remove(CDateTime(2000)));
+  EXPECT_EQ(nullptr, index.Remove(CDateTime(2000)));
+  EXPECT_EQ(std::vector<unsigned int>({ 10, 3, 4 }), GetBroadcastIds(index.GetTags()));
+  EXPECT_EQ(3U, index.GetStatistics().deadStrings);
+
+  index.Clear();
+  EXPECT_TRUE(index.IsEmpty());
+  EXPECT_EQ(0U, index.GetStatistics().strings);
+}
+
+TEST(TestEpgIndex, RemovesEndedEvents)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+  index.Update(CreateTag(1500, 8000, 5, "Marathon"));
+
+  std::vector<CPVREpgInfoTagPtr> removed = index.RemoveEndedBefore(CDateTime(5600));
+  EXPECT_EQ(std::vector<unsigned int>({ 1, 2 }), GetBroadcastIds(removed));
+  EXPECT_EQ(std::vector<unsigned int>({ 5, 3, 4 }), GetBroadcastIds(index.GetTags()));
+  EXPECT_EQ(std::vector<unsigned int>({ 5, 4 }), GetBroadcastIds(index.GetTagsBetween(CDateTime(6000), CDateTime(7000))));
+
+  EXPECT_TRUE(index.RemoveEndedBefore(CDateTime(1000)).empty());
+}
+
+TEST(TestEpgIndex, CopiesEvents)
+{
+  CPVREpgIndex index;
+  CreateSchedule(index);
+
+  CPVREpgIndex copy(index);
+  index.Clear();
+  EXPECT_EQ(std::vector<unsigned int>({ 1, 2, 3, 4 }), GetBroadcastIds(copy.GetTags()));
+
+  CPVREpgIndex::Query query;
+  query.strSearchTerm = "escape";
+  EXPECT_EQ(std::vector<unsigned int>({ 2 }), GetBroadcastIds(copy.Find(query)));
+}
+
+TEST(TestEpgIndex, CompactsUnusedStrings)
+{
+  CPVREpgIndex index;
+  for (unsigned int iRun = 0; iRun < 3; iRun++)
+  {
+    for (unsigned int i = 0; i < 5000; i++)
+      index.Update(CreateTag(i * 60, (i + 1) * 60, i, StringUtils::Format("Show %u-%u", iRun, i)));
+  }
+
+  // only the strings of the last update are left
+  CPVREpgIndex::Statistics statistics = index.GetStatistics();
+  EXPECT_EQ(5000U, statistics.strings);
+  EXPECT_GE(statistics.strings, statistics.deadStrings);
+
+  CPVREpgIndex::Query query;
+  query.strSearchTerm = "\"show 2-4999\"";
+  EXPECT_EQ(std::vector<unsigned int>({ 4999 }), GetBroadcastIds(index.Find(query)));
+  query.strSearchTerm = "\"show 0-\"";
+  EXPECT_TRUE(index.Find(query).empty());
+}
+
+// synthetic benchmark, run it with --gtest_also_run_disabled_tests
+TEST(TestEpgIndex, DISABLED_Benchmark)
+{
+  // 800 channels with 14 days of events of 5 to 27 minutes, one million events in total
+  const unsigned int iChannels = 800;
+  const unsigned int iEventsPerChannel = 1250;
+  const time_t firstStart = 1500000000;
+
+  const char *words[] = { "news", "sports", "movie", "show", "live", "night", "morning", "weather", "travel", "kitchen",
+                          "comedy", "drama", "history", "nature", "science", "music", "kids", "crime", "family", "quiz" };
+  const unsigned int iWords = sizeof(words) / sizeof(words[0]);
+
+  std::vector<CPVREpgIndex> channels(iChannels);
+  std::string strSearchTitle;
+  unsigned int iSeed = 1;
+  unsigned int iStart = XbmcThreads::SystemClockMillis();
+  for (unsigned int iChannel = 0; iChannel < iChannels; iChannel++)
+  {
+    time_t start = firstStart;
+    for (unsigned int iEvent = 0; iEvent < iEventsPerChannel; iEvent++)
+    {
+      iSeed = iSeed * 1103515245 + 12345;
+      unsigned int iRandom = iSeed >> 8;
+      time_t end = start + (5 + iRandom % 23) * 60;
+      // a limited number of distinct titles, as series repeat a lot
+      std::string strTitle = StringUtils::Format("%s %s %u", words[iRandom % iWords], words[(iRandom / iWords) % iWords], iRandom % 2500);
+      channels[iChannel].Update(CreateTag(start, end, iEvent + 1, strTitle, "", 0x10 * (1 + iRandom % 11)));
+      if (iChannel == iChannels / 2 && iEvent == iEventsPerChannel / 2)
+        strSearchTitle = strTitle;
+      start = end;
+    }
+  }
+  unsigned int iLoadTime = XbmcThreads::SystemClockMillis() - iStart;
+
+  size_t iEvents = 0;
+  for (const auto &channel : channels)
+    iEvents += channel.Size();
+  EXPECT_EQ(iChannels * iEventsPerChannel, iEvents);
+
+  // three hours of the grid
+  const CDateTime begin(firstStart + 7 * 24 * 3600);
+  const CDateTime end(firstStart + 7 * 24 * 3600 + 3 * 3600);
+  size_t iRunning = 0;
+  iStart = XbmcThreads::SystemClockMillis();
+  for (const auto &channel : channels)
+    iRunning += channel.GetTagsBetween(begin, end).size();
+  unsigned int iWindowTime = XbmcThreads::SystemClockMillis() - iStart;
+  EXPECT_GE(iRunning, iChannels);
+
+  CPVREpgIndex::Query query;
+  query.strSearchTerm = "\"" + strSearchTitle + "\"";
+  size_t iMatches = 0;
+  iStart = XbmcThreads::SystemClockMillis();
+  for (const auto &channel : channels)
+    iMatches += channel.Find(query).size();
+  unsigned int iSearchTime = XbmcThreads::SystemClockMillis() - iStart;
+  EXPECT_GT(iMatches, 0U);
+
+  CLog::Log(LOGDEBUG, "TestEpgIndex: %zu events loaded in %u ms, %zu running events found in %u ms, "
+                      "%zu search results found in %u ms",
+            iEvents, iLoadTime, iRunning, iWindowTime, iMatches, iSearchTime);
+}
@@ -700,11 +700,11 @@ void CGUIEPGGridContainer::UpdateItems()
     }
     else // "gap" tag selected
     {
-      const GridItem *currItem(GetItem(m_channelCursor));
+      const GridItemPtr currItem(GetItem(m_channelCursor));
       if (currItem)
         channelUid = currItem->item->GetEPGInfoTag()->ChannelTag()->UniqueID();
 
-      const GridItem *prevItem(GetPrevItem(m_channelCursor));
+      const GridItemPtr prevItem(GetPrevItem(m_channelCursor));
       if (prevItem)
       {
         const CPVREpgInfoTagPtr tag(prevItem->item->GetEPGInfoTag());
@@ -727,8 +727,8 @@ void CGUIEPGGridContainer::UpdateItems()
     }
   }
 
-  m_lastItem    = nullptr;
-  m_lastChannel = nullptr;
+  // m_lastItem and m_lastChannel are kept. items which did not change are taken over by the
+  // new model, so their focus state survives the update.
 
   // always use asynchronously precalculated grid data.
   m_outdatedGridModel = std::move(m_gridModel); // destructing grid data can be very expensive, thus this will be done asynchronously, not here.
@@ -1419,7 +1419,7 @@ int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, int channel)
   return block;
 }
 
-GridItem *CGUIEPGGridContainer::GetNextItem(int channel)
+GridItemPtr CGUIEPGGridContainer::GetNextItem(int channel)
 {
   const int channelIndex = channel + m_channelOffset;
   const int blockIndex = m_blockCursor + m_blockOffset;
@@ -1436,7 +1436,7 @@ GridItem *CGUIEPGGridContainer::GetNextItem(int channel)
   return m_gridModel->GetGridItemPtr(channelIndex, i + m_blockOffset);
 }
 
-GridItem *CGUIEPGGridContainer::GetPrevItem(int channel)
+GridItemPtr CGUIEPGGridContainer::GetPrevItem(int channel)
 {
   int channelIndex = channel + m_channelOffset;
   int blockIndex = m_blockCursor + m_blockOffset;
@@ -1451,7 +1451,7 @@ GridItem *CGUIEPGGridContainer::GetPrevItem(int channel)
   return m_gridModel->GetGridItemPtr(channelIndex, i + m_blockOffset);
 }
 
-GridItem *CGUIEPGGridContainer::GetItem(int channel)
+GridItemPtr CGUIEPGGridContainer::GetItem(int channel)
 {
   int channelIndex = channel + m_channelOffset;
   int blockIndex = m_blockCursor + m_blockOffset;
@@ -1677,6 +1677,7 @@ void CGUIEPGGridContainer::SetTimelineItems(const std::unique_ptr<CFileItemList>
   int iRulerUnit;
   int iBlocksPerPage;
   float fBlockSize;
+  std::shared_ptr<CGUIEPGGridContainerModel> previousGridModel;
   {
     CSingleLock lock(m_critSection);
 
@@ -1684,13 +1685,16 @@ void CGUIEPGGridContainer::SetTimelineItems(const std::unique_ptr<CFileItemList>
     iRulerUnit = m_rulerUnit;
     iBlocksPerPage = m_blocksPerPage;
     fBlockSize = m_blockSize;
+
+    // the most recent model. the new one takes over its unchanged items.
+    previousGridModel = m_updatedGridModel ? m_updatedGridModel : m_gridModel;
   }
 
-  std::unique_ptr<CGUIEPGGridContainerModel> oldOutdatedGridModel;
-  std::unique_ptr<CGUIEPGGridContainerModel> oldUpdatedGridModel;
-  std::unique_ptr<CGUIEPGGridContainerModel> newUpdatedGridModel(new CGUIEPGGridContainerModel);
+  std::shared_ptr<CGUIEPGGridContainerModel> oldOutdatedGridModel;
+  std::shared_ptr<CGUIEPGGridContainerModel> oldUpdatedGridModel;
+  std::shared_ptr<CGUIEPGGridContainerModel> newUpdatedGridModel(new CGUIEPGGridContainerModel);
   // can be very expensive. never call with lock acquired.
-  newUpdatedGridModel->Refresh(items, gridStart, gridEnd, iRulerUnit, iBlocksPerPage, fBlockSize);
+  newUpdatedGridModel->Refresh(items, gridStart, gridEnd, iRulerUnit, iBlocksPerPage, fBlockSize, previousGridModel.get());
 
   {
     CSingleLock lock(m_critSection);
@@ -31,6 +31,7 @@
 namespace PVR
 {
   struct GridItem;
+  typedef std::shared_ptr<GridItem> GridItemPtr;
   class CGUIEPGGridContainerModel;
 
   class CGUIEPGGridContainer : public IGUIContainer
@@ -104,9 +105,9 @@ namespace PVR
     void ValidateOffset();
     void UpdateLayout();
 
-    GridItem *GetItem(int channel);
-    GridItem *GetNextItem(int channel);
-    GridItem *GetPrevItem(int channel);
+    GridItemPtr GetItem(int channel);
+    GridItemPtr GetNextItem(int channel);
+    GridItemPtr GetPrevItem(int channel);
 
     int GetBlock(const CGUIListItemPtr &item, int channel);
     int GetRealBlock(const CGUIListItemPtr &item, int channel);
@@ -225,10 +226,10 @@ namespace PVR
     float m_channelScrollOffset;
 
     CCriticalSection m_critSection;
-    std::unique_ptr<CGUIEPGGridContainerModel> m_gridModel;
-    std::unique_ptr<CGUIEPGGridContainerModel> m_updatedGridModel;
-    std::unique_ptr<CGUIEPGGridContainerModel> m_outdatedGridModel;
+    std::shared_ptr<CGUIEPGGridContainerModel> m_gridModel;
+    std::shared_ptr<CGUIEPGGridContainerModel> m_updatedGridModel;
+    std::shared_ptr<CGUIEPGGridContainerModel> m_outdatedGridModel;
 
-    GridItem *m_item;
+    GridItemPtr m_item;
   };
 }
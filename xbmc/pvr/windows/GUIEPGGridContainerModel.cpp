@@ -20,8 +20,11 @@
 
 #include "GUIEPGGridContainerModel.h"
 
+#include <algorithm>
+
 #include "FileItem.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
 #include "utils/Variant.h"
 
 #include "pvr/channels/PVRChannel.h"
@@ -34,6 +37,29 @@ using namespace PVR;
 
 static const unsigned int GRID_START_PADDING = 30; // minutes
 
+// items of a previous model are only taken over if they are displayed the same
+static bool IsUnchangedItem(const CFileItem &previous, const CFileItem &current)
+{
+  return previous.GetPath() == current.GetPath() &&
+         previous.GetLabel() == current.GetLabel() &&
+         previous.GetLabel2() == current.GetLabel2() &&
+         previous.GetIconImage() == current.GetIconImage() &&
+         previous.m_dateTime == current.m_dateTime;
+}
+
+CGUIEPGGridContainerModel::CGUIEPGGridContainerModel(const CGUIEPGGridContainerModel &other) :
+  m_gridStart(other.m_gridStart),
+  m_gridEnd(other.m_gridEnd),
+  m_programmeItems(other.m_programmeItems),
+  m_channelItems(other.m_channelItems),
+  m_rulerItems(other.m_rulerItems),
+  m_epgItemsPtr(other.m_epgItemsPtr),
+  m_blocks(other.m_blocks),
+  m_fBlockSize(other.m_fBlockSize)
+{
+  // the grid rows are created again on demand
+}
+
 void CGUIEPGGridContainerModel::SetInvalid()
 {
   for (const auto &programme : m_programmeItems)
@@ -46,16 +72,11 @@ void CGUIEPGGridContainerModel::SetInvalid()
 
 void CGUIEPGGridContainerModel::Reset()
 {
-  for (auto &channel : m_gridIndex)
   {
-    for (const auto &block : channel)
-    {
-      if (block.item)
-        block.item->ClearProperties();
-    }
-    channel.clear();
+    // the items may still be shown by a newer model of the same grid, so they are left untouched
+    CSingleLock lock(m_gridRowsLock);
+    m_gridRows.clear();
   }
-  m_gridIndex.clear();
 
   m_channelItems.clear();
   m_programmeItems.clear();
@@ -63,10 +84,30 @@ void CGUIEPGGridContainerModel::Reset()
   m_epgItemsPtr.clear();
 }
 
-void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize)
+void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize,
+                                        const CGUIEPGGridContainerModel *previousModel /* = nullptr */)
 {
   Reset();
 
+  // the items of the previous model. the dummy programmes of channels without epg data are
+  // created again on every update, so they are looked up by their channel.
+  std::unordered_map<const CPVREpgInfoTag*, CFileItemPtr> previousProgrammes;
+  std::unordered_map<int, CFileItemPtr> previousDummyProgrammes;
+  std::unordered_map<int, CFileItemPtr> previousChannels;
+  if (previousModel)
+  {
+    for (const auto &programme : previousModel->m_programmeItems)
+    {
+      const CPVREpgInfoTagPtr tag(programme->GetEPGInfoTag());
+      if (tag->StartAsUTC().IsValid())
+        previousProgrammes.insert(std::make_pair(tag.get(), programme));
+      else if (tag->HasPVRChannel())
+        previousDummyProgrammes.insert(std::make_pair(tag->ChannelTag()->ChannelID(), programme));
+    }
+    for (const auto &channelItem : previousModel->m_channelItems)
+      previousChannels.insert(std::make_pair(channelItem->GetPVRChannelInfoTag()->ChannelID(), channelItem));
+  }
+
   ////////////////////////////////////////////////////////////////////////
   // Create programme & channel items
   m_programmeItems.reserve(items->Size());
@@ -82,9 +123,29 @@ void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &it
     if (!fileItem->HasEPGInfoTag() || !fileItem->GetEPGInfoTag()->HasPVRChannel())
       continue;
 
+    channel = fileItem->GetEPGInfoTag()->ChannelTag();
+
+    CFileItemPtr previousItem;
+    if (fileItem->GetEPGInfoTag()->StartAsUTC().IsValid())
+    {
+      const auto it = previousProgrammes.find(fileItem->GetEPGInfoTag().get());
+      if (it != previousProgrammes.end())
+        previousItem = it->second;
+    }
+    else if (channel)
+    {
+      const auto it = previousDummyProgrammes.find(channel->ChannelID());
+      if (it != previousDummyProgrammes.end() && it->second->GetEPGInfoTag()->ChannelTag() == channel)
+        previousItem = it->second;
+    }
+
+    if (previousItem && IsUnchangedItem(*previousItem, *fileItem))
+      fileItem = previousItem;
+    else
+      fileItem->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
+
     m_programmeItems.emplace_back(fileItem);
 
-    channel = fileItem->GetEPGInfoTag()->ChannelTag();
     if (!channel)
       continue;
 
@@ -98,7 +159,15 @@ void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &it
         itemsPointer.start = j;
       }
       iLastChannelID = iCurrentChannelID;
-      m_channelItems.emplace_back(CFileItemPtr(new CFileItem(channel)));
+
+      CFileItemPtr channelItem(new CFileItem(channel));
+      if (previousModel)
+      {
+        const auto it = previousChannels.find(iCurrentChannelID);
+        if (it != previousChannels.end() && it->second->GetPVRChannelInfoTag() == channel && IsUnchangedItem(*it->second, *channelItem))
+          channelItem = it->second;
+      }
+      m_channelItems.emplace_back(channelItem);
     }
     ++j;
   }
@@ -152,8 +221,7 @@ void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &it
   FreeItemsMemory();
 
   ////////////////////////////////////////////////////////////////////////
-  // Create epg grid
-  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
+  // Size epg grid. The rows are created on demand by GetGridRow().
   const CDateTimeSpan gridDuration(m_gridEnd - m_gridStart);
   m_blocks = (gridDuration.GetDays() * 24 * 60 + gridDuration.GetHours() * 60 + gridDuration.GetMinutes()) / MINSPERBLOCK;
   if (m_blocks >= MAXBLOCKS)
@@ -161,111 +229,168 @@ void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &it
   else if (m_blocks < iBlocksPerPage)
     m_blocks = iBlocksPerPage;
 
-  m_gridIndex.reserve(m_channelItems.size());
-  const std::vector<GridItem> blocks(m_blocks);
+  m_fBlockSize = fBlockSize;
 
-  for (size_t channel = 0; channel < m_channelItems.size(); ++channel)
-  {
-    m_gridIndex.emplace_back(blocks);
+  if (previousModel)
+    TakeOverGridRows(*previousModel);
+}
 
-    CDateTime gridCursor(m_gridStart); //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[channel].start;
-    unsigned long lastIdx = m_epgItemsPtr[channel].stop;
-    int iEpgId            = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
-    int itemSize          = 1; // size of the programme in blocks
-    int savedBlock        = 0;
+void CGUIEPGGridContainerModel::CreateGridRow(int iChannel, GridRow &row) const
+{
+  row.items.clear();
+  row.firstBlocks.clear();
+  row.progIndices.clear();
+
+  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
+  CDateTime gridCursor(m_gridStart);
+  unsigned long progIdx = m_epgItemsPtr[iChannel].start;
+  unsigned long lastIdx = m_epgItemsPtr[iChannel].stop;
+  int iEpgId = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
+  CPVREpgInfoTagPtr tag;
+
+  // collect the runs of blocks showing the same programme. gaps are runs without item.
+  for (int block = 0; block < m_blocks; ++block)
+  {
     CFileItemPtr item;
-    CPVREpgInfoTagPtr tag;
+    int iProgIndex = -1;
 
-    for (int block = 0; block < m_blocks; ++block)
+    while (progIdx <= lastIdx)
     {
-      while (progIdx <= lastIdx)
+      tag = m_programmeItems[progIdx]->GetEPGInfoTag();
+
+      if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
+        break;
+
+      if (gridCursor < tag->EndAsUTC())
       {
         item = m_programmeItems[progIdx];
-        tag = item->GetEPGInfoTag();
+        iProgIndex = progIdx;
+        break;
+      }
 
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
+      progIdx++;
+    }
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[channel][block].item = item;
-          m_gridIndex[channel][block].progIndex = progIdx;
-          break;
-        }
+    gridCursor += blockDuration;
 
-        progIdx++;
-      }
+    if (!row.items.empty() && row.items.back()->item == item)
+    {
+      row.items.back()->originWidth += m_fBlockSize;
+      continue;
+    }
 
-      gridCursor += blockDuration;
+    GridItemPtr run(new GridItem);
+    run->item = item;
+    run->originWidth = m_fBlockSize;
+    row.items.emplace_back(run);
+    row.firstBlocks.emplace_back(block);
+    row.progIndices.emplace_back(iProgIndex);
+  }
 
-      if (block == 0)
-        continue;
+  for (auto &run : row.items)
+  {
+    run->width = run->originWidth;
 
-      const CFileItemPtr prevItem(m_gridIndex[channel][block - 1].item);
-      const CFileItemPtr currItem(m_gridIndex[channel][block].item);
+    if (!run->item)
+    {
+      CPVREpgInfoTagPtr gapTag(CPVREpgInfoTag::CreateDefaultTag());
+      gapTag->SetPVRChannel(m_channelItems[iChannel]->GetPVRChannelInfoTag());
+      run->item.reset(new CFileItem(gapTag));
+    }
+  }
+}
 
-      if (block == m_blocks - 1 || prevItem != currItem)
-      {
-        // special handling for last block.
-        int blockDelta = -1;
-        int sizeDelta = 0;
-        if (block == m_blocks - 1 && prevItem == currItem)
-        {
-          itemSize++;
-          blockDelta = 0;
-          sizeDelta = 1;
-        }
+CGUIEPGGridContainerModel::GridRow &CGUIEPGGridContainerModel::GetGridRow(int iChannel) const
+{
+  // the caller has to hold m_gridRowsLock
+  auto it = m_gridRows.find(iChannel);
+  if (it == m_gridRows.end())
+  {
+    it = m_gridRows.insert(std::make_pair(iChannel, GridRow())).first;
+    CreateGridRow(iChannel, it->second);
+  }
+  return it->second;
+}
 
-        if (prevItem)
-        {
-          m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", prevItem->GetEPGInfoTag()->GenreType());
-        }
-        else
-        {
-          CPVREpgInfoTagPtr gapTag(CPVREpgInfoTag::CreateDefaultTag());
-          gapTag->SetPVRChannel(m_channelItems[channel]->GetPVRChannelInfoTag());
-          CFileItemPtr gapItem(new CFileItem(gapTag));
-          for (int i = block + blockDelta; i >= block - itemSize + sizeDelta; --i)
-          {
-            m_gridIndex[channel][i].item = gapItem;
-          }
-        }
+void CGUIEPGGridContainerModel::TakeOverGridRows(const CGUIEPGGridContainerModel &previousModel)
+{
+  if (previousModel.m_fBlockSize != m_fBlockSize)
+    return; // all runs changed their size
 
-        float fItemWidth = itemSize * fBlockSize;
-        m_gridIndex[channel][savedBlock].originWidth = fItemWidth;
-        m_gridIndex[channel][savedBlock].width = fItemWidth;
+  std::unordered_map<int, GridRow> previousRows;
+  {
+    // the previous model is still in use by the GUI
+    CSingleLock lock(previousModel.m_gridRowsLock);
+    previousRows = previousModel.m_gridRows;
+  }
+  if (previousRows.empty())
+    return;
 
-        itemSize = 1;
-        savedBlock = block;
+  std::unordered_map<int, int> channelIndices;
+  for (size_t i = 0; i < m_channelItems.size(); ++i)
+    channelIndices.insert(std::make_pair(m_channelItems[i]->GetPVRChannelInfoTag()->ChannelID(), static_cast<int>(i)));
 
-        // special handling for last block.
-        if (block == m_blocks - 1 && prevItem != currItem)
-        {
-          if (currItem)
-          {
-            m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", currItem->GetEPGInfoTag()->GenreType());
-          }
-          else
-          {
-            CPVREpgInfoTagPtr gapTag(CPVREpgInfoTag::CreateDefaultTag());
-            gapTag->SetPVRChannel(m_channelItems[channel]->GetPVRChannelInfoTag());
-            CFileItemPtr gapItem(new CFileItem(gapTag));
-            m_gridIndex[channel][block].item = gapItem;
-          }
+  // the number of blocks the grid start moved forward
+  int iBlockShift;
+  if (m_gridStart >= previousModel.m_gridStart)
+    iBlockShift = (m_gridStart - previousModel.m_gridStart).GetSecondsTotal() / 60 / MINSPERBLOCK;
+  else
+    iBlockShift = -((previousModel.m_gridStart - m_gridStart).GetSecondsTotal() / 60 / MINSPERBLOCK);
 
-          m_gridIndex[channel][savedBlock].originWidth = fBlockSize; // size always 1 block here
-          m_gridIndex[channel][savedBlock].width = fBlockSize;
-        }
-      }
-      else
-      {
-        itemSize++;
-      }
+  CSingleLock lock(m_gridRowsLock);
+  for (const auto &previousRow : previousRows)
+  {
+    // only rows of channels which did not change are worth comparing
+    const CFileItemPtr previousChannel(previousModel.m_channelItems[previousRow.first]);
+    const auto channelIndex = channelIndices.find(previousChannel->GetPVRChannelInfoTag()->ChannelID());
+    if (channelIndex == channelIndices.end() || m_channelItems[channelIndex->second] != previousChannel)
+      continue;
+
+    const GridRow &oldRow = previousRow.second;
+    GridRow &row = GetGridRow(channelIndex->second);
+    for (size_t i = 0; i < row.items.size(); ++i)
+    {
+      // the previous run has to cover exactly the same blocks, in the blocks of the previous grid
+      const int iFirstBlock = row.firstBlocks[i] + iBlockShift;
+      const size_t j = GetRunIndex(oldRow, iFirstBlock);
+      if (oldRow.firstBlocks[j] != iFirstBlock)
+        continue;
+
+      const int iEndBlock = (i + 1 < row.firstBlocks.size() ? row.firstBlocks[i + 1] : m_blocks) + iBlockShift;
+      const int iOldEndBlock = j + 1 < oldRow.firstBlocks.size() ? oldRow.firstBlocks[j + 1] : previousModel.m_blocks;
+      if (iEndBlock != iOldEndBlock)
+        continue;
+
+      // programme items have been taken over already, gaps only have to be gaps in both rows
+      const bool bGap = row.progIndices[i] < 0;
+      if (bGap != (oldRow.progIndices[j] < 0) || (!bGap && oldRow.items[j]->item != row.items[i]->item))
+        continue;
+
+      row.items[i] = oldRow.items[j];
     }
   }
 }
 
+size_t CGUIEPGGridContainerModel::GetRunIndex(const GridRow &row, int iBlock)
+{
+  auto it = std::upper_bound(row.firstBlocks.begin(), row.firstBlocks.end(), iBlock);
+  return std::max<int>(0, it - row.firstBlocks.begin() - 1);
+}
+
+GridItemPtr CGUIEPGGridContainerModel::GetRunItem(int iChannel, int iBlock) const
+{
+  CSingleLock lock(m_gridRowsLock);
+  const GridRow &row = GetGridRow(iChannel);
+  return row.items[GetRunIndex(row, iBlock)];
+}
+
+int CGUIEPGGridContainerModel::GetGridItemIndex(int iChannel, int iBlock) const
+{
+  CSingleLock lock(m_gridRowsLock);
+  const GridRow &row = GetGridRow(iChannel);
+  return row.progIndices[GetRunIndex(row, iBlock)];
+}
+
 void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigned int broadcastUid, int eventOffset, int &newChannelIndex, int &newBlockIndex) const
 {
   const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
@@ -345,45 +470,41 @@ void CGUIEPGGridContainerModel::FreeChannelMemory(int keepStart, int keepEnd)
     for (int i = keepEnd + 1; i < keepStart && i < ChannelItemsSize(); ++i)
       m_channelItems[i]->FreeMemory();
   }
+
+  // drop the grid rows of channels which are neither visible nor cached. grid items still
+  // referenced by the container are kept alive by their shared pointers.
+  CSingleLock lock(m_gridRowsLock);
+  for (auto it = m_gridRows.begin(); it != m_gridRows.end();)
+  {
+    const int channel = it->first;
+    const bool bKeep = keepStart < keepEnd ? (channel >= keepStart && channel <= keepEnd)
+                                           : (channel >= keepStart || channel <= keepEnd);
+    if (bKeep)
+    {
+      ++it;
+      continue;
+    }
+
+    for (const auto &run : it->second.items)
+      run->item->FreeMemory();
+    it = m_gridRows.erase(it);
+  }
 }
 
 void CGUIEPGGridContainerModel::FreeProgrammeMemory(int channel, int keepStart, int keepEnd)
 {
   if (keepStart < keepEnd)
   {
-    // remove before keepStart and after keepEnd
-    if (keepStart > 0 && keepStart < m_blocks)
+    // remove the runs which end before keepStart or begin after keepEnd. runs which are
+    // partially visible are kept.
+    CSingleLock lock(m_gridRowsLock);
+    const GridRow &row = GetGridRow(channel);
+    for (size_t i = 0; i < row.items.size(); ++i)
     {
-      // if item exist and block is not part of visible item
-      CGUIListItemPtr last(m_gridIndex[channel][keepStart].item);
-      for (int i = keepStart - 1; i > 0; --i)
-      {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
-    }
-
-    if (keepEnd > 0 && keepEnd < m_blocks)
-    {
-      CGUIListItemPtr last(m_gridIndex[channel][keepEnd].item);
-      for (int i = keepEnd + 1; i < m_blocks; ++i)
-      {
-        // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
+      const int firstBlock = row.firstBlocks[i];
+      const int lastBlock = (i + 1 < row.firstBlocks.size() ? row.firstBlocks[i + 1] : m_blocks) - 1;
+      if (lastBlock < keepStart || firstBlock > keepEnd)
+        row.items[i]->item->FreeMemory();
     }
   }
 }
@@ -20,9 +20,11 @@
  */
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "XBDateTime.h"
+#include "threads/CriticalSection.h"
 
 class CFileItem;
 typedef std::shared_ptr<CFileItem> CFileItemPtr;
@@ -36,21 +38,29 @@ namespace PVR
     CFileItemPtr item;
     float originWidth;
     float width;
-    int progIndex;
 
-    GridItem() : originWidth(0.0f), width(0.0f), progIndex(-1) {}
+    GridItem() : originWidth(0.0f), width(0.0f) {}
   };
 
+  typedef std::shared_ptr<GridItem> GridItemPtr;
+
   class CGUIEPGGridContainerModel
   {
   public:
     static const int MINSPERBLOCK = 5; // minutes
     static const int MAXBLOCKS = 33 * 24 * 60 / MINSPERBLOCK; //! 33 days of 5 minute blocks (31 days for upcoming data + 1 day for past data + 1 day for fillers)
 
-    CGUIEPGGridContainerModel() : m_blocks(0) {}
+    CGUIEPGGridContainerModel() : m_blocks(0), m_fBlockSize(0.0f) {}
+    CGUIEPGGridContainerModel(const CGUIEPGGridContainerModel &other);
     virtual ~CGUIEPGGridContainerModel() { Reset(); }
 
-    void Refresh(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize);
+    /*!
+     * Fill the model with the given epg items. Channel, programme and grid items of a previous
+     * model of the same grid are taken over where they did not change, so the GUI state of the
+     * untouched channels and events survives the refresh.
+     */
+    void Refresh(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize,
+                 const CGUIEPGGridContainerModel *previousModel = nullptr);
     void SetInvalid();
 
     static const int INVALID_INDEX = -1;
@@ -72,13 +82,19 @@ namespace PVR
     int RulerItemsSize() const { return static_cast<int>(m_rulerItems.size()); }
 
     int GetBlockCount() const { return m_blocks; }
-    bool HasGridItems() const { return !m_gridIndex.empty(); }
-    GridItem *GetGridItemPtr(int iChannel, int iBlock) { return &m_gridIndex[iChannel][iBlock]; }
-    CFileItemPtr GetGridItem(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].item; }
-    float GetGridItemWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].width; }
-    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].originWidth; }
-    int GetGridItemIndex(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].progIndex; }
-    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { m_gridIndex[iChannel][iBlock].width = fWidth; }
+    bool HasGridItems() const { return !m_channelItems.empty(); }
+
+    /*!
+     * The grid items of a channel are created on demand and describe a run of blocks showing
+     * the same programme or gap. All blocks of a run share the same grid item. A grid item
+     * handed out stays valid when the row of its channel is freed.
+     */
+    GridItemPtr GetGridItemPtr(int iChannel, int iBlock) const { return GetRunItem(iChannel, iBlock); }
+    CFileItemPtr GetGridItem(int iChannel, int iBlock) const { return GetRunItem(iChannel, iBlock)->item; }
+    float GetGridItemWidth(int iChannel, int iBlock) const { return GetRunItem(iChannel, iBlock)->width; }
+    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return GetRunItem(iChannel, iBlock)->originWidth; }
+    int GetGridItemIndex(int iChannel, int iBlock) const;
+    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { GetRunItem(iChannel, iBlock)->width = fWidth; }
 
     bool IsZeroGridDuration() const { return (m_gridEnd - m_gridStart) == CDateTimeSpan(0, 0, 0, 0); }
     const CDateTime &GetGridStart() const { return m_gridStart; }
@@ -87,9 +103,24 @@ namespace PVR
     unsigned int GetGridStartPadding() const;
 
   private:
+    CGUIEPGGridContainerModel &operator=(const CGUIEPGGridContainerModel &other) = delete;
+
     void FreeItemsMemory();
     void Reset();
 
+    struct GridRow
+    {
+      std::vector<GridItemPtr> items; // one item per run of blocks
+      std::vector<int> firstBlocks; // the first block of every run
+      std::vector<int> progIndices; // the programme item of every run, -1 for gaps
+    };
+
+    void CreateGridRow(int iChannel, GridRow &row) const;
+    void TakeOverGridRows(const CGUIEPGGridContainerModel &previousModel);
+    GridRow &GetGridRow(int iChannel) const;
+    static size_t GetRunIndex(const GridRow &row, int iBlock);
+    GridItemPtr GetRunItem(int iChannel, int iBlock) const;
+
     struct ItemsPtr
     {
       long start;
@@ -103,8 +134,10 @@ namespace PVR
     std::vector<CFileItemPtr> m_channelItems;
     std::vector<CFileItemPtr> m_rulerItems;
     std::vector<ItemsPtr> m_epgItemsPtr;
-    std::vector<std::vector<GridItem> > m_gridIndex;
+    mutable std::unordered_map<int, GridRow> m_gridRows; // rows of the channels around the visible area
+    mutable CCriticalSection m_gridRowsLock; // the rows are created by const getters too
 
     int m_blocks;
+    float m_fBlockSize;
   };
 }
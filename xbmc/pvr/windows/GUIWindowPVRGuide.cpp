@@ -478,11 +478,6 @@ bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
       if (!group)
         return false;
 
-      std::unique_ptr<CFileItemList> timeline(new CFileItemList);
-
-      // can be very expensive. never call with lock acquired.
-      group->GetEPGAll(*timeline, true);
-
       CDateTime startDate(group->GetFirstEPGDate());
       CDateTime endDate(group->GetLastEPGDate());
       const CDateTime currentDate(CDateTime::GetCurrentDateTime().GetAsUTCDateTime());
@@ -498,6 +493,11 @@ bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
       if (startDate < maxPastDate)
         startDate = maxPastDate;
 
+      std::unique_ptr<CFileItemList> timeline(new CFileItemList);
+
+      // can be very expensive. never call with lock acquired.
+      group->GetEPGBetween(*timeline, startDate, endDate, true);
+
       // can be very expensive. never call with lock acquired.
       epgGridContainer->SetTimelineItems(timeline, startDate, endDate);
 
@@ -159,6 +159,10 @@ void CAdvancedSettings::Initialize()
   m_DXVAForceProcessorRenderer = true;
   m_DXVAAllowHqScaling = true;
   m_videoFpsDetect = 1;
+  m_videoDemuxCache = true;
+  m_videoDirectDecode = true;
+  m_videoAdaptiveThreading = true;
+  m_videoAssPrerender = true;
   m_videoBusyDialogDelay_ms = 500;
 
   m_mediacodecForceSoftwareRendering = false;
@@ -305,6 +309,8 @@ void CAdvancedSettings::Initialize()
   m_iEpgUpdateEmptyTagsInterval = 60; /* override user selectable EPG update interval for empty EPG tags */
   m_bEpgDisplayUpdatePopup = true; /* display a progress popup while updating EPG data from clients */
   m_bEpgDisplayIncrementalUpdatePopup = false; /* also display a progress popup while doing incremental EPG updates */
+  m_iEpgMaxParallelUpdates = 4; /* update the EPG tables of up to 4 clients at the same time */
+  m_iEpgMaxParallelUpdatesPerClient = 1; /* pvr add-ons don't have to handle concurrent requests */
 
   m_bEdlMergeShortCommBreaks = false;      // Off by default
   m_iEdlMaxCommBreakLength = 8 * 30 + 10;  // Just over 8 * 30 second commercial break.
@@ -369,6 +375,17 @@ void CAdvancedSettings::Initialize()
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
+  m_jsonAnnouncementQueueSize = 1024;
+  m_jsonAnnouncementCoalesceTime = 250;
+
+  m_pythonInterpreterPool = 0;
+
+  m_gamesRewindMemory = 256;
+  m_gamesRunAheadFrames = 0;
+  m_gamesFrameDelay = 0;
+
+  m_webserverResponseCacheSize = 32;
+  m_webserverResponseDiskCache = false;
 
   m_enableMultimediaKeys = false;
 
@@ -380,6 +397,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiSmartRedraw = false;
+  m_guiSkinCache = true;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -687,6 +705,12 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "usedisplaycontrolhwstereo", m_useDisplayControlHWStereo);
     //0 = disable fps detect, 1 = only detect on timestamps with uniform spacing, 2 detect on all timestamps
     XMLUtils::GetInt(pElement, "fpsdetect", m_videoFpsDetect, 0, 2);
+    // remember the probed stream parameters and keyframe index of played files
+    XMLUtils::GetBoolean(pElement, "demuxcache", m_videoDemuxCache);
+    XMLUtils::GetBoolean(pElement, "directdecode", m_videoDirectDecode);
+    XMLUtils::GetBoolean(pElement, "adaptivethreading", m_videoAdaptiveThreading);
+    // render ass subtitles of the upcoming frames on a worker thread
+    XMLUtils::GetBoolean(pElement, "assprerender", m_videoAssPrerender);
 
     // controls the delay, in milliseconds, until
     // the busy dialog is shown when starting video playback.
@@ -814,6 +838,27 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   {
     XMLUtils::GetBoolean(pElement, "compactoutput", m_jsonOutputCompact);
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
+    XMLUtils::GetUInt(pElement, "announcementqueuesize", m_jsonAnnouncementQueueSize, 1, 65536);
+    XMLUtils::GetUInt(pElement, "announcementcoalescetime", m_jsonAnnouncementCoalesceTime, 0, 5000);
+  }
+
+  pElement = pRootElement->FirstChildElement("python");
+  if (pElement)
+    XMLUtils::GetUInt(pElement, "interpreterpool", m_pythonInterpreterPool, 0, 32);
+
+  pElement = pRootElement->FirstChildElement("games");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "rewindmemory", m_gamesRewindMemory, 0, 4096);
+    XMLUtils::GetUInt(pElement, "runaheadframes", m_gamesRunAheadFrames, 0, 4);
+    XMLUtils::GetUInt(pElement, "framedelay", m_gamesFrameDelay, 0, 15);
+  }
+
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "responsecachesize", m_webserverResponseCacheSize);
+    XMLUtils::GetBoolean(pElement, "responsediskcache", m_webserverResponseDiskCache);
   }
 
   pElement = pRootElement->FirstChildElement("samba");
@@ -890,6 +935,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "updateemptytagsinterval", m_iEpgUpdateEmptyTagsInterval);
     XMLUtils::GetBoolean(pElement, "displayupdatepopup", m_bEpgDisplayUpdatePopup);
     XMLUtils::GetBoolean(pElement, "displayincrementalupdatepopup", m_bEpgDisplayIncrementalUpdatePopup);
+    XMLUtils::GetInt(pElement, "maxparallelupdates", m_iEpgMaxParallelUpdates, 1, 32);
+    XMLUtils::GetInt(pElement, "maxparallelupdatesperclient", m_iEpgMaxParallelUpdatesPerClient, 1, 32);
   }
 
   // EDL commercial break handling
@@ -1196,6 +1243,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetBoolean(pElement, "smartredraw", m_guiSmartRedraw);
+    XMLUtils::GetBoolean(pElement, "skincache", m_guiSkinCache);
   }
 
   std::string seekSteps;
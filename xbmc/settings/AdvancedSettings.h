@@ -190,6 +190,10 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_DXVAForceProcessorRenderer;
     bool m_DXVAAllowHqScaling;
     int  m_videoFpsDetect;
+    bool m_videoDemuxCache;
+    bool m_videoDirectDecode;
+    bool m_videoAdaptiveThreading;
+    bool m_videoAssPrerender;
     int  m_videoBusyDialogDelay_ms;
     bool m_mediacodecForceSoftwareRendering;
 
@@ -287,6 +291,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iEpgUpdateEmptyTagsInterval; // seconds
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
+    int m_iEpgMaxParallelUpdates;   // number of EPG tables updated at the same time
+    int m_iEpgMaxParallelUpdatesPerClient; // number of EPG tables of the same PVR client updated at the same time
 
     // EDL Commercial Break
     bool m_bEdlMergeShortCommBreaks;
@@ -344,6 +350,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     bool m_guiSmartRedraw;
+    bool m_guiSkinCache;
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemSize;
@@ -352,6 +359,17 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
+    unsigned int m_jsonAnnouncementQueueSize;    ///< \brief maximum number of notifications queued per JSON-RPC client
+    unsigned int m_jsonAnnouncementCoalesceTime; ///< \brief time (in ms) high-frequency notifications are held back to be merged
+
+    unsigned int m_pythonInterpreterPool;        ///< \brief maximum number of idle python interpreters kept for plugins, 0 to disable
+
+    unsigned int m_gamesRewindMemory; ///< \brief size (in MB) of the memory used for rewinding games, 0 for no limit
+    unsigned int m_gamesRunAheadFrames; ///< \brief number of frames games run ahead of the shown one to hide their input lag, 0 to disable
+    unsigned int m_gamesFrameDelay;     ///< \brief time (in ms) a game frame is run later than scheduled, so it polls more recent input
+
+    unsigned int m_webserverResponseCacheSize; ///< \brief size (in MB) of the in-memory webserver response cache, 0 disables it
+    bool m_webserverResponseDiskCache;          ///< \brief whether responses evicted from memory are kept on disk
 
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
@@ -443,6 +443,7 @@ public:
 
   // overwrite (not override) from CSettingsBase
   bool GetBool(const std::string& id) const;
+  using CSettingsBase::GetBool;
 
 protected:
   // specializations of CSettingsBase
@@ -246,6 +246,31 @@ std::vector<CVariant> CSettingsBase::GetList(const std::string& id) const
   return CSettingUtils::GetList(std::static_pointer_cast<CSettingList>(setting));
 }
 
+SettingHandle CSettingsBase::GetHandle(const std::string& id)
+{
+  return m_settingsManager->GetHandle(id);
+}
+
+bool CSettingsBase::GetBool(SettingHandle handle) const
+{
+  return m_settingsManager->GetBool(handle);
+}
+
+int CSettingsBase::GetInt(SettingHandle handle) const
+{
+  return m_settingsManager->GetInt(handle);
+}
+
+double CSettingsBase::GetNumber(SettingHandle handle) const
+{
+  return m_settingsManager->GetNumber(handle);
+}
+
+std::string CSettingsBase::GetString(SettingHandle handle) const
+{
+  return m_settingsManager->GetString(handle);
+}
+
 bool CSettingsBase::SetList(const std::string& id, const std::vector<CVariant>& value)
 {
   std::shared_ptr<CSetting> setting = m_settingsManager->GetSetting(id);
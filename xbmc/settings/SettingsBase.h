@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "settings/lib/ISettingCallback.h"
+#include "settings/lib/SettingHandles.h"
 #include "threads/CriticalSection.h"
 
 class CSetting;
@@ -167,6 +168,44 @@ public:
    */
   std::vector<CVariant> GetList(const std::string& id) const;
 
+  /*!
+   \brief Gets a handle to read the value of the setting with the given
+   identifier without any lookup or lock.
+
+   \param id Setting identifier
+   \return Handle of the setting or CSettingHandles::InvalidHandle if the identifier is unknown
+   \sa CSettingsManager::GetHandle()
+   */
+  SettingHandle GetHandle(const std::string& id);
+  /*!
+   \brief Gets the boolean value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return Boolean value of the setting with the given handle
+   */
+  bool GetBool(SettingHandle handle) const;
+  /*!
+   \brief Gets the integer value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return Integer value of the setting with the given handle
+   */
+  int GetInt(SettingHandle handle) const;
+  /*!
+   \brief Gets the real number value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return Real number value of the setting with the given handle
+   */
+  double GetNumber(SettingHandle handle) const;
+  /*!
+   \brief Gets the string value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return String value of the setting with the given handle
+   */
+  std::string GetString(SettingHandle handle) const;
+
   /*!
    \brief Sets the boolean value of the setting with the given identifier.
 
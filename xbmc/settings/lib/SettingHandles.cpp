@@ -0,0 +1,171 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SettingHandles.h"
+#include "Setting.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+const SettingHandle CSettingHandles::InvalidHandle;
+const int CSettingHandles::MaxHandles;
+
+CSettingHandles::CSettingHandles()
+  : m_values(new Value[MaxHandles]),
+    m_nextHandle(0)
+{
+  for (int i = 0; i < MaxHandles; i++)
+  {
+    m_values[i].valid = false;
+    m_values[i].boolValue = false;
+    m_values[i].intValue = 0;
+    m_values[i].numberValue = 0.0;
+  }
+}
+
+SettingHandle CSettingHandles::Register(std::shared_ptr<const CSetting> setting)
+{
+  if (setting == nullptr)
+    return InvalidHandle;
+
+  int index;
+  {
+    CSingleLock lock(m_critical);
+    auto it = m_handles.find(setting->GetId());
+    if (it != m_handles.end())
+      return it->second;
+
+    if (m_nextHandle >= MaxHandles)
+    {
+      CLog::Log(LOGWARNING, "CSettingHandles: no handle left for setting \"%s\"", setting->GetId().c_str());
+      return InvalidHandle;
+    }
+
+    index = m_nextHandle++;
+    m_handles.insert(std::make_pair(setting->GetId(), static_cast<SettingHandle>(index)));
+  }
+
+  Update(setting);
+  m_values[index].valid.store(true, std::memory_order_release);
+
+  return static_cast<SettingHandle>(index);
+}
+
+void CSettingHandles::Update(std::shared_ptr<const CSetting> setting)
+{
+  if (setting == nullptr)
+    return;
+
+  int index;
+  {
+    CSingleLock lock(m_critical);
+    auto it = m_handles.find(setting->GetId());
+    if (it == m_handles.end())
+      return;
+
+    index = static_cast<int>(it->second);
+  }
+
+  // the value can't be read while holding the lock as the setting may be
+  // locked by a thread changing it which updates its value next, instead the
+  // value is stored again if it has been changed in the meantime
+  while (!Store(*setting, m_values[index]))
+    ;
+}
+
+bool CSettingHandles::GetBool(SettingHandle handle) const
+{
+  const int index = static_cast<int>(handle);
+  if (!IsValid(index))
+    return false;
+
+  return m_values[index].boolValue.load(std::memory_order_relaxed);
+}
+
+int CSettingHandles::GetInt(SettingHandle handle) const
+{
+  const int index = static_cast<int>(handle);
+  if (!IsValid(index))
+    return 0;
+
+  return m_values[index].intValue.load(std::memory_order_relaxed);
+}
+
+double CSettingHandles::GetNumber(SettingHandle handle) const
+{
+  const int index = static_cast<int>(handle);
+  if (!IsValid(index))
+    return 0.0;
+
+  return m_values[index].numberValue.load(std::memory_order_relaxed);
+}
+
+std::string CSettingHandles::GetString(SettingHandle handle) const
+{
+  const int index = static_cast<int>(handle);
+  if (!IsValid(index))
+    return "";
+
+  auto value = std::atomic_load(&m_values[index].stringValue);
+  if (value == nullptr)
+    return "";
+
+  return *value;
+}
+
+bool CSettingHandles::Store(const CSetting& setting, Value& value)
+{
+  switch (setting.GetType())
+  {
+    case SettingType::Boolean:
+    {
+      const auto& settingBool = static_cast<const CSettingBool&>(setting);
+      const bool newValue = settingBool.GetValue();
+      value.boolValue.store(newValue, std::memory_order_relaxed);
+      return settingBool.GetValue() == newValue;
+    }
+
+    case SettingType::Integer:
+    {
+      const auto& settingInt = static_cast<const CSettingInt&>(setting);
+      const int newValue = settingInt.GetValue();
+      value.intValue.store(newValue, std::memory_order_relaxed);
+      return settingInt.GetValue() == newValue;
+    }
+
+    case SettingType::Number:
+    {
+      const auto& settingNumber = static_cast<const CSettingNumber&>(setting);
+      const double newValue = settingNumber.GetValue();
+      value.numberValue.store(newValue, std::memory_order_relaxed);
+      return settingNumber.GetValue() == newValue;
+    }
+
+    case SettingType::String:
+    {
+      const auto& settingString = static_cast<const CSettingString&>(setting);
+      std::shared_ptr<const std::string> newValue = std::make_shared<const std::string>(settingString.GetValue());
+      std::atomic_store(&value.stringValue, newValue);
+      return settingString.GetValue() == *newValue;
+    }
+
+    default:
+      return true;
+  }
+}
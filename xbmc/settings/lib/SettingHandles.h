@@ -0,0 +1,105 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "threads/CriticalSection.h"
+
+class CSetting;
+
+/*!
+ \ingroup settings
+ \brief Handle of a setting, see CSettingHandles.
+
+ A type of its own, so a handle can't be passed where the value of an integer
+ setting is expected and the other way around.
+ */
+enum class SettingHandle : int {};
+
+/*!
+ \ingroup settings
+ \brief Copies of the values of settings which are read through handles.
+
+ Reading a setting by its identifier takes the locks of the settings manager
+ and of the setting and looks the identifier up in a map of strings. Settings
+ read by the render, audio and player threads every frame are looked up once
+ instead, and their values are read from here through the handle without
+ taking any lock: boolean, integer and number values are kept in atomics and
+ string values are immutable copies which are replaced as a whole when the
+ setting changes.
+
+ Handles stay valid when the settings are cleared and initialized again.
+ */
+class CSettingHandles
+{
+public:
+  static const SettingHandle InvalidHandle = static_cast<SettingHandle>(-1);
+  static const int MaxHandles = 256;
+
+  CSettingHandles();
+  ~CSettingHandles() = default;
+
+  /*!
+   \brief Gets the handle of the given setting, creating it if necessary.
+
+   \param setting Setting object
+   \return Handle of the setting or InvalidHandle if no more handles are available
+   */
+  SettingHandle Register(std::shared_ptr<const CSetting> setting);
+  /*!
+   \brief Updates the copy of the value of the given setting if it has a handle.
+
+   \param setting Setting object
+   */
+  void Update(std::shared_ptr<const CSetting> setting);
+
+  bool GetBool(SettingHandle handle) const;
+  int GetInt(SettingHandle handle) const;
+  double GetNumber(SettingHandle handle) const;
+  std::string GetString(SettingHandle handle) const;
+
+private:
+  CSettingHandles(const CSettingHandles&) = delete;
+  CSettingHandles& operator=(const CSettingHandles&) = delete;
+
+  struct Value
+  {
+    std::atomic<bool> valid;
+    std::atomic<bool> boolValue;
+    std::atomic<int> intValue;
+    std::atomic<double> numberValue;
+    std::shared_ptr<const std::string> stringValue; // accessed through std::atomic_load() and std::atomic_store()
+  };
+
+  bool IsValid(int index) const { return index >= 0 && index < MaxHandles && m_values[index].valid.load(std::memory_order_acquire); }
+  // returns false if the setting changed while its value was stored
+  static bool Store(const CSetting& setting, Value& value);
+
+  // allocated once, so the values never move while they are read
+  std::unique_ptr<Value[]> m_values;
+  int m_nextHandle;
+
+  std::map<std::string, SettingHandle> m_handles;
+  CCriticalSection m_critical;
+};
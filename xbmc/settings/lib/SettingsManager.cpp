@@ -284,6 +284,23 @@ void CSettingsManager::SetInitialized()
     ResolveSettingDependencies(setting.second);
 }
 
+void CSettingsManager::SetLoaded()
+{
+  SettingList settings;
+  {
+    CSharedLock lock(m_settingsCritical);
+    for (const auto& setting : m_settings)
+      settings.push_back(setting.second.setting);
+  }
+
+  // settings might have been replaced or got new defaults without a change
+  // notification, so update the values read through handles
+  for (const auto& setting : settings)
+    m_handles.Update(setting);
+
+  m_loaded = true;
+}
+
 void CSettingsManager::AddSection(SettingSectionPtr section)
 {
   if (section == nullptr)
@@ -601,6 +618,15 @@ SettingDependencyMap CSettingsManager::GetDependencies(SettingConstPtr setting)
   return GetDependencies(setting->GetId());
 }
 
+SettingHandle CSettingsManager::GetHandle(const std::string &id)
+{
+  SettingPtr setting = GetSetting(id);
+  if (setting == nullptr)
+    return CSettingHandles::InvalidHandle;
+
+  return m_handles.Register(setting);
+}
+
 bool CSettingsManager::GetBool(const std::string &id) const
 {
   CSharedLock lock(m_settingsCritical);
@@ -855,6 +881,9 @@ bool CSettingsManager::OnSettingChanging(std::shared_ptr<const CSetting> setting
   
 void CSettingsManager::OnSettingChanged(std::shared_ptr<const CSetting> setting)
 {
+  // values are also changed while loading and unloading
+  m_handles.Update(setting);
+
   CSharedLock lock(m_settingsCritical);
   if (!m_loaded || setting == nullptr)
     return;
@@ -32,6 +32,7 @@
 #include "SettingConditions.h"
 #include "SettingDefinitions.h"
 #include "SettingDependency.h"
+#include "SettingHandles.h"
 #include "threads/SharedSection.h"
 
 class CSettingCategory;
@@ -154,7 +155,7 @@ public:
    This manual trigger is necessary to enable the ISettingCallback methods
    being executed.
    */
-  void SetLoaded() { m_loaded = true; }
+  void SetLoaded();
   /*!
    \brief Returns whether the settings system has been loaded or not.
   */
@@ -367,6 +368,48 @@ public:
    */
   std::vector< std::shared_ptr<CSetting> > GetList(const std::string &id) const;
 
+  /*!
+   \brief Gets a handle to read the value of the setting with the given
+   identifier without any lookup or lock.
+
+   The identifier is only looked up once, so handles are meant for settings
+   which are read very often, e.g. by the render, audio or player threads
+   for every frame. Reading a value through a handle is wait-free for
+   boolean, integer and number settings.
+
+   \param id Setting identifier
+   \return Handle of the setting or CSettingHandles::InvalidHandle if the identifier is unknown
+   */
+  SettingHandle GetHandle(const std::string &id);
+  /*!
+   \brief Gets the boolean value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return Boolean value of the setting with the given handle
+   */
+  bool GetBool(SettingHandle handle) const { return m_handles.GetBool(handle); }
+  /*!
+   \brief Gets the integer value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return Integer value of the setting with the given handle
+   */
+  int GetInt(SettingHandle handle) const { return m_handles.GetInt(handle); }
+  /*!
+   \brief Gets the real number value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return Real number value of the setting with the given handle
+   */
+  double GetNumber(SettingHandle handle) const { return m_handles.GetNumber(handle); }
+  /*!
+   \brief Gets the string value of the setting with the given handle.
+
+   \param handle Setting handle, see GetHandle()
+   \return String value of the setting with the given handle
+   */
+  std::string GetString(SettingHandle handle) const { return m_handles.GetString(handle); }
+
   /*!
    \brief Sets the boolean value of the setting with the given identifier.
 
@@ -530,6 +573,8 @@ private:
 
   CSettingConditionsManager m_conditions;
 
+  CSettingHandles m_handles;
+
   struct SettingOptionsFiller {
     void *filler;
     SettingOptionsFillerType type;
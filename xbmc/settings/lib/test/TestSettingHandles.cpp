@@ -0,0 +1,134 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "settings/lib/Setting.h"
+#include "settings/lib/SettingSection.h"
+#include "settings/lib/SettingsManager.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+  const std::string SETTING_BOOL = "test.bool";
+  const std::string SETTING_INT = "test.int";
+  const std::string SETTING_NUMBER = "test.number";
+  const std::string SETTING_STRING = "test.string";
+
+  const int WRITE_COUNT = 10000;
+
+  // handles and the values of integer settings can't be mixed up
+  static_assert(!std::is_convertible<SettingHandle, int>::value && !std::is_convertible<int, SettingHandle>::value,
+                "SettingHandle must be a type of its own");
+}
+
+class TestSettingHandles : public testing::Test
+{
+protected:
+  TestSettingHandles()
+  {
+    auto section = std::make_shared<CSettingSection>("section", &m_manager);
+    auto category = std::make_shared<CSettingCategory>("category", &m_manager);
+    auto group = std::make_shared<CSettingGroup>("group", &m_manager);
+
+    m_manager.AddSetting(std::make_shared<CSettingBool>(SETTING_BOOL, 0, true, &m_manager), section, category, group);
+    m_manager.AddSetting(std::make_shared<CSettingInt>(SETTING_INT, 0, 42, &m_manager), section, category, group);
+    m_manager.AddSetting(std::make_shared<CSettingNumber>(SETTING_NUMBER, 0, 0.5f, &m_manager), section, category, group);
+    m_manager.AddSetting(std::make_shared<CSettingString>(SETTING_STRING, 0, "value", &m_manager), section, category, group);
+
+    m_manager.SetInitialized();
+    m_manager.SetLoaded();
+  }
+
+  ~TestSettingHandles()
+  {
+    m_manager.Clear();
+  }
+
+  CSettingsManager m_manager;
+};
+
+TEST_F(TestSettingHandles, Values)
+{
+  SettingHandle boolHandle = m_manager.GetHandle(SETTING_BOOL);
+  SettingHandle intHandle = m_manager.GetHandle(SETTING_INT);
+  SettingHandle numberHandle = m_manager.GetHandle(SETTING_NUMBER);
+  SettingHandle stringHandle = m_manager.GetHandle(SETTING_STRING);
+
+  EXPECT_NE(CSettingHandles::InvalidHandle, boolHandle);
+  EXPECT_EQ(intHandle, m_manager.GetHandle(SETTING_INT));
+  EXPECT_EQ(CSettingHandles::InvalidHandle, m_manager.GetHandle("test.unknown"));
+
+  EXPECT_TRUE(m_manager.GetBool(boolHandle));
+  EXPECT_EQ(42, m_manager.GetInt(intHandle));
+  EXPECT_DOUBLE_EQ(0.5, m_manager.GetNumber(numberHandle));
+  EXPECT_EQ("value", m_manager.GetString(stringHandle));
+
+  // same defaults as reading by identifier
+  EXPECT_EQ(0, m_manager.GetInt(boolHandle));
+  EXPECT_EQ("", m_manager.GetString(CSettingHandles::InvalidHandle));
+
+  EXPECT_TRUE(m_manager.SetBool(SETTING_BOOL, false));
+  EXPECT_TRUE(m_manager.SetInt(SETTING_INT, 7));
+  EXPECT_TRUE(m_manager.SetNumber(SETTING_NUMBER, 1.5));
+  EXPECT_TRUE(m_manager.SetString(SETTING_STRING, "changed"));
+
+  EXPECT_FALSE(m_manager.GetBool(boolHandle));
+  EXPECT_EQ(7, m_manager.GetInt(intHandle));
+  EXPECT_DOUBLE_EQ(1.5, m_manager.GetNumber(numberHandle));
+  EXPECT_EQ("changed", m_manager.GetString(stringHandle));
+
+  // unloading resets the values to their defaults
+  m_manager.Unload();
+  EXPECT_TRUE(m_manager.GetBool(boolHandle));
+  EXPECT_EQ(42, m_manager.GetInt(intHandle));
+  EXPECT_EQ("value", m_manager.GetString(stringHandle));
+}
+
+TEST_F(TestSettingHandles, ConcurrentWrites)
+{
+  SettingHandle handle = m_manager.GetHandle(SETTING_INT);
+
+  std::atomic<bool> stop(false);
+  std::thread writer([this, &stop]()
+  {
+    for (int value = 0; value < WRITE_COUNT; value++)
+      m_manager.SetInt(SETTING_INT, value % 1000);
+    stop = true;
+  });
+
+  // every value read is one which has been written
+  bool valid = true;
+  while (!stop && valid)
+  {
+    const int value = m_manager.GetInt(handle);
+    valid = value >= 0 && value < 1000;
+  }
+  writer.join();
+
+  EXPECT_TRUE(valid);
+  EXPECT_EQ(m_manager.GetInt(SETTING_INT), m_manager.GetInt(handle));
+  EXPECT_EQ((WRITE_COUNT - 1) % 1000, m_manager.GetInt(handle));
+}
@@ -20,7 +20,10 @@
 
 #include "FileItem.h"
 #include "URL.h"
+#include "music/tags/MusicInfoTag.h"
+#include "music/tags/MusicInfoTagSource.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
 
 #include "gtest/gtest.h"
 
@@ -136,3 +139,73 @@ const TestFileData BaseMovies[] = {{ "c:\\dir\\filename.avi", false, "c:\\dir\\f
                                    { "/home/user/movies/movie_name/BDMV/index.bdmv", true, "/home/user/movies/movie_name/" }};
 
 INSTANTIATE_TEST_CASE_P(BaseNameMovies, TestFileItemBasePath, ValuesIn(BaseMovies));
+
+class TestMusicInfoTagSource : public MUSIC_INFO::CMusicInfoTagSource
+{
+public:
+  MUSIC_INFO::CMusicInfoTag* CreateTag(unsigned int row) const override
+  {
+    created++;
+    MUSIC_INFO::CMusicInfoTag* tag = new MUSIC_INFO::CMusicInfoTag;
+    tag->SetTitle(StringUtils::Format("Song %u", row));
+    return tag;
+  }
+
+  mutable int created = 0;
+};
+
+TEST(TestFileItem, MusicInfoTagSource)
+{
+  std::shared_ptr<TestMusicInfoTagSource> source = std::make_shared<TestMusicInfoTagSource>();
+
+  CFileItem item;
+  const CFileItem &constItem = item;
+  item.SetMusicInfoTagSource(source, 2);
+  EXPECT_TRUE(item.HasMusicInfoTag());
+  EXPECT_EQ(0, source->created);
+
+  EXPECT_EQ("Song 2", constItem.GetMusicInfoTag()->GetTitle());
+  EXPECT_EQ("Song 2", constItem.GetMusicInfoTag()->GetTitle());
+  EXPECT_EQ(1, source->created);
+
+  // released tags are created again when accessed
+  item.FreeMemory();
+  EXPECT_TRUE(item.HasMusicInfoTag());
+  EXPECT_FALSE(item.ReleaseMusicInfoTag());
+  EXPECT_EQ("Song 2", constItem.GetMusicInfoTag()->GetTitle());
+  EXPECT_EQ(2, source->created);
+
+  // locked tags aren't released
+  item.LockMusicInfoTag();
+  EXPECT_FALSE(item.ReleaseMusicInfoTag());
+  item.UnlockMusicInfoTag();
+  EXPECT_TRUE(item.ReleaseMusicInfoTag());
+
+  // copies share the source and don't create a tag of their own
+  CFileItem copy(item);
+  const CFileItem &constCopy = copy;
+  EXPECT_EQ(source, copy.GetMusicInfoTagSource());
+  EXPECT_EQ(2, source->created);
+  EXPECT_EQ("Song 2", constCopy.GetMusicInfoTag()->GetTitle());
+  EXPECT_EQ(3, source->created);
+  EXPECT_TRUE(copy.ReleaseMusicInfoTag());
+
+  // tags which may have been changed are kept
+  copy.GetMusicInfoTag()->SetLyrics("Lyrics");
+  EXPECT_FALSE(copy.ReleaseMusicInfoTag());
+  EXPECT_EQ("Lyrics", constCopy.GetMusicInfoTag()->GetLyrics());
+  EXPECT_EQ(3, source->created);
+
+  // updated tags are kept, copies of them don't share the source anymore
+  CFileItem updated;
+  updated.GetMusicInfoTag()->SetTitle("Updated");
+  item.UpdateInfo(updated);
+  EXPECT_FALSE(item.ReleaseMusicInfoTag());
+  EXPECT_EQ("Updated", constItem.GetMusicInfoTag()->GetTitle());
+  EXPECT_EQ(4, source->created);
+
+  CFileItem updatedCopy(item);
+  EXPECT_FALSE(updatedCopy.GetMusicInfoTagSource());
+  EXPECT_EQ("Updated", updatedCopy.GetMusicInfoTag()->GetTitle());
+  EXPECT_EQ(4, source->created);
+}
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Decode benchmark of VideoPlayer for CI, e.g.
+ *
+ *   kodi-benchmark --create /tmp/test.asf --seconds 30 --size 1920x1080
+ *   kodi-benchmark /tmp/test.asf
+ *   kodi-benchmark --runs 2 smb://server/share/movie.mkv
+ *
+ * Later runs of a file open it with the stream info of the demux cache, so
+ * comparing the time to the first packet of the runs shows what it saves.
+ *
+ * The exit code is non-zero if a file fails to play.
+ */
+
+#include "TestBasicEnvironment.h"
+
+#include "cores/VideoPlayer/test/VideoPlayerBenchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static void Usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [options] <file>...\n"
+          "  --no-video          don't decode the video stream\n"
+          "  --no-audio          don't decode the audio stream\n"
+          "  --no-render         don't copy decoded pictures into render buffers\n"
+          "  --packets <n>       stop after n packets of each file\n"
+          "  --runs <n>          play each file n times (default 1)\n"
+          "  --create <file>     write a test file instead of playing files\n"
+          "  --seconds <n>       length of the test file (default 10)\n"
+          "  --size <w>x<h>      picture size of the test file (default 1280x720)\n",
+          name);
+}
+
+int main(int argc, char **argv)
+{
+  CVideoPlayerBenchmark::SOptions options;
+  std::vector<std::string> files;
+  std::string create;
+  int seconds = 10;
+  int width = 1280;
+  int height = 720;
+  int runs = 1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--no-video"))
+      options.video = false;
+    else if (!strcmp(argv[i], "--no-audio"))
+      options.audio = false;
+    else if (!strcmp(argv[i], "--no-render"))
+      options.render = false;
+    else if (!strcmp(argv[i], "--packets") && hasValue)
+      options.maxPackets = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--runs") && hasValue)
+      runs = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--create") && hasValue)
+      create = argv[++i];
+    else if (!strcmp(argv[i], "--seconds") && hasValue)
+      seconds = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--size") && hasValue)
+    {
+      if (sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+      {
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (argv[i][0] == '-')
+    {
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    else
+      files.push_back(argv[i]);
+  }
+
+  if (create.empty() && files.empty())
+  {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  TestBasicEnvironment environment;
+  environment.SetUp();
+
+  int ret = EXIT_SUCCESS;
+  if (!create.empty())
+  {
+    if (!CVideoPlayerBenchmark::CreateTestFile(create, seconds, width, height))
+    {
+      fprintf(stderr, "failed to create %s\n", create.c_str());
+      ret = EXIT_FAILURE;
+    }
+  }
+
+  for (const auto &file : files)
+  {
+    for (int run = 1; run <= runs; run++)
+    {
+      CVideoPlayerBenchmark::SResult result;
+      bool ok = CVideoPlayerBenchmark::Run(file, options, result);
+
+      printf("file: %s\n", file.c_str());
+      if (runs > 1)
+        printf("run: %d\n", run);
+      printf("%s", CVideoPlayerBenchmark::Report(result).c_str());
+      printf("result: %s\n\n", ok ? "ok" : "failed");
+      if (!ok)
+        ret = EXIT_FAILURE;
+    }
+  }
+
+  environment.TearDown();
+  return ret;
+}
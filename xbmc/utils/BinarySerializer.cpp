@@ -0,0 +1,84 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "BinarySerializer.h"
+
+void CBinaryWriter::WriteString(const std::string &value)
+{
+  Write(static_cast<uint32_t>(value.size()));
+  m_data.append(value);
+}
+
+void CBinaryWriter::WriteStrings(const std::vector<std::string> &values)
+{
+  Write(static_cast<uint32_t>(values.size()));
+  for (const auto &value : values)
+    WriteString(value);
+}
+
+void CBinaryWriter::WriteArray(const void *buffer, size_t size)
+{
+  if (size > 0)
+    m_data.append(static_cast<const char*>(buffer), size);
+}
+
+bool CBinaryReader::ReadString(std::string &value)
+{
+  uint32_t size;
+  if (!Read(size) || m_size - m_pos < size)
+    return false;
+  value.assign(m_data + m_pos, size);
+  m_pos += size;
+  return true;
+}
+
+bool CBinaryReader::ReadStrings(std::vector<std::string> &values, uint32_t maxCount)
+{
+  uint32_t count;
+  if (!Read(count) || count > maxCount)
+    return false;
+
+  values.resize(count);
+  for (auto &value : values)
+  {
+    if (!ReadString(value))
+      return false;
+  }
+  return true;
+}
+
+bool CBinaryReader::ReadArray(void *buffer, size_t size)
+{
+  if (m_size - m_pos < size)
+    return false;
+  if (size > 0)
+    memcpy(buffer, m_data + m_pos, size);
+  m_pos += size;
+  return true;
+}
+
+bool CBinaryReader::ReadMagic(const char *magic)
+{
+  size_t size = strlen(magic);
+  if (m_size - m_pos < size || memcmp(m_data + m_pos, magic, size) != 0)
+    return false;
+  m_pos += size;
+  return true;
+}
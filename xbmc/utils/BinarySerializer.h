@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Appends values in host byte order to a string, for cache files which
+ are only ever read back on the machine that wrote them. Strings are stored
+ with their size in front.
+ */
+class CBinaryWriter
+{
+public:
+  explicit CBinaryWriter(std::string &data) : m_data(data) {}
+
+  //! \brief Write a value which can be copied byte by byte
+  template<typename T>
+  void Write(const T &value)
+  {
+    m_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteString(const std::string &value);
+  void WriteStrings(const std::vector<std::string> &values);
+  void WriteArray(const void *buffer, size_t size);
+  //! \brief Write a tag without size, to tell the file type apart
+  void WriteMagic(const char *magic) { WriteArray(magic, strlen(magic)); }
+
+private:
+  std::string &m_data;
+};
+
+/*!
+ \brief Reads what CBinaryWriter has written. Every read checks the remaining
+ size first, so broken or truncated data makes it fail instead of reading past
+ the end.
+ */
+class CBinaryReader
+{
+public:
+  CBinaryReader(const char *data, size_t size) : m_data(data), m_size(size), m_pos(0) {}
+
+  //! \brief Read a value which can be copied byte by byte
+  template<typename T>
+  bool Read(T &value)
+  {
+    return ReadArray(&value, sizeof(T));
+  }
+
+  bool ReadString(std::string &value);
+  /*!
+   \brief Read a list of strings
+   \param values [out] the strings
+   \param maxCount lists with more strings are rejected as broken
+   */
+  bool ReadStrings(std::vector<std::string> &values, uint32_t maxCount);
+  bool ReadArray(void *buffer, size_t size);
+  //! \brief Read a tag written with CBinaryWriter::WriteMagic, fails if it's another one
+  bool ReadMagic(const char *magic);
+
+  bool AtEnd() const { return m_pos == m_size; }
+
+private:
+  const char *m_data;
+  size_t m_size;
+  size_t m_pos;
+};
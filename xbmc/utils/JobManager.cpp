@@ -21,6 +21,7 @@
 #include "JobManager.h"
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <stdexcept>
 #include "threads/SingleLock.h"
 #include "utils/log.h"
@@ -144,12 +145,22 @@ bool CJobQueue::AddJob(CJob *job)
 void CJobQueue::QueueNextJob()
 {
   CSingleLock lock(m_section);
-  if (m_jobQueue.size() && m_processing.size() < m_jobsAtOnce)
+  while (m_jobQueue.size() && m_processing.size() < m_jobsAtOnce)
   {
-    CJobPointer &job = m_jobQueue.back();
+    std::vector<const CJob*> processing;
+    for (const auto &job : m_processing)
+      processing.push_back(job.m_job);
+
+    // the next job in order which may run now
+    Queue::reverse_iterator i = std::find_if(m_jobQueue.rbegin(), m_jobQueue.rend(),
+                                             [this, &processing](const CJobPointer &job) { return CanProcess(job.m_job, processing); });
+    if (i == m_jobQueue.rend())
+      break;
+
+    CJobPointer job = *i;
     job.m_id = CJobManager::GetInstance().AddJob(job.m_job, this, m_priority);
     m_processing.push_back(job);
-    m_jobQueue.pop_back();
+    m_jobQueue.erase(std::next(i).base());
   }
 }
 
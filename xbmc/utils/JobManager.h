@@ -146,7 +146,17 @@ protected:
    NOTE: This function does not take into account the jobs that are currently processing 
    */
   bool QueueEmpty() const;
-  
+
+  /*!
+   \brief Check whether a queued job may be processed next to the jobs being processed
+   Jobs which may not run yet stay queued and the next one in order is tried instead.
+   Subclasses may override this to keep jobs competing for a resource apart.
+   \param job the queued job.
+   \param processing the jobs being processed.
+   \return true if the job may be processed now, the default.
+   */
+  virtual bool CanProcess(const CJob *job, const std::vector<const CJob*> &processing) const { return true; }
+
 private:
   void QueueNextJob();
 
@@ -240,11 +250,16 @@ public:
 
   /*!
    \brief Add a function f to this job manager for asynchronously execution.
+   \return the id of the job, 0 if the job manager isn't running and f won't be called
    */
   template<typename F>
-  void Submit(F&& f, CJob::PRIORITY priority = CJob::PRIORITY_LOW)
+  unsigned int Submit(F&& f, CJob::PRIORITY priority = CJob::PRIORITY_LOW)
   {
-    AddJob(new CLambdaJob<F>(std::forward<F>(f)), nullptr, priority);
+    CJob *job = new CLambdaJob<F>(std::forward<F>(f));
+    unsigned int id = AddJob(job, nullptr, priority);
+    if (!id)
+      delete job;
+    return id;
   }
 
   /*!
@@ -0,0 +1,260 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TaskGraph.h"
+
+#include <algorithm>
+
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/log.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+int64_t CTaskTrace::Now()
+{
+  static const int64_t frequency = CurrentHostFrequency();
+  int64_t counter = CurrentHostCounter();
+  return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+}
+
+void CTaskTrace::Add(const std::string &category, const std::string &name, int64_t start, int64_t end /* = Now() */)
+{
+  CSingleLock lock(m_section);
+  auto thread = m_threads.insert(std::make_pair(std::this_thread::get_id(), static_cast<int>(m_threads.size()))).first;
+
+  STask task;
+  task.category = category;
+  task.name = name;
+  task.start = start;
+  task.end = end;
+  task.thread = thread->second;
+  m_tasks.push_back(task);
+}
+
+std::vector<CTaskTrace::STask> CTaskTrace::GetTasks() const
+{
+  CSingleLock lock(m_section);
+  return m_tasks;
+}
+
+bool CTaskTrace::Write(const std::string &path) const
+{
+  std::vector<STask> tasks = GetTasks();
+  if (tasks.empty())
+    return false;
+
+  // times are written relative to the first task
+  int64_t first = std::min_element(tasks.begin(), tasks.end(),
+                                   [](const STask &a, const STask &b) { return a.start < b.start; })->start;
+
+  CVariant events(CVariant::VariantTypeArray);
+  for (const auto &task : tasks)
+  {
+    CVariant event(CVariant::VariantTypeObject);
+    event["name"] = task.name;
+    event["cat"] = task.category;
+    event["ph"] = "X";
+    event["ts"] = task.start - first;
+    event["dur"] = task.end - task.start;
+    event["pid"] = 0;
+    event["tid"] = task.thread;
+    events.push_back(event);
+  }
+
+  CVariant trace(CVariant::VariantTypeObject);
+  trace["traceEvents"] = events;
+  trace["displayTimeUnit"] = "ms";
+
+  std::string data;
+  if (!CJSONVariantWriter::Write(trace, data, false))
+    return false;
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true) ||
+      file.Write(data.c_str(), data.size()) != static_cast<ssize_t>(data.size()))
+  {
+    CLog::Log(LOGWARNING, "CTaskTrace::%s - failed to write %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+CTaskGraph::CTaskGraph(const std::string &name, CTaskTrace *trace /* = nullptr */)
+  : m_name(name),
+    m_trace(trace),
+    m_running(0),
+    m_remaining(0)
+{
+}
+
+void CTaskGraph::Add(const std::string &name, Task task, const std::vector<std::string> &dependencies /* = std::vector<std::string>() */, bool mainThread /* = false */)
+{
+  STask entry;
+  entry.name = name;
+  entry.task = task;
+  entry.dependencies = dependencies;
+  entry.pending = 0;
+  entry.mainThread = mainThread;
+  entry.state = TASK_WAITING;
+  m_tasks.push_back(entry);
+}
+
+bool CTaskGraph::Run(const std::function<void()> &idle /* = nullptr */)
+{
+  for (auto &task : m_tasks)
+  {
+    for (const auto &dependency : task.dependencies)
+    {
+      auto it = std::find_if(m_tasks.begin(), m_tasks.end(),
+                             [&dependency](const STask &other) { return other.name == dependency; });
+      if (it == m_tasks.end())
+      {
+        CLog::Log(LOGERROR, "CTaskGraph::%s - %s: task %s depends on unknown task %s", __FUNCTION__, m_name.c_str(), task.name.c_str(), dependency.c_str());
+        return false;
+      }
+      it->dependents.push_back(&task - &m_tasks[0]);
+      task.pending++;
+    }
+  }
+
+  int64_t start = CTaskTrace::Now();
+
+  CSingleLock lock(m_section);
+  m_remaining = m_tasks.size();
+  for (size_t i = 0; i < m_tasks.size(); i++)
+  {
+    if (m_tasks[i].pending == 0)
+      Schedule(i);
+  }
+
+  while (m_remaining > 0)
+  {
+    if (!m_mainQueue.empty())
+    {
+      size_t index = m_mainQueue.front();
+      m_mainQueue.erase(m_mainQueue.begin());
+
+      CSingleExit exit(m_section);
+      Execute(index);
+      continue;
+    }
+
+    if (m_running == 0)
+    {
+      // nothing runs and nothing can be started, the rest depends on itself
+      for (const auto &task : m_tasks)
+      {
+        if (task.state == TASK_WAITING)
+          CLog::Log(LOGERROR, "CTaskGraph::%s - %s: task %s is part of a dependency cycle", __FUNCTION__, m_name.c_str(), task.name.c_str());
+      }
+      return false;
+    }
+
+    bool finished;
+    {
+      CSingleExit exit(m_section);
+      finished = m_finished.WaitMSec(1000);
+    }
+    if (!finished && idle)
+    {
+      CSingleExit exit(m_section);
+      idle();
+    }
+  }
+
+  bool success = std::none_of(m_tasks.begin(), m_tasks.end(),
+                              [](const STask &task) { return task.state != TASK_DONE; });
+
+  CLog::Log(LOGDEBUG, "CTaskGraph::%s - %s: %zu tasks finished in %.2fms%s", __FUNCTION__, m_name.c_str(),
+            m_tasks.size(), (CTaskTrace::Now() - start) / 1000.0, success ? "" : ", some failed");
+  return success;
+}
+
+void CTaskGraph::Schedule(size_t index)
+{
+  STask &task = m_tasks[index];
+  task.state = TASK_QUEUED;
+  if (task.mainThread)
+  {
+    m_mainQueue.push_back(index);
+    m_finished.Set();
+    return;
+  }
+
+  m_running++;
+  if (!CJobManager::GetInstance().Submit([this, index]() {
+        Execute(index);
+      }, CJob::PRIORITY_DEDICATED))
+  {
+    // the job manager has been stopped, run it on the calling thread instead
+    m_running--;
+    task.mainThread = true;
+    m_mainQueue.push_back(index);
+    m_finished.Set();
+  }
+}
+
+void CTaskGraph::Execute(size_t index)
+{
+  STask &task = m_tasks[index];
+
+  int64_t start = CTaskTrace::Now();
+  bool success = task.task();
+  int64_t end = CTaskTrace::Now();
+
+  if (m_trace)
+    m_trace->Add(m_name, task.name, start, end);
+  CLog::Log(success ? LOGDEBUG : LOGERROR, "CTaskGraph::%s - %s: task %s %s after %.2fms", __FUNCTION__, m_name.c_str(),
+            task.name.c_str(), success ? "finished" : "failed", (end - start) / 1000.0);
+
+  CSingleLock lock(m_section);
+  if (!task.mainThread)
+    m_running--;
+  Finish(index, success ? TASK_DONE : TASK_FAILED);
+
+  // Run() may return as soon as this is set, don't touch the graph afterwards
+  m_finished.Set();
+}
+
+void CTaskGraph::Finish(size_t index, TaskState state)
+{
+  STask &task = m_tasks[index];
+  task.state = state;
+  m_remaining--;
+
+  for (auto dependent : task.dependents)
+  {
+    STask &other = m_tasks[dependent];
+    if (other.state != TASK_WAITING)
+      continue;
+
+    if (state != TASK_DONE)
+    {
+      CLog::Log(LOGERROR, "CTaskGraph::%s - %s: skipping task %s, task %s didn't finish", __FUNCTION__, m_name.c_str(), other.name.c_str(), task.name.c_str());
+      Finish(dependent, TASK_SKIPPED);
+    }
+    else if (--other.pending == 0)
+      Schedule(dependent);
+  }
+}
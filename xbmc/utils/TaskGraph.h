@@ -0,0 +1,151 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <functional>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+/*!
+ \brief Records the wall time of tasks, e.g. of the steps of the startup, and
+ writes them as a trace file which chrome://tracing and similar tools can show.
+ */
+class CTaskTrace
+{
+public:
+  struct STask
+  {
+    std::string category;
+    std::string name;
+    int64_t start; //!< microseconds, see Now()
+    int64_t end;
+    int thread;    //!< threads are numbered in the order they first appear
+  };
+
+  /*!
+   \brief Current time in microseconds of a monotonic clock.
+   */
+  static int64_t Now();
+
+  /*!
+   \brief Record a task which ran on the calling thread.
+   \param category the group of the task, e.g. the task graph it belonged to
+   \param name the name of the task
+   \param start when the task started, from Now()
+   \param end when the task ended, by default now
+   */
+  void Add(const std::string &category, const std::string &name, int64_t start, int64_t end = Now());
+
+  std::vector<STask> GetTasks() const;
+
+  /*!
+   \brief Write the trace in the JSON format of the trace event profiling tool.
+   \param path the file to write, replaced if it exists
+   */
+  bool Write(const std::string &path) const;
+
+private:
+  mutable CCriticalSection m_section;
+  std::vector<STask> m_tasks;
+  std::map<std::thread::id, int> m_threads;
+};
+
+/*!
+ \brief Runs tasks with dependencies between them, each as soon as the tasks
+ it depends on have finished.
+
+ Tasks run concurrently on dedicated jobs of the job manager. Tasks which have
+ to run on the thread calling Run(), e.g. because they touch the GUI, are run
+ there in between waiting for the others. So are all tasks once the job
+ manager has been stopped.
+ */
+class CTaskGraph
+{
+public:
+  /*!
+   \brief A task, returns false if it failed.
+   */
+  typedef std::function<bool()> Task;
+
+  /*!
+   \param name the name of the graph for logging and the trace
+   \param trace the trace to record the time of the tasks in, may be nullptr
+   */
+  CTaskGraph(const std::string &name, CTaskTrace *trace = nullptr);
+
+  /*!
+   \brief Add a task to the graph.
+   \param name the name of the task, dependencies refer to it
+   \param task the task
+   \param dependencies names of the tasks which have to finish first
+   \param mainThread run the task on the thread calling Run()
+   */
+  void Add(const std::string &name, Task task, const std::vector<std::string> &dependencies = std::vector<std::string>(), bool mainThread = false);
+
+  /*!
+   \brief Run all tasks and wait for them to finish.
+   Tasks depending on a failed task are skipped.
+   \param idle called about every second while waiting for tasks, e.g. to update a splash screen
+   \return false if a task failed or was skipped, or the dependencies are invalid
+   */
+  bool Run(const std::function<void()> &idle = nullptr);
+
+private:
+  enum TaskState
+  {
+    TASK_WAITING,
+    TASK_QUEUED,
+    TASK_DONE,
+    TASK_FAILED,
+    TASK_SKIPPED
+  };
+
+  struct STask
+  {
+    std::string name;
+    Task task;
+    std::vector<std::string> dependencies;
+    std::vector<size_t> dependents;
+    unsigned int pending;
+    bool mainThread;
+    TaskState state;
+  };
+
+  void Schedule(size_t index);
+  void Execute(size_t index);
+  void Finish(size_t index, TaskState state);
+
+  std::string m_name;
+  CTaskTrace *m_trace;
+  std::vector<STask> m_tasks;
+
+  CCriticalSection m_section;
+  CEvent m_finished;
+  std::vector<size_t> m_mainQueue;
+  unsigned int m_running;
+  unsigned int m_remaining;
+};
@@ -0,0 +1,91 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/BinarySerializer.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestBinarySerializer, WriteAndRead)
+{
+  std::string data;
+  CBinaryWriter writer(data);
+  writer.WriteMagic("TEST");
+  writer.Write(static_cast<uint32_t>(42));
+  writer.Write(static_cast<int64_t>(-1));
+  writer.WriteString("");
+  writer.WriteString(std::string("a\0b", 3));
+  writer.WriteStrings({ "one", "two" });
+  const char array[] = { 1, 2, 3 };
+  writer.WriteArray(array, sizeof(array));
+
+  CBinaryReader reader(data.c_str(), data.size());
+  uint32_t u32;
+  int64_t i64;
+  std::string string1, string2;
+  std::vector<std::string> strings;
+  char result[3];
+  EXPECT_TRUE(reader.ReadMagic("TEST"));
+  EXPECT_TRUE(reader.Read(u32));
+  EXPECT_EQ(42U, u32);
+  EXPECT_TRUE(reader.Read(i64));
+  EXPECT_EQ(-1, i64);
+  EXPECT_TRUE(reader.ReadString(string1));
+  EXPECT_EQ("", string1);
+  EXPECT_TRUE(reader.ReadString(string2));
+  EXPECT_EQ(std::string("a\0b", 3), string2);
+  EXPECT_TRUE(reader.ReadStrings(strings, 2));
+  EXPECT_EQ(std::vector<std::string>({ "one", "two" }), strings);
+  EXPECT_FALSE(reader.AtEnd());
+  EXPECT_TRUE(reader.ReadArray(result, sizeof(result)));
+  EXPECT_EQ(0, memcmp(array, result, sizeof(result)));
+  EXPECT_TRUE(reader.AtEnd());
+
+  // nothing left
+  uint8_t u8;
+  EXPECT_FALSE(reader.Read(u8));
+}
+
+TEST(TestBinarySerializer, RejectsBrokenData)
+{
+  std::string data;
+  CBinaryWriter writer(data);
+  writer.WriteMagic("TEST");
+  writer.WriteStrings({ "one", "two", "three" });
+
+  CBinaryReader otherMagic(data.c_str(), data.size());
+  EXPECT_FALSE(otherMagic.ReadMagic("ABCD"));
+
+  // too many strings
+  CBinaryReader tooMany(data.c_str(), data.size());
+  std::vector<std::string> strings;
+  EXPECT_TRUE(tooMany.ReadMagic("TEST"));
+  EXPECT_FALSE(tooMany.ReadStrings(strings, 2));
+
+  // the size of a string points past the end
+  CBinaryReader truncated(data.c_str(), data.size() - 1);
+  EXPECT_TRUE(truncated.ReadMagic("TEST"));
+  EXPECT_FALSE(truncated.ReadStrings(strings, 3));
+
+  CBinaryReader empty(nullptr, 0);
+  uint32_t value;
+  EXPECT_TRUE(empty.AtEnd());
+  EXPECT_FALSE(empty.ReadMagic("TEST"));
+  EXPECT_FALSE(empty.Read(value));
+}
@@ -21,8 +21,14 @@
 #include "ServiceBroker.h"
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
 #include "utils/SystemInfo.h"
 
+#ifdef TARGET_POSIX
+#include "../linux/XTimeUtils.h"
+#endif
+
 #include "gtest/gtest.h"
 
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
@@ -154,6 +160,71 @@ WaitForJobToStartProcessing(CJob::PRIORITY priority, JobControlPackage &package)
 
   return job;
 }
+
+struct ResourceJobControl
+{
+  ResourceJobControl() : started(true), finish(true) {}
+
+  CEvent started;
+  CEvent finish;
+};
+
+// a job which uses a resource until it's told to finish
+class ResourceJob :
+  public CJob
+{
+public:
+  ResourceJob(int resource, ResourceJobControl &control) :
+    m_resource(resource),
+    m_control(control)
+  {
+  }
+
+  const char * GetType() const
+  {
+    return "ResourceJob";
+  }
+
+  // CJobQueue finds its jobs through this
+  bool operator==(const CJob *job) const override
+  {
+    return this == job;
+  }
+
+  bool DoWork()
+  {
+    m_control.started.Set();
+    m_control.finish.Wait();
+    return true;
+  }
+
+  int m_resource;
+
+private:
+  ResourceJobControl &m_control;
+};
+
+// runs up to three jobs at once, but only one per resource
+class ResourceJobQueue :
+  public CJobQueue
+{
+public:
+  ResourceJobQueue() : CJobQueue(false, 3, CJob::PRIORITY_NORMAL)
+  {
+  }
+
+protected:
+  bool CanProcess(const CJob *job, const std::vector<const CJob*> &processing) const override
+  {
+    int resource = static_cast<const ResourceJob*>(job)->m_resource;
+    for (const auto &other : processing)
+    {
+      if (static_cast<const ResourceJob*>(other)->m_resource == resource)
+        return false;
+    }
+    return true;
+  }
+};
 }
   
 TEST_F(TestJobManager, PauseLowPriorityJob)
@@ -179,3 +250,31 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+TEST_F(TestJobManager, JobQueueCanProcess)
+{
+  ResourceJobControl first, second, other;
+  ResourceJobQueue queue;
+  // a worker which hasn't taken its job yet would be handed the next one too
+  queue.AddJob(new ResourceJob(1, first));
+  ASSERT_TRUE(first.started.WaitMSec(5000));
+
+  // the second job has to wait for the first one, the later one with another
+  // resource may overtake it
+  queue.AddJob(new ResourceJob(1, second));
+  queue.AddJob(new ResourceJob(2, other));
+  EXPECT_TRUE(other.started.WaitMSec(5000));
+  EXPECT_FALSE(second.started.WaitMSec(100));
+
+  first.finish.Set();
+  EXPECT_TRUE(second.started.WaitMSec(5000));
+
+  second.finish.Set();
+  other.finish.Set();
+
+  // the jobs use the controls until they are done
+  XbmcThreads::EndTime timeout(5000);
+  while (queue.IsProcessing() && !timeout.IsTimePast())
+    Sleep(10);
+  EXPECT_FALSE(queue.IsProcessing());
+}
@@ -0,0 +1,154 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+#include "utils/TaskGraph.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+
+class COrder
+{
+public:
+  bool Add(const std::string &name)
+  {
+    CSingleLock lock(m_section);
+    m_order.push_back(name);
+    return true;
+  }
+
+  size_t IndexOf(const std::string &name)
+  {
+    CSingleLock lock(m_section);
+    return std::find(m_order.begin(), m_order.end(), name) - m_order.begin();
+  }
+
+  size_t Size()
+  {
+    CSingleLock lock(m_section);
+    return m_order.size();
+  }
+
+private:
+  CCriticalSection m_section;
+  std::vector<std::string> m_order;
+};
+
+}
+
+TEST(TestTaskGraph, Dependencies)
+{
+  COrder order;
+  CTaskTrace trace;
+  CTaskGraph graph("test", &trace);
+  graph.Add("d", [&order]() { return order.Add("d"); }, { "b", "c" });
+  graph.Add("a", [&order]() { return order.Add("a"); });
+  graph.Add("b", [&order]() { return order.Add("b"); }, { "a" });
+  graph.Add("c", [&order]() { return order.Add("c"); }, { "a" });
+
+  EXPECT_TRUE(graph.Run());
+  ASSERT_EQ(4U, order.Size());
+  EXPECT_LT(order.IndexOf("a"), order.IndexOf("b"));
+  EXPECT_LT(order.IndexOf("a"), order.IndexOf("c"));
+  EXPECT_LT(order.IndexOf("b"), order.IndexOf("d"));
+  EXPECT_LT(order.IndexOf("c"), order.IndexOf("d"));
+
+  std::vector<CTaskTrace::STask> tasks = trace.GetTasks();
+  ASSERT_EQ(4U, tasks.size());
+  for (const auto &task : tasks)
+  {
+    EXPECT_EQ("test", task.category);
+    EXPECT_LE(task.start, task.end);
+  }
+}
+
+TEST(TestTaskGraph, Concurrent)
+{
+  // both tasks only finish if they run at the same time
+  CEvent a(true), b(true);
+  CTaskGraph graph("test");
+  graph.Add("a", [&a, &b]() { a.Set(); return b.WaitMSec(5000); });
+  graph.Add("b", [&a, &b]() { b.Set(); return a.WaitMSec(5000); });
+
+  EXPECT_TRUE(graph.Run());
+}
+
+TEST(TestTaskGraph, MainThread)
+{
+  std::thread::id caller = std::this_thread::get_id();
+  std::thread::id ran;
+  CTaskGraph graph("test");
+  graph.Add("worker", []() { return true; });
+  graph.Add("main", [&ran]() { ran = std::this_thread::get_id(); return true; }, { "worker" }, true);
+
+  EXPECT_TRUE(graph.Run());
+  EXPECT_EQ(caller, ran);
+}
+
+TEST(TestTaskGraph, Failure)
+{
+  std::atomic<int> ran(0);
+  CTaskGraph graph("test");
+  graph.Add("a", [&ran]() { ran++; return false; });
+  graph.Add("b", [&ran]() { ran++; return true; }, { "a" });
+  graph.Add("c", [&ran]() { ran++; return true; }, { "b" });
+  graph.Add("d", [&ran]() { ran++; return true; });
+
+  EXPECT_FALSE(graph.Run());
+  EXPECT_EQ(2, ran);
+}
+
+TEST(TestTaskGraph, InvalidDependencies)
+{
+  CTaskGraph unknown("test");
+  unknown.Add("a", []() { return true; }, { "b" });
+  EXPECT_FALSE(unknown.Run());
+
+  CTaskGraph cycle("test");
+  cycle.Add("a", []() { return true; }, { "b" });
+  cycle.Add("b", []() { return true; }, { "a" });
+  cycle.Add("c", []() { return true; });
+  EXPECT_FALSE(cycle.Run());
+}
+
+TEST(TestTaskGraph, JobManagerStopped)
+{
+  std::thread::id caller = std::this_thread::get_id();
+  std::vector<std::thread::id> ran;
+  CTaskGraph graph("test");
+  graph.Add("a", [&ran]() { ran.push_back(std::this_thread::get_id()); return true; });
+  graph.Add("b", [&ran]() { ran.push_back(std::this_thread::get_id()); return true; }, { "a" });
+
+  // the tasks run on the calling thread instead of waiting for jobs which never start
+  CJobManager::GetInstance().CancelJobs();
+  bool success = graph.Run();
+  CJobManager::GetInstance().Restart();
+
+  EXPECT_TRUE(success);
+  ASSERT_EQ(2U, ran.size());
+  EXPECT_EQ(caller, ran[0]);
+  EXPECT_EQ(caller, ran[1]);
+}
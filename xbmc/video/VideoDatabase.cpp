@@ -1292,6 +1292,7 @@ int CVideoDatabase::AddMovie(const std::string& strFilenameAndPath)
       std::string strSQL=PrepareSQL("insert into movie (idMovie, idFile) values (NULL, %i)", idFile);
       m_pDS->exec(strSQL);
       idMovie = (int)m_pDS->lastinsertid();
+      GetLibraryChanges().Add(MediaTypeMovie, idMovie, CMediaLibraryChanges::Added);
     }
 
     return idMovie;
@@ -1344,9 +1345,12 @@ bool CVideoDatabase::AddPathToTvShow(int idShow, const std::string &path, const
 
 int CVideoDatabase::AddTvShow()
 {
-  if (ExecuteQuery("INSERT INTO tvshow(idShow) VALUES(NULL)"))
-    return (int)m_pDS->lastinsertid();
-  return -1;
+  if (!ExecuteQuery("INSERT INTO tvshow(idShow) VALUES(NULL)"))
+    return -1;
+
+  int idShow = (int)m_pDS->lastinsertid();
+  GetLibraryChanges().Add(MediaTypeTvShow, idShow, CMediaLibraryChanges::Added);
+  return idShow;
 }
 
 //********************************************************************************************************************************
@@ -1364,7 +1368,9 @@ int CVideoDatabase::AddEpisode(int idShow, const std::string& strFilenameAndPath
 
     std::string strSQL=PrepareSQL("insert into episode (idEpisode, idFile, idShow) values (NULL, %i, %i)", idFile, idShow);
     m_pDS->exec(strSQL);
-    return (int)m_pDS->lastinsertid();
+    int idEpisode = (int)m_pDS->lastinsertid();
+    GetLibraryChanges().Add(MediaTypeEpisode, idEpisode, CMediaLibraryChanges::Added);
+    return idEpisode;
   }
   catch (...)
   {
@@ -1390,6 +1396,7 @@ int CVideoDatabase::AddMusicVideo(const std::string& strFilenameAndPath)
       std::string strSQL=PrepareSQL("insert into musicvideo (idMVideo, idFile) values (NULL, %i)", idFile);
       m_pDS->exec(strSQL);
       idMVideo = (int)m_pDS->lastinsertid();
+      GetLibraryChanges().Add(MediaTypeMusicVideo, idMVideo, CMediaLibraryChanges::Added);
     }
 
     return idMVideo;
@@ -1727,6 +1734,7 @@ void CVideoDatabase::AddTagToItem(int media_id, int tag_id, const std::string &t
     return;
 
   AddToLinkTable(media_id, type, "tag", tag_id);
+  GetLibraryChanges().Add(type, media_id, CMediaLibraryChanges::Updated);
 }
 
 void CVideoDatabase::RemoveTagFromItem(int media_id, int tag_id, const std::string &type)
@@ -1735,6 +1743,7 @@ void CVideoDatabase::RemoveTagFromItem(int media_id, int tag_id, const std::stri
     return;
 
   RemoveFromLinkTable(media_id, type, "tag", tag_id);
+  GetLibraryChanges().Add(type, media_id, CMediaLibraryChanges::Updated);
 }
 
 void CVideoDatabase::RemoveTagsFromItem(int media_id, const std::string &type)
@@ -1743,6 +1752,7 @@ void CVideoDatabase::RemoveTagsFromItem(int media_id, const std::string &type)
     return;
 
   m_pDS2->exec(PrepareSQL("DELETE FROM tag_link WHERE media_id=%d AND media_type='%s'", media_id, type.c_str()));
+  GetLibraryChanges().Add(type, media_id, CMediaLibraryChanges::Updated);
 }
 
 //****Actors****
@@ -2384,6 +2394,7 @@ int CVideoDatabase::SetDetailsForMovie(const std::string& strFilenameAndPath, CV
     sql += PrepareSQL(" where idMovie=%i", idMovie);
     m_pDS->exec(sql);
     CommitTransaction();
+    GetLibraryChanges().Add(MediaTypeMovie, idMovie, CMediaLibraryChanges::Updated);
 
     return idMovie;
   }
@@ -2645,6 +2656,7 @@ bool CVideoDatabase::UpdateDetailsForTvShow(int idTvShow, CVideoInfoTag &details
   if (ExecuteQuery(sql))
   {
     CommitTransaction();
+    GetLibraryChanges().Add(MediaTypeTvShow, idTvShow, CMediaLibraryChanges::Updated);
     return true;
   }
   RollbackTransaction();
@@ -2786,6 +2798,7 @@ int CVideoDatabase::SetDetailsForEpisode(const std::string& strFilenameAndPath,
     sql += PrepareSQL(" where idEpisode=%i", idEpisode);
     m_pDS->exec(sql);
     CommitTransaction();
+    GetLibraryChanges().Add(MediaTypeEpisode, idEpisode, CMediaLibraryChanges::Updated);
 
     return idEpisode;
   }
@@ -2877,6 +2890,7 @@ int CVideoDatabase::SetDetailsForMusicVideo(const std::string& strFilenameAndPat
     sql += PrepareSQL(" where idMVideo=%i", idMVideo);
     m_pDS->exec(sql);
     CommitTransaction();
+    GetLibraryChanges().Add(MediaTypeMusicVideo, idMVideo, CMediaLibraryChanges::Updated);
 
     return idMVideo;
   }
@@ -3148,6 +3162,8 @@ void CVideoDatabase::AddBookMarkToFile(const std::string& strFilenameAndPath, co
       strSQL=PrepareSQL("insert into bookmark (idBookmark, idFile, timeInSeconds, totalTimeInSeconds, thumbNailImage, player, playerState, type) values(NULL,%i,%f,%f,'%s','%s','%s', %i)", idFile, bookmark.timeInSeconds, bookmark.totalTimeInSeconds, bookmark.thumbNailImage.c_str(), bookmark.player.c_str(), bookmark.playerState.c_str(), (int)type);
 
     m_pDS->exec(strSQL);
+    if (type != CBookmark::STANDARD)
+      AddLibraryChangesForFile(idFile);
   }
   catch (...)
   {
@@ -3181,6 +3197,8 @@ void CVideoDatabase::ClearBookMarkOfFile(const std::string& strFilenameAndPath,
         strSQL=PrepareSQL("update episode set c%02d=-1 where idFile=%i and c%02d=%i", VIDEODB_ID_EPISODE_BOOKMARK, idFile, VIDEODB_ID_EPISODE_BOOKMARK, idBookmark);
         m_pDS->exec(strSQL);
       }
+      if (type != CBookmark::STANDARD)
+        AddLibraryChangesForFile(idFile);
     }
 
     m_pDS->close();
@@ -3216,6 +3234,8 @@ void CVideoDatabase::ClearBookMarksOfFile(int idFile, CBookmark::EType type /*=
       strSQL=PrepareSQL("update episode set c%02d=-1 where idFile=%i", VIDEODB_ID_EPISODE_BOOKMARK, idFile);
       m_pDS->exec(strSQL);
     }
+    if (type != CBookmark::STANDARD)
+      AddLibraryChangesForFile(idFile);
   }
   catch (...)
   {
@@ -3565,10 +3585,14 @@ void CVideoDatabase::ClearMovieSet(int idMovie)
 
 void CVideoDatabase::SetMovieSet(int idMovie, int idSet)
 {
+  bool updated;
   if (idSet >= 0)
-    ExecuteQuery(PrepareSQL("update movie set idSet = %i where idMovie = %i", idSet, idMovie));
+    updated = ExecuteQuery(PrepareSQL("update movie set idSet = %i where idMovie = %i", idSet, idMovie));
   else
-    ExecuteQuery(PrepareSQL("update movie set idSet = null where idMovie = %i", idMovie));
+    updated = ExecuteQuery(PrepareSQL("update movie set idSet = null where idMovie = %i", idMovie));
+
+  if (updated)
+    GetLibraryChanges().Add(MediaTypeMovie, idMovie, CMediaLibraryChanges::Updated);
 }
 
 void CVideoDatabase::DeleteTag(int idTag, VIDEODB_CONTENT_TYPE mediaType)
@@ -4354,6 +4378,7 @@ void CVideoDatabase::SetArtForItem(int mediaId, const MediaType &mediaType, cons
       {
         sql = PrepareSQL("UPDATE art SET url='%s' where art_id=%d", url.c_str(), artId);
         m_pDS->exec(sql);
+        GetLibraryChanges().Add(mediaType, mediaId, CMediaLibraryChanges::Updated);
       }
     }
     else
@@ -4361,6 +4386,7 @@ void CVideoDatabase::SetArtForItem(int mediaId, const MediaType &mediaType, cons
       m_pDS->close();
       sql = PrepareSQL("INSERT INTO art(media_id, media_type, type, url) VALUES (%d, '%s', '%s', '%s')", mediaId, mediaType.c_str(), artType.c_str(), url.c_str());
       m_pDS->exec(sql);
+      GetLibraryChanges().Add(mediaType, mediaId, CMediaLibraryChanges::Updated);
     }
   }
   catch (...)
@@ -5413,6 +5439,8 @@ void CVideoDatabase::SetPlayCount(const CFileItem &item, int count, const CDateT
     // We only need to announce changes to video items in the library
     if (item.HasVideoInfoTag() && item.GetVideoInfoTag()->m_iDbId > 0)
     {
+      GetLibraryChanges().Add(item.GetVideoInfoTag()->m_type, item.GetVideoInfoTag()->m_iDbId, CMediaLibraryChanges::Updated);
+
       CVariant data;
       if (g_application.IsVideoScanning())
         data["transaction"] = true;
@@ -5421,6 +5449,8 @@ void CVideoDatabase::SetPlayCount(const CFileItem &item, int count, const CDateT
         data["playcount"] = count;
       ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnUpdate", CFileItemPtr(new CFileItem(item)), data);
     }
+    else // a library item of the file might have changed, but we don't know which
+      GetLibraryChanges().Invalidate();
   }
   catch (...)
   {
@@ -5470,6 +5500,7 @@ void CVideoDatabase::UpdateMovieTitle(int idMovie, const std::string& strNewMovi
       CLog::Log(LOGINFO, "Changing Movie set:id:%i New Title:%s", idMovie, strNewMovieTitle.c_str());
       std::string strSQL = PrepareSQL("UPDATE sets SET strSet='%s' WHERE idSet=%i", strNewMovieTitle.c_str(), idMovie );
       m_pDS->exec(strSQL);
+      GetLibraryChanges().Add(MediaTypeVideoCollection, idMovie, CMediaLibraryChanges::Updated);
     }
 
     if (!content.empty())
@@ -9607,7 +9638,11 @@ bool CVideoDatabase::SetSingleValue(VIDEODB_CONTENT_TYPE type, int dbId, int dbF
     if (strTable.empty())
       return false;
 
-    return SetSingleValue(strTable, StringUtils::Format("c%02u", dbField), strValue, strField, dbId);
+    if (!UpdateSingleValue(strTable, StringUtils::Format("c%02u", dbField), strValue, strField, dbId))
+      return false;
+
+    GetLibraryChanges().Add(DatabaseUtils::MediaTypeFromVideoContentType(type), dbId, CMediaLibraryChanges::Updated);
+    return true;
   }
   catch (...)
   {
@@ -9631,6 +9666,17 @@ bool CVideoDatabase::SetSingleValue(VIDEODB_CONTENT_TYPE type, int dbId, Field d
 
 bool CVideoDatabase::SetSingleValue(const std::string &table, const std::string &fieldName, const std::string &strValue,
                                     const std::string &conditionName /* = "" */, int conditionValue /* = -1 */)
+{
+  if (!UpdateSingleValue(table, fieldName, strValue, conditionName, conditionValue))
+    return false;
+
+  // any rows of any table might have changed
+  GetLibraryChanges().Invalidate();
+  return true;
+}
+
+bool CVideoDatabase::UpdateSingleValue(const std::string &table, const std::string &fieldName, const std::string &strValue,
+                                       const std::string &conditionName, int conditionValue)
 {
   if (table.empty() || fieldName.empty())
     return false;
@@ -9661,8 +9707,37 @@ std::string CVideoDatabase::GetSafeFile(const std::string &dir, const std::strin
   return URIUtils::AddFileToFolder(dir, CUtil::MakeLegalFileName(safeThumb));
 }
 
+CMediaLibraryChanges& CVideoDatabase::GetLibraryChanges()
+{
+  static CMediaLibraryChanges changes;
+  return changes;
+}
+
+void CVideoDatabase::AddLibraryChangesForFile(int idFile)
+{
+  // a file can hold several episodes
+  const std::pair<std::string, MediaType> items[] = {
+    { PrepareSQL("SELECT idMovie FROM movie WHERE idFile=%i", idFile), MediaTypeMovie },
+    { PrepareSQL("SELECT idEpisode FROM episode WHERE idFile=%i", idFile), MediaTypeEpisode },
+    { PrepareSQL("SELECT idMVideo FROM musicvideo WHERE idFile=%i", idFile), MediaTypeMusicVideo }
+  };
+
+  for (const auto &item : items)
+  {
+    m_pDS2->query(item.first);
+    while (!m_pDS2->eof())
+    {
+      GetLibraryChanges().Add(item.second, m_pDS2->fv(0).get_asInt(), CMediaLibraryChanges::Updated);
+      m_pDS2->next();
+    }
+    m_pDS2->close();
+  }
+}
+
 void CVideoDatabase::AnnounceRemove(std::string content, int id, bool scanning /* = false */)
 {
+  GetLibraryChanges().Add(content, id, CMediaLibraryChanges::Removed);
+
   CVariant data;
   data["type"] = content;
   data["id"] = id;
@@ -9673,6 +9748,8 @@ void CVideoDatabase::AnnounceRemove(std::string content, int id, bool scanning /
 
 void CVideoDatabase::AnnounceUpdate(std::string content, int id)
 {
+  GetLibraryChanges().Add(content, id, CMediaLibraryChanges::Updated);
+
   CVariant data;
   data["type"] = content;
   data["id"] = id;
@@ -9994,6 +10071,7 @@ bool CVideoDatabase::SetVideoUserRating(int dbId, int rating, const MediaType& m
       sql = PrepareSQL("UPDATE seasons SET userrating=%i WHERE idSeason = %i", rating, dbId);
 
     m_pDS->exec(sql);
+    GetLibraryChanges().Add(mediaType, dbId, CMediaLibraryChanges::Updated);
     return true;
   }
   catch (...)
@@ -27,6 +27,7 @@
 #include "addons/Scraper.h"
 #include "Bookmark.h"
 #include "dbwrappers/Database.h"
+#include "media/MediaLibraryChanges.h"
 #include "utils/SortUtils.h"
 #include "video/VideoDbUrl.h"
 #include "VideoInfoTag.h"
@@ -852,6 +853,11 @@ public:
   void SetMovieSet(int idMovie, int idSet);
   bool SetVideoUserRating(int dbId, int rating, const MediaType& mediaType);
 
+  /*! \brief Feed of the changes made to the items of the video library.
+   Used by listings of the library to update their items instead of fetching all of them again.
+   */
+  static CMediaLibraryChanges& GetLibraryChanges();
+
 protected:
   int GetMovieId(const std::string& strFilenameAndPath);
   int GetMusicVideoId(const std::string& strFilenameAndPath);
@@ -990,4 +996,12 @@ private:
 
   static void AnnounceRemove(std::string content, int id, bool scanning = false);
   static void AnnounceUpdate(std::string content, int id);
+
+  /*! \brief Adds the library items of the given file to the change feed as updated
+   \param idFile id of the file
+   */
+  void AddLibraryChangesForFile(int idFile);
+
+  bool UpdateSingleValue(const std::string &table, const std::string &fieldName, const std::string &strValue,
+                         const std::string &conditionName, int conditionValue);
 };
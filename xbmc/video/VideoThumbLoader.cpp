@@ -37,6 +37,7 @@
 #include "settings/Settings.h"
 #include "settings/VideoSettings.h"
 #include "TextureCache.h"
+#include "threads/SingleLock.h"
 #include "URL.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
@@ -47,6 +48,9 @@
 using namespace XFILE;
 using namespace VIDEO;
 
+// extractions running at once, each reads from a different source
+#define THUMB_EXTRACT_JOBS 3
+
 CThumbExtractor::CThumbExtractor(const CFileItem& item,
                                  const std::string& listpath,
                                  bool thumb,
@@ -66,6 +70,8 @@ CThumbExtractor::CThumbExtractor(const CFileItem& item,
 
   if (m_item.IsStack())
     m_item.SetPath(CStackDirectory::GetFirstStackedFile(m_item.GetPath()));
+
+  m_source = GetSource(m_item.GetPath());
 }
 
 CThumbExtractor::~CThumbExtractor()
@@ -84,6 +90,20 @@ bool CThumbExtractor::operator==(const CJob* job) const
   return false;
 }
 
+std::string CThumbExtractor::GetSource(const std::string &path)
+{
+  CURL url(path);
+  if (!url.IsLocal())
+    return url.GetProtocol() + "://" + url.GetHostName() + "/" + url.GetShareName();
+
+  // the first two levels of a local path, which usually tell drives and
+  // mount points apart
+  size_t pos = 0;
+  for (int i = 0; i < 2 && pos != std::string::npos; i++)
+    pos = path.find_first_of("/\\", pos + 1);
+  return path.substr(0, pos);
+}
+
 bool CThumbExtractor::DoWork()
 {
   if (m_item.IsLiveTV()
@@ -134,6 +154,10 @@ bool CThumbExtractor::DoWork()
         }
       }
     }
+    // the stream details were read before decoding failed, store them so
+    // the file isn't opened again just for them
+    else if (m_fillStreamDetails && m_item.GetVideoInfoTag()->HasStreamDetails())
+      result = true;
   }
   else if (!m_item.IsPlugin() &&
            (!m_item.HasVideoInfoTag() ||
@@ -183,7 +207,7 @@ bool CThumbExtractor::DoWork()
 }
 
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(), CJobQueue(true, 1, CJob::PRIORITY_LOW_PAUSABLE)
+  CThumbLoader(), CJobQueue(true, THUMB_EXTRACT_JOBS, CJob::PRIORITY_LOW_PAUSABLE)
 {
   m_videoDatabase = new CVideoDatabase();
 }
@@ -566,6 +590,23 @@ std::string CVideoThumbLoader::GetEmbeddedThumbURL(const CFileItem &item)
   return CTextureUtils::GetWrappedImageURL(path, "video");
 }
 
+bool CVideoThumbLoader::CanProcess(const CJob *job, const std::vector<const CJob*> &processing) const
+{
+  // reading several files of one disk or server at once is slower than
+  // reading them one after the other
+  const CThumbExtractor* extract = dynamic_cast<const CThumbExtractor*>(job);
+  if (!extract)
+    return true;
+
+  for (auto running : processing)
+  {
+    const CThumbExtractor* other = dynamic_cast<const CThumbExtractor*>(running);
+    if (other && other->m_source == extract->m_source)
+      return false;
+  }
+  return true;
+}
+
 void CVideoThumbLoader::OnJobComplete(unsigned int jobID, bool success, CJob* job)
 {
   if (success)
@@ -573,6 +614,8 @@ void CVideoThumbLoader::OnJobComplete(unsigned int jobID, bool success, CJob* jo
     CThumbExtractor* loader = (CThumbExtractor*)job;
     loader->m_item.SetPath(loader->m_listpath);
 
+    // jobs complete on their worker threads, observers expect one item at a time
+    CSingleLock lock(m_completeSection);
     if (m_pObserver)
       m_pObserver->OnItemLoaded(&loader->m_item);
     CFileItemPtr pItem(new CFileItem(loader->m_item));
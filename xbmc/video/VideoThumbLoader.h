@@ -54,12 +54,19 @@ public:
 
   virtual bool operator==(const CJob* job) const;
 
+  /*!
+   \brief Tell which drive or server a path is read from.
+   Extractions reading from the same source are run one after the other.
+   */
+  static std::string GetSource(const std::string &path);
+
   std::string m_target; ///< thumbpath
   std::string m_listpath; ///< path used in fileitem list
   CFileItem  m_item;
   bool       m_thumb; ///< extract thumb?
   int64_t    m_pos; ///< position to extract thumb from
   bool m_fillStreamDetails; ///< fill in stream details? 
+  std::string m_source; ///< drive or server the file is read from
 };
 
 class CVideoThumbLoader : public CThumbLoader, public CJobQueue
@@ -127,7 +134,10 @@ public:
   static void SetArt(CFileItem &item, const std::map<std::string, std::string> &artwork);
 
 protected:
+  virtual bool CanProcess(const CJob *job, const std::vector<const CJob*> &processing) const;
+
   CVideoDatabase *m_videoDatabase;
+  CCriticalSection m_completeSection;
   typedef std::map<int, std::map<std::string, std::string> > ArtCache;
   ArtCache m_showArt;
   ArtCache m_seasonArt;
@@ -1260,6 +1260,57 @@ std::string CGUIWindowVideoNav::GetStartFolder(const std::string &dir)
   return CGUIWindowVideoBase::GetStartFolder(dir);
 }
 
+CMediaLibraryChanges* CGUIWindowVideoNav::GetLibraryChanges() const
+{
+  return &CVideoDatabase::GetLibraryChanges();
+}
+
+bool CGUIWindowVideoNav::GetLibraryItems(const MediaType &mediaType, const std::set<int> &ids, CFileItemList &items)
+{
+  // the unfiltered items are patched, so get them without the filter
+  const std::string path = RemoveParameterFromPath(m_strFilterPath.empty() ? m_vecItems->GetPath() : m_strFilterPath, "filter");
+  if (!URIUtils::IsProtocol(path, "videodb"))
+    return false;
+
+  // only lists which are described completely by their path, unlike e.g.
+  // recently added or in progress items, can be retrieved item by item
+  NODE_TYPE node = CVideoDatabaseDirectory::GetDirectoryChildType(path);
+  std::string idField;
+  if (node == NODE_TYPE_TITLE_MOVIES && mediaType == MediaTypeMovie)
+    idField = "movie_view.idMovie";
+  else if (node == NODE_TYPE_TITLE_TVSHOWS && mediaType == MediaTypeTvShow)
+    idField = "tvshow_view.idShow";
+  else if (node == NODE_TYPE_EPISODES && mediaType == MediaTypeEpisode)
+    idField = "episode_view.idEpisode";
+  else if (node == NODE_TYPE_TITLE_MUSICVIDEOS && mediaType == MediaTypeMusicVideo)
+    idField = "musicvideo_view.idMVideo";
+  else
+    return false;
+
+  if (ids.empty())
+    return true;
+
+  std::vector<std::string> idList;
+  for (int id : ids)
+    idList.push_back(StringUtils::Format("%i", id));
+
+  CDatabase::Filter filter;
+  filter.AppendWhere(idField + " IN (" + StringUtils::Join(idList, ",") + ")");
+
+  // the stream details would be loaded by the thumb loader otherwise
+  if (mediaType == MediaTypeMovie)
+    return m_database.GetMoviesByWhere(path, filter, items, SortDescription(), VideoDbDetailsStream);
+  if (mediaType == MediaTypeTvShow)
+  {
+    if (!CServiceBroker::GetSettings().GetBool(CSettings::SETTING_VIDEOLIBRARY_SHOWEMPTYTVSHOWS))
+      filter.AppendWhere("totalCount IS NOT NULL AND totalCount > 0");
+    return m_database.GetTvShowsByWhere(path, filter, items);
+  }
+  if (mediaType == MediaTypeEpisode)
+    return m_database.GetEpisodesByWhere(path, filter, items, false, SortDescription(), VideoDbDetailsStream);
+  return m_database.GetMusicVideosByWhere(path, filter, items, true, SortDescription(), VideoDbDetailsStream);
+}
+
 bool CGUIWindowVideoNav::ApplyWatchedFilter(CFileItemList &items)
 {
   bool listchanged = false;
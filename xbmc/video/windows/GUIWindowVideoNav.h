@@ -83,6 +83,8 @@ protected:
   bool OnAddMediaSource() override;
   virtual bool OnClick(int iItem, const std::string &player = "") override;
   virtual std::string GetStartFolder(const std::string &dir) override;
+  CMediaLibraryChanges* GetLibraryChanges() const override;
+  bool GetLibraryItems(const MediaType &mediaType, const std::set<int> &ids, CFileItemList &items) override;
 
   VECSOURCES m_shares;
 
@@ -52,6 +52,8 @@
 #include "guilib/LocalizeStrings.h"
 #include "interfaces/generic/ScriptInvocationManager.h"
 #include "input/Key.h"
+#include "media/MediaLibraryChanges.h"
+#include "music/tags/MusicInfoTag.h"
 #include "network/Network.h"
 #include "playlists/PlayList.h"
 #include "profiles/ProfilesManager.h"
@@ -66,6 +68,7 @@
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
+#include "video/VideoInfoTag.h"
 #include "view/GUIViewState.h"
 
 #define CONTROL_BTNVIEWASICONS       2
@@ -90,6 +93,7 @@ CGUIMediaWindow::CGUIMediaWindow(int id, const char *xmlFile)
   m_loadType = KEEP_IN_MEMORY;
   m_vecItems = new CFileItemList;
   m_unfilteredItems = new CFileItemList;
+  m_libraryRevision = 0;
   m_vecItems->SetPath("?");
   m_iLastControl = -1;
   m_canFilterAdvanced = false;
@@ -366,7 +370,7 @@ bool CGUIMediaWindow::OnMessage(CGUIMessage& message)
           list.RemoveDiscCache(GetID());
           Update(message.GetStringParam());
         }
-        else
+        else if (!UpdateChangedItems())
           Refresh(true); // refresh the listing
       }
       else if (message.GetParam1()==GUI_MSG_UPDATE_ITEM && message.GetItem())
@@ -629,6 +633,9 @@ void CGUIMediaWindow::FormatItemLabels(CFileItemList &items, const LABEL_MASKS &
       folderFormatter.FormatLabels(pItem.get());
     else
       fileFormatter.FormatLabels(pItem.get());
+
+    // the tags of the visible items are created again when they are shown
+    pItem->ReleaseMusicInfoTag();
   }
 
   if (items.GetSortMethod() == SortByLabel)
@@ -772,6 +779,10 @@ bool CGUIMediaWindow::Update(const std::string &strDirectory, bool updateFilterP
   if (CanContainFilter(pathNoFilter) && CURL(pathNoFilter).HasOption("filter"))
     pathNoFilter = RemoveParameterFromPath(pathNoFilter, "filter");
 
+  // any library changes made from now on are applied by UpdateChangedItems()
+  const CMediaLibraryChanges* libraryChanges = GetLibraryChanges();
+  m_libraryRevision = libraryChanges ? libraryChanges->GetRevision() : 0;
+
   if (!GetDirectory(pathNoFilter, *m_vecItems))
   {
     CLog::Log(LOGERROR,"CGUIMediaWindow::GetDirectory(%s) failed", CURL(path).GetRedacted().c_str());
@@ -898,6 +909,94 @@ bool CGUIMediaWindow::Refresh(bool clearCache /* = false */)
   return true;
 }
 
+static int GetLibraryId(const CFileItem &item, const MediaType &mediaType)
+{
+  if (item.HasVideoInfoTag() && item.GetVideoInfoTag()->m_type == mediaType)
+    return item.GetVideoInfoTag()->m_iDbId;
+  if (item.HasMusicInfoTag() && item.GetMusicInfoTag()->GetType() == mediaType)
+    return item.GetMusicInfoTag()->GetDatabaseId();
+  return -1;
+}
+
+bool CGUIMediaWindow::UpdateChangedItems()
+{
+  CMediaLibraryChanges* libraryChanges = GetLibraryChanges();
+  if (libraryChanges == nullptr)
+    return false;
+
+  // without any changes of items we don't know why the list has to be refreshed
+  uint64_t revision = m_libraryRevision;
+  std::vector<CMediaLibraryChanges::Change> changes;
+  if (!libraryChanges->GetChanges(revision, changes) || changes.empty())
+    return false;
+
+  // only the last change of every item matters
+  std::map<MediaType, std::map<int, CMediaLibraryChanges::ChangeType>> changedItems;
+  for (const auto &change : changes)
+  {
+    // new items have to be retrieved with the whole list to be placed correctly
+    if (change.type == CMediaLibraryChanges::Added)
+      return false;
+    changedItems[change.mediaType][change.id] = change.type;
+  }
+
+  for (const auto &mediaType : changedItems)
+  {
+    std::set<int> updatedIds;
+    for (const auto &changedItem : mediaType.second)
+    {
+      if (changedItem.second == CMediaLibraryChanges::Updated)
+        updatedIds.insert(changedItem.first);
+    }
+
+    // retrieving most of the items one by one is slower than retrieving the whole list
+    if (updatedIds.size() > static_cast<size_t>(m_unfilteredItems->Size() / 2))
+      return false;
+
+    CFileItemList items;
+    if (!GetLibraryItems(mediaType.first, updatedIds, items))
+      return false;
+
+    std::map<int, CFileItemPtr> updatedItems;
+    for (int i = 0; i < items.Size(); i++)
+      updatedItems.insert(std::make_pair(GetLibraryId(*items[i], mediaType.first), items[i]));
+
+    CLog::Log(LOGDEBUG, "CGUIMediaWindow::UpdateChangedItems - %i of %u changed %s items retrieved",
+              items.Size(), static_cast<unsigned int>(mediaType.second.size()), mediaType.first.c_str());
+
+    for (int i = 0; i < m_unfilteredItems->Size(); )
+    {
+      CFileItemPtr item = m_unfilteredItems->Get(i);
+      const int id = GetLibraryId(*item, mediaType.first);
+      const auto changedItem = id >= 0 ? mediaType.second.find(id) : mediaType.second.end();
+      if (changedItem == mediaType.second.end())
+      {
+        i++;
+        continue;
+      }
+
+      const auto updatedItem = updatedItems.find(changedItem->first);
+      if (changedItem->second == CMediaLibraryChanges::Updated && updatedItem != updatedItems.end())
+      {
+        item->UpdateInfo(*updatedItem->second);
+        item->AppendProperties(*updatedItem->second);
+        i++;
+      }
+      else // removed from the library or not part of this list anymore
+        m_unfilteredItems->Remove(i);
+    }
+  }
+
+  m_libraryRevision = revision;
+  m_vecItems->RemoveDiscCache(GetID());
+
+  // filter, group and sort the items again as Update() does
+  OnFilterItems(GetProperty("filter").asString());
+  UpdateButtons();
+
+  return true;
+}
+
 /*!
  * \brief On prepare file items
  *
@@ -20,15 +20,20 @@
  *
  */
 
+#include <set>
+#include <stdint.h>
+
 #include "dialogs/GUIDialogContextMenu.h"
 #include "filesystem/DirectoryHistory.h"
 #include "filesystem/VirtualDirectory.h"
 #include "guilib/GUIWindow.h"
+#include "media/MediaType.h"
 #include "playlists/SmartPlayList.h"
 #include "view/GUIViewControl.h"
 
 class CFileItemList;
 class CGUIViewState;
+class CMediaLibraryChanges;
 
 // base class for all media windows
 class CGUIMediaWindow : public CGUIWindow
@@ -106,6 +111,27 @@ protected:
    \sa GetDirectory
    */
   virtual bool Refresh(bool clearCache = false);
+  /*! \brief Updates the current list with the library changes made since it was retrieved
+   Only the changed items are retrieved again and patched into the list, which is
+   then filtered, grouped and sorted again.
+   \return true if the list was updated, false if it has to be refreshed instead
+   \sa GetLibraryChanges
+   \sa GetLibraryItems
+   */
+  bool UpdateChangedItems();
+  /*! \brief Get the feed of changes of the library the items of this window come from
+   \return the feed or nullptr if the window doesn't show library items
+   \sa UpdateChangedItems
+   */
+  virtual CMediaLibraryChanges* GetLibraryChanges() const { return nullptr; }
+  /*! \brief Retrieves the given items of the current list again
+   \param mediaType Media type of the items
+   \param ids Database ids of the items
+   \param items Items which are still part of the current list
+   \return false if the current list doesn't consist of library items of the given type
+   \sa UpdateChangedItems
+   */
+  virtual bool GetLibraryItems(const MediaType &mediaType, const std::set<int> &ids, CFileItemList &items) { return false; }
 
   virtual void FormatAndSort(CFileItemList &items);
   virtual void OnPrepareFileItems(CFileItemList &items);
@@ -187,6 +213,7 @@ protected:
   // current path and history
   CFileItemList* m_vecItems;
   CFileItemList* m_unfilteredItems;        ///< \brief items prior to filtering using FilterItems()
+  uint64_t m_libraryRevision;              ///< \brief revision of the library changes included in the items
   CDirectoryHistory m_history;
   std::unique_ptr<CGUIViewState> m_guiState;
 